@@ -0,0 +1,95 @@
+// Attitude integration: RKMK4 on the unit quaternions versus plain RK4 on
+// the quaternion components, torque-free, at the 200 Hz attitude step and
+// at steps stretched by time warp; then the cost of a held step with the
+// gravity-gradient and RCS torques.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/AttitudeDynamics.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    constexpr int STEP_COUNT = 1000000;
+    
+    struct TorqueFree {
+        glm::dvec3 operator()(double, const glm::dquat&, const glm::dvec3&) const { return glm::dvec3(0.0); }
+    };
+    
+    // RK4 on (q, w) as eight numbers, q' = q * (0, w) / 2
+    void stepComponentRK4(glm::dquat& q, glm::dvec3& w, double h, const RigidBody& body) {
+        auto derivative = [&](const glm::dquat& attitude, const glm::dvec3& rate,
+                              glm::dquat& outAttitude, glm::dvec3& outRate) {
+            outAttitude = attitude * glm::dquat(0.0, rate.x, rate.y, rate.z) * 0.5;
+            outRate = body.angularAcceleration(rate, glm::dvec3(0.0));
+        };
+        glm::dquat k1, k2, k3, k4;
+        glm::dvec3 a1, a2, a3, a4;
+        derivative(q, w, k1, a1);
+        derivative(q + k1 * (0.5 * h), w + (0.5 * h) * a1, k2, a2);
+        derivative(q + k2 * (0.5 * h), w + (0.5 * h) * a2, k3, a3);
+        derivative(q + k3 * h, w + h * a3, k4, a4);
+        q = q + (k1 + k2 * 2.0 + k3 * 2.0 + k4) * (h / 6.0);
+        w = w + (h / 6.0) * (a1 + 2.0 * a2 + 2.0 * a3 + a4);
+    }
+    
+    double kineticEnergy(const RigidBody& body, const glm::dvec3& w) {
+        return 0.5 * glm::dot(w, body.inertia * w);
+    }
+}
+
+void runAttitudeBench() {
+    Bench::printHeader("Attitude, 10^6 torque-free steps (RKMK4 vs RK4 on quaternion components)");
+    
+    RigidBody body;
+    const glm::dvec3 initialRate(0.3, 0.01, 0.2);   // rad/s, tumbling about all three axes
+    
+    std::printf("  %-8s %-10s %10s %12s %12s\n", "step", "method", "ns/step", "|q| - 1", "energy err");
+    for (double h : {AttitudeDynamics::STEP, 0.1, 0.5}) {
+        for (int method = 0; method < 2; ++method) {
+            glm::dquat q(1.0, 0.0, 0.0, 0.0);
+            glm::dvec3 w = initialRate;
+            double seconds = Bench::measure([&]() {
+                for (int i = 0; i < STEP_COUNT; ++i) {
+                    if (method == 0) {
+                        AttitudeDynamics::stepRKMK4(q, w, i * h, h, body, TorqueFree{});
+                    } else {
+                        stepComponentRK4(q, w, h, body);
+                    }
+                }
+            });
+            double energy = kineticEnergy(body, initialRate);
+            std::printf("  %-8.3g %-10s %10.1f %12.2e %12.2e\n", h, method == 0 ? "RKMK4" : "RK4",
+                        seconds / STEP_COUNT * 1e9, glm::length(q) - 1.0,
+                        (kineticEnergy(body, w) - energy) / energy);
+            Bench::consume(q.w);
+        }
+    }
+    
+    // Held attitude on a 100 km circular orbit, as the warp scheduler runs it
+    SpacecraftState state;
+    AttitudeSpan span;
+    span.duration = AttitudeDynamics::MAX_STEPS * AttitudeDynamics::STEP;
+    double radius = Constants::MOON_RADIUS + 100000.0;
+    double speed = std::sqrt(Constants::MOON_MU / radius);
+    double angle = speed / radius * span.duration;
+    span.startPosition = glm::dvec3(radius, 0.0, 0.0);
+    span.endPosition = radius * glm::dvec3(std::cos(angle), std::sin(angle), 0.0);
+    span.startTarget = AttitudeDynamics::computeHoldAttitude(glm::dvec3(0.0, 1.0, 0.0), span.startPosition,
+                                                             glm::dvec3(0.0, speed, 0.0));
+    span.endTarget = AttitudeDynamics::computeHoldAttitude(glm::dvec3(-std::sin(angle), std::cos(angle), 0.0),
+                                                           span.endPosition,
+                                                           speed * glm::dvec3(-std::sin(angle), std::cos(angle), 0.0));
+    state.attitude = span.startTarget;
+    
+    const int spans = STEP_COUNT / AttitudeDynamics::MAX_STEPS;
+    int steps = 0;
+    double seconds = Bench::measure([&]() {
+        for (int i = 0; i < spans; ++i) {
+            steps += AttitudeDynamics::advance(state, body, span, Constants::MOON_MU);
+        }
+    });
+    std::printf("  held step (gravity gradient + RCS): %.1f ns, %.1f us per %d-step span\n",
+                seconds / steps * 1e9, seconds / spans * 1e6, AttitudeDynamics::MAX_STEPS);
+    Bench::consume(state.attitude.w);
+}
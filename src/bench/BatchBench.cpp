@@ -0,0 +1,95 @@
+// Many-state coast throughput: one SpacecraftState at a time through
+// Integrator::stepRK4 (array of structures) versus BatchPropagator's
+// structure-of-arrays kernels at each instruction set this CPU supports.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/BatchPropagator.h"
+#include "physics/Gravity.h"
+#include "physics/Integrator.h"
+#include "physics/Orbit.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    // Spread of circular-to-mildly-elliptical orbits from 100 to 2000 km
+    void makeInitialStates(size_t count, std::vector<SpacecraftState>& states, StateBatch& batch) {
+        states.resize(count);
+        batch.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            double f = static_cast<double>(i) / static_cast<double>(count);
+            OrbitalElements elements;
+            elements.semiMajorAxis = Constants::MOON_RADIUS + 100000.0 + 1900000.0 * f;
+            elements.eccentricity = 0.2 * std::fmod(f * 7.0, 1.0);
+            elements.inclination = Constants::PI * std::fmod(f * 13.0, 1.0);
+            elements.raan = Constants::TWO_PI * std::fmod(f * 17.0, 1.0);
+            elements.argOfPeriapsis = Constants::TWO_PI * std::fmod(f * 19.0, 1.0);
+            elements.trueAnomaly = Constants::TWO_PI * f;
+            
+            Orbit::computeStateFromElements(elements, Constants::MOON_MU, states[i].position, states[i].velocity);
+            batch.set(i, states[i].position, states[i].velocity);
+        }
+    }
+}
+
+void runBatchBench() {
+    Bench::printHeader("Batch coast throughput, RK4 point mass (AoS vs SoA SIMD)");
+    
+    const double dt = 10.0;
+    const int steps = 100;
+    PointMassForceModel forceModel{Constants::MOON_MU};
+    
+    const BatchPropagator::SimdLevel levels[] = {
+        BatchPropagator::SimdLevel::Scalar,
+        BatchPropagator::SimdLevel::AVX2,
+        BatchPropagator::SimdLevel::AVX512
+    };
+    
+    std::printf("  %-14s %9s %12s %14s %9s %12s\n",
+                "path", "states", "time", "state-steps/s", "speedup", "max |dr| (m)");
+    
+    for (size_t count : {size_t(10000), size_t(100000)}) {
+        std::vector<SpacecraftState> initialStates;
+        StateBatch initialBatch;
+        makeInitialStates(count, initialStates, initialBatch);
+        double work = static_cast<double>(count) * steps;
+        
+        // Reference: the per-spacecraft path
+        std::vector<SpacecraftState> states = initialStates;
+        double aosSeconds = Bench::measure([&]() {
+            for (SpacecraftState& state : states) {
+                for (int i = 0; i < steps; ++i) {
+                    Integrator::stepRK4(state, dt, forceModel);
+                }
+            }
+        });
+        std::printf("  %-14s %9zu %9.1f ms %14.3e %8.2fx %12s\n",
+                    "AoS Integrator", count, aosSeconds * 1e3, work / aosSeconds, 1.0, "-");
+        Bench::consume(states[0].position.x);
+        
+        for (BatchPropagator::SimdLevel level : levels) {
+            if (!BatchPropagator::isSupported(level)) {
+                std::printf("  SoA %-10s %9zu   (not supported on this build/CPU)\n",
+                            BatchPropagator::getSimdLevelName(level), count);
+                continue;
+            }
+            
+            StateBatch batch = initialBatch;
+            double seconds = Bench::measure([&]() {
+                BatchPropagator::propagateRK4(batch, dt, steps, Constants::MOON_MU, 0, batch.size(), level);
+            });
+            
+            double maxDiff = 0.0;
+            for (size_t i = 0; i < count; ++i) {
+                maxDiff = std::max(maxDiff, glm::length(batch.getPosition(i) - states[i].position));
+            }
+            
+            std::printf("  SoA %-10s %9zu %9.1f ms %14.3e %8.2fx %12.3e\n",
+                        BatchPropagator::getSimdLevelName(level), count, seconds * 1e3,
+                        work / seconds, aosSeconds / seconds, maxDiff);
+            Bench::consume(batch.x[0]);
+        }
+    }
+}
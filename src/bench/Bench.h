@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+class GravityField;
+
+// Minimal benchmark helpers shared by the artemis-bench suites
+namespace Bench {
+    // Wall-clock seconds taken by one call of fn
+    template <typename Fn>
+    double measure(Fn&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+    
+    // Keep a result observable so the optimizer cannot drop the work
+    void consume(double value);
+    
+    void printHeader(const std::string& title);
+    
+    // Synthetic lunar field with Kaula-rule magnitudes (1e-4 / n^2); cost
+    // does not depend on the values, only on the degree
+    GravityField makeKaulaField(int degree);
+}
+
+// Benchmark suites (one per source file in src/bench)
+void runIntegratorBench();
+void runPredictionBench();
+void runSymplecticBench();
+void runBatchBench();
+void runElementBench();
+void runKeplerBench();
+void runGravityBench();
+void runCR3BPBench();
+void runTransitionBench();
+void runLambertBench();
+void runAttitudeBench();
+void runBurnBench();
+void runFleetBench();
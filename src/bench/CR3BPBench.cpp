@@ -0,0 +1,57 @@
+// Earth-Moon CR3BP: Bulirsch-Stoer versus Dormand-Prince on one revolution
+// of the 9:2 NRHO, integrated in the rotating frame where the orbit closes.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/CR3BP.h"
+#include "physics/Integrator.h"
+#include "physics/Scenario.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // Two synodic months over nine revolutions
+    constexpr double NRHO_PERIOD = 2.0 * 29.530589 * Constants::SECONDS_PER_DAY / 9.0;
+    constexpr int REPEATS = 20;
+}
+
+void runCR3BPBench() {
+    Bench::printHeader("CR3BP: one revolution of the 9:2 NRHO, rotating frame");
+    
+    Spacecraft spacecraft;
+    Scenarios::apply(Scenarios::getBuiltIn(3), spacecraft);
+    SpacecraftState initial = spacecraft.getState();
+    CR3BP::inertialToRotating(initial.position, initial.velocity, 0.0, initial.position, initial.velocity);
+    const double jacobi0 = CR3BP::jacobiConstant(initial.position, initial.velocity);
+    const CR3BPForceModel forceModel;
+    
+    std::printf("  %-16s %8s %8s %12s %12s %12s %10s\n",
+                "method", "relTol", "steps", "evaluations", "closure (m)", "|dC|", "time");
+    
+    for (double tolerance : {1e-8, 1e-10, 1e-12}) {
+        AdaptiveOptions options;
+        options.relTol = tolerance;
+        options.absTol = tolerance * 1000.0;
+        
+        for (bool extrapolate : {false, true}) {
+            SpacecraftState end;
+            AdaptiveStats stats;
+            double seconds = Bench::measure([&]() {
+                for (int i = 0; i < REPEATS; ++i) {
+                    stats = AdaptiveStats{};
+                    end = extrapolate
+                        ? Integrator::propagateBulirschStoer(initial, NRHO_PERIOD, forceModel, options, nullptr, &stats)
+                        : Integrator::propagateAdaptive(initial, NRHO_PERIOD, forceModel, options, nullptr, &stats);
+                }
+            });
+            Bench::consume(end.position.x);
+            
+            double closure = glm::length(end.position - initial.position);
+            double drift = std::abs(CR3BP::jacobiConstant(end.position, end.velocity) - jacobi0);
+            std::printf("  %-16s %8.0e %8d %12d %12.3f %12.2e %7.3f ms\n",
+                        extrapolate ? "Bulirsch-Stoer" : "Dormand-Prince", tolerance,
+                        stats.acceptedSteps, stats.evaluations, closure, drift,
+                        seconds * 1000.0 / REPEATS);
+        }
+    }
+}
@@ -0,0 +1,113 @@
+// State vector <-> orbital element conversion throughput: Orbit's
+// one-state functions versus BatchOrbit's structure-of-arrays kernels at
+// each instruction set this CPU supports, with the round-trip error of each.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/BatchOrbit.h"
+#include "physics/Orbit.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    constexpr size_t STATE_COUNT = 1000000;
+    
+    // Every kind of conic the kernels select between: inclined ellipses and
+    // hyperbolas, circles, and equatorial ellipses both ways round
+    void makeStates(StateBatch& batch) {
+        batch.resize(STATE_COUNT);
+        for (size_t i = 0; i < STATE_COUNT; ++i) {
+            double f = static_cast<double>(i) / static_cast<double>(STATE_COUNT);
+            int kind = static_cast<int>(i % 10);
+            OrbitalElements e;
+            e.eccentricity = kind < 6 ? 0.9 * std::fmod(f * 7.0, 1.0)
+                           : kind < 8 ? 1.05 + 2.0 * std::fmod(f * 7.0, 1.0)
+                           : kind < 9 ? 0.0 : 0.5 * std::fmod(f * 7.0, 1.0);
+            double periapsis = Constants::MOON_RADIUS + 100000.0 + 3000000.0 * std::fmod(f * 11.0, 1.0);
+            e.semiMajorAxis = periapsis / (1.0 - e.eccentricity);
+            e.inclination = kind < 9 ? 0.01 + 3.12 * std::fmod(f * 13.0, 1.0) : (i % 20 < 10 ? 0.0 : Constants::PI);
+            e.raan = Constants::TWO_PI * std::fmod(f * 17.0, 1.0);
+            e.argOfPeriapsis = Constants::TWO_PI * std::fmod(f * 19.0, 1.0);
+            // Stay clear of a hyperbola's asymptotes
+            double maxAnomaly = e.eccentricity > 1.0 ? 0.9 * std::acos(-1.0 / e.eccentricity) : Constants::PI;
+            e.trueAnomaly = maxAnomaly * (2.0 * std::fmod(f * 23.0, 1.0) - 1.0);
+            
+            glm::dvec3 position, velocity;
+            Orbit::computeStateFromElements(e, Constants::MOON_MU, position, velocity);
+            batch.set(i, position, velocity);
+        }
+    }
+    
+    // Largest |dr| / r between two batches
+    double maxRelativeError(const StateBatch& a, const StateBatch& b) {
+        double maxError = 0.0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            glm::dvec3 position = a.getPosition(i);
+            maxError = std::max(maxError, glm::length(b.getPosition(i) - position) / glm::length(position));
+        }
+        return maxError;
+    }
+}
+
+void runElementBench() {
+    Bench::printHeader("State <-> element conversion, 10^6 mixed conics (Orbit vs SoA SIMD)");
+    
+    StateBatch states;
+    makeStates(states);
+    const double count = static_cast<double>(STATE_COUNT);
+    
+    std::printf("  %-14s %14s %9s %14s %9s %14s\n",
+                "path", "to elements", "speedup", "to states", "speedup", "round trip dr/r");
+    
+    // Reference: one state at a time
+    std::vector<OrbitalElements> elements(STATE_COUNT);
+    double scalarElementSeconds = Bench::measure([&]() {
+        for (size_t i = 0; i < STATE_COUNT; ++i) {
+            elements[i] = Orbit::computeElements(states.getPosition(i), states.getVelocity(i), Constants::MOON_MU);
+        }
+    });
+    StateBatch roundTrip;
+    roundTrip.resize(STATE_COUNT);
+    double scalarStateSeconds = Bench::measure([&]() {
+        glm::dvec3 position, velocity;
+        for (size_t i = 0; i < STATE_COUNT; ++i) {
+            Orbit::computeStateFromElements(elements[i], Constants::MOON_MU, position, velocity);
+            roundTrip.set(i, position, velocity);
+        }
+    });
+    std::printf("  %-14s %11.1f ns %8.2fx %11.1f ns %8.2fx %14.2e\n", "Orbit",
+                scalarElementSeconds / count * 1e9, 1.0, scalarStateSeconds / count * 1e9, 1.0,
+                maxRelativeError(states, roundTrip));
+    Bench::consume(elements[0].trueAnomaly);
+    
+    const BatchPropagator::SimdLevel levels[] = {
+        BatchPropagator::SimdLevel::Scalar,
+        BatchPropagator::SimdLevel::AVX2,
+        BatchPropagator::SimdLevel::AVX512
+    };
+    
+    ElementBatch batch;
+    batch.resize(STATE_COUNT);
+    for (BatchPropagator::SimdLevel level : levels) {
+        if (!BatchPropagator::isSupported(level)) {
+            std::printf("  SoA %-10s   (not supported on this build/CPU)\n", BatchPropagator::getSimdLevelName(level));
+            continue;
+        }
+        
+        double elementSeconds = Bench::measure([&]() {
+            BatchOrbit::computeElements(states, Constants::MOON_MU, batch, 0, STATE_COUNT, level);
+        });
+        double stateSeconds = Bench::measure([&]() {
+            BatchOrbit::computeStates(batch, Constants::MOON_MU, roundTrip, 0, STATE_COUNT, level);
+        });
+        
+        std::printf("  SoA %-10s %11.1f ns %8.2fx %11.1f ns %8.2fx %14.2e\n",
+                    BatchPropagator::getSimdLevelName(level),
+                    elementSeconds / count * 1e9, scalarElementSeconds / elementSeconds,
+                    stateSeconds / count * 1e9, scalarStateSeconds / stateSeconds,
+                    maxRelativeError(states, roundTrip));
+        Bench::consume(batch.trueAnomaly[0]);
+    }
+}
@@ -0,0 +1,87 @@
+// Fleet tick cost against fleet size: every vehicle through its own
+// Integrator::stepRK4 calls (what one Spacecraft per vehicle costs) versus
+// Fleet::advance, which coasts the whole fleet through the batched kernels,
+// with nobody burning and with one vehicle in a hundred burning. Then the
+// copy into the render instances. One physics tick at 1x, 1000x and
+// 100000x warp.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/Fleet.h"
+#include "physics/GravityField.h"
+#include "physics/Integrator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+    constexpr double TICK_RATE = 240.0;         // Hz, as Simulation
+    constexpr double WORK_PER_RUN = 2.0e5;      // vehicle-steps timed per measurement
+    constexpr uint64_t SEED = 2024;
+    
+    // Microseconds per tick of ticks calls of fn
+    template <typename Fn>
+    double measureTick(int ticks, Fn&& fn) {
+        return Bench::measure([&]() {
+            for (int i = 0; i < ticks; ++i) {
+                fn();
+            }
+        }) / ticks * 1e6;
+    }
+}
+
+void runFleetBench() {
+    Bench::printHeader("Fleet tick, point mass (one integrator per vehicle vs batched SoA)");
+    std::printf("  batched kernels: %s\n",
+                BatchPropagator::getSimdLevelName(BatchPropagator::getBestSimdLevel()));
+    
+    GravityFieldForceModel forceModel;
+    forceModel.mu = Constants::MOON_MU;
+    
+    for (int warp : {1, 1000, 100000}) {
+        double dt = warp / TICK_RATE;
+        int steps = std::max(1, static_cast<int>(std::ceil(dt / Fleet::MAX_STEP)));
+        double h = dt / steps;
+        std::printf("\n  %dx warp: %.4g s per tick, %d step(s) of %.4g s\n", warp, dt, steps, h);
+        std::printf("  %-8s %14s %14s %14s %14s %14s\n", "vehicles", "separate us",
+                    "fleet us", "1% burning us", "instances us", "fleet ns/veh");
+        
+        for (size_t count : {size_t(1), size_t(10), size_t(100), size_t(1000)}) {
+            Fleet initial;
+            initial.spawn(count, SEED);
+            int ticks = std::max(1, static_cast<int>(WORK_PER_RUN / (static_cast<double>(count) * steps)));
+            
+            std::vector<SpacecraftState> states(count);
+            for (size_t i = 0; i < count; ++i) {
+                states[i].position = initial.getPosition(i);
+                states[i].velocity = initial.getVelocity(i);
+            }
+            double separate = measureTick(ticks, [&]() {
+                for (SpacecraftState& state : states) {
+                    for (int s = 0; s < steps; ++s) {
+                        Integrator::stepRK4(state, h, forceModel);
+                    }
+                }
+            });
+            
+            Fleet fleet = initial;
+            double batched = measureTick(ticks, [&]() { fleet.advance(dt, Constants::MOON_MU); });
+            
+            // Long burns, so they last through every tick timed
+            Fleet burning = initial;
+            for (size_t i = 0; i < count; i += 100) {
+                burning.startBurn(i, 0.01, Spacecraft::ThrustMode::Prograde, 1.0e9);
+            }
+            double withBurns = measureTick(ticks, [&]() { burning.advance(dt, Constants::MOON_MU); });
+            
+            std::vector<FleetInstance> instances;
+            double exported = measureTick(ticks, [&]() { fleet.exportInstances(instances); });
+            
+            std::printf("  %-8zu %14.2f %14.2f %14.2f %14.2f %14.1f\n", count, separate, batched,
+                        withBurns, exported, batched / count * 1e3);
+            Bench::consume(states[0].position.x + fleet.getPosition(0).x + burning.getPosition(0).x +
+                           instances[0].position.x);
+        }
+    }
+}
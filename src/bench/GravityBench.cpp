@@ -0,0 +1,170 @@
+// Spherical-harmonic gravity: evaluations per second against degree, and
+// the share of one core that 50 Hz RK4 physics at 100x warp would need,
+// directly and through the precomputed cache; and the cost of the Earth and
+// Sun positions for third-body perturbations.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "core/ThreadPool.h"
+#include "physics/Ephemeris.h"
+#include "physics/GravityCache.h"
+#include "physics/GravityField.h"
+#include "physics/Integrator.h"
+#include "physics/Scenario.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+GravityField Bench::makeKaulaField(int degree) {
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<double> c(GravityField::index(degree + 1, 0), 0.0);
+    std::vector<double> s(c.size(), 0.0);
+    for (int n = 2; n <= degree; ++n) {
+        double sigma = 1e-4 / (static_cast<double>(n) * n);
+        for (int m = 0; m <= n; ++m) {
+            c[GravityField::index(n, m)] = sigma * normal(rng);
+            s[GravityField::index(n, m)] = (m == 0) ? 0.0 : sigma * normal(rng);
+        }
+    }
+    GravityField field;
+    field.setCoefficients(Constants::MOON_MU, 1738000.0, degree, std::move(c), std::move(s));
+    return field;
+}
+
+void runGravityBench() {
+    Bench::printHeader("Spherical-harmonic gravity (normalized Cunningham recursion)");
+    
+    // 50 Hz physics at 100x warp: 5000 RK4 steps, 4 evaluations each
+    const double requiredRate = 4.0 * 100.0 / Constants::FIXED_TIMESTEP;
+    const int maxDegree = 200;
+    GravityField field = Bench::makeKaulaField(maxDegree);
+    
+    Spacecraft spacecraft;
+    Scenarios::apply(Scenarios::getBuiltIn(1), spacecraft);
+    const SpacecraftState initial = spacecraft.getState();
+    
+    std::printf("  %-8s %14s %12s %22s\n", "degree", "evals/s", "ns/eval", "core share @100x");
+    
+    for (int degree : {0, 2, 4, 8, 16, 32, 50, 70, 100, 150, 200}) {
+        GravityFieldForceModel forceModel;
+        forceModel.mu = Constants::MOON_MU;
+        forceModel.field = &field;
+        forceModel.degree = degree;
+        
+        // Positions along the capture orbit, so latitude and radius vary
+        SpacecraftState state = initial;
+        const int evaluations = (degree < 20) ? 2000000 : 20000000 / (degree * degree / 20 + 1);
+        glm::dvec3 accel(0.0), velDeriv(0.0), sum(0.0);
+        double seconds = Bench::measure([&]() {
+            for (int i = 0; i < evaluations; ++i) {
+                forceModel(state, accel, velDeriv);
+                sum += accel;
+                state.position += state.velocity * 0.5;
+            }
+        });
+        Bench::consume(sum.x + sum.y + sum.z);
+        
+        double rate = evaluations / seconds;
+        std::printf("  %-8d %14.0f %12.0f %21.1f%%\n", degree, rate, 1e9 / rate, 100.0 * requiredRate / rate);
+    }
+    
+    // Precomputed cache against direct evaluation at the same degree, on a
+    // 100 km orbit inside the cached shell
+    const int cacheDegree = 50;
+    GravityCache cache;
+    GravityCache::BuildOptions options;
+    options.degree = cacheDegree;
+    options.minRadius = Constants::MOON_RADIUS - 10000.0;
+    options.maxRadius = Constants::MOON_RADIUS + 200000.0;
+    options.tolerance = 1e-5;
+    options.errorSamples = 5000;
+    ThreadPool pool;
+    std::string error;
+    double buildSeconds = Bench::measure([&]() {
+        if (!cache.build(field, options, pool, error)) {
+            std::printf("  cache build failed: %s\n", error.c_str());
+        }
+    });
+    if (!cache.isValid()) return;
+    
+    const GravityCache::ErrorReport& report = cache.getErrorReport();
+    std::printf("\n  Cache, degree %d, -10..200 km: %.1f MB, built in %.1f s on %u threads, "
+                "max error %.2e m/s^2 (rms %.2e)\n",
+                cacheDegree, cache.getByteSize() / 1e6, buildSeconds, pool.getThreadCount(),
+                report.maxError, report.rmsError);
+    
+    std::vector<SpacecraftState> orbit(4096);
+    const double radius = Constants::MOON_RADIUS + 100000.0;
+    const double inclination = 60.0 * Constants::DEG_TO_RAD;
+    for (size_t i = 0; i < orbit.size(); ++i) {
+        double angle = 2.0 * Constants::PI * i / orbit.size();
+        orbit[i].position = radius * glm::dvec3(std::cos(angle), std::sin(angle) * std::cos(inclination),
+                                                std::sin(angle) * std::sin(inclination));
+    }
+    
+    std::printf("  %-8s %14s %12s %22s\n", "method", "evals/s", "ns/eval", "core share @100x");
+    double directRate = 0.0;
+    for (bool cached : {false, true}) {
+        GravityFieldForceModel forceModel;
+        forceModel.mu = Constants::MOON_MU;
+        forceModel.field = &field;
+        forceModel.degree = cacheDegree;
+        forceModel.cache = cached ? &cache : nullptr;
+        
+        const int evaluations = cached ? 2000000 : 100000;
+        glm::dvec3 accel(0.0), velDeriv(0.0), sum(0.0);
+        double seconds = Bench::measure([&]() {
+            for (int i = 0; i < evaluations; ++i) {
+                forceModel(orbit[i % orbit.size()], accel, velDeriv);
+                sum += accel;
+            }
+        });
+        Bench::consume(sum.x + sum.y + sum.z);
+        
+        double rate = evaluations / seconds;
+        std::printf("  %-8s %14.0f %12.0f %21.1f%%", cached ? "cached" : "direct", rate, 1e9 / rate,
+                    100.0 * requiredRate / rate);
+        if (cached) {
+            std::printf("   %.0fx faster", rate / directRate);
+        } else {
+            directRate = rate;
+        }
+        std::printf("\n");
+    }
+    
+    // Earth and Sun positions: analytic series against the Chebyshev fit,
+    // once per force evaluation
+    Ephemeris ephemeris;
+    const double span = 365.25 * Constants::SECONDS_PER_DAY;
+    double fitSeconds = Bench::measure([&]() {
+        ephemeris.build(Constants::EPOCH_JULIAN_DATE, span);
+    });
+    std::printf("\n  Ephemeris, 1 year: fitted in %.1f ms, max fit error %.2f m\n",
+                1000.0 * fitSeconds, ephemeris.getFitError());
+    std::printf("  %-8s %14s %12s\n", "method", "evals/s", "ns/eval");
+    for (bool fitted : {false, true}) {
+        const int evaluations = 1000000;
+        glm::dvec3 earth(0.0), sun(0.0), sum(0.0);
+        double seconds = Bench::measure([&]() {
+            for (int i = 0; i < evaluations; ++i) {
+                double time = span * i / evaluations;
+                if (fitted) {
+                    ephemeris.getPositions(time, earth, sun);
+                } else {
+                    double julianDate = Constants::EPOCH_JULIAN_DATE + time / Constants::SECONDS_PER_DAY;
+                    glm::dvec3 moon = Ephemeris::moonFromEarth(julianDate);
+                    earth = -moon;
+                    sun = Ephemeris::sunFromEarth(julianDate) - moon;
+                }
+                sum += earth + sun;
+            }
+        });
+        Bench::consume(sum.x + sum.y + sum.z);
+        
+        double rate = evaluations / seconds;
+        std::printf("  %-8s %14.0f %12.0f\n", fitted ? "fitted" : "series", rate, 1e9 / rate);
+    }
+}
@@ -0,0 +1,76 @@
+// RK4 throughput on the 100 km circular LLO scenario: type-erased
+// DerivativeFunc versus the templated kernels with an inlined force model.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/Gravity.h"
+#include "physics/Integrator.h"
+#include "physics/Scenario.h"
+#include <cstdio>
+
+namespace {
+    constexpr long long NUM_STEPS = 2000000;
+    constexpr double DT = Constants::FIXED_TIMESTEP;
+    
+    SpacecraftState lloState() {
+        Spacecraft spacecraft;
+        Scenarios::apply(Scenarios::getBuiltIn(0), spacecraft);
+        return spacecraft.getState();
+    }
+    
+    void report(const char* label, double seconds, double baseline) {
+        double stepsPerSecond = NUM_STEPS / seconds;
+        std::printf("  %-44s %8.2f Msteps/s  %6.1f ns/step  %5.2fx\n",
+                    label, stepsPerSecond / 1e6, seconds / NUM_STEPS * 1e9,
+                    baseline / seconds);
+    }
+}
+
+void runIntegratorBench() {
+    Bench::printHeader("RK4 steps/s, 100 km LLO, dt = 0.02 s");
+    
+    const SpacecraftState initial = lloState();
+    glm::dvec3 thrustAccel(0.0);
+    
+    // Before: what Application::update() used to do, a capturing lambda
+    // converted to a std::function for every substep
+    SpacecraftState perStep = initial;
+    double perStepTime = Bench::measure([&]() {
+        for (long long i = 0; i < NUM_STEPS; ++i) {
+            DerivativeFunc derivatives = [thrustAccel](const SpacecraftState& s,
+                                                       glm::dvec3& accel, glm::dvec3& velDeriv) {
+                accel = Gravity::pointMass(s.position, Constants::MOON_MU) + thrustAccel;
+                velDeriv = s.velocity;
+            };
+            Integrator::step(perStep, DT, Integrator::Type::RK4, derivatives);
+        }
+    });
+    Bench::consume(perStep.position.x);
+    
+    // Type-erased, but constructed once
+    SpacecraftState hoisted = initial;
+    DerivativeFunc hoistedFunc = PointMassForceModel{Constants::MOON_MU, thrustAccel};
+    double hoistedTime = Bench::measure([&]() {
+        for (long long i = 0; i < NUM_STEPS; ++i) {
+            Integrator::step(hoisted, DT, Integrator::Type::RK4, hoistedFunc);
+        }
+    });
+    Bench::consume(hoisted.position.x);
+    
+    // After: templated kernel, force model inlined into every stage
+    SpacecraftState inlined = initial;
+    PointMassForceModel forceModel{Constants::MOON_MU, thrustAccel};
+    double inlinedTime = Bench::measure([&]() {
+        for (long long i = 0; i < NUM_STEPS; ++i) {
+            Integrator::step(inlined, DT, Integrator::Type::RK4, forceModel);
+        }
+    });
+    Bench::consume(inlined.position.x);
+    
+    report("std::function, rebuilt every step (before)", perStepTime, perStepTime);
+    report("std::function, hoisted", hoistedTime, perStepTime);
+    report("template DerivativeModel (after)", inlinedTime, perStepTime);
+    
+    double difference = glm::length(inlined.position - perStep.position);
+    std::printf("  final position difference: %.3e m over %.0f s\n", difference, NUM_STEPS * DT);
+}
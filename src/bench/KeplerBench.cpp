@@ -0,0 +1,82 @@
+// Analytic universal-variable Kepler propagation versus RK4: cost per call
+// and position/energy error after 1000 revolutions.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/Gravity.h"
+#include "physics/Integrator.h"
+#include "physics/Orbit.h"
+#include "physics/Scenario.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    double specificEnergy(const glm::dvec3& position, const glm::dvec3& velocity) {
+        return 0.5 * glm::dot(velocity, velocity) - Constants::MOON_MU / glm::length(position);
+    }
+}
+
+void runKeplerBench() {
+    Bench::printHeader("Kepler (universal variables) vs RK4 over 1000 revolutions");
+    
+    PointMassForceModel forceModel{Constants::MOON_MU};
+    const int revolutions = 1000;
+    
+    std::printf("  %-34s %-16s %12s %12s %12s\n", "scenario", "method", "|dr| (m)", "|dE/E|", "time");
+    
+    for (int scenarioIndex = 0; scenarioIndex < 2; ++scenarioIndex) {
+        Scenario scenario = Scenarios::getBuiltIn(scenarioIndex);
+        Spacecraft spacecraft;
+        Scenarios::apply(scenario, spacecraft);
+        const SpacecraftState initial = spacecraft.getState();
+        OrbitalElements elements = Orbit::computeElements(initial.position, initial.velocity, Constants::MOON_MU);
+        const double duration = revolutions * elements.orbitalPeriod;
+        const double energy0 = specificEnergy(initial.position, initial.velocity);
+        
+        // Single analytic jump over the whole span is the reference
+        glm::dvec3 refPosition, refVelocity;
+        double jumpSeconds = Bench::measure([&]() {
+            Orbit::propagateKepler(initial.position, initial.velocity, duration, Constants::MOON_MU,
+                                   refPosition, refVelocity);
+        });
+        std::printf("  %-34s %-16s %12s %12.3e %9.3f us\n", scenario.name.c_str(), "Kepler, 1 jump", "(ref)",
+                    std::abs((specificEnergy(refPosition, refVelocity) - energy0) / energy0), jumpSeconds * 1e6);
+        
+        // Chained analytic steps, as the time-warp path takes them
+        for (double dt : {10.0, 1000.0}) {
+            glm::dvec3 position = initial.position, velocity = initial.velocity;
+            long long steps = static_cast<long long>(duration / dt);
+            double seconds = Bench::measure([&]() {
+                for (long long i = 0; i < steps; ++i) {
+                    Orbit::propagateKepler(position, velocity, dt, Constants::MOON_MU, position, velocity);
+                }
+                Orbit::propagateKepler(position, velocity, duration - steps * dt, Constants::MOON_MU, position, velocity);
+            });
+            char label[32];
+            std::snprintf(label, sizeof(label), "Kepler, %g s", dt);
+            std::printf("  %-34s %-16s %12.3e %12.3e %9.1f ms (%.0f ns/call)\n", "", label,
+                        glm::length(position - refPosition),
+                        std::abs((specificEnergy(position, velocity) - energy0) / energy0),
+                        seconds * 1e3, seconds * 1e9 / static_cast<double>(steps + 1));
+            Bench::consume(position.x);
+        }
+        
+        for (double dt : {1.0, 10.0}) {
+            SpacecraftState state = initial;
+            long long steps = static_cast<long long>(duration / dt);
+            double seconds = Bench::measure([&]() {
+                for (long long i = 0; i < steps; ++i) {
+                    Integrator::stepRK4(state, dt, forceModel);
+                }
+                Integrator::stepRK4(state, duration - steps * dt, forceModel);
+            });
+            char label[32];
+            std::snprintf(label, sizeof(label), "RK4, %g s", dt);
+            std::printf("  %-34s %-16s %12.3e %12.3e %9.1f ms\n", "", label,
+                        glm::length(state.position - refPosition),
+                        std::abs((specificEnergy(state.position, state.velocity) - energy0) / energy0),
+                        seconds * 1e3);
+            Bench::consume(state.position.x);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+// Lambert solver cost per arc and a 1000 x 1000 transfer-window grid from
+// the 100 km LLO to a 200 km target orbit, on one thread and on all of
+// them; arcs are checked by Kepler-propagating their departure state.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "core/ThreadPool.h"
+#include "physics/Orbit.h"
+#include "physics/Scenario.h"
+#include "physics/TransferGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int SOLVES = 200000;
+    constexpr int GRID_SIZE = 1000;
+    constexpr int CHECKED_CELLS = 2000;
+    
+    TransferGrid::Options makeGridOptions() {
+        Spacecraft spacecraft;
+        Scenarios::apply(Scenarios::getBuiltIn(0), spacecraft);
+        TransferGrid::Options options;
+        options.departurePosition = spacecraft.getState().position;
+        options.departureVelocity = spacecraft.getState().velocity;
+        options.mu = Constants::MOON_MU;
+        
+        // Target 100 km higher, 2 degrees off in inclination and node,
+        // 120 degrees ahead
+        Orbit::createCircularOrbit(200000.0, 30.0 * Constants::DEG_TO_RAD, 2.0 * Constants::DEG_TO_RAD,
+                                   120.0 * Constants::DEG_TO_RAD, Constants::MOON_MU, Constants::MOON_RADIUS,
+                                   options.arrivalPosition, options.arrivalVelocity);
+        
+        // Two LLO periods of departures, arrivals up to eight hours out
+        options.departureStart = 0.0;
+        options.departureEnd = 4.0 * 3600.0;
+        options.departureCount = GRID_SIZE;
+        options.arrivalStart = 0.5 * 3600.0;
+        options.arrivalEnd = 8.0 * 3600.0;
+        options.arrivalCount = GRID_SIZE;
+        options.maxRevolutions = 2;
+        return options;
+    }
+    
+    void runSolves(int maxRevolutions) {
+        std::vector<LambertSolution> arcs;
+        const glm::dvec3 r1(1837400.0, 0.0, 0.0);
+        long long arcCount = 0, iterations = 0;
+        double seconds = Bench::measure([&]() {
+            for (int k = 0; k < SOLVES; ++k) {
+                double angle = 0.1 + 6.0 * k / SOLVES;
+                glm::dvec3 r2(1937400.0 * std::cos(angle), 1937400.0 * std::sin(angle), 50000.0);
+                double flightTime = 1800.0 + (k % 997) * 25.0;
+                Orbit::solveLambert(r1, r2, flightTime, Constants::MOON_MU, maxRevolutions, false, arcs);
+                arcCount += static_cast<long long>(arcs.size());
+                for (const LambertSolution& arc : arcs) {
+                    iterations += arc.iterations;
+                }
+            }
+        });
+        Bench::consume(static_cast<double>(arcCount));
+        std::printf("  %-26s %10.0f ns/solve %8.2f arcs/solve %8.2f iterations/arc\n",
+                    maxRevolutions == 0 ? "direct arc only" : "up to 2 revolutions",
+                    seconds * 1e9 / SOLVES, static_cast<double>(arcCount) / SOLVES,
+                    static_cast<double>(iterations) / std::max(arcCount, 1LL));
+    }
+    
+    // Largest miss at arrival, over a spread of solved cells
+    double checkArcs(const TransferGrid::Options& options, const TransferGrid::Result& result) {
+        double worst = 0.0;
+        size_t stride = std::max<size_t>(1, result.getCellCount() / CHECKED_CELLS);
+        for (size_t cell = 0; cell < result.getCellCount(); cell += stride) {
+            if (std::isnan(result.departureDeltaV[cell])) {
+                continue;
+            }
+            double departureTime = result.getDepartureTime(static_cast<int>(cell / result.arrivalCount));
+            double arrivalTime = result.getArrivalTime(static_cast<int>(cell % result.arrivalCount));
+            LambertSolution arc;
+            glm::dvec3 departureDeltaV, arrivalDeltaV;
+            glm::dvec3 r1, v1, r2, v2, end, endVelocity;
+            if (!TransferGrid::solveCell(options, departureTime, arrivalTime, arc, departureDeltaV, arrivalDeltaV) ||
+                !Orbit::propagateKepler(options.departurePosition, options.departureVelocity, departureTime,
+                                        options.mu, r1, v1) ||
+                !Orbit::propagateKepler(options.arrivalPosition, options.arrivalVelocity, arrivalTime,
+                                        options.mu, r2, v2) ||
+                !Orbit::propagateKepler(r1, arc.departureVelocity, arrivalTime - departureTime, options.mu,
+                                        end, endVelocity)) {
+                continue;
+            }
+            worst = std::max(worst, glm::length(end - r2));
+        }
+        return worst;
+    }
+}
+
+void runLambertBench() {
+    Bench::printHeader("Lambert (Izzo) solves and a 1000 x 1000 transfer-window grid");
+    
+    runSolves(0);
+    runSolves(2);
+    
+    const TransferGrid::Options options = makeGridOptions();
+    std::printf("\n  %-26s %10s %14s %12s %14s\n", "grid", "time", "cells/s", "solved", "best dv (m/s)");
+    
+    ThreadPool pool;
+    TransferGrid::Result result;
+    std::string error;
+    for (unsigned threads : {1u, pool.getThreadCount()}) {
+        ThreadPool runPool(threads);
+        if (!TransferGrid::compute(options, runPool, result, error)) {
+            std::printf("  grid failed: %s\n", error.c_str());
+            return;
+        }
+        char label[32];
+        std::snprintf(label, sizeof(label), "%u thread%s", threads, threads == 1 ? "" : "s");
+        std::printf("  %-26s %8.2f s %14.3g %12zu %14.1f\n", label, result.wallSeconds,
+                    result.getCellCount() / result.wallSeconds, result.solvedCells, result.bestDeltaV);
+        if (pool.getThreadCount() == 1) {
+            break;
+        }
+    }
+    
+    size_t best = result.bestIndex;
+    std::printf("  best: depart %.0f s, arrive %.0f s, %d revolutions; %.2f iterations/arc\n",
+                result.getDepartureTime(static_cast<int>(best / result.arrivalCount)),
+                result.getArrivalTime(static_cast<int>(best % result.arrivalCount)),
+                result.revolutions[best], result.meanIterations);
+    std::printf("  largest arrival miss over %d checked arcs: %.2e m\n", CHECKED_CELLS, checkArcs(options, result));
+}
@@ -0,0 +1,82 @@
+// Force evaluations per predicted orbit: the fixed-step RK4 prediction path
+// (ORBIT_PREDICTION_HORIZON / ORBIT_PREDICTION_STEPS = 3.6 s) versus adaptive
+// Dormand-Prince 5(4) at several tolerances, for each built-in scenario.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/Gravity.h"
+#include "physics/Integrator.h"
+#include "physics/Orbit.h"
+#include "physics/Scenario.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // Counts force model calls for the fixed-step path
+    struct CountingForceModel {
+        PointMassForceModel model;
+        long long* count;
+        
+        void operator()(const SpacecraftState& state, glm::dvec3& outAccel, glm::dvec3& outVelDeriv) const {
+            (*count)++;
+            model(state, outAccel, outVelDeriv);
+        }
+    };
+}
+
+void runPredictionBench() {
+    Bench::printHeader("Force evaluations per predicted orbit (fixed RK4 vs adaptive DOPRI5)");
+    
+    PointMassForceModel forceModel{Constants::MOON_MU};
+    double fixedDt = Constants::ORBIT_PREDICTION_HORIZON / Constants::ORBIT_PREDICTION_STEPS;
+    
+    for (int index = 0; index < Scenarios::getBuiltInCount(); ++index) {
+        Spacecraft spacecraft;
+        Scenario scenario = Scenarios::getBuiltIn(index);
+        Scenarios::apply(scenario, spacecraft);
+        const SpacecraftState initial = spacecraft.getState();
+        
+        OrbitalElements elements = Orbit::computeElements(initial.position, initial.velocity, Constants::MOON_MU);
+        double period = elements.orbitalPeriod;
+        
+        // Reference: one full revolution brings the state back to the start
+        std::printf("\n  %s (period %.0f s)\n", scenario.name.c_str(), period);
+        std::printf("  %-26s %10s %8s %14s %10s\n", "method", "evals/orbit", "steps", "closure err", "time");
+        
+        // Fixed-step RK4, as used by the old prediction path
+        long long fixedEvaluations = 0;
+        CountingForceModel counting{forceModel, &fixedEvaluations};
+        SpacecraftState fixedState = initial;
+        long long fixedSteps = static_cast<long long>(std::floor(period / fixedDt));
+        double fixedTime = Bench::measure([&]() {
+            for (long long i = 0; i < fixedSteps; ++i) {
+                Integrator::stepRK4(fixedState, fixedDt, counting);
+            }
+            Integrator::stepRK4(fixedState, period - fixedSteps * fixedDt, counting);
+        });
+        std::printf("  %-26s %10lld %8lld %12.3e m %8.3f ms\n", "RK4 fixed 3.6 s",
+                    fixedEvaluations, fixedSteps + 1,
+                    glm::length(fixedState.position - initial.position), fixedTime * 1e3);
+        
+        for (double tolerance : {1e-8, 1e-10, 1e-12}) {
+            AdaptiveOptions options;
+            options.relTol = tolerance;
+            options.absTol = tolerance * 1e3;
+            
+            AdaptiveStats stats;
+            DenseTrajectory dense;
+            SpacecraftState finalState;
+            double adaptiveTime = Bench::measure([&]() {
+                finalState = Integrator::propagateAdaptive(initial, period, forceModel, options, &dense, &stats);
+            });
+            
+            char label[64];
+            std::snprintf(label, sizeof(label), "DOPRI5 tol %.0e", tolerance);
+            std::printf("  %-26s %10d %8d %12.3e m %8.3f ms\n", label,
+                        stats.evaluations, stats.acceptedSteps + stats.rejectedSteps,
+                        glm::length(finalState.position - initial.position), adaptiveTime * 1e3);
+            Bench::consume(finalState.position.x);
+        }
+        Bench::consume(fixedState.position.x);
+    }
+}
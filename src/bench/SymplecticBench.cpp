@@ -0,0 +1,66 @@
+// Long-coast energy behaviour: RK4 versus the symplectic compositions on
+// 100 revolutions of the elliptical capture orbit at large fixed steps.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/Gravity.h"
+#include "physics/Integrator.h"
+#include "physics/Orbit.h"
+#include "physics/Scenario.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    double specificEnergy(const SpacecraftState& state) {
+        return 0.5 * glm::dot(state.velocity, state.velocity) - Constants::MOON_MU / glm::length(state.position);
+    }
+}
+
+void runSymplecticBench() {
+    Bench::printHeader("Energy error over 100 revolutions, elliptical capture orbit");
+    
+    Spacecraft spacecraft;
+    Scenarios::apply(Scenarios::getBuiltIn(1), spacecraft);
+    const SpacecraftState initial = spacecraft.getState();
+    OrbitalElements elements = Orbit::computeElements(initial.position, initial.velocity, Constants::MOON_MU);
+    
+    const double duration = 100.0 * elements.orbitalPeriod;
+    const double energy0 = specificEnergy(initial);
+    PointMassForceModel forceModel{Constants::MOON_MU};
+    
+    const Integrator::Type types[] = {
+        Integrator::Type::RK4,
+        Integrator::Type::VelocityVerlet,
+        Integrator::Type::ForestRuth,
+        Integrator::Type::Yoshida4,
+        Integrator::Type::Yoshida6
+    };
+    
+    std::printf("  %-12s %7s %12s %14s %14s %10s\n",
+                "method", "dt (s)", "evaluations", "max |dE/E|", "final |dE/E|", "time");
+    
+    for (double dt : {5.0, 20.0}) {
+        for (Integrator::Type type : types) {
+            SpacecraftState state = initial;
+            long long steps = static_cast<long long>(duration / dt);
+            double maxError = 0.0;
+            
+            double seconds = Bench::measure([&]() {
+                for (long long i = 0; i < steps; ++i) {
+                    Integrator::step(state, dt, type, forceModel);
+                    if (i % 64 == 0) {
+                        maxError = std::max(maxError, std::abs((specificEnergy(state) - energy0) / energy0));
+                    }
+                }
+            });
+            
+            double finalError = std::abs((specificEnergy(state) - energy0) / energy0);
+            maxError = std::max(maxError, finalError);
+            std::printf("  %-12s %7.1f %12lld %14.3e %14.3e %8.1f ms\n",
+                        Integrator::getName(type), dt, steps * Integrator::getEvaluationsPerStep(type),
+                        maxError, finalError, seconds * 1e3);
+            Bench::consume(state.position.x);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+// State transition matrix over one orbit of the 100 km LLO: propagated
+// with dual-number gravity gradients and the variational equations, against
+// one-sided (7 propagations) and central (13) finite differences, for a
+// point mass and spherical-harmonic fields.
+
+#include "Bench.h"
+#include "core/Constants.h"
+#include "physics/Gravity.h"
+#include "physics/GravityField.h"
+#include "physics/Integrator.h"
+#include "physics/Scenario.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    constexpr int REPEATS = 5;
+    
+    // Perturbations for the finite differences: about sqrt(eps) relative
+    constexpr double POSITION_STEP = 1.0;    // m
+    constexpr double VELOCITY_STEP = 1e-3;   // m/s
+    
+    // Column j of the transition matrix: the final state's change per unit
+    // change of initial component j
+    void setColumn(StateTransition& phi, int col, const SpacecraftState& plus, const SpacecraftState& minus,
+                   double step) {
+        glm::dvec3 dr = (plus.position - minus.position) / step;
+        glm::dvec3 dv = (plus.velocity - minus.velocity) / step;
+        if (col < 3) {
+            phi.rr[col] = dr;
+            phi.vr[col] = dv;
+        } else {
+            phi.rv[col - 3] = dr;
+            phi.vv[col - 3] = dv;
+        }
+    }
+    
+    template <DerivativeModel F>
+    StateTransition finiteDifference(const SpacecraftState& initial, double duration, const F& forceModel,
+                                     const AdaptiveOptions& options, bool central) {
+        SpacecraftState nominal;
+        if (!central) {
+            nominal = Integrator::propagateAdaptive(initial, duration, forceModel, options);
+        }
+        
+        StateTransition phi;
+        for (int col = 0; col < 6; ++col) {
+            double step = (col < 3) ? POSITION_STEP : VELOCITY_STEP;
+            SpacecraftState plus = initial;
+            SpacecraftState minus = initial;
+            glm::dvec3& plusComponent = (col < 3) ? plus.position : plus.velocity;
+            glm::dvec3& minusComponent = (col < 3) ? minus.position : minus.velocity;
+            plusComponent[col % 3] += step;
+            if (central) {
+                minusComponent[col % 3] -= step;
+            }
+            SpacecraftState end = Integrator::propagateAdaptive(plus, duration, forceModel, options);
+            if (central) {
+                setColumn(phi, col, end, Integrator::propagateAdaptive(minus, duration, forceModel, options),
+                          2.0 * step);
+            } else {
+                setColumn(phi, col, end, nominal, step);
+            }
+        }
+        return phi;
+    }
+    
+    // Largest difference in each 3x3 block relative to that block's largest
+    // element (the blocks differ in units), worst over the four blocks
+    double relativeDifference(const StateTransition& a, const StateTransition& b) {
+        double worst = 0.0;
+        for (int block = 0; block < 4; ++block) {
+            int row0 = (block / 2) * 3;
+            int col0 = (block % 2) * 3;
+            double scale = 0.0, diff = 0.0;
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    scale = std::max(scale, std::abs(a.get(row0 + i, col0 + j)));
+                    diff = std::max(diff, std::abs(a.get(row0 + i, col0 + j) - b.get(row0 + i, col0 + j)));
+                }
+            }
+            worst = std::max(worst, diff / scale);
+        }
+        return worst;
+    }
+    
+    template <DifferentiableModel F>
+    void runModel(const char* name, const SpacecraftState& initial, double duration, const F& forceModel) {
+        AdaptiveOptions options;
+        
+        SpacecraftState end;
+        AdaptiveStats stats;
+        double plainSeconds = Bench::measure([&]() {
+            for (int i = 0; i < REPEATS; ++i) {
+                end = Integrator::propagateAdaptive(initial, duration, forceModel, options, nullptr, &stats);
+            }
+        });
+        Bench::consume(end.position.x);
+        
+        StateTransition dual;
+        double dualSeconds = Bench::measure([&]() {
+            for (int i = 0; i < REPEATS; ++i) {
+                end = Integrator::propagateWithTransition(initial, duration, forceModel, dual, options);
+            }
+        });
+        Bench::consume(end.position.x + dual.rv[0][0]);
+        
+        StateTransition forward, central;
+        double forwardSeconds = Bench::measure([&]() {
+            for (int i = 0; i < REPEATS; ++i) {
+                forward = finiteDifference(initial, duration, forceModel, options, false);
+            }
+        });
+        double centralSeconds = Bench::measure([&]() {
+            for (int i = 0; i < REPEATS; ++i) {
+                central = finiteDifference(initial, duration, forceModel, options, true);
+            }
+        });
+        Bench::consume(forward.rv[0][0] + central.rv[0][0]);
+        
+        double plainMs = plainSeconds * 1000.0 / REPEATS;
+        auto row = [&](const char* method, double seconds, const char* difference) {
+            double ms = seconds * 1000.0 / REPEATS;
+            std::printf("  %-12s %-18s %10.2f ms %8.1fx %14s\n", name, method, ms, ms / plainMs, difference);
+        };
+        char forwardText[32], centralText[32];
+        std::snprintf(forwardText, sizeof(forwardText), "%.1e", relativeDifference(dual, forward));
+        std::snprintf(centralText, sizeof(centralText), "%.1e", relativeDifference(dual, central));
+        
+        row("state only", plainSeconds, "");
+        row("dual + variational", dualSeconds, "");
+        row("forward diff.", forwardSeconds, forwardText);
+        row("central diff.", centralSeconds, centralText);
+        std::printf("  %-12s %d steps\n\n", "", stats.acceptedSteps);
+    }
+}
+
+void runTransitionBench() {
+    Bench::printHeader("State transition matrix: dual numbers vs. finite differences, one LLO orbit");
+    
+    Spacecraft spacecraft;
+    Scenarios::apply(Scenarios::getBuiltIn(0), spacecraft);
+    const SpacecraftState initial = spacecraft.getState();
+    const double radius = glm::length(initial.position);
+    const double period = 2.0 * Constants::PI * std::sqrt(radius * radius * radius / Constants::MOON_MU);
+    
+    std::printf("  %-12s %-18s %13s %9s %14s\n", "model", "method", "time", "vs. state", "diff. vs. dual");
+    
+    PointMassForceModel pointMass;
+    pointMass.mu = Constants::MOON_MU;
+    runModel("point mass", initial, period, pointMass);
+    
+    GravityField field = Bench::makeKaulaField(50);
+    for (int degree : {8, 50}) {
+        GravityFieldForceModel forceModel;
+        forceModel.mu = Constants::MOON_MU;
+        forceModel.field = &field;
+        forceModel.degree = degree;
+        forceModel.setTime(0.0);
+        char name[32];
+        std::snprintf(name, sizeof(name), "degree %d", degree);
+        runModel(name, initial, period, forceModel);
+    }
+}
@@ -0,0 +1,68 @@
+// artemis-bench: micro-benchmarks for the headless physics core.
+//
+// Usage: artemis-bench [suite...]   (no arguments runs every suite)
+
+#include "Bench.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+    struct Suite {
+        const char* name;
+        void (*run)();
+    };
+    
+    const Suite SUITES[] = {
+        {"integrator", runIntegratorBench},
+        {"prediction", runPredictionBench},
+        {"symplectic", runSymplecticBench},
+        {"batch", runBatchBench},
+        {"elements", runElementBench},
+        {"kepler", runKeplerBench},
+        {"gravity", runGravityBench},
+        {"cr3bp", runCR3BPBench},
+        {"stm", runTransitionBench},
+        {"lambert", runLambertBench},
+        {"attitude", runAttitudeBench},
+        {"burn", runBurnBench},
+        {"fleet", runFleetBench},
+    };
+    
+    volatile double s_sink = 0.0;
+}
+
+void Bench::consume(double value) {
+    s_sink = s_sink + value;
+}
+
+void Bench::printHeader(const std::string& title) {
+    std::cout << "\n=== " << title << " ===" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    bool ranAny = false;
+    
+    for (const Suite& suite : SUITES) {
+        bool selected = (argc == 1);
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], suite.name) == 0) {
+                selected = true;
+            }
+        }
+        if (selected) {
+            suite.run();
+            ranAny = true;
+        }
+    }
+    
+    if (!ranAny) {
+        std::cerr << "Usage: " << argv[0] << " [suite...]\nSuites:";
+        for (const Suite& suite : SUITES) {
+            std::cerr << " " << suite.name;
+        }
+        std::cerr << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
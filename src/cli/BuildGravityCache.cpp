@@ -0,0 +1,199 @@
+// artemis-gravity-cache: precomputes a spherical-harmonic gravity field on
+// an interpolation grid for fast evaluation.
+//
+// Samples the field's perturbing acceleration on a shell grid around the
+// Moon, refined until the interpolation error is below --tolerance, and
+// writes it to a file that artemis-propagate, artemis-montecarlo and the
+// simulator memory-map at startup. --check reports the error of an existing
+// cache against the field instead.
+
+#include "core/Constants.h"
+#include "core/ThreadPool.h"
+#include "physics/GravityCache.h"
+#include "physics/GravityField.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+    struct Options {
+        std::string gravityFile;
+        std::string outputFile;
+        std::string checkFile;
+        int gravityDegree = GravityField::MAX_DEGREE;
+        double minAltitude = -10.0;     // km, below the lowest lunar terrain
+        double maxAltitude = 500.0;     // km
+        double tolerance = 1e-6;        // m/s^2
+        double maxSize = 256.0;         // MB
+        unsigned long long samples = 20000;
+        unsigned threads = 0;
+    };
+    
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " --gravity-file PATH (--output PATH | --check PATH) [options]\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  --gravity-file PATH   Spherical-harmonic coefficient table\n"
+                  << "  --degree N            Truncate the field at degree N (default all)\n"
+                  << "  --output PATH         Build a cache and write it to PATH\n"
+                  << "  --check PATH          Report the error of an existing cache instead\n"
+                  << "  --min-alt KM          Lowest altitude covered (default -10)\n"
+                  << "  --max-alt KM          Highest altitude covered (default 500)\n"
+                  << "  --tolerance MPS2      Target maximum interpolation error (default 1e-6)\n"
+                  << "  --max-size MB         Grid size limit (default 256)\n"
+                  << "  --samples N           Random probes for the error report (default 20000)\n"
+                  << "  --threads N           Worker threads (default: all cores)\n"
+                  << "  --help                Show this message\n";
+    }
+    
+    bool parseDouble(const char* text, double& out) {
+        char* end = nullptr;
+        out = std::strtod(text, &end);
+        return end != text && *end == '\0';
+    }
+    
+    bool parseUnsigned(const char* text, unsigned long long& out) {
+        char* end = nullptr;
+        out = std::strtoull(text, &end, 10);
+        return end != text && *end == '\0' && text[0] != '-';
+    }
+    
+    bool parseArgs(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = (i + 1 < argc);
+            
+            if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                std::exit(0);
+            } else if (!hasValue) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            
+            const char* value = argv[++i];
+            double number = 0.0;
+            unsigned long long count = 0;
+            
+            if (arg == "--gravity-file") {
+                options.gravityFile = value;
+            } else if (arg == "--output") {
+                options.outputFile = value;
+            } else if (arg == "--check") {
+                options.checkFile = value;
+            } else if (arg == "--degree" || arg == "--samples" || arg == "--threads") {
+                if (!parseUnsigned(value, count)) {
+                    std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                    return false;
+                }
+                if (arg == "--degree") options.gravityDegree = static_cast<int>(std::min<unsigned long long>(count, GravityField::MAX_DEGREE));
+                if (arg == "--samples") options.samples = count;
+                if (arg == "--threads") options.threads = static_cast<unsigned>(count);
+            } else if (!parseDouble(value, number)) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return false;
+            } else if (arg == "--min-alt") {
+                options.minAltitude = number;
+            } else if (arg == "--max-alt") {
+                options.maxAltitude = number;
+            } else if (arg == "--tolerance") {
+                options.tolerance = number;
+            } else if (arg == "--max-size") {
+                options.maxSize = number;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+        
+        if (options.gravityFile.empty() || options.outputFile.empty() == options.checkFile.empty()) {
+            std::cerr << "Need --gravity-file and one of --output or --check" << std::endl;
+            return false;
+        }
+        if (options.tolerance <= 0.0 || options.maxSize <= 0.0) {
+            std::cerr << "Tolerance and size limit must be positive" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    void printReport(const char* label, const GravityCache::ErrorReport& report) {
+        std::printf("%s: max %.3e m/s^2, rms %.3e m/s^2, max relative %.3e (%zu probes)\n",
+                    label, report.maxError, report.rmsError, report.maxRelativeError, report.samples);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    GravityField field;
+    std::string error;
+    if (!field.loadFromFile(options.gravityFile, options.gravityDegree, error)) {
+        std::cerr << "Failed to load gravity field: " << error << std::endl;
+        return 1;
+    }
+    
+    ThreadPool pool(options.threads);
+    GravityCache cache;
+    
+    if (!options.checkFile.empty()) {
+        if (!cache.load(options.checkFile, error)) {
+            std::cerr << "Failed to load gravity cache: " << error << std::endl;
+            return 1;
+        }
+        if (!cache.matches(field)) {
+            std::cerr << "Cache was not built from this gravity field" << std::endl;
+            return 1;
+        }
+        std::printf("Cache: degree %d, %.1f to %.1f km altitude, %d nodes per face edge, %d shells, %.1f MB\n",
+                    cache.getDegree(),
+                    (cache.getMinRadius() - Constants::MOON_RADIUS) / 1000.0,
+                    (cache.getMaxRadius() - Constants::MOON_RADIUS) / 1000.0,
+                    cache.getFaceNodes(), cache.getShellCount(), cache.getByteSize() / 1e6);
+        printReport("Stored error", cache.getErrorReport());
+        printReport("Measured error", cache.measureError(field, options.samples, 2, pool));
+        return 0;
+    }
+    
+    GravityCache::BuildOptions build;
+    build.degree = options.gravityDegree;
+    build.minRadius = Constants::MOON_RADIUS + options.minAltitude * 1000.0;
+    build.maxRadius = Constants::MOON_RADIUS + options.maxAltitude * 1000.0;
+    build.tolerance = options.tolerance;
+    build.maxBytes = static_cast<size_t>(options.maxSize * 1e6);
+    build.errorSamples = options.samples;
+    
+    auto wallStart = std::chrono::steady_clock::now();
+    if (!cache.build(field, build, pool, error)) {
+        std::cerr << "Failed to build gravity cache: " << error << std::endl;
+        return 1;
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    
+    if (!cache.save(options.outputFile, error)) {
+        std::cerr << "Failed to write gravity cache: " << error << std::endl;
+        return 1;
+    }
+    
+    const GravityCache::ErrorReport& report = cache.getErrorReport();
+    std::printf("Built degree %d cache in %.1f s on %u threads: %d nodes per face edge, %d shells, %.1f MB\n",
+                cache.getDegree(), wallSeconds, pool.getThreadCount(),
+                cache.getFaceNodes(), cache.getShellCount(), cache.getByteSize() / 1e6);
+    printReport("Error", report);
+    if (cache.getDegree() < 10) {
+        std::printf("Note: below about degree 10 direct evaluation is as fast as the cache\n");
+    }
+    if (report.maxError > options.tolerance) {
+        std::printf("Tolerance %.3e m/s^2 not reached within %.0f MB; raise --max-size or narrow the altitude range\n",
+                    options.tolerance, options.maxSize);
+        return 2;
+    }
+    return 0;
+}
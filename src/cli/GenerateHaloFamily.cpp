@@ -0,0 +1,177 @@
+// artemis-halo-family: generates a family of Earth-Moon CR3BP halo orbits
+// and writes it as a preset table for the simulator.
+//
+// Starts from the 9:2 L2 southern NRHO (or a seed given in normalized
+// units), corrects it, continues the family both ways by pseudo-arclength
+// and polishes every member in parallel. The table loads in the simulator's
+// scenario list; --check prints an existing table instead.
+
+#include "core/Constants.h"
+#include "core/ThreadPool.h"
+#include "physics/CR3BP.h"
+#include "physics/HaloFamily.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Options {
+        std::string outputFile;
+        std::string checkFile;
+        HaloFamily::Member seed = HaloFamily::nrhoSeed();
+        HaloFamily::Options family;
+        bool north = false;
+        unsigned threads = 0;
+    };
+    
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " (--output PATH | --check PATH) [options]\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  --output PATH         Generate a family and write it to PATH\n"
+                  << "  --check PATH          Print an existing table instead\n"
+                  << "  --members N           Members continued each way from the seed (default 30)\n"
+                  << "  --step DS             Pseudo-arclength step (default 0.05)\n"
+                  << "  --tolerance TOL       Final periodicity residual, normalized (default 1e-11)\n"
+                  << "  --min-perilune-alt KM Stop below this perilune altitude (default 250)\n"
+                  << "  --seed X Z VY T       Seed crossing state and period, normalized units\n"
+                  << "                        (default: 9:2 L2 southern NRHO)\n"
+                  << "  --north               Mirror the seed into the northern family\n"
+                  << "  --threads N           Worker threads (default: all cores)\n"
+                  << "  --help                Show this message\n";
+    }
+    
+    bool parseDouble(const char* text, double& out) {
+        char* end = nullptr;
+        out = std::strtod(text, &end);
+        return end != text && *end == '\0';
+    }
+    
+    bool parseUnsigned(const char* text, unsigned long long& out) {
+        char* end = nullptr;
+        out = std::strtoull(text, &end, 10);
+        return end != text && *end == '\0' && text[0] != '-';
+    }
+    
+    bool parseArgs(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            
+            if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                std::exit(0);
+            } else if (arg == "--north") {
+                options.north = true;
+                continue;
+            } else if (arg == "--seed") {
+                double* fields[] = {&options.seed.x0, &options.seed.z0, &options.seed.vy0, &options.seed.period};
+                for (double* field : fields) {
+                    if (i + 1 >= argc || !parseDouble(argv[++i], *field)) {
+                        std::cerr << "--seed needs four numbers: X Z VY T" << std::endl;
+                        return false;
+                    }
+                }
+                continue;
+            } else if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            
+            const char* value = argv[++i];
+            double number = 0.0;
+            unsigned long long count = 0;
+            
+            if (arg == "--output") {
+                options.outputFile = value;
+            } else if (arg == "--check") {
+                options.checkFile = value;
+            } else if (arg == "--members" || arg == "--threads") {
+                if (!parseUnsigned(value, count)) {
+                    std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                    return false;
+                }
+                if (arg == "--members") options.family.membersPerSide = static_cast<int>(count);
+                if (arg == "--threads") options.threads = static_cast<unsigned>(count);
+            } else if (!parseDouble(value, number)) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return false;
+            } else if (arg == "--step") {
+                options.family.stepSize = number;
+            } else if (arg == "--tolerance") {
+                options.family.tolerance = number;
+            } else if (arg == "--min-perilune-alt") {
+                options.family.minPeriluneAltitude = number * 1000.0;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+        
+        if (options.outputFile.empty() == options.checkFile.empty()) {
+            std::cerr << "Need one of --output or --check" << std::endl;
+            return false;
+        }
+        if (options.family.stepSize <= 0.0 || options.family.tolerance <= 0.0 || options.seed.period <= 0.0) {
+            std::cerr << "Step, tolerance and seed period must be positive" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    void printTable(const std::vector<HaloFamily::Member>& members) {
+        std::printf("  %3s %18s %18s %18s %9s %14s %10s %10s %9s %9s\n",
+                    "#", "x0", "z0", "vy0", "T (d)", "Jacobi", "rp (km)", "ra (km)", "stability", "closure");
+        const double toDays = 1.0 / (CR3BP::getMeanMotion() * Constants::SECONDS_PER_DAY);
+        for (size_t i = 0; i < members.size(); ++i) {
+            const HaloFamily::Member& m = members[i];
+            std::printf("  %3zu %18.15f %18.15f %18.15f %9.4f %14.10f %10.1f %10.1f %9.2f %9.1e\n",
+                        i, m.x0, m.z0, m.vy0, m.period * toDays, m.jacobi,
+                        m.periluneRadius / 1000.0, m.apoluneRadius / 1000.0, m.stabilityIndex, m.closureError);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    std::string error;
+    std::vector<HaloFamily::Member> members;
+    
+    if (!options.checkFile.empty()) {
+        if (!HaloFamily::load(options.checkFile, members, error)) {
+            std::cerr << "Failed to load halo family: " << error << std::endl;
+            return 1;
+        }
+        std::printf("%zu members\n", members.size());
+        printTable(members);
+        return 0;
+    }
+    
+    if (options.north) {
+        options.seed = HaloFamily::mirror(options.seed);
+    }
+    
+    ThreadPool pool(options.threads);
+    auto wallStart = std::chrono::steady_clock::now();
+    if (!HaloFamily::generate(options.seed, options.family, pool, members, error)) {
+        std::cerr << "Failed to generate halo family: " << error << std::endl;
+        return 1;
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    
+    if (!HaloFamily::save(options.outputFile, members, error)) {
+        std::cerr << "Failed to write halo family: " << error << std::endl;
+        return 1;
+    }
+    
+    std::printf("Generated %zu members in %.2f s on %u threads\n", members.size(), wallSeconds, pool.getThreadCount());
+    printTable(members);
+    return 0;
+}
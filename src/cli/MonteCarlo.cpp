@@ -0,0 +1,295 @@
+// artemis-montecarlo: dispersion analysis for a coast with an optional burn.
+//
+// Disperses the initial state, thrust magnitude and pointing, and Isp of a
+// built-in or file-based scenario, propagates every sample on a thread pool
+// and prints impact probability and periapsis statistics. Results are
+// bitwise identical for any --threads value; the digest line makes that easy
+// to check.
+
+#include "core/Constants.h"
+#include "core/ThreadPool.h"
+#include "physics/Ephemeris.h"
+#include "physics/GravityCache.h"
+#include "physics/GravityField.h"
+#include "physics/MonteCarlo.h"
+#include "physics/Scenario.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+    struct Options {
+        int scenarioIndex = 0;
+        std::string scenarioFile;
+        std::string gravityFile;
+        std::string gravityCacheFile;
+        int gravityDegree = GravityField::MAX_DEGREE;
+        bool thirdBodies = false;
+        double epochJulianDate = Constants::EPOCH_JULIAN_DATE;
+        unsigned threads = 0;
+        MonteCarloConfig config;
+    };
+    
+    struct ModeName {
+        const char* name;
+        Spacecraft::ThrustMode mode;
+    };
+    
+    const ModeName MODE_NAMES[] = {
+        {"prograde", Spacecraft::ThrustMode::Prograde},
+        {"retrograde", Spacecraft::ThrustMode::Retrograde},
+        {"radial-in", Spacecraft::ThrustMode::RadialIn},
+        {"radial-out", Spacecraft::ThrustMode::RadialOut},
+        {"normal", Spacecraft::ThrustMode::Normal},
+        {"anti-normal", Spacecraft::ThrustMode::AntiNormal},
+    };
+    
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "\n"
+                  << "Scenario and propagation:\n"
+                  << "  --scenario N            Built-in scenario index (0-" << Scenarios::getBuiltInCount() - 1 << ", default 0)\n"
+                  << "  --scenario-file PATH    Load scenario from a key = value file\n"
+                  << "  --duration SECONDS      Simulated time per sample (default 7200)\n"
+                  << "  --dt SECONDS            Integration step (default 1)\n"
+                  << "  --integrator NAME       Integrator name as in artemis-propagate (default rk4)\n"
+                  << "  --gravity-file PATH     Spherical-harmonic coefficient table (default point mass)\n"
+                  << "  --degree N              Truncate the gravity field at degree N (default all)\n"
+                  << "  --gravity-cache PATH    Interpolate the field from a cache built by artemis-gravity-cache\n"
+                  << "  --third-bodies          Add Earth and Sun perturbations\n"
+                  << "  --epoch-jd JD           Julian date (TT) at t = 0 (default " << Constants::EPOCH_JULIAN_DATE << ")\n"
+                  << "\n"
+                  << "Burn:\n"
+                  << "  --burn-direction NAME   prograde | retrograde | radial-in | radial-out |\n"
+                  << "                          normal | anti-normal (default prograde)\n"
+                  << "  --burn-start SECONDS    Burn ignition time (default 0)\n"
+                  << "  --burn-duration SECONDS Burn length (default 0 = coast only)\n"
+                  << "  --throttle F            Throttle 0..1 (default 1)\n"
+                  << "\n"
+                  << "Dispersions (1-sigma):\n"
+                  << "  --sigma-position M      Position, per axis\n"
+                  << "  --sigma-velocity MPS    Velocity, per axis\n"
+                  << "  --sigma-thrust F        Thrust magnitude, fraction of max thrust\n"
+                  << "  --sigma-pointing DEG    Thrust pointing, per perpendicular axis\n"
+                  << "  --sigma-isp F           Isp, fraction\n"
+                  << "  --thrust-bias F         Thrust offset for every sample (0.02 = 2% hot)\n"
+                  << "\n"
+                  << "Run:\n"
+                  << "  --samples N             Number of samples (default 1000)\n"
+                  << "  --seed N                RNG seed (default 1)\n"
+                  << "  --threads N             Worker threads (default: all cores)\n"
+                  << "  --help                  Show this message\n";
+    }
+    
+    bool parseDouble(const char* text, double& out) {
+        char* end = nullptr;
+        out = std::strtod(text, &end);
+        return end != text && *end == '\0';
+    }
+    
+    bool parseUnsigned(const char* text, unsigned long long& out) {
+        char* end = nullptr;
+        out = std::strtoull(text, &end, 10);
+        return end != text && *end == '\0' && text[0] != '-';
+    }
+    
+    bool parseArgs(int argc, char** argv, Options& options) {
+        MonteCarloConfig& config = options.config;
+        
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = (i + 1 < argc);
+            
+            if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                std::exit(0);
+            } else if (arg == "--third-bodies") {
+                options.thirdBodies = true;
+                continue;
+            } else if (!hasValue) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            
+            const char* value = argv[++i];
+            double number = 0.0;
+            unsigned long long count = 0;
+            bool isNumber = parseDouble(value, number);
+            
+            if (arg == "--scenario") {
+                options.scenarioIndex = std::atoi(value);
+                if (options.scenarioIndex < 0 || options.scenarioIndex >= Scenarios::getBuiltInCount()) {
+                    std::cerr << "Scenario index out of range: " << value << std::endl;
+                    return false;
+                }
+            } else if (arg == "--scenario-file") {
+                options.scenarioFile = value;
+            } else if (arg == "--gravity-file") {
+                options.gravityFile = value;
+            } else if (arg == "--gravity-cache") {
+                options.gravityCacheFile = value;
+            } else if (arg == "--integrator") {
+                if (!Integrator::parseName(value, config.integrator)) {
+                    std::cerr << "Unknown integrator: " << value << std::endl;
+                    return false;
+                }
+            } else if (arg == "--burn-direction") {
+                bool found = false;
+                for (const ModeName& mode : MODE_NAMES) {
+                    if (std::strcmp(mode.name, value) == 0) {
+                        config.burn.mode = mode.mode;
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    std::cerr << "Unknown burn direction: " << value << std::endl;
+                    return false;
+                }
+            } else if (arg == "--samples" || arg == "--seed" || arg == "--threads" || arg == "--degree") {
+                if (!parseUnsigned(value, count)) {
+                    std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                    return false;
+                }
+                if (arg == "--samples") config.sampleCount = static_cast<size_t>(count);
+                if (arg == "--seed") config.seed = count;
+                if (arg == "--threads") options.threads = static_cast<unsigned>(count);
+                if (arg == "--degree") options.gravityDegree = static_cast<int>(std::min<unsigned long long>(count, GravityField::MAX_DEGREE));
+            } else if (arg == "--thrust-bias") {
+                // May be negative ("2% cold")
+                if (!isNumber || number <= -1.0) {
+                    std::cerr << "Invalid thrust bias: " << value << std::endl;
+                    return false;
+                }
+                config.dispersion.thrustBias = number;
+            } else if (arg == "--epoch-jd") {
+                if (!isNumber) {
+                    std::cerr << "Invalid epoch: " << value << std::endl;
+                    return false;
+                }
+                options.epochJulianDate = number;
+            } else if (!isNumber || number < 0.0) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return false;
+            } else if (arg == "--duration") {
+                config.duration = number;
+            } else if (arg == "--dt") {
+                if (number <= 0.0) {
+                    std::cerr << "Invalid dt: " << value << std::endl;
+                    return false;
+                }
+                config.dt = number;
+            } else if (arg == "--burn-start") {
+                config.burn.startTime = number;
+            } else if (arg == "--burn-duration") {
+                config.burn.duration = number;
+            } else if (arg == "--throttle") {
+                config.burn.throttle = std::min(number, 1.0);
+            } else if (arg == "--sigma-position") {
+                config.dispersion.positionSigma = number;
+            } else if (arg == "--sigma-velocity") {
+                config.dispersion.velocitySigma = number;
+            } else if (arg == "--sigma-thrust") {
+                config.dispersion.thrustSigma = number;
+            } else if (arg == "--sigma-pointing") {
+                config.dispersion.pointingSigma = number * Constants::DEG_TO_RAD;
+            } else if (arg == "--sigma-isp") {
+                config.dispersion.ispSigma = number;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    Scenario scenario;
+    if (!options.scenarioFile.empty()) {
+        std::string error;
+        if (!Scenarios::loadFromFile(options.scenarioFile, scenario, error)) {
+            std::cerr << "Failed to load scenario: " << error << std::endl;
+            return 1;
+        }
+    } else {
+        scenario = Scenarios::getBuiltIn(options.scenarioIndex);
+    }
+    
+    MonteCarloConfig& config = options.config;
+    Scenarios::apply(scenario, config.nominal);
+    config.circularEarth = (scenario.dynamics == Scenario::Dynamics::EarthMoonCR3BP);
+    
+    GravityField gravityField;
+    GravityCache gravityCache;
+    if (!options.gravityFile.empty() && !config.circularEarth) {
+        std::string error;
+        if (!gravityField.loadFromFile(options.gravityFile, options.gravityDegree, error)) {
+            std::cerr << "Failed to load gravity field: " << error << std::endl;
+            return 1;
+        }
+        config.gravityField = &gravityField;
+        config.gravityDegree = gravityField.getDegree();
+    }
+    if (!options.gravityCacheFile.empty() && !config.circularEarth) {
+        std::string error;
+        if (!gravityCache.load(options.gravityCacheFile, error)) {
+            std::cerr << "Failed to load gravity cache: " << error << std::endl;
+            return 1;
+        }
+        if (!gravityCache.matches(gravityField) || gravityCache.getDegree() != gravityField.getDegree()) {
+            std::cerr << "Gravity cache was not built from this field at degree "
+                      << gravityField.getDegree() << std::endl;
+            return 1;
+        }
+        config.gravityCache = &gravityCache;
+    }
+    Ephemeris ephemeris;
+    if (options.thirdBodies && !config.circularEarth) {
+        ephemeris.build(options.epochJulianDate, config.duration);
+        config.ephemeris = &ephemeris;
+    }
+    
+    ThreadPool pool(options.threads);
+    MonteCarloResult result = MonteCarlo::run(config, pool);
+    
+    const double km = 1.0 / 1000.0;
+    std::printf("Scenario: %s\n", scenario.name.c_str());
+    const char* thirdBodies = config.ephemeris ? " + Earth/Sun" : (config.circularEarth ? " + Earth (CR3BP)" : "");
+    if (config.gravityDegree >= 2) {
+        std::printf("Gravity: degree %d%s%s\n", config.gravityDegree, config.gravityCache ? " (cached)" : "", thirdBodies);
+    } else {
+        std::printf("Gravity: point mass%s\n", thirdBodies);
+    }
+    std::printf("Samples: %zu, seed %llu, %u threads, %.2f s wall\n",
+                result.sampleCount, static_cast<unsigned long long>(config.seed),
+                pool.getThreadCount(), result.wallSeconds);
+    std::printf("Impact probability: %.4f (%zu of %zu)\n",
+                result.impactProbability, result.impactCount, result.sampleCount);
+    if (result.impactCount > 0) {
+        std::printf("Impact time: mean %.1f s, min %.1f s, max %.1f s\n",
+                    result.impactTime.mean, result.impactTime.min, result.impactTime.max);
+    }
+    std::printf("Periapsis altitude (km): mean %.3f, std %.3f, min %.3f, max %.3f\n",
+                result.periapsisAltitude.mean * km, result.periapsisAltitude.getStdDev() * km,
+                result.periapsisAltitude.min * km, result.periapsisAltitude.max * km);
+    std::printf("Periapsis percentiles (km): p1 %.2f, p5 %.2f, p50 %.2f, p95 %.2f, p99 %.2f\n",
+                result.getPeriapsisPercentile(0.01) * km, result.getPeriapsisPercentile(0.05) * km,
+                result.getPeriapsisPercentile(0.50) * km, result.getPeriapsisPercentile(0.95) * km,
+                result.getPeriapsisPercentile(0.99) * km);
+    if (result.apoapsisAltitude.count > 0) {
+        std::printf("Apoapsis altitude (km, bound orbits): mean %.3f, std %.3f\n",
+                    result.apoapsisAltitude.mean * km, result.apoapsisAltitude.getStdDev() * km);
+    }
+    std::printf("Digest: %016llx\n", static_cast<unsigned long long>(result.digest));
+    
+    return 0;
+}
@@ -0,0 +1,242 @@
+// artemis-porkchop: transfer-window grid from a scenario's orbit to a
+// circular target orbit.
+//
+// Solves Lambert's problem for every pair of departure and arrival times on
+// the grid, in parallel, and writes the two-impulse delta-v of the
+// cheapest arc per cell as CSV: the data behind a porkchop plot. Both orbits
+// are two-body conics about the Moon.
+
+#include "core/Constants.h"
+#include "core/ThreadPool.h"
+#include "physics/Orbit.h"
+#include "physics/Scenario.h"
+#include "physics/Spacecraft.h"
+#include "physics/TransferGrid.h"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+    struct Options {
+        int scenarioIndex = 0;
+        std::string scenarioFile;
+        std::string outputFile;
+        
+        // Circular target orbit at t = 0
+        double targetAltitude = 200000.0;                       // meters
+        double targetInclination = 30.0 * Constants::DEG_TO_RAD;
+        double targetRaan = 0.0;
+        double targetPhase = 120.0 * Constants::DEG_TO_RAD;     // argument of latitude
+        
+        TransferGrid::Options grid;
+        unsigned threads = 0;
+        bool quiet = false;
+    };
+    
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  --scenario N             Departure orbit: built-in scenario index (0-" << Scenarios::getBuiltInCount() - 1 << ", default 0)\n"
+                  << "  --scenario-file PATH     Departure orbit from a key = value file\n"
+                  << "  --target-alt KM          Circular target orbit altitude (default 200)\n"
+                  << "  --target-inc DEG         Target inclination (default 30)\n"
+                  << "  --target-raan DEG        Target ascending node (default 0)\n"
+                  << "  --target-phase DEG       Target argument of latitude at t = 0 (default 120)\n"
+                  << "  --departure T0 T1 N      Departure times, seconds (default 0 14400 1000)\n"
+                  << "  --arrival T0 T1 N        Arrival times, seconds (default 1800 28800 1000)\n"
+                  << "  --revolutions N          Most complete revolutions of a transfer arc (default 2)\n"
+                  << "  --retrograde             Arcs against the departure orbit's motion\n"
+                  << "  --flyby                  Count only the departure burn\n"
+                  << "  --threads N              Worker threads (default: all cores)\n"
+                  << "  --output PATH            Write CSV to PATH (default stdout)\n"
+                  << "  --quiet                  Suppress the summary on stderr\n"
+                  << "  --help                   Show this message\n";
+    }
+    
+    bool parseDouble(const char* text, double& out) {
+        char* end = nullptr;
+        out = std::strtod(text, &end);
+        return end != text && *end == '\0';
+    }
+    
+    bool parseInt(const char* text, int& out) {
+        char* end = nullptr;
+        long value = std::strtol(text, &end, 10);
+        out = static_cast<int>(value);
+        return end != text && *end == '\0';
+    }
+    
+    // T0 T1 N for one grid axis
+    bool parseAxis(int argc, char** argv, int& i, double& start, double& end, int& count) {
+        if (i + 3 >= argc || !parseDouble(argv[i + 1], start) || !parseDouble(argv[i + 2], end) ||
+            !parseInt(argv[i + 3], count) || count <= 0 || end < start) {
+            std::cerr << argv[i] << " needs T0 T1 N with T1 >= T0 and N > 0" << std::endl;
+            return false;
+        }
+        i += 3;
+        return true;
+    }
+    
+    bool parseArgs(int argc, char** argv, Options& options) {
+        TransferGrid::Options& grid = options.grid;
+        grid.departureStart = 0.0;
+        grid.departureEnd = 4.0 * 3600.0;
+        grid.departureCount = 1000;
+        grid.arrivalStart = 0.5 * 3600.0;
+        grid.arrivalEnd = 8.0 * 3600.0;
+        grid.arrivalCount = 1000;
+        
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            
+            if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                std::exit(0);
+            } else if (arg == "--retrograde") {
+                grid.retrograde = true;
+                continue;
+            } else if (arg == "--flyby") {
+                grid.rendezvous = false;
+                continue;
+            } else if (arg == "--quiet") {
+                options.quiet = true;
+                continue;
+            } else if (arg == "--departure") {
+                if (!parseAxis(argc, argv, i, grid.departureStart, grid.departureEnd, grid.departureCount)) {
+                    return false;
+                }
+                continue;
+            } else if (arg == "--arrival") {
+                if (!parseAxis(argc, argv, i, grid.arrivalStart, grid.arrivalEnd, grid.arrivalCount)) {
+                    return false;
+                }
+                continue;
+            } else if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            
+            const char* value = argv[++i];
+            double number = 0.0;
+            int count = 0;
+            
+            if (arg == "--scenario-file") {
+                options.scenarioFile = value;
+            } else if (arg == "--output") {
+                options.outputFile = value;
+            } else if (arg == "--scenario" || arg == "--revolutions" || arg == "--threads") {
+                if (!parseInt(value, count) || count < 0) {
+                    std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                    return false;
+                }
+                if (arg == "--scenario") {
+                    if (count >= Scenarios::getBuiltInCount()) {
+                        std::cerr << "Scenario index out of range: " << value << std::endl;
+                        return false;
+                    }
+                    options.scenarioIndex = count;
+                }
+                if (arg == "--revolutions") grid.maxRevolutions = count;
+                if (arg == "--threads") options.threads = static_cast<unsigned>(count);
+            } else if (!parseDouble(value, number)) {
+                std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+                return false;
+            } else if (arg == "--target-alt") {
+                options.targetAltitude = number * 1000.0;
+            } else if (arg == "--target-inc") {
+                options.targetInclination = number * Constants::DEG_TO_RAD;
+            } else if (arg == "--target-raan") {
+                options.targetRaan = number * Constants::DEG_TO_RAD;
+            } else if (arg == "--target-phase") {
+                options.targetPhase = number * Constants::DEG_TO_RAD;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    void writeCsv(std::ostream& out, const TransferGrid::Result& result) {
+        out << "departure_s,arrival_s,dv_departure_mps,dv_arrival_mps,dv_total_mps,revolutions\n";
+        out << std::setprecision(8);
+        for (int i = 0; i < result.departureCount; ++i) {
+            for (int j = 0; j < result.arrivalCount; ++j) {
+                size_t cell = static_cast<size_t>(i) * result.arrivalCount + j;
+                if (std::isnan(result.departureDeltaV[cell])) {
+                    continue;
+                }
+                out << result.getDepartureTime(i) << ',' << result.getArrivalTime(j) << ','
+                    << result.departureDeltaV[cell] << ',' << result.arrivalDeltaV[cell] << ','
+                    << result.getTotalDeltaV(cell) << ',' << static_cast<int>(result.revolutions[cell]) << '\n';
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    Scenario scenario;
+    std::string error;
+    if (!options.scenarioFile.empty()) {
+        if (!Scenarios::loadFromFile(options.scenarioFile, scenario, error)) {
+            std::cerr << "Failed to load scenario: " << error << std::endl;
+            return 1;
+        }
+    } else {
+        scenario = Scenarios::getBuiltIn(options.scenarioIndex);
+    }
+    Spacecraft spacecraft;
+    Scenarios::apply(scenario, spacecraft);
+    
+    TransferGrid::Options& grid = options.grid;
+    grid.mu = Constants::MOON_MU;
+    grid.departurePosition = spacecraft.getState().position;
+    grid.departureVelocity = spacecraft.getState().velocity;
+    Orbit::createCircularOrbit(options.targetAltitude, options.targetInclination, options.targetRaan,
+                               options.targetPhase, Constants::MOON_MU, Constants::MOON_RADIUS,
+                               grid.arrivalPosition, grid.arrivalVelocity);
+    
+    ThreadPool pool(options.threads);
+    TransferGrid::Result result;
+    if (!TransferGrid::compute(grid, pool, result, error)) {
+        std::cerr << "Transfer grid failed: " << error << std::endl;
+        return 1;
+    }
+    
+    if (options.outputFile.empty()) {
+        writeCsv(std::cout, result);
+    } else {
+        std::ofstream file(options.outputFile);
+        if (!file) {
+            std::cerr << "Cannot open output file: " << options.outputFile << std::endl;
+            return 1;
+        }
+        writeCsv(file, result);
+    }
+    
+    if (!options.quiet) {
+        size_t best = result.bestIndex;
+        std::cerr << "Scenario: " << scenario.name << " -> circular " << options.targetAltitude / 1000.0 << " km\n"
+                  << "Grid: " << result.departureCount << " x " << result.arrivalCount << " cells, "
+                  << result.solvedCells << " solved in " << result.wallSeconds << " s on "
+                  << pool.getThreadCount() << " threads (" << result.meanIterations << " iterations/arc)\n";
+        if (result.solvedCells > 0) {
+            std::cerr << "Best: depart " << result.getDepartureTime(static_cast<int>(best / result.arrivalCount))
+                      << " s, arrive " << result.getArrivalTime(static_cast<int>(best % result.arrivalCount))
+                      << " s, " << result.bestDeltaV << " m/s (" << result.departureDeltaV[best] << " + "
+                      << result.arrivalDeltaV[best] << "), " << static_cast<int>(result.revolutions[best])
+                      << " revolutions" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,400 @@
+// artemis-propagate: headless propagator for batch what-if coasts.
+//
+// Loads a built-in or file-based scenario, integrates it as fast as the CPU
+// allows (no window, no vsync, no time warp limit) and writes the state
+// history as CSV. Impact ends the run at its exact time; apsides and node
+// crossings can be logged to a second CSV. --predict only reports whether
+// the coast reaches the surface within the duration, which ImpactPredictor
+// usually settles without integrating.
+
+#include "core/Constants.h"
+#include "physics/CR3BP.h"
+#include "physics/DenseTrajectory.h"
+#include "physics/Ephemeris.h"
+#include "physics/EventDetector.h"
+#include "physics/GravityCache.h"
+#include "physics/GravityField.h"
+#include "physics/ImpactPredictor.h"
+#include "physics/Integrator.h"
+#include "physics/Orbit.h"
+#include "physics/Scenario.h"
+#include "physics/Spacecraft.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+namespace {
+    struct Options {
+        int scenarioIndex = 0;
+        std::string scenarioFile;
+        std::string outputFile;
+        std::string eventsFile;
+        std::string gravityFile;
+        std::string gravityCacheFile;
+        int gravityDegree = GravityField::MAX_DEGREE;
+        bool thirdBodies = false;
+        double epochJulianDate = Constants::EPOCH_JULIAN_DATE;
+        double duration = 7.0 * 86400.0;            // seconds
+        double dt = Constants::FIXED_TIMESTEP;      // seconds
+        double outputInterval = 60.0;               // seconds of sim time between rows
+        Integrator::Type integrator = Integrator::Type::RK4;
+        bool predictOnly = false;
+        bool quiet = false;
+    };
+    
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  --scenario N          Built-in scenario index (0-" << Scenarios::getBuiltInCount() - 1 << ", default 0)\n"
+                  << "  --scenario-file PATH  Load scenario from a key = value file\n"
+                  << "  --duration SECONDS    Simulated time to propagate (default 604800)\n"
+                  << "  --dt SECONDS          Integration step (default " << Constants::FIXED_TIMESTEP << ")\n"
+                  << "  --integrator NAME     euler | semi-implicit | rk4 | verlet | forest-ruth |\n"
+                  << "                        yoshida4 | yoshida6 (default rk4)\n"
+                  << "  --gravity-file PATH   Spherical-harmonic coefficient table (default point mass)\n"
+                  << "  --degree N            Truncate the gravity field at degree N (default all)\n"
+                  << "  --gravity-cache PATH  Interpolate the field from a cache built by artemis-gravity-cache\n"
+                  << "  --third-bodies        Add Earth and Sun perturbations\n"
+                  << "  --epoch-jd JD         Julian date (TT) at t = 0 (default " << Constants::EPOCH_JULIAN_DATE << ")\n"
+                  << "  --output-interval S   Sim seconds between history rows (default 60, 0 = every step)\n"
+                  << "  --output PATH         Write CSV history to PATH (default stdout)\n"
+                  << "  --events PATH         Write apsides, node crossings and impact to PATH as CSV\n"
+                  << "  --predict             Only predict impact or closest approach within the duration\n"
+                  << "  --quiet               Suppress the summary on stderr\n"
+                  << "  --help                Show this message\n";
+    }
+    
+    bool parseDouble(const char* text, double& out) {
+        char* end = nullptr;
+        out = std::strtod(text, &end);
+        return end != text && *end == '\0';
+    }
+    
+    bool parseArgs(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = (i + 1 < argc);
+            
+            if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                std::exit(0);
+            } else if (arg == "--quiet") {
+                options.quiet = true;
+            } else if (arg == "--third-bodies") {
+                options.thirdBodies = true;
+            } else if (arg == "--predict") {
+                options.predictOnly = true;
+            } else if (!hasValue) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            } else if (arg == "--scenario") {
+                options.scenarioIndex = std::atoi(argv[++i]);
+                if (options.scenarioIndex < 0 || options.scenarioIndex >= Scenarios::getBuiltInCount()) {
+                    std::cerr << "Scenario index out of range: " << argv[i] << std::endl;
+                    return false;
+                }
+            } else if (arg == "--scenario-file") {
+                options.scenarioFile = argv[++i];
+            } else if (arg == "--gravity-file") {
+                options.gravityFile = argv[++i];
+            } else if (arg == "--gravity-cache") {
+                options.gravityCacheFile = argv[++i];
+            } else if (arg == "--degree") {
+                options.gravityDegree = std::atoi(argv[++i]);
+                if (options.gravityDegree < 0) {
+                    std::cerr << "Invalid degree: " << argv[i] << std::endl;
+                    return false;
+                }
+            } else if (arg == "--output") {
+                options.outputFile = argv[++i];
+            } else if (arg == "--events") {
+                options.eventsFile = argv[++i];
+            } else if (arg == "--integrator") {
+                if (!Integrator::parseName(argv[++i], options.integrator)) {
+                    std::cerr << "Unknown integrator: " << argv[i] << std::endl;
+                    return false;
+                }
+            } else if (arg == "--duration") {
+                if (!parseDouble(argv[++i], options.duration) || options.duration < 0.0) {
+                    std::cerr << "Invalid duration: " << argv[i] << std::endl;
+                    return false;
+                }
+            } else if (arg == "--dt") {
+                if (!parseDouble(argv[++i], options.dt) || options.dt <= 0.0) {
+                    std::cerr << "Invalid dt: " << argv[i] << std::endl;
+                    return false;
+                }
+            } else if (arg == "--epoch-jd") {
+                if (!parseDouble(argv[++i], options.epochJulianDate)) {
+                    std::cerr << "Invalid epoch: " << argv[i] << std::endl;
+                    return false;
+                }
+            } else if (arg == "--output-interval") {
+                if (!parseDouble(argv[++i], options.outputInterval) || options.outputInterval < 0.0) {
+                    std::cerr << "Invalid output interval: " << argv[i] << std::endl;
+                    return false;
+                }
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    void writeRow(std::ostream& out, double t, const SpacecraftState& state) {
+        double altitude = Orbit::computeAltitude(state.position, Constants::MOON_RADIUS);
+        out << t << ','
+            << state.position.x << ',' << state.position.y << ',' << state.position.z << ','
+            << state.velocity.x << ',' << state.velocity.y << ',' << state.velocity.z << ','
+            << state.mass << ',' << altitude << '\n';
+    }
+    
+    void writeEvent(std::ostream& out, const Event& event) {
+        out << event.time << ',' << event.name << ','
+            << Orbit::computeAltitude(event.position, Constants::MOON_RADIUS) << ','
+            << glm::length(event.velocity) << '\n';
+    }
+    
+    void printPrediction(std::ostream& out, const ImpactPrediction& prediction, double microseconds) {
+        out << "Impact prediction (" << ImpactPrediction::getMethodName(prediction.method) << ", "
+            << microseconds << " us): ";
+        if (prediction.impact) {
+            out << "IMPACT at t = " << prediction.impactTime << " s, " << prediction.impactSpeed << " m/s, "
+                << "lat " << prediction.latitude * Constants::RAD_TO_DEG << " deg, "
+                << "lon " << prediction.longitude * Constants::RAD_TO_DEG << " deg\n";
+            return;
+        }
+        out << "no impact before t = " << prediction.horizonEnd << " s\n"
+            << "Closest approach: " << prediction.closestAltitude / 1000.0 << " km at t = "
+            << prediction.closestTime << " s";
+        if (prediction.method == ImpactPrediction::Method::Bound) {
+            out << ", proven above " << prediction.minimumAltitude / 1000.0 << " km";
+        }
+        out << "\n";
+    }
+    
+    // Jacobi constant of an inertial state at simulation time t
+    double jacobiConstant(const SpacecraftState& state, double t) {
+        glm::dvec3 position, velocity;
+        CR3BP::inertialToRotating(state.position, state.velocity, t, position, velocity);
+        return CR3BP::jacobiConstant(position, velocity);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    Scenario scenario;
+    if (!options.scenarioFile.empty()) {
+        std::string error;
+        if (!Scenarios::loadFromFile(options.scenarioFile, scenario, error)) {
+            std::cerr << "Failed to load scenario: " << error << std::endl;
+            return 1;
+        }
+    } else {
+        scenario = Scenarios::getBuiltIn(options.scenarioIndex);
+    }
+    
+    GravityField gravityField;
+    if (!options.gravityFile.empty()) {
+        std::string error;
+        if (!gravityField.loadFromFile(options.gravityFile, options.gravityDegree, error)) {
+            std::cerr << "Failed to load gravity field: " << error << std::endl;
+            return 1;
+        }
+    }
+    
+    GravityCache gravityCache;
+    if (!options.gravityCacheFile.empty()) {
+        std::string error;
+        if (!gravityCache.load(options.gravityCacheFile, error)) {
+            std::cerr << "Failed to load gravity cache: " << error << std::endl;
+            return 1;
+        }
+        if (!gravityCache.matches(gravityField) || gravityCache.getDegree() != gravityField.getDegree()) {
+            std::cerr << "Gravity cache was not built from this field at degree "
+                      << gravityField.getDegree() << std::endl;
+            return 1;
+        }
+    }
+    
+    Spacecraft spacecraft;
+    Scenarios::apply(scenario, spacecraft);
+    SpacecraftState& state = spacecraft.getState();
+    
+    GravityFieldForceModel forceModel;
+    forceModel.mu = Constants::MOON_MU;
+    if (!options.gravityFile.empty()) {
+        forceModel.field = &gravityField;
+        forceModel.degree = gravityField.getDegree();
+        forceModel.cache = gravityCache.isValid() ? &gravityCache : nullptr;
+    }
+    Ephemeris ephemeris;
+    bool cr3bp = (scenario.dynamics == Scenario::Dynamics::EarthMoonCR3BP);
+    if (cr3bp) {
+        // The scenario fixes the model: point masses on circular orbits
+        forceModel.field = nullptr;
+        forceModel.cache = nullptr;
+        forceModel.circularEarth = true;
+    } else if (options.thirdBodies) {
+        ephemeris.build(options.epochJulianDate, options.duration);
+        forceModel.ephemeris = &ephemeris;
+    }
+    bool timeDependent = !forceModel.isPointMass();
+    
+    if (options.predictOnly) {
+        auto predictStart = std::chrono::steady_clock::now();
+        AdaptiveOptions adaptive;
+        adaptive.relTol = Constants::ORBIT_PREDICTION_TOLERANCE;
+        adaptive.absTol = Constants::ORBIT_PREDICTION_TOLERANCE * 1000.0;
+        ImpactPrediction prediction = ImpactPredictor::predict(state, 0.0, options.duration, forceModel, adaptive);
+        double microseconds = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - predictStart).count();
+        printPrediction(std::cout, prediction, microseconds);
+        return prediction.impact ? 2 : 0;
+    }
+    
+    std::ofstream file;
+    if (!options.outputFile.empty()) {
+        file.open(options.outputFile);
+        if (!file) {
+            std::cerr << "Cannot open output file: " << options.outputFile << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = options.outputFile.empty() ? std::cout : file;
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    out << "t_s,x_m,y_m,z_m,vx_mps,vy_mps,vz_mps,mass_kg,altitude_m\n";
+    
+    double initialJacobi = jacobiConstant(state, 0.0);
+    
+    std::ofstream eventsOut;
+    EventDetector events;
+    events.addFunction(EventFunction::impact());
+    if (!options.eventsFile.empty()) {
+        eventsOut.open(options.eventsFile);
+        if (!eventsOut) {
+            std::cerr << "Cannot open events file: " << options.eventsFile << std::endl;
+            return 1;
+        }
+        eventsOut << std::setprecision(std::numeric_limits<double>::max_digits10);
+        eventsOut << "t_s,event,altitude_m,speed_mps\n";
+        events.addFunction(EventFunction::apsides());
+        events.addFunction(EventFunction::nodes());
+    }
+    events.begin(0.0, state.position, state.velocity);
+    std::vector<Event> located;
+    
+    auto wallStart = std::chrono::steady_clock::now();
+    
+    // Step count is derived from the duration so long runs do not
+    // accumulate round-off in the sim clock
+    long long totalSteps = static_cast<long long>(std::ceil(options.duration / options.dt - 1e-9));
+    long long steps = 0;
+    double t = 0.0;
+    double nextOutput = 0.0;
+    bool impacted = false;
+    
+    writeRow(out, t, state);
+    nextOutput += options.outputInterval;
+    
+    while (steps < totalSteps) {
+        double dt = std::min(options.dt, options.duration - t);
+        const double stepStart = t;
+        const glm::dvec3 startPosition = state.position;
+        const glm::dvec3 startVelocity = state.velocity;
+        if (timeDependent) {
+            forceModel.setTime(t);
+        }
+        Integrator::step(state, dt, options.integrator, forceModel);
+        steps++;
+        t = (steps == totalSteps) ? options.duration : steps * options.dt;
+        
+        // Events inside the step, on the Hermite cubic through its ends
+        DenseTrajectory::Segment segment;
+        bool interpolated = false;
+        auto interpolate = [&](double time, glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+            if (!interpolated) {
+                SpacecraftState start = state;
+                start.position = startPosition;
+                start.velocity = startVelocity;
+                glm::dvec3 velocity, startAccel, endAccel;
+                forceModel.setTime(stepStart);
+                forceModel(start, startAccel, velocity);
+                forceModel.setTime(t);
+                forceModel(state, endAccel, velocity);
+                segment = DenseTrajectory::makeHermite(stepStart, t - stepStart, startPosition, startVelocity,
+                                                       startAccel, state.position, state.velocity, endAccel);
+                interpolated = true;
+            }
+            DenseTrajectory::evaluateSegment(segment, time, outPosition, outVelocity);
+        };
+        located.clear();
+        bool stopped = events.step(t, state.position, state.velocity, interpolate, located);
+        if (eventsOut.is_open()) {
+            for (const Event& event : located) {
+                writeEvent(eventsOut, event);
+            }
+        }
+        if (stopped) {
+            // Impact is the only terminal event
+            impacted = true;
+            t = located.back().time;
+            state.position = located.back().position;
+            state.velocity = located.back().velocity;
+            writeRow(out, t, state);
+            break;
+        }
+        
+        if (t >= nextOutput - 1e-9 || steps == totalSteps) {
+            writeRow(out, t, state);
+            while (nextOutput <= t + 1e-9) {
+                nextOutput += (options.outputInterval > 0.0) ? options.outputInterval : options.dt;
+            }
+        }
+    }
+    out.flush();
+    
+    auto wallEnd = std::chrono::steady_clock::now();
+    double wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    
+    if (!options.quiet) {
+        OrbitalElements elements = Orbit::computeElements(state.position, state.velocity, Constants::MOON_MU);
+        std::cerr << "Scenario: " << scenario.name << "\n"
+                  << "Integrator: " << Integrator::getName(options.integrator)
+                  << ", dt = " << options.dt << " s\n"
+                  << "Gravity: " << (forceModel.hasField() ? "degree " + std::to_string(forceModel.degree) : std::string("point mass"))
+                  << (forceModel.cache ? " (cached)" : "")
+                  << (forceModel.ephemeris ? " + Earth/Sun" : "")
+                  << (cr3bp ? " + Earth (CR3BP)" : "") << "\n"
+                  << "Propagated " << t << " s in " << steps << " steps, "
+                  << wallSeconds << " s wall ("
+                  << (wallSeconds > 0.0 ? t / wallSeconds : 0.0) << "x real time)\n"
+                  << "Final altitude: " << Orbit::computeAltitude(state.position, Constants::MOON_RADIUS) / 1000.0 << " km, "
+                  << "periapsis " << elements.periapsisAltitude / 1000.0 << " km, "
+                  << "apoapsis " << elements.apoapsisAltitude / 1000.0 << " km\n";
+        if (cr3bp) {
+            std::cerr << "Jacobi constant drift: " << jacobiConstant(state, t) - initialJacobi << "\n";
+        }
+        if (impacted) {
+            double latitude = 0.0, longitude = 0.0;
+            ImpactPredictor::toMoonFixed(state.position, t, forceModel, latitude, longitude);
+            std::cerr << "SURFACE IMPACT at t = " << t << " s, lat " << latitude * Constants::RAD_TO_DEG
+                      << " deg, lon " << longitude * Constants::RAD_TO_DEG << " deg\n";
+        }
+    }
+    
+    return impacted ? 2 : 0;
+}
@@ -5,6 +5,7 @@
 #include <imgui.h>
 #include <iostream>
 #include <chrono>
+#include <algorithm>
 
 // Static instance for callbacks
 static Application* s_instance = nullptr;
@@ -55,7 +56,6 @@ bool Application::init(int width, int height, const char* title) {
     
     // Initialize subsystems
     m_time.init();
-    m_spacecraft.init();
     
     if (!m_renderer.init(width, height)) {
         std::cerr << "Failed to initialize renderer" << std::endl;
@@ -71,9 +71,62 @@ bool Application::init(int width, int height, const char* title) {
     m_ui.setResetCallback([this](int scenarioIndex) {
         initScenario(scenarioIndex);
     });
+    m_ui.setBurnCallback([this](Spacecraft::ThrustMode mode, float throttle, float duration, float delay) {
+        SimulationCommand command;
+        if (delay > 0.0f) {
+            // Planned on the simulation clock as shown now
+            command.type = SimulationCommand::Type::ScheduleBurn;
+            command.burn.startTime = m_simulation.getSnapshot().simulationTime + delay;
+            command.burn.duration = duration;
+            command.burn.throttle = throttle;
+            command.burn.mode = mode;
+            m_simulation.postCommand(command);
+            return;
+        }
+        // Throttle, direction and target travel with the settings; send
+        // them first so the burn starts with the values shown when it was
+        // commanded. A targeted burn's duration comes from the solver.
+        postSettings();
+        command.type = SimulationCommand::Type::StartBurn;
+        command.burnDuration = duration;
+        m_simulation.postCommand(command);
+    });
+    m_ui.setCancelBurnCallback([this]() {
+        SimulationCommand command;
+        command.type = SimulationCommand::Type::CancelBurn;
+        m_simulation.postCommand(command);
+    });
+    m_ui.setRemoveBurnCallback([this](uint32_t burnId) {
+        SimulationCommand command;
+        command.type = SimulationCommand::Type::RemoveBurn;
+        command.burnId = burnId;
+        m_simulation.postCommand(command);
+    });
+    m_ui.setTransferCallback([this](const TransferGrid::Options& options) {
+        startTransferGrid(options);
+    });
+    m_ui.setSpawnFleetCallback([this](int count) {
+        SimulationCommand command;
+        command.type = SimulationCommand::Type::SpawnFleet;
+        command.fleetSize = count;
+        m_simulation.postCommand(command);
+    });
+    m_ui.setFleetBurnCallback([this](int vehicleIndex, Spacecraft::ThrustMode mode, float throttle, float duration) {
+        SimulationCommand command;
+        command.type = SimulationCommand::Type::FleetBurn;
+        command.vehicleIndex = vehicleIndex;
+        command.burn.duration = duration;
+        command.burn.throttle = throttle;
+        command.burn.mode = mode;
+        m_simulation.postCommand(command);
+    });
     
-    // Initialize default scenario
-    initScenario(0);
+    // Start physics on the default scenario
+    if (!m_simulation.start(0)) {
+        std::cerr << "Failed to start simulation" << std::endl;
+        return false;
+    }
+    m_ui.setScenarioNames(m_simulation.getScenarioNames());
     
     return true;
 }
@@ -92,6 +145,10 @@ void Application::run() {
 }
 
 void Application::shutdown() {
+    if (m_transferJob.valid()) {
+        m_transferJob.wait();
+    }
+    m_simulation.stop();
     m_ui.shutdown();
     m_renderer.shutdown();
     
@@ -108,122 +165,71 @@ void Application::processInput() {
 }
 
 void Application::update() {
-    if (m_ui.isImpactOccurred() || m_time.isPaused()) {
-        return;
+    // Forward UI changes to the physics thread
+    postSettings();
+    
+    // Physics runs on its own thread; pick up the newest state it published
+    m_simulation.updateSnapshot();
+    const SimulationSnapshot& snapshot = m_simulation.getSnapshot();
+    const SpacecraftState& state = snapshot.state;
+    
+    m_time.setSimulationTime(snapshot.simulationTime);
+    m_time.setPhysicsTime(snapshot.physicsTime);
+    m_ui.setBurnStatus(snapshot.burnActive, snapshot.burnTimeRemaining, snapshot.burnDuration);
+    m_ui.setManeuvers(snapshot.maneuvers, snapshot.simulationTime);
+    m_ui.setWarpStats(snapshot.warpStats, snapshot.achievedWarp);
+    m_ui.setGravityDegreeInUse(snapshot.gravityDegree, snapshot.gravityCached);
+    m_ui.setCR3BPStatus(snapshot.cr3bp, snapshot.jacobiConstant, snapshot.jacobiDrift);
+    m_ui.setTargetingSolution(snapshot.targeting);
+    m_ui.setEventLog(snapshot.events);
+    m_ui.setFleet(snapshot.fleet, snapshot.fleetTime);
+    m_ui.setImpactPrediction(snapshot.impactPrediction, snapshot.simulationTime);
+    pollTransferGrid();
+    
+    // Until a requested reset has been processed the snapshot may still
+    // show the impact that the reset is clearing
+    if (snapshot.impacted && snapshot.resetCount == m_resetsRequested) {
+        m_ui.setImpactOccurred(true);
     }
     
-    auto physicsStart = std::chrono::high_resolution_clock::now();
-    
-    // Fixed timestep physics
-    double dt = Constants::FIXED_TIMESTEP;
-    double frameTime = m_time.getDeltaTime() * m_time.getTimeWarp();
-    m_physicsAccumulator += frameTime;
-    
-    // Limit accumulator to prevent spiral of death
-    const double maxAccumulator = 0.5;
-    if (m_physicsAccumulator > maxAccumulator) {
-        m_physicsAccumulator = maxAccumulator;
-    }
-    
-    // Update burn timer in UI (uses simulation time scale)
-    m_ui.updateBurn(frameTime);
-    
-    // Handle burn timing from UI
-    if (m_ui.isBurnActive()) {
-        // The burn is active, throttle is set from UI
-    } else {
-        // Reset throttle when burn is not active
-        m_spacecraft.setThrottle(0.0f);
-    }
-    
-    // Get integrator type from UI
-    Integrator::Type integratorType = static_cast<Integrator::Type>(m_ui.getSelectedIntegrator());
-    
-    // Set thrust parameters from UI
-    m_spacecraft.setThrustMode(m_ui.getThrustMode());
-    if (m_ui.isBurnActive()) {
-        m_spacecraft.setThrottle(m_ui.getThrottle());
-    }
+    // Update camera target for chase mode
+    m_renderer.getCamera().setTarget(glm::vec3(state.position / Constants::RENDER_SCALE));
+    m_renderer.getCamera().setTargetVelocity(glm::vec3(state.velocity));
+    m_renderer.getCamera().update(static_cast<float>(m_time.getDeltaTime()));
     
-    while (m_physicsAccumulator >= dt) {
-        // Apply thrust acceleration if burning
-        glm::dvec3 thrustAccel(0.0);
-        if (m_spacecraft.getThrottle() > 0.0 && m_spacecraft.hasFuel()) {
-            glm::dvec3 thrustForce = m_spacecraft.computeThrustVector();
-            thrustAccel = thrustForce / m_spacecraft.getMass();
-            m_spacecraft.applyThrust(dt);
-        }
-        
-        // Integration step with combined forces
-        SpacecraftState& state = m_spacecraft.getState();
-        
-        auto derivatives = [this, thrustAccel](const SpacecraftState& s, 
-                                               glm::dvec3& accel, glm::dvec3& velDeriv) {
-            computeDerivatives(s, accel, velDeriv);
-            accel += thrustAccel;
-        };
-        
-        Integrator::step(state, dt, integratorType, derivatives);
-        
-        // Check for collision with Moon surface
-        double altitude = Orbit::computeAltitude(state.position, Constants::MOON_RADIUS);
-        if (altitude <= 0) {
-            m_ui.setImpactOccurred(true);
-            m_spacecraft.setThrottle(0.0f);
-            break;
-        }
-        
-        m_physicsAccumulator -= dt;
+    if (m_ui.isImpactOccurred() || m_time.isPaused()) {
+        return;
     }
     
-    // Update orbital elements
-    m_currentElements = Orbit::computeElements(
-        m_spacecraft.getState().position,
-        m_spacecraft.getState().velocity,
-        Constants::MOON_MU
-    );
-    
     // Record telemetry
-    double altitude = Orbit::computeAltitude(m_spacecraft.getState().position, Constants::MOON_RADIUS);
-    double speed = glm::length(m_spacecraft.getState().velocity);
-    m_ui.recordTelemetry(m_time.getSimulationTime(), altitude, speed, m_currentElements.eccentricity);
-    
-    // Update trajectory prediction periodically
-    m_trajectoryUpdateTimer += m_time.getDeltaTime();
-    if (m_trajectoryUpdateTimer >= 0.5) {  // Update every 0.5 real seconds
-        updateTrajectoryPrediction();
-        m_trajectoryUpdateTimer = 0.0;
-    }
-    
-    // Update camera target for chase mode
-    m_renderer.getCamera().setTarget(glm::vec3(m_spacecraft.getState().position / Constants::RENDER_SCALE));
-    m_renderer.getCamera().setTargetVelocity(glm::vec3(m_spacecraft.getState().velocity));
-    m_renderer.getCamera().update(static_cast<float>(m_time.getDeltaTime()));
-    
-    auto physicsEnd = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double, std::milli> physicsTime = physicsEnd - physicsStart;
-    m_time.setPhysicsTime(physicsTime.count());
+    double altitude = Orbit::computeAltitude(state.position, Constants::MOON_RADIUS);
+    double speed = glm::length(state.velocity);
+    m_ui.recordTelemetry(snapshot.simulationTime, altitude, speed, snapshot.elements.eccentricity);
 }
 
 void Application::render() {
     auto renderStart = std::chrono::high_resolution_clock::now();
     
+    // Render the same snapshot update() consumed this frame
+    const SimulationSnapshot& snapshot = m_simulation.getSnapshot();
+    
     m_renderer.beginFrame();
     
     // Render 3D scene
     m_renderer.renderMoon();
-    m_renderer.renderSpacecraft(m_spacecraft.getState(), 
-                                static_cast<float>(m_spacecraft.getThrottle()));
+    m_renderer.renderSpacecraft(snapshot.state, 
+                                static_cast<float>(snapshot.throttle));
+    m_renderer.renderFleet(snapshot.fleet);
     
     // Render orbit path
     if (m_renderer.getShowOrbitPath()) {
-        m_renderer.renderOrbitPath(m_predictedTrajectory, glm::vec3(0.0f, 1.0f, 0.5f));
+        m_renderer.renderOrbitPath(snapshot.predictedTrajectory, glm::vec3(0.0f, 1.0f, 0.5f));
     }
     
     // Render velocity vector
     if (m_renderer.getShowVelocityVector()) {
-        m_renderer.renderVector(m_spacecraft.getState().position,
-                               m_spacecraft.getState().velocity,
+        m_renderer.renderVector(snapshot.state.position,
+                               snapshot.state.velocity,
                                50.0f, glm::vec3(1.0f, 1.0f, 0.0f));
     }
     
@@ -235,7 +241,7 @@ void Application::render() {
     bool showThrust = m_renderer.getShowThrustVector();
     
     m_ui.beginFrame();
-    m_ui.render(m_spacecraft.getState(), m_currentElements, m_time, 
+    m_ui.render(snapshot.state, snapshot.elements, m_time, 
                m_renderer.getCamera(), showOrbit, showVel, showThrust);
     m_ui.endFrame();
     
@@ -249,95 +255,73 @@ void Application::render() {
 }
 
 void Application::initScenario(int index) {
-    m_spacecraft.init();
-    m_time.reset();
-    m_physicsAccumulator = 0.0;
-    
-    SpacecraftState& state = m_spacecraft.getState();
-    
-    switch (index) {
-        case 0:  // Circular Low Lunar Orbit (100km)
-            Orbit::createCircularOrbit(
-                100000.0,  // 100 km altitude
-                28.0 * Constants::DEG_TO_RAD,  // inclination
-                0.0,  // RAAN
-                0.0,  // true anomaly
-                Constants::MOON_MU,
-                Constants::MOON_RADIUS,
-                state.position,
-                state.velocity
-            );
-            break;
-            
-        case 1:  // Elliptical Capture Orbit
-            Orbit::createEllipticalOrbit(
-                100000.0,   // 100 km periapsis
-                5000000.0,  // 5000 km apoapsis
-                90.0 * Constants::DEG_TO_RAD,  // polar orbit
-                0.0,  // RAAN
-                0.0,  // arg of periapsis
-                180.0 * Constants::DEG_TO_RAD,  // start at apoapsis
-                Constants::MOON_MU,
-                Constants::MOON_RADIUS,
-                state.position,
-                state.velocity
-            );
-            break;
-            
-        case 2:  // Near Surface Skimming
-            Orbit::createEllipticalOrbit(
-                15000.0,   // 15 km periapsis
-                120000.0,  // 120 km apoapsis
-                45.0 * Constants::DEG_TO_RAD,
-                0.0,
-                0.0,
-                0.0,  // start at periapsis
-                Constants::MOON_MU,
-                Constants::MOON_RADIUS,
-                state.position,
-                state.velocity
-            );
-            break;
+    SimulationCommand command;
+    command.type = SimulationCommand::Type::Reset;
+    command.scenarioIndex = index;
+    if (m_simulation.postCommand(command)) {
+        m_time.reset();
+        ++m_resetsRequested;
+    }
+}
+
+void Application::postSettings() {
+    SimulationSettings settings;
+    settings.timeWarp = m_time.getTimeWarp();
+    settings.paused = m_time.isPaused();
+    settings.integrator = static_cast<Integrator::Type>(m_ui.getSelectedIntegrator());
+    settings.fixedStep = m_ui.getPhysicsTimestep();
+    settings.analyticCoast = m_ui.isAnalyticCoastEnabled();
+    settings.attitudeHold = m_ui.isAttitudeHoldEnabled();
+    settings.throttle = m_ui.getThrottle();
+    settings.thrustMode = m_ui.getThrustMode();
+    settings.gravityDegree = m_ui.getGravityDegree();
+    settings.thirdBodies = m_ui.isThirdBodiesEnabled();
+    settings.target = m_ui.getTarget();
+    
+    if (settings == m_sentSettings) {
+        return;
     }
     
-    // Update elements and trajectory
-    m_currentElements = Orbit::computeElements(state.position, state.velocity, Constants::MOON_MU);
-    updateTrajectoryPrediction();
+    SimulationCommand command;
+    command.type = SimulationCommand::Type::ApplySettings;
+    command.settings = settings;
     
-    std::cout << "Scenario " << index << " initialized" << std::endl;
-    std::cout << "  Position: " << state.position.x << ", " << state.position.y << ", " << state.position.z << std::endl;
-    std::cout << "  Velocity: " << state.velocity.x << ", " << state.velocity.y << ", " << state.velocity.z << std::endl;
-    std::cout << "  Altitude: " << (glm::length(state.position) - Constants::MOON_RADIUS) / 1000.0 << " km" << std::endl;
+    // If the queue is full the change is retried next frame
+    if (m_simulation.postCommand(command)) {
+        m_sentSettings = settings;
+    }
 }
 
-void Application::computeDerivatives(const SpacecraftState& state,
-                                    glm::dvec3& outAccel, glm::dvec3& outVelDeriv) {
-    // Two-body gravity: a = -mu * r / |r|^3
-    double r = glm::length(state.position);
-    if (r > 1.0) {  // Avoid division by zero
-        outAccel = -Constants::MOON_MU * state.position / (r * r * r);
-    } else {
-        outAccel = glm::dvec3(0.0);
+void Application::startTransferGrid(TransferGrid::Options options) {
+    // One grid at a time; the UI disables Compute while busy
+    if (m_transferJob.valid()) {
+        return;
     }
-    outVelDeriv = state.velocity;
+    
+    // Time zero of the grid is the latest snapshot
+    const SimulationSnapshot& snapshot = m_simulation.getSnapshot();
+    options.departurePosition = snapshot.state.position;
+    options.departureVelocity = snapshot.state.velocity;
+    m_transferRequestTime = snapshot.simulationTime;
+    
+    m_ui.setTransferBusy(true);
+    m_transferJob = std::async(std::launch::async, [this, options]() {
+        return TransferGrid::compute(options, m_transferPool, m_transferResult, m_transferError);
+    });
 }
 
-void Application::updateTrajectoryPrediction() {
-    auto derivatives = [this](const SpacecraftState& s, 
-                             glm::dvec3& accel, glm::dvec3& velDeriv) {
-        computeDerivatives(s, accel, velDeriv);
-    };
-    
-    double predictionDt = Constants::ORBIT_PREDICTION_HORIZON / Constants::ORBIT_PREDICTION_STEPS;
-    
-    m_predictedTrajectory = Integrator::predictTrajectory(
-        m_spacecraft.getState(),
-        Constants::ORBIT_PREDICTION_HORIZON,
-        predictionDt,
-        Constants::ORBIT_PREDICTION_STEPS,
-        derivatives,
-        Constants::MOON_RADIUS
-    );
+void Application::pollTransferGrid() {
+    if (!m_transferJob.valid() ||
+        m_transferJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    if (m_transferJob.get()) {
+        m_ui.setTransferGrid(std::move(m_transferResult), m_transferRequestTime);
+    } else {
+        m_ui.setTransferError(m_transferError);
+    }
+    m_transferResult = TransferGrid::Result();
+    m_ui.setTransferBusy(false);
 }
 
 // GLFW Callbacks
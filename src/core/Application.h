@@ -1,12 +1,13 @@
 #pragma once
 
 #include "Time.h"
-#include "physics/Spacecraft.h"
-#include "physics/Integrator.h"
-#include "physics/Orbit.h"
+#include "Simulation.h"
+#include "ThreadPool.h"
 #include "render/Renderer.h"
 #include "ui/Ui.h"
-#include <vector>
+#include <cstdint>
+#include <future>
+#include <string>
 
 struct GLFWwindow;
 
@@ -22,24 +23,33 @@ private:
     void render();
     
     void initScenario(int index);
-    void computeDerivatives(const SpacecraftState& state, 
-                           glm::dvec3& outAccel, glm::dvec3& outVelDeriv);
-    void updateTrajectoryPrediction();
+    void postSettings();
+    void startTransferGrid(TransferGrid::Options options);
+    void pollTransferGrid();
     
     GLFWwindow* m_window = nullptr;
     int m_width = 1280;
     int m_height = 720;
     
     Time m_time;
-    Spacecraft m_spacecraft;
+    Simulation m_simulation;
     Renderer m_renderer;
     Ui m_ui;
     
-    OrbitalElements m_currentElements;
-    std::vector<glm::dvec3> m_predictedTrajectory;
+    // Last settings the physics thread accepted
+    SimulationSettings m_sentSettings;
     
-    double m_physicsAccumulator = 0.0;
-    double m_trajectoryUpdateTimer = 0.0;
+    // Reset commands sent; snapshots from before the latest reset are
+    // still shown but their impact flag is ignored
+    uint64_t m_resetsRequested = 0;
+    
+    // Transfer-window grid, computed off the render thread. The result and
+    // error are only touched by the job until its future is ready.
+    ThreadPool m_transferPool;
+    std::future<bool> m_transferJob;
+    TransferGrid::Result m_transferResult;
+    std::string m_transferError;
+    double m_transferRequestTime = 0.0;
     
     // Mouse state
     double m_lastMouseX = 0.0;
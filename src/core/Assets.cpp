@@ -0,0 +1,29 @@
+#include "Assets.h"
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+std::string Assets::findPath(const std::string& relativePath) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> searchPaths;
+    
+    // Check environment variable first (for installed package)
+    const char* envPath = std::getenv("ARTEMIS_ASSETS_DIR");
+    if (envPath) {
+        searchPaths.push_back(fs::path(envPath) / relativePath);
+    }
+    
+    // Check relative paths (for development and portable builds)
+    searchPaths.push_back(fs::path("assets") / relativePath);
+    searchPaths.push_back(fs::path("..") / "share" / "ArtemisMoonOrbiterSim" / "assets" / relativePath);
+    searchPaths.push_back(fs::path("share") / "ArtemisMoonOrbiterSim" / "assets" / relativePath);
+    
+    for (const auto& path : searchPaths) {
+        if (fs::exists(path)) {
+            return path.string();
+        }
+    }
+    
+    // Return the default relative path if nothing found
+    return (fs::path("assets") / relativePath).string();
+}
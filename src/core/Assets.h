@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+class Assets {
+public:
+    // Locate a file under the assets directory. Checks ARTEMIS_ASSETS_DIR
+    // first (installed package), then paths relative to the working
+    // directory (development and portable builds). Returns the default
+    // relative path if nothing is found.
+    static std::string findPath(const std::string& relativePath);
+};
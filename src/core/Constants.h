@@ -4,6 +4,15 @@ namespace Constants {
     // Moon parameters
     constexpr double MOON_MU = 4902.800066e9;           // m^3/s^2 gravitational parameter
     constexpr double MOON_RADIUS = 1737400.0;           // meters
+    constexpr double MOON_ROTATION_RATE = 2.6616995e-6; // rad/s (sidereal, 27.321661 days)
+    
+    // Third bodies
+    constexpr double EARTH_MU = 3.986004418e14;         // m^3/s^2
+    constexpr double SUN_MU = 1.32712440018e20;         // m^3/s^2
+    
+    // Simulation time zero (Julian date, TT): 2026-01-01 00:00
+    constexpr double EPOCH_JULIAN_DATE = 2461041.5;
+    constexpr double SECONDS_PER_DAY = 86400.0;
     
     // Standard gravity (for Isp calculations)
     constexpr double G0 = 9.80665;                      // m/s^2
@@ -16,12 +25,13 @@ namespace Constants {
     
     // Simulation
     constexpr double FIXED_TIMESTEP = 0.02;             // seconds (50 Hz physics)
-    constexpr int MAX_TIME_WARP = 100;
+    constexpr int MAX_TIME_WARP = 100000;
     
     // Rendering
     constexpr double RENDER_SCALE = 1000.0;             // 1 render unit = 1 km
-    constexpr int ORBIT_PREDICTION_STEPS = 2000;
+    constexpr int ORBIT_PREDICTION_STEPS = 2000;          // display samples
     constexpr double ORBIT_PREDICTION_HORIZON = 7200.0; // seconds
+    constexpr double ORBIT_PREDICTION_TOLERANCE = 1e-10; // adaptive relative tolerance
     
     // Math
     constexpr double PI = 3.14159265358979323846;
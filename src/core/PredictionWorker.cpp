@@ -0,0 +1,141 @@
+#include "PredictionWorker.h"
+#include "Constants.h"
+#include "physics/CR3BP.h"
+#include "physics/DenseTrajectory.h"
+#include "physics/Integrator.h"
+
+PredictionWorker::~PredictionWorker() {
+    stop();
+}
+
+void PredictionWorker::start() {
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_stopping = false;
+    m_thread = std::thread(&PredictionWorker::threadMain, this);
+}
+
+void PredictionWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_hasPending = false;
+    }
+    m_cancelRunning.store(true, std::memory_order_relaxed);
+    m_wake.notify_one();
+    
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+uint64_t PredictionWorker::request(const SpacecraftState& state, const GravityFieldForceModel& forceModel,
+                                   double time, double horizon) {
+    uint64_t generation = ++m_generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingState = state;
+        m_pendingForceModel = forceModel;
+        m_pendingTime = time;
+        m_pendingHorizon = horizon;
+        m_pendingGeneration = generation;
+        m_hasPending = true;
+    }
+    m_wake.notify_one();
+    return generation;
+}
+
+void PredictionWorker::cancel() {
+    m_cancelledGeneration = ++m_generation;
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hasPending = false;
+    m_cancelRunning.store(true, std::memory_order_relaxed);
+}
+
+bool PredictionWorker::fetch(std::vector<glm::dvec3>& outPositions, ImpactPrediction& outImpact) {
+    m_results.update();
+    const Result& result = m_results.getReadBuffer();
+    
+    if (result.generation <= m_fetchedGeneration || result.generation <= m_cancelledGeneration) {
+        return false;
+    }
+    
+    m_fetchedGeneration = result.generation;
+    outPositions = result.positions;
+    outImpact = result.impact;
+    return true;
+}
+
+void PredictionWorker::threadMain() {
+    // Adaptive propagation takes only as many steps as the tolerance needs;
+    // the dense output is then resampled evenly for display
+    AdaptiveOptions options;
+    options.relTol = Constants::ORBIT_PREDICTION_TOLERANCE;
+    options.absTol = Constants::ORBIT_PREDICTION_TOLERANCE * 1000.0;
+    options.cancel = &m_cancelRunning;
+    
+    DenseTrajectory path;
+    
+    while (true) {
+        SpacecraftState state;
+        GravityFieldForceModel forceModel;
+        double time = 0.0;
+        double horizon = 0.0;
+        uint64_t generation = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || m_hasPending; });
+            if (m_stopping) {
+                return;
+            }
+            state = m_pendingState;
+            forceModel = m_pendingForceModel;
+            forceModel.thrustAccel = glm::dvec3(0.0);
+            time = m_pendingTime;
+            horizon = m_pendingHorizon;
+            generation = m_pendingGeneration;
+            m_hasPending = false;
+            
+            // Cancels issued before this job was taken do not apply to it
+            m_cancelRunning.store(false, std::memory_order_relaxed);
+        }
+        
+        ImpactPrediction impact;
+        bool decided = ImpactPredictor::predictAnalytic(state.position, state.velocity, time, horizon,
+                                                        forceModel, impact);
+        
+        // The CR3BP is integrated in its rotating frame, where the Earth
+        // does not move; its path is rotated back for display
+        bool rotating = forceModel.isCR3BP();
+        if (rotating) {
+            CR3BP::propagate(state, time, horizon, options, &path, nullptr, Constants::MOON_RADIUS);
+        } else {
+            Integrator::propagateAdaptive(
+                state,
+                horizon,
+                forceModel,
+                options,
+                &path,
+                nullptr,
+                Constants::MOON_RADIUS
+            );
+        }
+        
+        if (m_cancelRunning.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        
+        Result& result = m_results.getWriteBuffer();
+        result.generation = generation;
+        if (!decided) {
+            impact = ImpactPredictor::search(path, time, forceModel);
+            impact.horizonEnd = time + horizon;
+        }
+        result.impact = impact;
+        result.positions = rotating ? CR3BP::resampleInertial(path, time, Constants::ORBIT_PREDICTION_STEPS + 1)
+                                    : path.resamplePositions(Constants::ORBIT_PREDICTION_STEPS + 1);
+        m_results.publish();
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Constants.h"
+#include "TripleBuffer.h"
+#include "physics/GravityField.h"
+#include "physics/ImpactPredictor.h"
+#include "physics/Spacecraft.h"
+#include <glm/glm.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Computes the predicted orbit path on a background thread so the physics
+// tick never stalls on it. Every request() and cancel() takes a new
+// generation number; a result is only handed out by fetch() if it is newer
+// than the last one fetched and than the last cancel(). cancel() also stops
+// a propagation that is already running. All methods except the worker
+// itself must be called from one thread.
+//
+// Each result also carries the impact or closest approach over the
+// horizon. ImpactPredictor clears most coasts from the bound before the
+// path is integrated; the others are searched on the path itself, so the
+// prediction never costs a second propagation.
+class PredictionWorker {
+public:
+    ~PredictionWorker();
+    
+    void start();
+    void stop();
+    
+    // Predict a coast of horizon seconds from state, at simulation time,
+    // under forceModel's gravity. Replaces a request that has not started
+    // yet; a running prediction is left to finish. Returns the request's
+    // generation.
+    uint64_t request(const SpacecraftState& state, const GravityFieldForceModel& forceModel,
+                     double time, double horizon = Constants::ORBIT_PREDICTION_HORIZON);
+    
+    // Drop the pending request, stop the running one and ignore any result
+    // from before this call (e.g. after a reset or a burn)
+    void cancel();
+    
+    // Copy out the newest valid result. Returns false if there is none.
+    bool fetch(std::vector<glm::dvec3>& outPositions, ImpactPrediction& outImpact);
+
+private:
+    struct Result {
+        uint64_t generation = 0;
+        std::vector<glm::dvec3> positions;
+        ImpactPrediction impact;
+    };
+    
+    void threadMain();
+    
+    // Requesting thread only
+    uint64_t m_generation = 0;
+    uint64_t m_cancelledGeneration = 0;
+    uint64_t m_fetchedGeneration = 0;
+    
+    // Guarded by m_mutex
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    SpacecraftState m_pendingState;
+    GravityFieldForceModel m_pendingForceModel;
+    double m_pendingTime = 0.0;
+    double m_pendingHorizon = 0.0;
+    uint64_t m_pendingGeneration = 0;
+    bool m_hasPending = false;
+    bool m_stopping = false;
+    
+    std::atomic<bool> m_cancelRunning{false};
+    TripleBuffer<Result> m_results;
+    std::thread m_thread;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al., SC'11).
+// Output is a pure function of (seed, stream, draw index), so a stream per
+// Monte Carlo sample gives the same numbers no matter which thread runs the
+// sample or in what order.
+class CounterRng {
+public:
+    CounterRng(uint64_t seed, uint64_t stream)
+        : m_key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}
+        , m_counter{0, 0, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)} {}
+    
+    uint32_t nextUint32() {
+        if (m_outputIndex == 4) {
+            generateBlock();
+        }
+        return m_output[m_outputIndex++];
+    }
+    
+    // Uniform in (0, 1) with 53 random bits
+    double nextUniform() {
+        uint64_t bits = (static_cast<uint64_t>(nextUint32()) << 21) ^ (nextUint32() >> 11);
+        return (static_cast<double>(bits) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+    
+    // Standard normal (Box-Muller; the second variate is kept for the next call)
+    double nextNormal() {
+        if (m_hasSpareNormal) {
+            m_hasSpareNormal = false;
+            return m_spareNormal;
+        }
+        double radius = std::sqrt(-2.0 * std::log(nextUniform()));
+        double angle = 6.283185307179586 * nextUniform();
+        m_spareNormal = radius * std::sin(angle);
+        m_hasSpareNormal = true;
+        return radius * std::cos(angle);
+    }
+
+private:
+    static constexpr uint32_t MULTIPLIER_0 = 0xD2511F53u;
+    static constexpr uint32_t MULTIPLIER_1 = 0xCD9E8D57u;
+    static constexpr uint32_t WEYL_0 = 0x9E3779B9u;
+    static constexpr uint32_t WEYL_1 = 0xBB67AE85u;
+    
+    void generateBlock() {
+        uint32_t c[4] = {m_counter[0], m_counter[1], m_counter[2], m_counter[3]};
+        uint32_t k0 = m_key[0], k1 = m_key[1];
+        
+        for (int round = 0; round < 10; ++round) {
+            uint64_t p0 = static_cast<uint64_t>(MULTIPLIER_0) * c[0];
+            uint64_t p1 = static_cast<uint64_t>(MULTIPLIER_1) * c[2];
+            uint32_t next[4] = {
+                static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0,
+                static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1,
+                static_cast<uint32_t>(p0)
+            };
+            c[0] = next[0]; c[1] = next[1]; c[2] = next[2]; c[3] = next[3];
+            k0 += WEYL_0;
+            k1 += WEYL_1;
+        }
+        
+        m_output[0] = c[0]; m_output[1] = c[1]; m_output[2] = c[2]; m_output[3] = c[3];
+        m_outputIndex = 0;
+        
+        // Low 64 bits of the counter index draws; the high 64 hold the stream
+        if (++m_counter[0] == 0) {
+            ++m_counter[1];
+        }
+    }
+    
+    uint32_t m_key[2];
+    uint32_t m_counter[4];
+    uint32_t m_output[4] = {0, 0, 0, 0};
+    int m_outputIndex = 4;
+    double m_spareNormal = 0.0;
+    bool m_hasSpareNormal = false;
+};
@@ -0,0 +1,480 @@
+#include "Simulation.h"
+#include "Assets.h"
+#include "Constants.h"
+#include "physics/CR3BP.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+Simulation::~Simulation() {
+    stop();
+}
+
+bool Simulation::start(int scenarioIndex) {
+    if (isRunning()) {
+        std::cerr << "Simulation already running" << std::endl;
+        return false;
+    }
+    
+    std::string gravityPath = Assets::findPath(GRAVITY_FIELD_ASSET);
+    std::string error;
+    if (m_gravityField.loadFromFile(gravityPath, GravityField::MAX_DEGREE, error)) {
+        std::cout << "Loaded gravity field: degree " << m_gravityField.getDegree()
+                  << " from '" << gravityPath << "'" << std::endl;
+    } else {
+        std::cout << "No gravity field (" << error << "), using point mass" << std::endl;
+        m_gravityField.setPointMass(Constants::MOON_MU, Constants::MOON_RADIUS);
+    }
+    
+    // The cache is optional (built with artemis-gravity-cache); a stale one
+    // from another coefficient file is ignored
+    std::string cachePath = Assets::findPath(GRAVITY_CACHE_ASSET);
+    if (std::filesystem::exists(cachePath)) {
+        if (!m_gravityCache.load(cachePath, error)) {
+            std::cout << "Gravity cache not used: " << error << std::endl;
+        } else if (!m_gravityCache.matches(m_gravityField)) {
+            std::cout << "Gravity cache '" << cachePath << "' does not match the field, ignored" << std::endl;
+            m_gravityCache = GravityCache();
+        } else {
+            std::cout << "Loaded gravity cache: degree " << m_gravityCache.getDegree()
+                      << ", max error " << m_gravityCache.getErrorReport().maxError << " m/s^2" << std::endl;
+        }
+    }
+    
+    m_ephemeris.build(Constants::EPOCH_JULIAN_DATE, EPHEMERIS_SPAN);
+    std::cout << "Fitted Earth/Sun ephemeris: " << EPHEMERIS_SPAN / (365.25 * Constants::SECONDS_PER_DAY)
+              << " years, max fit error " << m_ephemeris.getFitError() << " m" << std::endl;
+    
+    // Halo family presets are optional (generated with artemis-halo-family)
+    std::string presetsPath = Assets::findPath(SCENARIO_PRESETS_ASSET);
+    if (std::filesystem::exists(presetsPath)) {
+        if (!Scenarios::loadPresets(presetsPath, m_presets, error)) {
+            std::cout << "Scenario presets not used: " << error << std::endl;
+            m_presets.clear();
+        } else {
+            std::cout << "Loaded " << m_presets.size() << " scenario presets from '" << presetsPath << "'" << std::endl;
+        }
+    }
+    
+    m_predictor.start();
+    m_warpScheduler.getEventDetector().addFunction(EventFunction::apsides());
+    m_warpScheduler.getEventDetector().addFunction(EventFunction::nodes());
+    resetScenario(scenarioIndex);
+    publish();
+    
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&Simulation::threadMain, this);
+    return true;
+}
+
+void Simulation::stop() {
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_predictor.stop();
+}
+
+bool Simulation::postCommand(const SimulationCommand& command) {
+    if (!m_commands.push(command)) {
+        std::cerr << "Simulation command queue full, command dropped" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Simulation::threadMain() {
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / TICK_RATE));
+    
+    auto lastTick = Clock::now();
+    auto nextTick = lastTick + period;
+    
+    while (m_running.load(std::memory_order_acquire)) {
+        auto now = Clock::now();
+        std::chrono::duration<double> elapsed = now - lastTick;
+        lastTick = now;
+        
+        processCommands();
+        
+        // Same clamp as the render loop uses against a spiral of death
+        tick(std::min(elapsed.count(), 0.25));
+        publish();
+        
+        // Fixed rate; after a long tick start the next one straight away
+        // instead of trying to catch up
+        now = Clock::now();
+        if (nextTick < now) {
+            nextTick = now;
+        }
+        std::this_thread::sleep_until(nextTick);
+        nextTick += period;
+    }
+}
+
+void Simulation::processCommands() {
+    SimulationCommand command;
+    while (m_commands.pop(command)) {
+        switch (command.type) {
+            case SimulationCommand::Type::ApplySettings: {
+                bool gravityChanged = command.settings.gravityDegree != m_settings.gravityDegree ||
+                                      command.settings.thirdBodies != m_settings.thirdBodies;
+                bool targetChanged = !(command.settings.target == m_settings.target);
+                m_settings = command.settings;
+                if (gravityChanged) {
+                    restartPrediction();
+                }
+                if (targetChanged && !m_targetedBurn) {
+                    // A solution for another goal is no starting point
+                    m_targeting = Targeting::Solution{};
+                    m_targetingTimer = TARGETING_INTERVAL;
+                }
+                break;
+            }
+            case SimulationCommand::Type::Reset:
+                resetScenario(command.scenarioIndex);
+                ++m_resetCount;
+                break;
+            case SimulationCommand::Type::StartBurn: {
+                if (m_impacted || m_burnActive) {
+                    break;
+                }
+                // Throttle and direction as set now, held for the burn
+                BurnNode burn;
+                burn.startTime = m_simulationTime;
+                burn.duration = command.burnDuration;
+                burn.throttle = m_settings.throttle;
+                burn.mode = m_settings.thrustMode;
+                bool targeted = m_settings.target.goal != Targeting::Goal::None;
+                if (targeted) {
+                    // Solve from exactly this state; the snapshot's solution
+                    // is up to a frame old
+                    solveTargeting();
+                    if (!m_targeting.isExecutable()) {
+                        bool met = m_targeting.status == Targeting::Status::Converged;
+                        std::cerr << "Targeted burn not started: "
+                                  << (met ? "goal already met" : Targeting::getStatusName(m_targeting.status))
+                                  << std::endl;
+                        break;
+                    }
+                    burn.mode = Spacecraft::ThrustMode::Custom;
+                    burn.direction = m_targeting.direction;
+                    burn.duration = m_targeting.duration;
+                }
+                if (planBurn(burn)) {
+                    m_targetedBurn = targeted;
+                    updateBurnState();
+                }
+                break;
+            }
+            case SimulationCommand::Type::ScheduleBurn:
+                if (!m_impacted && planBurn(command.burn)) {
+                    updateBurnState();
+                }
+                break;
+            case SimulationCommand::Type::RemoveBurn:
+                if (m_maneuvers.remove(command.burnId)) {
+                    updateBurnState();
+                }
+                break;
+            case SimulationCommand::Type::CancelBurn:
+                if (const BurnNode* burn = m_maneuvers.findActive(m_simulationTime)) {
+                    m_maneuvers.remove(burn->id);
+                    updateBurnState();
+                }
+                break;
+            case SimulationCommand::Type::SpawnFleet:
+                m_fleet.spawn(static_cast<size_t>(std::max(0, command.fleetSize)), FLEET_SEED);
+                break;
+            case SimulationCommand::Type::FleetBurn: {
+                size_t begin = command.vehicleIndex < 0 ? 0 : static_cast<size_t>(command.vehicleIndex);
+                size_t end = command.vehicleIndex < 0 ? m_fleet.size() : begin + 1;
+                for (size_t i = begin; i < end; ++i) {
+                    m_fleet.startBurn(i, command.burn.throttle, command.burn.mode, command.burn.duration);
+                }
+                break;
+            }
+        }
+    }
+}
+
+void Simulation::tick(double realDeltaTime) {
+    auto physicsStart = std::chrono::high_resolution_clock::now();
+    
+    if (!m_impacted && !m_settings.paused) {
+        WarpRequest request;
+        request.realDeltaTime = realDeltaTime;
+        request.timeWarp = m_settings.timeWarp;
+        request.fixedStep = m_settings.fixedStep;
+        request.integrator = m_settings.integrator;
+        request.analyticCoast = m_settings.analyticCoast;
+        request.maneuvers = &m_maneuvers;
+        request.thrustMode = m_settings.thrustMode;
+        request.attitudeHold = m_settings.attitudeHold;
+        request.gravityField = &m_gravityField;
+        request.gravityDegree = getGravityDegree();
+        request.gravityCache = getGravityCache();
+        request.ephemeris = getEphemeris();
+        request.circularEarth = isCR3BP();
+        request.simulationTime = m_simulationTime;
+        
+        // The fleet's last tick comes out of the spacecraft's budget, and
+        // so does the last targeting solve on a tick that ends with one, so
+        // both lower the achieved warp instead of overrunning the tick
+        double budget = TICK_BUDGET_FRACTION / TICK_RATE;
+        double reserved = m_fleetTime;
+        if (isTargetingDue(realDeltaTime)) {
+            reserved += m_targetingTime;
+        }
+        m_warpScheduler.setFrameBudget(std::max(0.5 * budget, budget - reserved / 1000.0));
+        WarpFrameStats warpStats = m_warpScheduler.advance(m_spacecraft, request);
+        
+        // Sim clock, burns and fleet follow what physics actually integrated
+        m_simulationTime += warpStats.advancedTime;
+        updateBurnState();
+        
+        auto fleetStart = std::chrono::high_resolution_clock::now();
+        size_t lost = m_fleet.advance(warpStats.advancedTime, Constants::MOON_MU);
+        auto fleetEnd = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> fleetTime = fleetEnd - fleetStart;
+        m_fleetTime = fleetTime.count();
+        if (lost > 0) {
+            std::cout << lost << " fleet vehicle(s) hit the surface by t = " << m_simulationTime << " s" << std::endl;
+        }
+        
+        for (const Event& event : warpStats.events) {
+            m_eventLog.push_back(event);
+            if (m_eventLog.size() > EVENT_LOG_SIZE) {
+                m_eventLog.pop_front();
+            }
+        }
+        
+        if (warpStats.impacted) {
+            const Event& impact = warpStats.events.back();
+            std::cout << "Surface impact at t = " << impact.time << " s, "
+                      << glm::length(impact.velocity) << " m/s" << std::endl;
+            m_impacted = true;
+            m_maneuvers.clear();
+            m_burnActive = false;
+            m_targetedBurn = false;
+            m_spacecraft.setThrottle(0.0);
+        }
+        
+        const SpacecraftState& state = m_spacecraft.getState();
+        m_elements = Orbit::computeElements(state.position, state.velocity, Constants::MOON_MU);
+        
+        // Refresh the prediction periodically; the worker runs it in the
+        // background and the result is picked up on a later tick
+        m_predictionTimer += realDeltaTime;
+        if (m_predictionTimer >= PREDICTION_INTERVAL) {
+            m_predictor.request(state, makeForceModel(), m_simulationTime, getPredictionHorizon());
+            m_predictionTimer = 0.0;
+        }
+    }
+    
+    m_predictor.fetch(m_predictedTrajectory, m_impactPrediction);
+    
+    // Re-solve once per display frame as the state moves along the orbit;
+    // a targeted burn in flight keeps the solution it started with
+    if (m_settings.target.goal != Targeting::Goal::None && !m_burnActive && !m_impacted) {
+        m_targetingTimer += realDeltaTime;
+        if (m_targetingTimer >= TARGETING_INTERVAL) {
+            auto targetingStart = std::chrono::high_resolution_clock::now();
+            solveTargeting();
+            auto targetingEnd = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> targetingTime = targetingEnd - targetingStart;
+            m_targetingTime = targetingTime.count();
+            m_targetingTimer = 0.0;
+        }
+    }
+    
+    auto physicsEnd = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> physicsTime = physicsEnd - physicsStart;
+    m_physicsTime = physicsTime.count();
+}
+
+std::vector<std::string> Simulation::getScenarioNames() const {
+    std::vector<std::string> names;
+    for (int i = 0; i < Scenarios::getBuiltInCount(); ++i) {
+        names.push_back(Scenarios::getBuiltIn(i).name);
+    }
+    for (const Scenario& preset : m_presets) {
+        names.push_back(preset.name);
+    }
+    return names;
+}
+
+Scenario Simulation::getScenario(int index) const {
+    int preset = index - Scenarios::getBuiltInCount();
+    if (preset >= 0 && preset < static_cast<int>(m_presets.size())) {
+        return m_presets[preset];
+    }
+    return Scenarios::getBuiltIn(index);
+}
+
+void Simulation::resetScenario(int index) {
+    m_warpScheduler.reset();
+    
+    Scenario scenario = getScenario(index);
+    Scenarios::apply(scenario, m_spacecraft);
+    const SpacecraftState& state = m_spacecraft.getState();
+    
+    m_dynamics = scenario.dynamics;
+    m_simulationTime = 0.0;
+    m_jacobiReference = computeJacobiConstant();
+    m_maneuvers.clear();
+    m_burnActive = false;
+    m_impacted = false;
+    m_eventLog.clear();
+    m_targeting = Targeting::Solution{};
+    m_targetedBurn = false;
+    m_targetingTimer = TARGETING_INTERVAL;
+    
+    // The old scenario's path must not be shown, even briefly
+    m_predictedTrajectory.clear();
+    m_impactPrediction = ImpactPrediction{};
+    m_elements = Orbit::computeElements(state.position, state.velocity, Constants::MOON_MU);
+    restartPrediction();
+    
+    std::cout << "Scenario " << index << " initialized" << std::endl;
+    std::cout << "  Position: " << state.position.x << ", " << state.position.y << ", " << state.position.z << std::endl;
+    std::cout << "  Velocity: " << state.velocity.x << ", " << state.velocity.y << ", " << state.velocity.z << std::endl;
+    std::cout << "  Altitude: " << (glm::length(state.position) - Constants::MOON_RADIUS) / 1000.0 << " km" << std::endl;
+}
+
+void Simulation::restartPrediction() {
+    m_predictor.cancel();
+    m_predictor.request(m_spacecraft.getState(), makeForceModel(), m_simulationTime, getPredictionHorizon());
+    m_predictionTimer = 0.0;
+}
+
+bool Simulation::isTargetingDue(double realDeltaTime) const {
+    // Mirrors the check at the end of tick(); a burn starting this tick
+    // only makes the reservation conservative
+    return m_settings.target.goal != Targeting::Goal::None && !m_burnActive &&
+           m_targetingTimer + realDeltaTime >= TARGETING_INTERVAL;
+}
+
+void Simulation::solveTargeting() {
+    // The solve differentiates the field directly (no cache) once per RK4
+    // stage; a low-degree truncation keeps it to about a millisecond
+    GravityFieldForceModel forceModel = makeForceModel();
+    forceModel.degree = std::min(forceModel.degree, TARGETING_DEGREE);
+    forceModel.cache = nullptr;
+    
+    // Warm-start only from a solution that got somewhere
+    bool warm = m_targeting.status == Targeting::Status::Converged ||
+                m_targeting.status == Targeting::Status::OutOfFuel;
+    Targeting::Solution previous = m_targeting;
+    m_targeting = Targeting::solve(m_spacecraft.getState(), m_settings.target,
+                                   Targeting::getEngine(m_spacecraft, m_settings.throttle),
+                                   forceModel, Targeting::Options{}, warm ? &previous : nullptr);
+}
+
+bool Simulation::planBurn(const BurnNode& burn) {
+    uint32_t id = 0;
+    std::string error;
+    if (!m_maneuvers.add(burn, m_simulationTime, id, error)) {
+        std::cerr << "Burn not planned: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Simulation::updateBurnState() {
+    size_t ended = m_maneuvers.retire(m_simulationTime);
+    bool active = m_maneuvers.findActive(m_simulationTime) != nullptr;
+    if (ended > 0 || (m_burnActive && !active)) {
+        // Cutoff: targeting resumes from the new orbit
+        m_targetedBurn = false;
+        m_targetingTimer = TARGETING_INTERVAL;
+        m_jacobiReference = computeJacobiConstant();
+    }
+    if (!active) {
+        m_spacecraft.setThrottle(0.0);
+    }
+    if (ended > 0 || active != m_burnActive) {
+        restartPrediction();
+    }
+    m_burnActive = active;
+}
+
+GravityFieldForceModel Simulation::makeForceModel() const {
+    GravityFieldForceModel forceModel;
+    forceModel.mu = Constants::MOON_MU;
+    forceModel.field = &m_gravityField;
+    forceModel.degree = getGravityDegree();
+    forceModel.cache = getGravityCache();
+    forceModel.ephemeris = getEphemeris();
+    forceModel.circularEarth = isCR3BP();
+    forceModel.setTime(m_simulationTime);
+    return forceModel;
+}
+
+const GravityCache* Simulation::getGravityCache() const {
+    // Only at the degree it was built for; other truncations evaluate the
+    // field directly
+    if (m_gravityCache.isValid() && m_gravityCache.getDegree() == getGravityDegree()) {
+        return &m_gravityCache;
+    }
+    return nullptr;
+}
+
+int Simulation::getGravityDegree() const {
+    // The CR3BP's Moon is a point mass
+    if (isCR3BP()) {
+        return 0;
+    }
+    int degree = std::min(m_settings.gravityDegree, m_gravityField.getDegree());
+    return degree < 2 ? 0 : degree;
+}
+
+const Ephemeris* Simulation::getEphemeris() const {
+    // The CR3BP places the Earth itself and leaves out the Sun
+    return (m_settings.thirdBodies && !isCR3BP()) ? &m_ephemeris : nullptr;
+}
+
+double Simulation::computeJacobiConstant() const {
+    if (!isCR3BP()) {
+        return 0.0;
+    }
+    const SpacecraftState& state = m_spacecraft.getState();
+    glm::dvec3 position, velocity;
+    CR3BP::inertialToRotating(state.position, state.velocity, m_simulationTime, position, velocity);
+    return CR3BP::jacobiConstant(position, velocity);
+}
+
+void Simulation::publish() {
+    // The write buffer is private to this thread until publish(); assigning
+    // into it reuses the trajectory's capacity from earlier ticks
+    SimulationSnapshot& snapshot = m_snapshots.getWriteBuffer();
+    snapshot.state = m_spacecraft.getState();
+    snapshot.elements = m_elements;
+    snapshot.predictedTrajectory = m_predictedTrajectory;
+    snapshot.impactPrediction = m_impactPrediction;
+    snapshot.simulationTime = m_simulationTime;
+    snapshot.throttle = m_spacecraft.getThrottle();
+    const BurnNode* burn = m_maneuvers.findActive(m_simulationTime);
+    snapshot.burnActive = burn != nullptr;
+    snapshot.burnTimeRemaining = burn ? burn->getEndTime() - m_simulationTime : 0.0;
+    snapshot.burnDuration = burn ? burn->duration : 0.0;
+    snapshot.maneuvers = m_maneuvers.getNodes();
+    m_fleet.exportInstances(snapshot.fleet);
+    snapshot.fleetTime = m_fleetTime;
+    snapshot.impacted = m_impacted;
+    snapshot.warpStats = m_warpScheduler.getLastStats();
+    snapshot.achievedWarp = m_warpScheduler.getAchievedWarp();
+    snapshot.physicsTime = m_physicsTime;
+    snapshot.gravityDegree = getGravityDegree();
+    snapshot.gravityCached = getGravityCache() != nullptr;
+    snapshot.cr3bp = isCR3BP();
+    snapshot.jacobiConstant = computeJacobiConstant();
+    snapshot.jacobiDrift = snapshot.jacobiConstant - m_jacobiReference;
+    snapshot.targeting = m_targeting;
+    snapshot.events.assign(m_eventLog.begin(), m_eventLog.end());
+    snapshot.resetCount = m_resetCount;
+    
+    m_snapshots.publish();
+}
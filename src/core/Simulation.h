@@ -0,0 +1,218 @@
+#pragma once
+
+#include "PredictionWorker.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+#include "physics/Ephemeris.h"
+#include "physics/Fleet.h"
+#include "physics/GravityCache.h"
+#include "physics/GravityField.h"
+#include "physics/Integrator.h"
+#include "physics/ManeuverTimeline.h"
+#include "physics/Orbit.h"
+#include "physics/Scenario.h"
+#include "physics/Spacecraft.h"
+#include "physics/Targeting.h"
+#include "physics/WarpScheduler.h"
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Everything the UI controls continuously. Sent whenever it changes.
+struct SimulationSettings {
+    int timeWarp = 1;
+    bool paused = false;
+    Integrator::Type integrator = Integrator::Type::RK4;
+    double fixedStep = 0.02;
+    bool analyticCoast = true;
+    bool attitudeHold = true;       // RCS holds the nose along the burn direction
+    double throttle = 0.0;
+    Spacecraft::ThrustMode thrustMode = Spacecraft::ThrustMode::Prograde;
+    int gravityDegree = GravityField::MAX_DEGREE;   // below 2 = point mass
+    bool thirdBodies = true;        // Earth and Sun perturbations
+    Targeting::Target target;       // goal None = manual burns
+    
+    bool operator==(const SimulationSettings& other) const = default;
+};
+
+// One-off requests from the UI to the physics thread
+struct SimulationCommand {
+    enum class Type {
+        ApplySettings,
+        Reset,          // load scenarioIndex and clear burn/impact state
+        StartBurn,      // burn now for burnDuration seconds of simulated time, or as targeted
+        ScheduleBurn,   // add burn to the maneuver timeline
+        RemoveBurn,     // drop burnId from the timeline, even mid-burn
+        CancelBurn,     // stop the burn in progress
+        SpawnFleet,     // replace the fleet with fleetSize new vehicles
+        FleetBurn       // burn vehicleIndex (every vehicle if negative) as burn, from now
+    };
+    
+    Type type = Type::ApplySettings;
+    SimulationSettings settings;
+    int scenarioIndex = 0;
+    double burnDuration = 0.0;
+    BurnNode burn;
+    uint32_t burnId = 0;
+    int fleetSize = 0;
+    int vehicleIndex = -1;
+};
+
+// Complete physics state as of one physics tick, as seen by the renderer
+struct SimulationSnapshot {
+    SpacecraftState state;
+    OrbitalElements elements;
+    std::vector<glm::dvec3> predictedTrajectory;     // newest completed prediction
+    ImpactPrediction impactPrediction;               // impact or closest approach along it
+    
+    double simulationTime = 0.0;
+    double throttle = 0.0;          // engine throttle actually applied
+    bool burnActive = false;
+    double burnTimeRemaining = 0.0;
+    double burnDuration = 0.0;      // of the burn in progress
+    std::vector<BurnNode> maneuvers;    // the timeline: in progress and planned, by start
+    bool impacted = false;
+    
+    std::vector<FleetInstance> fleet;   // the other vehicles, in Fleet order
+    double fleetTime = 0.0;         // ms of CPU advancing the fleet in the last tick
+    
+    WarpFrameStats warpStats;       // last tick
+    double achievedWarp = 1.0;
+    double physicsTime = 0.0;       // ms of CPU in the last tick
+    int gravityDegree = 0;          // spherical-harmonic degree in use (0 = point mass)
+    bool gravityCached = false;     // interpolated from the precomputed cache
+    
+    // Earth-Moon CR3BP scenarios: Jacobi constant (normalized units) and its
+    // change since the scenario started or the last burn ended
+    bool cr3bp = false;
+    double jacobiConstant = 0.0;
+    double jacobiDrift = 0.0;
+    
+    // Live solution for the settings' target while no burn runs; the one
+    // being flown while a targeted burn does
+    Targeting::Solution targeting;
+    
+    // Latest Simulation::EVENT_LOG_SIZE events (impact, apsides, nodes),
+    // oldest first, with exact times
+    std::vector<Event> events;
+    
+    uint64_t resetCount = 0;        // Reset commands processed so far
+};
+
+// Runs the spacecraft, and the fleet on the same clock, on its own thread at
+// TICK_RATE, independent of the render frame rate. The render thread never
+// touches physics state: it reads the newest published SimulationSnapshot
+// through a lock-free triple buffer and sends changes back through a
+// wait-free command queue. Exactly one thread may post commands and read
+// snapshots.
+class Simulation {
+public:
+    static constexpr double TICK_RATE = 240.0;              // Hz
+    static constexpr double TICK_BUDGET_FRACTION = 0.75;    // of the tick period
+    static constexpr double PREDICTION_INTERVAL = 0.5;      // seconds of real time
+    static constexpr size_t COMMAND_QUEUE_SIZE = 64;
+    static constexpr const char* GRAVITY_FIELD_ASSET = "gravity/moon_sha.tab";
+    static constexpr const char* GRAVITY_CACHE_ASSET = "gravity/moon_sha.cache";
+    static constexpr const char* SCENARIO_PRESETS_ASSET = "scenarios/halo_family.bin";
+    static constexpr double EPHEMERIS_SPAN = 10.0 * 365.25 * 86400.0;     // seconds fitted at start
+    static constexpr double CR3BP_PREDICTION_HORIZON = 7.0 * 86400.0;     // one NRHO revolution
+    static constexpr double TARGETING_INTERVAL = 1.0 / 60.0;    // seconds of real time, one display frame
+    static constexpr int TARGETING_DEGREE = 8;      // field degree cap for the live solve
+    static constexpr size_t EVENT_LOG_SIZE = 16;
+    static constexpr uint64_t FLEET_SEED = 1;
+    
+    ~Simulation();
+    
+    // Loads the gravity field (point mass if the coefficient file is
+    // missing) and its cache if there is one, fits the Earth and Sun
+    // ephemeris, loads the scenario presets if there are any, then loads
+    // the scenario; publishes the first snapshot and starts the thread
+    bool start(int scenarioIndex);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+    
+    // Returns false if the queue is full; the command is then dropped
+    bool postCommand(const SimulationCommand& command);
+    
+    // Swap in the newest published snapshot. Returns true if it changed.
+    bool updateSnapshot() { return m_snapshots.update(); }
+    const SimulationSnapshot& getSnapshot() const { return m_snapshots.getReadBuffer(); }
+    
+    // Names of the scenarios Reset accepts, by index: the built-in ones,
+    // then the presets. Fixed once started.
+    std::vector<std::string> getScenarioNames() const;
+
+private:
+    void threadMain();
+    void processCommands();
+    void tick(double realDeltaTime);
+    void resetScenario(int index);
+    Scenario getScenario(int index) const;
+    
+    // Start a new prediction from the current state, discarding any in
+    // flight (the state jumped or the thrust changed)
+    void restartPrediction();
+    
+    // Re-solve the targeted burn from the current state, warm-started from
+    // the last solution
+    void solveTargeting();
+    
+    // Whether this tick will end with a solve, so its time can be reserved
+    bool isTargetingDue(double realDeltaTime) const;
+    
+    // Add a burn to the timeline, reporting why if it does not fit
+    bool planBurn(const BurnNode& burn);
+    
+    // After the timeline's burns may have started or ended: restart the
+    // prediction, and on cutoff free the targeting solution
+    void updateBurnState();
+    GravityFieldForceModel makeForceModel() const;
+    bool isCR3BP() const { return m_dynamics == Scenario::Dynamics::EarthMoonCR3BP; }
+    double getPredictionHorizon() const {
+        return isCR3BP() ? CR3BP_PREDICTION_HORIZON : Constants::ORBIT_PREDICTION_HORIZON;
+    }
+    int getGravityDegree() const;
+    const GravityCache* getGravityCache() const;
+    const Ephemeris* getEphemeris() const;
+    double computeJacobiConstant() const;
+    void publish();
+    
+    // Read-only once the thread runs; shared with the prediction worker
+    GravityField m_gravityField;
+    GravityCache m_gravityCache;
+    Ephemeris m_ephemeris;
+    std::vector<Scenario> m_presets;
+    
+    // Physics thread only
+    Spacecraft m_spacecraft;
+    Scenario::Dynamics m_dynamics = Scenario::Dynamics::LunarGravity;
+    double m_jacobiReference = 0.0;
+    WarpScheduler m_warpScheduler;
+    SimulationSettings m_settings;
+    OrbitalElements m_elements;
+    std::vector<glm::dvec3> m_predictedTrajectory;
+    ImpactPrediction m_impactPrediction;
+    double m_simulationTime = 0.0;
+    ManeuverTimeline m_maneuvers;
+    Fleet m_fleet;                  // kept across scenario resets
+    double m_fleetTime = 0.0;
+    bool m_burnActive = false;      // a timeline burn was in progress at the end of the last tick
+    bool m_impacted = false;
+    Targeting::Solution m_targeting;
+    bool m_targetedBurn = false;    // the burn in progress flies m_targeting
+    double m_targetingTimer = 0.0;
+    double m_targetingTime = 0.0;   // ms, last solve
+    double m_predictionTimer = 0.0;
+    double m_physicsTime = 0.0;
+    std::deque<Event> m_eventLog;
+    uint64_t m_resetCount = 0;
+    PredictionWorker m_predictor;
+    
+    // Shared
+    TripleBuffer<SimulationSnapshot> m_snapshots;
+    SpscQueue<SimulationCommand, COMMAND_QUEUE_SIZE> m_commands;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded wait-free single-producer / single-consumer ring buffer. push()
+// and pop() finish in a fixed number of steps; push() returns false when the
+// queue is full instead of waiting. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side
+    bool push(const T& item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tailCache >= Capacity) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head - m_tailCache >= Capacity) {
+                return false;
+            }
+        }
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer side
+    bool pop(T& out) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_headCache) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail == m_headCache) {
+                return false;
+            }
+        }
+        out = std::move(m_items[tail & (Capacity - 1)]);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T m_items[Capacity];
+    
+    // Producer-owned
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_tailCache = 0;
+    
+    // Consumer-owned
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_headCache = 0;
+};
@@ -0,0 +1,149 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace {
+    // Identifies the pool and worker slot of the current thread
+    thread_local const ThreadPool* t_pool = nullptr;
+    thread_local unsigned t_workerIndex = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    m_queues.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    
+    m_workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stop = true;
+    }
+    m_workAvailable.notify_all();
+    
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::getCurrentWorkerIndex() const {
+    return (t_pool == this) ? t_workerIndex : getThreadCount();
+}
+
+void ThreadPool::submit(Task task) {
+    unsigned worker = getCurrentWorkerIndex();
+    unsigned queue = (worker < getThreadCount())
+        ? worker
+        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % getThreadCount();
+    
+    m_pendingTasks.fetch_add(1);
+    {
+        // Counted before the push so the counter never dips below the number
+        // of tasks in the deques. Taking the sleep lock orders this with a
+        // worker's predicate check, so the wake-up cannot be lost.
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_queuedTasks.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+        m_queues[queue]->tasks.push_back(std::move(task));
+    }
+    m_workAvailable.notify_one();
+}
+
+bool ThreadPool::popBack(unsigned queue, Task& out) {
+    WorkQueue& q = *m_queues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) {
+        return false;
+    }
+    out = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::stealFront(unsigned queue, Task& out) {
+    WorkQueue& q = *m_queues[queue];
+    std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || q.tasks.empty()) {
+        return false;
+    }
+    out = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::tryRunTask(unsigned preferredQueue) {
+    unsigned count = getThreadCount();
+    Task task;
+    bool found = (preferredQueue < count) && popBack(preferredQueue, task);
+    
+    // Steal, starting after our own queue so thieves spread out
+    for (unsigned i = 1; !found && i <= count; ++i) {
+        found = stealFront((preferredQueue + i) % count, task);
+    }
+    if (!found) {
+        return false;
+    }
+    
+    m_queuedTasks.fetch_sub(1);
+    task();
+    finishTask();
+    return true;
+}
+
+void ThreadPool::finishTask() {
+    if (m_pendingTasks.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_allDone.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    t_pool = this;
+    t_workerIndex = index;
+    
+    while (true) {
+        if (tryRunTask(index)) {
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_workAvailable.wait(lock, [this]() { return m_stop || m_queuedTasks > 0; });
+        if (m_stop && m_queuedTasks == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::wait() {
+    unsigned self = getCurrentWorkerIndex();
+    
+    while (m_pendingTasks > 0) {
+        if (tryRunTask(self)) {
+            continue;
+        }
+        
+        // Nothing left to steal; the remaining tasks are running elsewhere
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_allDone.wait(lock, [this]() { return m_pendingTasks == 0 || m_queuedTasks > 0; });
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    for (size_t i = 0; i < count; ++i) {
+        submit([&fn, i]() { fn(i); });
+    }
+    wait();
+}
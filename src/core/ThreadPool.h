@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Each worker owns a task deque: it pushes and
+// pops its own work at the back (newest first, cache-warm) and steals from
+// the front of other workers' deques when it runs dry. Tasks submitted from
+// outside the pool are dealt round-robin across the worker deques.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+    
+    // threadCount 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    unsigned getThreadCount() const { return static_cast<unsigned>(m_workers.size()); }
+    
+    void submit(Task task);
+    
+    // Block until every submitted task has finished. The calling thread runs
+    // queued tasks while it waits. Must not be called from inside a task.
+    void wait();
+    
+    // Run fn(i) for i in [0, count) and wait for completion
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+    
+    // Index of the pool worker running the caller, in [0, getThreadCount()),
+    // or getThreadCount() for threads outside the pool. Lets tasks keep
+    // per-thread scratch without locking.
+    unsigned getCurrentWorkerIndex() const;
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    
+    void workerLoop(unsigned index);
+    bool tryRunTask(unsigned preferredQueue);
+    bool popBack(unsigned queue, Task& out);
+    bool stealFront(unsigned queue, Task& out);
+    void finishTask();
+    
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    
+    std::atomic<size_t> m_queuedTasks{0};    // in a deque, not yet started
+    std::atomic<size_t> m_pendingTasks{0};   // submitted, not yet finished
+    std::atomic<unsigned> m_nextQueue{0};
+    std::atomic<bool> m_stop{false};
+    
+    std::mutex m_sleepMutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_allDone;
+};
@@ -26,10 +26,6 @@ void Time::update() {
     
     std::chrono::duration<double> totalElapsed = currentTime - m_startTime;
     m_realTime = totalElapsed.count();
-    
-    if (!m_paused) {
-        m_simulationTime += m_deltaTime * m_timeWarp;
-    }
 }
 
 void Time::setTimeWarp(int warp) {
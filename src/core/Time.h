@@ -18,6 +18,10 @@ public:
     void decreaseTimeWarp();
     void togglePause();
     void setPaused(bool paused) { m_paused = paused; }
+    
+    // Simulated time is owned by the physics thread: it advances by what was
+    // actually integrated, which can be less than real time x warp
+    void setSimulationTime(double time) { m_simulationTime = time; }
     void reset();
     
     double getFrameTime() const { return m_frameTime; }
@@ -42,7 +46,8 @@ private:
     double m_physicsTime = 0.0;
     double m_renderTime = 0.0;
     
-    static constexpr int TIME_WARP_LEVELS[] = {1, 2, 5, 10, 50, 100};
-    static constexpr int NUM_WARP_LEVELS = 6;
+    // Levels above 100x rely on analytic coasting (Orbit::propagateKepler)
+    static constexpr int TIME_WARP_LEVELS[] = {1, 2, 5, 10, 50, 100, 1000, 10000, 100000};
+    static constexpr int NUM_WARP_LEVELS = 9;
     int m_warpLevelIndex = 0;
 };
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-writer / single-reader triple buffer. The writer fills
+// its private buffer and publishes it by swapping it with the shared middle
+// slot; the reader swaps the middle slot with its own buffer when a fresh one
+// is waiting. Neither side ever blocks or waits for the other, and the reader
+// always sees the most recently published complete value.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& getWriteBuffer() { return m_buffers[m_writeIndex]; }
+    
+    void publish() {
+        uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_writeIndex | FRESH_BIT),
+                                             std::memory_order_acq_rel);
+        m_writeIndex = previous & INDEX_MASK;
+    }
+    
+    // Reader side: swap in the newest published buffer, if any. Returns true
+    // when the read buffer changed.
+    bool update() {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0) {
+            return false;
+        }
+        uint8_t previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+        m_readIndex = previous & INDEX_MASK;
+        return true;
+    }
+    
+    const T& getReadBuffer() const { return m_buffers[m_readIndex]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+    
+    T m_buffers[3];
+    
+    // Each index is owned by one thread; keep them off each other's cache line
+    alignas(64) uint8_t m_writeIndex = 0;
+    alignas(64) std::atomic<uint8_t> m_middle{1};
+    alignas(64) uint8_t m_readIndex = 2;
+};
@@ -0,0 +1,163 @@
+#include "AttitudeDynamics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Rotation taking the body axes to the given inertial unit vectors
+    // (Shepperd's method: pivot on the largest of w, x, y, z)
+    glm::dquat fromAxes(const glm::dvec3& xAxis, const glm::dvec3& yAxis, const glm::dvec3& zAxis) {
+        // m[row][column], the axes as columns
+        const double m[3][3] = {
+            {xAxis.x, yAxis.x, zAxis.x},
+            {xAxis.y, yAxis.y, zAxis.y},
+            {xAxis.z, yAxis.z, zAxis.z}
+        };
+        double trace = m[0][0] + m[1][1] + m[2][2];
+        glm::dquat q;
+        if (trace > std::max({m[0][0], m[1][1], m[2][2]})) {
+            double s = 2.0 * std::sqrt(1.0 + trace);
+            q = glm::dquat(0.25 * s, (m[2][1] - m[1][2]) / s, (m[0][2] - m[2][0]) / s, (m[1][0] - m[0][1]) / s);
+        } else if (m[0][0] >= m[1][1] && m[0][0] >= m[2][2]) {
+            double s = 2.0 * std::sqrt(1.0 + m[0][0] - m[1][1] - m[2][2]);
+            q = glm::dquat((m[2][1] - m[1][2]) / s, 0.25 * s, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s);
+        } else if (m[1][1] >= m[2][2]) {
+            double s = 2.0 * std::sqrt(1.0 - m[0][0] + m[1][1] - m[2][2]);
+            q = glm::dquat((m[0][2] - m[2][0]) / s, (m[0][1] + m[1][0]) / s, 0.25 * s, (m[1][2] + m[2][1]) / s);
+        } else {
+            double s = 2.0 * std::sqrt(1.0 - m[0][0] - m[1][1] + m[2][2]);
+            q = glm::dquat((m[1][0] - m[0][1]) / s, (m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, 0.25 * s);
+        }
+        return glm::normalize(q);
+    }
+    
+    // cos(angle / 2) - 1 and sin(angle / 2) / angle of a rotation vector.
+    // The series below 1e-4 rad is exact to rounding and avoids 0 / 0.
+    void halfAngle(const glm::dvec3& rotation, double& outCosMinusOne, double& outSinOverAngle) {
+        double angle2 = glm::dot(rotation, rotation);
+        if (angle2 < 1e-8) {
+            outCosMinusOne = -angle2 / 8.0 + angle2 * angle2 / 384.0;
+            outSinOverAngle = 0.5 - angle2 / 48.0 + angle2 * angle2 / 3840.0;
+            return;
+        }
+        double angle = std::sqrt(angle2);
+        double c = std::cos(0.5 * angle);
+        double s = std::sin(0.5 * angle);
+        // cos - 1 = -sin^2 / (1 + cos), without the cancellation
+        outCosMinusOne = c > 0.0 ? -s * s / (1.0 + c) : c - 1.0;
+        outSinOverAngle = s / angle;
+    }
+}
+
+glm::dquat AttitudeDynamics::exp(const glm::dvec3& rotation) {
+    double cosMinusOne, s;
+    halfAngle(rotation, cosMinusOne, s);
+    return glm::dquat(1.0 + cosMinusOne, s * rotation.x, s * rotation.y, s * rotation.z);
+}
+
+glm::dquat AttitudeDynamics::rotate(const glm::dquat& attitude, const glm::dvec3& rotation) {
+    double cosMinusOne, s;
+    halfAngle(rotation, cosMinusOne, s);
+    glm::dquat delta = attitude * glm::dquat(cosMinusOne, s * rotation.x, s * rotation.y, s * rotation.z);
+    return attitude + delta;
+}
+
+glm::dvec3 AttitudeDynamics::log(const glm::dquat& rotation) {
+    glm::dvec3 axis(rotation.x, rotation.y, rotation.z);
+    double w = rotation.w;
+    if (w < 0.0) {
+        axis = -axis;
+        w = -w;
+    }
+    double sine = glm::length(axis);
+    if (sine < 1e-12) {
+        return 2.0 * axis;
+    }
+    return axis * (2.0 * std::atan2(sine, w) / sine);
+}
+
+glm::dvec3 AttitudeDynamics::gravityGradientTorque(const RigidBody& body, const glm::dquat& attitude,
+                                                   const glm::dvec3& position, double mu) {
+    double r2 = glm::dot(position, position);
+    if (r2 <= 0.0) {
+        return glm::dvec3(0.0);
+    }
+    double r = std::sqrt(r2);
+    glm::dvec3 nadir = glm::conjugate(attitude) * (position / r);
+    return (3.0 * mu / (r2 * r)) * glm::cross(nadir, body.inertia * nadir);
+}
+
+glm::dvec3 AttitudeDynamics::holdTorque(const RigidBody& body, const glm::dquat& attitude,
+                                        const glm::dvec3& angularVelocity, const glm::dquat& target,
+                                        const glm::dvec3& targetRate) {
+    // Body attitude relative to the target, the short way round. Twice its
+    // vector part is the rotation vector for small errors and saturates
+    // smoothly at 2 for a half turn.
+    glm::dquat error = glm::conjugate(target) * attitude;
+    double sign = error.w < 0.0 ? -2.0 : 2.0;
+    glm::dvec3 angleError = sign * glm::dvec3(error.x, error.y, error.z);
+    glm::dvec3 rateError = angularVelocity - glm::conjugate(attitude) * targetRate;
+    
+    const double stiffness = HOLD_FREQUENCY * HOLD_FREQUENCY;
+    const double damping = 2.0 * HOLD_DAMPING * HOLD_FREQUENCY;
+    glm::dvec3 torque = -body.inertia * (stiffness * angleError + damping * rateError);
+    for (int axis = 0; axis < 3; ++axis) {
+        torque[axis] = std::clamp(torque[axis], -body.rcsTorque, body.rcsTorque);
+    }
+    return torque;
+}
+
+glm::dquat AttitudeDynamics::computeHoldAttitude(const glm::dvec3& pointing, const glm::dvec3& position,
+                                                 const glm::dvec3& velocity) {
+    glm::dvec3 nose = glm::length(pointing) > 1e-12 ? glm::normalize(pointing) : glm::normalize(velocity);
+    glm::dvec3 right = glm::cross(nose, position);
+    if (glm::length(right) < 1e-6 * glm::length(position)) {
+        right = glm::cross(nose, glm::cross(position, velocity));
+        if (glm::length(right) < 1e-12) {
+            right = glm::cross(nose, std::abs(nose.z) < 0.9 ? glm::dvec3(0.0, 0.0, 1.0) : glm::dvec3(1.0, 0.0, 0.0));
+        }
+    }
+    right = glm::normalize(right);
+    return fromAxes(right, nose, glm::cross(right, nose));
+}
+
+int AttitudeDynamics::advance(SpacecraftState& state, const RigidBody& body, const AttitudeSpan& span, double mu) {
+    if (span.duration <= 0.0) {
+        return 0;
+    }
+    
+    // Interpolate the target the short way round, at the rate it turns over
+    // the span
+    glm::dquat startTarget = span.startTarget;
+    glm::dquat endTarget = span.endTarget;
+    if (glm::dot(startTarget, endTarget) < 0.0) {
+        endTarget = endTarget * -1.0;
+    }
+    glm::dvec3 targetRate = log(endTarget * glm::conjugate(startTarget)) / span.duration;
+    
+    int steps = static_cast<int>(std::ceil(span.duration / STEP * (1.0 - 1e-12)));
+    steps = std::clamp(steps, 1, MAX_STEPS);
+    double h = span.duration / steps;
+    
+    if (span.hold && h > MAX_HOLD_STEP) {
+        // The hold settles in tens of seconds, far inside a span this long
+        state.attitude = endTarget;
+        state.angularVelocity = glm::conjugate(endTarget) * targetRate;
+        return 0;
+    }
+    
+    auto torque = [&](double t, const glm::dquat& attitude, const glm::dvec3& angularVelocity) {
+        double s = t / span.duration;
+        glm::dvec3 position = span.startPosition + s * (span.endPosition - span.startPosition);
+        glm::dvec3 total = gravityGradientTorque(body, attitude, position, mu);
+        if (span.hold) {
+            glm::dquat target = glm::normalize(startTarget * (1.0 - s) + endTarget * s);
+            total += holdTorque(body, attitude, angularVelocity, target, targetRate);
+        }
+        return total;
+    };
+    
+    for (int i = 0; i < steps; ++i) {
+        stepRKMK4(state.attitude, state.angularVelocity, i * h, h, body, torque);
+    }
+    return steps;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Spacecraft.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <type_traits>
+
+// Body torque (N m) at a time, attitude and body angular velocity
+template <typename F>
+concept TorqueModel = std::is_invocable_r_v<glm::dvec3, const F&, double, const glm::dquat&, const glm::dvec3&>;
+
+// One stretch of translational motion the attitude is advanced over. The
+// position and the hold attitude are interpolated linearly between its
+// start and end.
+struct AttitudeSpan {
+    double duration = 0.0;                      // seconds
+    glm::dvec3 startPosition{0.0};              // meters, inertial
+    glm::dvec3 endPosition{0.0};
+    bool hold = true;                           // RCS holds the target attitude
+    glm::dquat startTarget{1.0, 0.0, 0.0, 0.0}; // body to inertial
+    glm::dquat endTarget{1.0, 0.0, 0.0, 0.0};
+};
+
+// Rotational dynamics of the spacecraft: Euler's equations for a rigid body
+// under gravity-gradient torque and an RCS attitude hold.
+//
+// The attitude is integrated on the unit quaternions themselves with the
+// Runge-Kutta-Munthe-Kaas method of order 4. Each stage moves the attitude
+// by the exponential of a rotation vector, q * exp(theta), and every
+// exponential is a unit quaternion, so the attitude stays normalized to
+// rounding at any step size without ever being renormalized. Plain RK4 on
+// the four quaternion components shrinks the norm by O((h w)^6) per step,
+// harmless at 200 Hz but not at the stretched steps of a time warp.
+//
+// The attitude runs at its own rate: STEP (200 Hz) however long the
+// translational steps are, with the position interpolated across them.
+// Kepler jumps and warped frames get at most MAX_STEPS per span, with the
+// step stretched to cover it, so the cost per physics tick stays bounded.
+class AttitudeDynamics {
+public:
+    static constexpr double STEP = 0.005;           // seconds
+    static constexpr int MAX_STEPS = 250;           // per span
+    
+    // Attitude hold: a damped proportional-derivative law per body axis, scaled
+    // by the inertia and saturated at the RCS torque. Steps longer than
+    // MAX_HOLD_STEP would resolve nothing of it (and approach RK4's
+    // stability limit); such spans end settled on the target.
+    static constexpr double HOLD_FREQUENCY = 0.5;   // rad/s
+    static constexpr double HOLD_DAMPING = 0.9;     // damping ratio
+    static constexpr double MAX_HOLD_STEP = 1.0;    // seconds
+    
+    // Unit quaternion of a rotation vector (radians), and back. log returns
+    // the shorter of the two rotations a quaternion and its negation give.
+    static glm::dquat exp(const glm::dvec3& rotation);
+    static glm::dvec3 log(const glm::dquat& rotation);
+    
+    // attitude * exp(rotation), formed as attitude + attitude * (exp - 1).
+    // exp's scalar part rounds the same way at every step of a steady turn,
+    // which would bias the norm by up to 1e-16 per step; its difference
+    // from 1 does not round like that, so the norm only random-walks.
+    static glm::dquat rotate(const glm::dquat& attitude, const glm::dvec3& rotation);
+    
+    // One RKMK4 step of h seconds from time t. The angular velocity is in
+    // body axes, q' = q * (0, w) / 2, and torque returns body torque.
+    template <TorqueModel F>
+    static void stepRKMK4(glm::dquat& attitude, glm::dvec3& angularVelocity, double t, double h,
+                          const RigidBody& body, const F& torque);
+    
+    // Body torque of the gravity gradient at an inertial position,
+    // 3 mu / r^3 (n x I n) with n the unit nadir direction in body axes
+    static glm::dvec3 gravityGradientTorque(const RigidBody& body, const glm::dquat& attitude,
+                                            const glm::dvec3& position, double mu);
+    
+    // RCS torque holding target, which turns at targetRate (inertial rad/s)
+    static glm::dvec3 holdTorque(const RigidBody& body, const glm::dquat& attitude,
+                                 const glm::dvec3& angularVelocity, const glm::dquat& target,
+                                 const glm::dvec3& targetRate);
+    
+    // Attitude with the nose (+y) along pointing and the top (+z) as near
+    // radial out as the pointing allows; the orbit normal stands in for
+    // radial when pointing is radial
+    static glm::dquat computeHoldAttitude(const glm::dvec3& pointing, const glm::dvec3& position,
+                                          const glm::dvec3& velocity);
+    
+    // Advance the state's attitude and angular velocity over a span.
+    // Returns the steps taken, of span.duration / steps each; 0 if the hold
+    // settled the span without integrating it.
+    static int advance(SpacecraftState& state, const RigidBody& body, const AttitudeSpan& span, double mu);
+};
+
+template <TorqueModel F>
+void AttitudeDynamics::stepRKMK4(glm::dquat& attitude, glm::dvec3& angularVelocity, double t, double h,
+                                 const RigidBody& body, const F& torque) {
+    // Rotation-vector rate of rotate(q0, theta) at body rate w, the inverse
+    // of the exponential's derivative truncated after the order-4 terms
+    auto dexpInverse = [](const glm::dvec3& theta, const glm::dvec3& w) {
+        glm::dvec3 c = glm::cross(theta, w);
+        return w + 0.5 * c + (1.0 / 12.0) * glm::cross(theta, c);
+    };
+    auto acceleration = [&](double time, const glm::dquat& q, const glm::dvec3& w) {
+        return body.angularAcceleration(w, torque(time, q, w));
+    };
+    
+    const glm::dquat q0 = attitude;
+    const glm::dvec3 w0 = angularVelocity;
+    
+    glm::dvec3 k1 = w0;
+    glm::dvec3 a1 = acceleration(t, q0, w0);
+    
+    glm::dvec3 theta = 0.5 * h * k1;
+    glm::dvec3 w = w0 + 0.5 * h * a1;
+    glm::dvec3 k2 = dexpInverse(theta, w);
+    glm::dvec3 a2 = acceleration(t + 0.5 * h, rotate(q0, theta), w);
+    
+    theta = 0.5 * h * k2;
+    w = w0 + 0.5 * h * a2;
+    glm::dvec3 k3 = dexpInverse(theta, w);
+    glm::dvec3 a3 = acceleration(t + 0.5 * h, rotate(q0, theta), w);
+    
+    theta = h * k3;
+    w = w0 + h * a3;
+    glm::dvec3 k4 = dexpInverse(theta, w);
+    glm::dvec3 a4 = acceleration(t + h, rotate(q0, theta), w);
+    
+    attitude = rotate(q0, (h / 6.0) * (k1 + 2.0 * k2 + 2.0 * k3 + k4));
+    angularVelocity = w0 + (h / 6.0) * (a1 + 2.0 * a2 + 2.0 * a3 + a4);
+}
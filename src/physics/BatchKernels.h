@@ -0,0 +1,107 @@
+#pragma once
+
+// Batch RK4 kernels, written once against the simd:: wrappers and
+// instantiated in one translation unit per instruction set. Internal to
+// BatchPropagator; include Simd.h first.
+//
+// The templates live in an unnamed namespace on purpose: each ISA-specific
+// translation unit must get its own copy, otherwise the linker could fold an
+// AVX-512 instantiation into the scalar path.
+
+#include <cstddef>
+
+struct BatchView {
+    double* x;
+    double* y;
+    double* z;
+    double* vx;
+    double* vy;
+    double* vz;
+    double* lowest = nullptr;   // optional: per-lane minimum r^2, lowered at each step end
+};
+
+namespace {
+
+template <typename V>
+struct PointMassKernel {
+    V mu;
+    
+    void operator()(V x, V y, V z, V& ax, V& ay, V& az) const {
+        V r2 = x * x + y * y + z * z;
+        V r = sqrt(r2);
+        V zero = V::broadcast(0.0);
+        // Matches Gravity::pointMass, including the r^2 > 1 guard
+        V scale = select(greater(r2, V::broadcast(1.0)), zero - mu / (r2 * r), zero);
+        ax = x * scale;
+        ay = y * scale;
+        az = z * scale;
+    }
+};
+
+// Full-width blocks only; returns the first index not processed
+template <typename V, typename GravityKernel>
+size_t propagateRK4Blocks(const BatchView& b, size_t begin, size_t end,
+                          double dt, int steps, const GravityKernel& gravity) {
+    const V halfDt = V::broadcast(dt * 0.5);
+    const V fullDt = V::broadcast(dt);
+    const V sixthDt = V::broadcast(dt / 6.0);
+    const V two = V::broadcast(2.0);
+    const bool track = b.lowest != nullptr;
+    
+    size_t i = begin;
+    for (; i + V::WIDTH <= end; i += V::WIDTH) {
+        V x = V::load(b.x + i), y = V::load(b.y + i), z = V::load(b.z + i);
+        V vx = V::load(b.vx + i), vy = V::load(b.vy + i), vz = V::load(b.vz + i);
+        V lowest = track ? V::load(b.lowest + i) : V::broadcast(0.0);
+        
+        for (int step = 0; step < steps; ++step) {
+            // k1
+            V k1ax, k1ay, k1az;
+            gravity(x, y, z, k1ax, k1ay, k1az);
+            
+            // k2
+            V x2 = x + vx * halfDt, y2 = y + vy * halfDt, z2 = z + vz * halfDt;
+            V vx2 = vx + k1ax * halfDt, vy2 = vy + k1ay * halfDt, vz2 = vz + k1az * halfDt;
+            V k2ax, k2ay, k2az;
+            gravity(x2, y2, z2, k2ax, k2ay, k2az);
+            
+            // k3
+            V x3 = x + vx2 * halfDt, y3 = y + vy2 * halfDt, z3 = z + vz2 * halfDt;
+            V vx3 = vx + k2ax * halfDt, vy3 = vy + k2ay * halfDt, vz3 = vz + k2az * halfDt;
+            V k3ax, k3ay, k3az;
+            gravity(x3, y3, z3, k3ax, k3ay, k3az);
+            
+            // k4
+            V x4 = x + vx3 * fullDt, y4 = y + vy3 * fullDt, z4 = z + vz3 * fullDt;
+            V vx4 = vx + k3ax * fullDt, vy4 = vy + k3ay * fullDt, vz4 = vz + k3az * fullDt;
+            V k4ax, k4ay, k4az;
+            gravity(x4, y4, z4, k4ax, k4ay, k4az);
+            
+            // Combine
+            x = x + (vx + two * vx2 + two * vx3 + vx4) * sixthDt;
+            y = y + (vy + two * vy2 + two * vy3 + vy4) * sixthDt;
+            z = z + (vz + two * vz2 + two * vz3 + vz4) * sixthDt;
+            vx = vx + (k1ax + two * k2ax + two * k3ax + k4ax) * sixthDt;
+            vy = vy + (k1ay + two * k2ay + two * k3ay + k4ay) * sixthDt;
+            vz = vz + (k1az + two * k2az + two * k3az + k4az) * sixthDt;
+            if (track) {
+                lowest = min(lowest, x * x + y * y + z * z);
+            }
+        }
+        
+        x.store(b.x + i); y.store(b.y + i); z.store(b.z + i);
+        vx.store(b.vx + i); vy.store(b.vy + i); vz.store(b.vz + i);
+        if (track) {
+            lowest.store(b.lowest + i);
+        }
+    }
+    return i;
+}
+
+}  // namespace
+
+// Per-ISA entry points (defined only when the ISA is compiled in)
+size_t batchPropagateRK4Avx2(const BatchView& b, size_t begin, size_t end,
+                             double dt, int steps, double mu);
+size_t batchPropagateRK4Avx512(const BatchView& b, size_t begin, size_t end,
+                               double dt, int steps, double mu);
@@ -0,0 +1,136 @@
+#include "BatchOrbit.h"
+#include "Simd.h"
+#include "BatchOrbitKernels.h"
+#include "core/Constants.h"
+#include <algorithm>
+
+void ElementBatch::resize(size_t count) {
+    semiMajorAxis.resize(count);
+    eccentricity.resize(count);
+    inclination.resize(count);
+    raan.resize(count);
+    argOfPeriapsis.resize(count);
+    trueAnomaly.resize(count);
+    periapsisAltitude.resize(count);
+    apoapsisAltitude.resize(count);
+    orbitalPeriod.resize(count);
+    specificEnergy.resize(count);
+    angularMomentum.resize(count);
+}
+
+void ElementBatch::set(size_t index, const OrbitalElements& elements) {
+    semiMajorAxis[index] = elements.semiMajorAxis;
+    eccentricity[index] = elements.eccentricity;
+    inclination[index] = elements.inclination;
+    raan[index] = elements.raan;
+    argOfPeriapsis[index] = elements.argOfPeriapsis;
+    trueAnomaly[index] = elements.trueAnomaly;
+    periapsisAltitude[index] = elements.periapsisAltitude;
+    apoapsisAltitude[index] = elements.apoapsisAltitude;
+    orbitalPeriod[index] = elements.orbitalPeriod;
+    specificEnergy[index] = elements.specificEnergy;
+    angularMomentum[index] = elements.angularMomentum;
+}
+
+OrbitalElements ElementBatch::get(size_t index) const {
+    OrbitalElements elements;
+    elements.semiMajorAxis = semiMajorAxis[index];
+    elements.eccentricity = eccentricity[index];
+    elements.inclination = inclination[index];
+    elements.raan = raan[index];
+    elements.argOfPeriapsis = argOfPeriapsis[index];
+    elements.trueAnomaly = trueAnomaly[index];
+    elements.periapsisAltitude = periapsisAltitude[index];
+    elements.apoapsisAltitude = apoapsisAltitude[index];
+    elements.orbitalPeriod = orbitalPeriod[index];
+    elements.specificEnergy = specificEnergy[index];
+    elements.angularMomentum = angularMomentum[index];
+    return elements;
+}
+
+void BatchOrbit::computeElements(const StateBatch& states, double mu, ElementBatch& out,
+                                 size_t begin, size_t end, SimdLevel level) {
+    end = std::min(end, states.size());
+    if (begin >= end) {
+        return;
+    }
+    if (out.size() < states.size()) {
+        out.resize(states.size());
+    }
+    
+    StateView in{states.x.data(), states.y.data(), states.z.data(),
+                 states.vx.data(), states.vy.data(), states.vz.data()};
+    ElementOutView view{out.semiMajorAxis.data(), out.eccentricity.data(), out.inclination.data(),
+                        out.raan.data(), out.argOfPeriapsis.data(), out.trueAnomaly.data(),
+                        out.periapsisAltitude.data(), out.apoapsisAltitude.data(),
+                        out.orbitalPeriod.data(), out.specificEnergy.data(), out.angularMomentum.data()};
+    
+    if (!BatchPropagator::isSupported(level)) {
+        level = SimdLevel::Scalar;
+    }
+    
+    size_t next = begin;
+    switch (level) {
+#if defined(ARTEMIS_HAVE_AVX512_KERNELS)
+        case SimdLevel::AVX512:
+            next = batchComputeElementsAvx512(in, view, begin, end, mu, Constants::MOON_RADIUS);
+            break;
+#endif
+#if defined(ARTEMIS_HAVE_AVX2_KERNELS)
+        case SimdLevel::AVX2:
+            next = batchComputeElementsAvx2(in, view, begin, end, mu, Constants::MOON_RADIUS);
+            break;
+#endif
+        default:
+            break;
+    }
+    
+    // Remaining lanes (or everything, without SIMD support)
+    computeElementBlocks<simd::Scalar>(in, view, next, end, mu, Constants::MOON_RADIUS);
+}
+
+void BatchOrbit::computeElements(const StateBatch& states, double mu, ElementBatch& out) {
+    computeElements(states, mu, out, 0, states.size(), BatchPropagator::getBestSimdLevel());
+}
+
+void BatchOrbit::computeStates(const ElementBatch& elements, double mu, StateBatch& out,
+                               size_t begin, size_t end, SimdLevel level) {
+    end = std::min(end, elements.size());
+    if (begin >= end) {
+        return;
+    }
+    if (out.size() < elements.size()) {
+        out.resize(elements.size());
+    }
+    
+    ElementView in{elements.semiMajorAxis.data(), elements.eccentricity.data(), elements.inclination.data(),
+                   elements.raan.data(), elements.argOfPeriapsis.data(), elements.trueAnomaly.data()};
+    StateOutView view{out.x.data(), out.y.data(), out.z.data(),
+                      out.vx.data(), out.vy.data(), out.vz.data()};
+    
+    if (!BatchPropagator::isSupported(level)) {
+        level = SimdLevel::Scalar;
+    }
+    
+    size_t next = begin;
+    switch (level) {
+#if defined(ARTEMIS_HAVE_AVX512_KERNELS)
+        case SimdLevel::AVX512:
+            next = batchComputeStatesAvx512(in, view, begin, end, mu);
+            break;
+#endif
+#if defined(ARTEMIS_HAVE_AVX2_KERNELS)
+        case SimdLevel::AVX2:
+            next = batchComputeStatesAvx2(in, view, begin, end, mu);
+            break;
+#endif
+        default:
+            break;
+    }
+    
+    computeStateBlocks<simd::Scalar>(in, view, next, end, mu);
+}
+
+void BatchOrbit::computeStates(const ElementBatch& elements, double mu, StateBatch& out) {
+    computeStates(elements, mu, out, 0, elements.size(), BatchPropagator::getBestSimdLevel());
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "BatchPropagator.h"
+#include "Orbit.h"
+#include <cstddef>
+#include <vector>
+
+// Structure-of-arrays orbital elements, one lane per state; the fields of
+// OrbitalElements with the same units and conventions
+struct ElementBatch {
+    std::vector<double> semiMajorAxis;       // meters
+    std::vector<double> eccentricity;
+    std::vector<double> inclination;         // radians
+    std::vector<double> raan;                // radians
+    std::vector<double> argOfPeriapsis;      // radians
+    std::vector<double> trueAnomaly;         // radians
+    std::vector<double> periapsisAltitude;   // meters
+    std::vector<double> apoapsisAltitude;    // meters
+    std::vector<double> orbitalPeriod;       // seconds
+    std::vector<double> specificEnergy;      // J/kg
+    std::vector<double> angularMomentum;     // m²/s
+    
+    size_t size() const { return semiMajorAxis.size(); }
+    void resize(size_t count);
+    void set(size_t index, const OrbitalElements& elements);
+    OrbitalElements get(size_t index) const;
+};
+
+// Converts many states to orbital elements and back with vectorized
+// kernels, for post-processing dispersions and constellation sweeps.
+//
+// Same formulas and degenerate-case conventions as Orbit::computeElements
+// and Orbit::computeStateFromElements, evaluated branch-free: every lane
+// computes the circular, equatorial and open-orbit variants and selects
+// per lane. Angles come from atan2 of unnormalized components rather than
+// clamped acos, which stays accurate near 0 and pi where acos loses half
+// its digits, and atan2, sin and cos are polynomial approximations shared
+// by all instruction sets (within 4.5e-16 of the libm results on their own
+// ranges). Dispatch follows BatchPropagator: the widest instruction set
+// compiled in and supported, scalar for the leftover lanes.
+class BatchOrbit {
+public:
+    using SimdLevel = BatchPropagator::SimdLevel;
+    
+    // Elements of states [begin, end); out is resized to the batch if smaller
+    static void computeElements(const StateBatch& states, double mu, ElementBatch& out,
+                                size_t begin, size_t end, SimdLevel level);
+    static void computeElements(const StateBatch& states, double mu, ElementBatch& out);
+    
+    // States of elements [begin, end), reading only the six classical
+    // elements; out is resized to the batch if smaller. Angles are accurate
+    // for magnitudes up to 1e6 rad.
+    static void computeStates(const ElementBatch& elements, double mu, StateBatch& out,
+                              size_t begin, size_t end, SimdLevel level);
+    static void computeStates(const ElementBatch& elements, double mu, StateBatch& out);
+};
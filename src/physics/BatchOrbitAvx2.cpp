@@ -0,0 +1,17 @@
+// Compiled with AVX2 flags (see CMakeLists.txt); only reached after a
+// runtime CPU check in BatchOrbit.cpp.
+
+#include "Simd.h"
+#include "BatchOrbitKernels.h"
+
+#if defined(__AVX2__)
+size_t batchComputeElementsAvx2(const StateView& in, const ElementOutView& out, size_t begin, size_t end,
+                                double mu, double bodyRadius) {
+    return computeElementBlocks<simd::Avx2>(in, out, begin, end, mu, bodyRadius);
+}
+
+size_t batchComputeStatesAvx2(const ElementView& in, const StateOutView& out, size_t begin, size_t end,
+                              double mu) {
+    return computeStateBlocks<simd::Avx2>(in, out, begin, end, mu);
+}
+#endif
@@ -0,0 +1,325 @@
+#pragma once
+
+// Batch element conversion kernels, written once against the simd::
+// wrappers and instantiated in one translation unit per instruction set.
+// Internal to BatchOrbit; include Simd.h first. Unnamed namespace for the
+// same reason as BatchKernels.h.
+
+#include <cstddef>
+#include <limits>
+
+struct StateView {
+    const double* x;
+    const double* y;
+    const double* z;
+    const double* vx;
+    const double* vy;
+    const double* vz;
+};
+
+struct StateOutView {
+    double* x;
+    double* y;
+    double* z;
+    double* vx;
+    double* vy;
+    double* vz;
+};
+
+struct ElementView {
+    const double* semiMajorAxis;
+    const double* eccentricity;
+    const double* inclination;
+    const double* raan;
+    const double* argOfPeriapsis;
+    const double* trueAnomaly;
+};
+
+struct ElementOutView {
+    double* semiMajorAxis;
+    double* eccentricity;
+    double* inclination;
+    double* raan;
+    double* argOfPeriapsis;
+    double* trueAnomaly;
+    double* periapsisAltitude;
+    double* apoapsisAltitude;
+    double* orbitalPeriod;
+    double* specificEnergy;
+    double* angularMomentum;
+};
+
+namespace {
+
+namespace batchmath {
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double PI_2 = 1.57079632679489661923;
+    constexpr double PI_4 = 0.78539816339744830962;
+    // pi/2 - PI_2 and pi/4 - PI_4, to restore the bits lost in rounding
+    constexpr double PI_2_LO = 6.123233995736766036e-17;
+    constexpr double PI_4_LO = 3.061616997868383018e-17;
+    constexpr double TAN_PI_8 = 0.41421356237309504880;
+    constexpr double TWO_OVER_PI = 0.63661977236758134308;
+    
+    // pi/2 in three parts (fdlibm); the first has 33 significant bits, so
+    // k * PIO2_1 is exact for |k| < 2^20
+    constexpr double PIO2_1 = 1.57079632673412561417e+00;
+    constexpr double PIO2_2 = 6.07710050630396597660e-11;
+    constexpr double PIO2_3 = 2.02226624871116645580e-21;
+}
+
+template <typename V>
+V abs(V a) {
+    return max(a, V::broadcast(0.0) - a);
+}
+
+// Angle of (x, y) in (-pi, pi]. Reduced to an octant, then to
+// |u| <= tan(pi/8) around 0 or pi/4, where a rational minimax fit
+// (Cephes atan) gives atan(u) to about 1e-16 relative.
+template <typename V>
+V atan2(V y, V x) {
+    using namespace batchmath;
+    const V zero = V::broadcast(0.0);
+    const V one = V::broadcast(1.0);
+    
+    V ax = abs(x), ay = abs(y);
+    V big = max(ax, ay), small = min(ax, ay);
+    
+    // u = t or (t - 1) / (t + 1) for t = small / big, with one division
+    auto upper = greater(small, big * V::broadcast(TAN_PI_8));
+    V numerator = select(upper, small - big, small);
+    V denominator = select(upper, small + big, select(greater(big, zero), big, one));
+    V u = numerator / denominator;
+    V base = select(upper, V::broadcast(PI_4), zero);
+    V baseLo = select(upper, V::broadcast(PI_4_LO), zero);
+    
+    V z = u * u;
+    V p = V::broadcast(-8.750608600031904122785e-1);
+    p = p * z + V::broadcast(-1.615753718733365076637e1);
+    p = p * z + V::broadcast(-7.500855792314704667340e1);
+    p = p * z + V::broadcast(-1.228866684490136173410e2);
+    p = p * z + V::broadcast(-6.485021904942025371773e1);
+    V q = z + V::broadcast(2.485846490142306297962e1);
+    q = q * z + V::broadcast(1.650270098316988542046e2);
+    q = q * z + V::broadcast(4.328810604912902668951e2);
+    q = q * z + V::broadcast(4.853903996359136964868e2);
+    q = q * z + V::broadcast(1.945506571482613964425e2);
+    V angle = base + (u + (u * z * p / q + baseLo));
+    
+    // Undo the octant: swap, then the quadrant, then the sign of y
+    angle = select(greater(ay, ax), V::broadcast(PI_2) - angle + V::broadcast(PI_2_LO), angle);
+    angle = select(greater(zero, x), V::broadcast(PI) - angle + V::broadcast(2.0 * PI_2_LO), angle);
+    return select(greater(zero, y), zero - angle, angle);
+}
+
+// Angle of (x, y) in [0, 2 pi), the range of the scalar conversions
+template <typename V>
+V angle2Pi(V y, V x) {
+    V angle = atan2(y, x);
+    V zero = V::broadcast(0.0);
+    return select(greater(zero, angle), angle + V::broadcast(2.0 * batchmath::PI), angle);
+}
+
+// sin and cos together. Reduced by the nearest multiple k of pi/2 in three
+// parts (Cody-Waite), so |r| <= pi/4, then Cephes' minimax polynomials;
+// the quadrant k mod 4 swaps and negates the pair.
+template <typename V>
+void sincos(V x, V& outSin, V& outCos) {
+    using namespace batchmath;
+    const V zero = V::broadcast(0.0);
+    const V half = V::broadcast(0.5);
+    const V one = V::broadcast(1.0);
+    
+    V k = floor(x * V::broadcast(TWO_OVER_PI) + half);
+    V r = ((x - k * V::broadcast(PIO2_1)) - k * V::broadcast(PIO2_2)) - k * V::broadcast(PIO2_3);
+    V z = r * r;
+    
+    V ps = V::broadcast(1.58962301576546568060e-10);
+    ps = ps * z + V::broadcast(-2.50507477628578072866e-8);
+    ps = ps * z + V::broadcast(2.75573136213857245213e-6);
+    ps = ps * z + V::broadcast(-1.98412698295895385996e-4);
+    ps = ps * z + V::broadcast(8.33333333332211858878e-3);
+    ps = ps * z + V::broadcast(-1.66666666666666307295e-1);
+    V s = r + r * z * ps;
+    
+    V pc = V::broadcast(-1.13585365213876817300e-11);
+    pc = pc * z + V::broadcast(2.08757008419747316778e-9);
+    pc = pc * z + V::broadcast(-2.75573141792967388112e-7);
+    pc = pc * z + V::broadcast(2.48015872888517045348e-5);
+    pc = pc * z + V::broadcast(-1.38888888888730564116e-3);
+    pc = pc * z + V::broadcast(4.16666666666665929218e-2);
+    V c = one - half * z + z * z * pc;
+    
+    // Quadrant 0..3 and its neighbour, as exact small doubles
+    const V quarter = V::broadcast(0.25);
+    const V four = V::broadcast(4.0);
+    V quadrant = k - four * floor(k * quarter);
+    V next = quadrant + one;
+    next = next - four * floor(next * quarter);
+    V odd = quadrant - V::broadcast(2.0) * floor(quadrant * half);
+    
+    auto swap = greater(odd, half);
+    V sinValue = select(swap, c, s);
+    V cosValue = select(swap, s, c);
+    const V oneHalf = V::broadcast(1.5);
+    outSin = select(greater(quadrant, oneHalf), zero - sinValue, sinValue);
+    outCos = select(greater(next, oneHalf), zero - cosValue, cosValue);
+}
+
+// Orbit::computeElements per lane. Full-width blocks only; returns the
+// first index not processed.
+template <typename V>
+size_t computeElementBlocks(const StateView& in, const ElementOutView& out, size_t begin, size_t end,
+                            double muValue, double bodyRadius) {
+    const V zero = V::broadcast(0.0);
+    const V one = V::broadcast(1.0);
+    const V tiny = V::broadcast(1e-10);
+    const V infinity = V::broadcast(std::numeric_limits<double>::infinity());
+    const V mu = V::broadcast(muValue);
+    const V inverseMu = V::broadcast(1.0 / muValue);
+    const V radius = V::broadcast(bodyRadius);
+    const V twoPi = V::broadcast(2.0 * batchmath::PI);
+    
+    size_t i = begin;
+    for (; i + V::WIDTH <= end; i += V::WIDTH) {
+        V x = V::load(in.x + i), y = V::load(in.y + i), z = V::load(in.z + i);
+        V vx = V::load(in.vx + i), vy = V::load(in.vy + i), vz = V::load(in.vz + i);
+        
+        V r = sqrt(x * x + y * y + z * z);
+        V v2 = vx * vx + vy * vy + vz * vz;
+        V potential = mu / r;
+        V energy = v2 * V::broadcast(0.5) - potential;
+        
+        // Angular momentum h = r x v, and the node vector n = k x h =
+        // (-hy, hx, 0)
+        V hx = y * vz - z * vy;
+        V hy = z * vx - x * vz;
+        V hz = x * vy - y * vx;
+        V nSquared = hx * hx + hy * hy;
+        V nMag = sqrt(nSquared);
+        V h = sqrt(nSquared + hz * hz);
+        
+        // Eccentricity vector
+        V rv = x * vx + y * vy + z * vz;
+        V scale = v2 - potential;
+        V ex = (scale * x - rv * vx) * inverseMu;
+        V ey = (scale * y - rv * vy) * inverseMu;
+        V ez = (scale * z - rv * vz) * inverseMu;
+        V e = sqrt(ex * ex + ey * ey + ez * ez);
+        
+        // Semi-major axis, infinite for a parabola
+        V a = select(greater(abs(e - one), tiny), zero - mu / (energy + energy), infinity);
+        
+        auto hasPlane = greater(h, tiny);
+        auto hasNode = greater(nMag, tiny);
+        auto hasPeriapsis = greater(e, tiny);
+        
+        // Each angle is one atan2 whose arguments are picked per lane, so a
+        // degenerate case costs selects rather than a branch or a second
+        // evaluation; (0, 1) gives the scalar path's 0
+        V inclination = atan2(select(hasPlane, nMag, zero), select(hasPlane, hz, one));
+        V raan = angle2Pi(select(hasNode, hx, zero), select(hasNode, zero - hy, one));
+        
+        // Argument of periapsis from the node, signed by e.z
+        // (sin w = e.z |h| / (e |n|)); on an equatorial orbit the longitude
+        // of periapsis, in the direction of motion (cos i = hz / |h|)
+        V eDotN = hx * ey - hy * ex;
+        V periapsisY = select(hasNode, ez * h, ey * hz);
+        V periapsisX = select(hasNode, eDotN, ex * h);
+        V argOfPeriapsis = angle2Pi(select(hasPeriapsis, periapsisY, zero),
+                                    select(hasPeriapsis, periapsisX, one));
+        
+        // True anomaly from the periapsis, signed by r.v
+        // ((e x r) . h = e r |h| sin nu). On a circle the argument of
+        // latitude from the node, signed by z, or the true longitude if
+        // also equatorial.
+        V exrDotH = hx * (ey * z - ez * y) + hy * (ez * x - ex * z) + hz * (ex * y - ey * x);
+        V eDotR = ex * x + ey * y + ez * z;
+        V nDotR = hx * y - hy * x;
+        V circleY = select(hasNode, z * h, y * hz);
+        V circleX = select(hasNode, nDotR, x * h);
+        V trueAnomaly = angle2Pi(select(hasPeriapsis, exrDotH, circleY),
+                                 select(hasPeriapsis, eDotR * h, circleX));
+        
+        // Apsides and period: closed orbits, open orbits (e >= 1), or
+        // neither (a degenerate non-positive a with e < 1)
+        V periapsis = a * (one - e) - radius;
+        V apoapsis = a * (one + e) - radius;
+        V period = twoPi * sqrt(a * a * a * inverseMu);
+        auto closed = greater(one, e);
+        auto elliptic = greater(a, zero);
+        V periapsisAltitude = select(closed, select(elliptic, periapsis, zero), periapsis);
+        V apoapsisAltitude = select(closed, select(elliptic, apoapsis, zero), infinity);
+        V orbitalPeriod = select(closed, select(elliptic, period, zero), infinity);
+        
+        a.store(out.semiMajorAxis + i);
+        e.store(out.eccentricity + i);
+        inclination.store(out.inclination + i);
+        raan.store(out.raan + i);
+        argOfPeriapsis.store(out.argOfPeriapsis + i);
+        trueAnomaly.store(out.trueAnomaly + i);
+        periapsisAltitude.store(out.periapsisAltitude + i);
+        apoapsisAltitude.store(out.apoapsisAltitude + i);
+        orbitalPeriod.store(out.orbitalPeriod + i);
+        energy.store(out.specificEnergy + i);
+        h.store(out.angularMomentum + i);
+    }
+    return i;
+}
+
+// Orbit::computeStateFromElements per lane; conics of every kind share the
+// perifocal formulas. Full-width blocks only.
+template <typename V>
+size_t computeStateBlocks(const ElementView& in, const StateOutView& out, size_t begin, size_t end,
+                          double muValue) {
+    const V one = V::broadcast(1.0);
+    const V zero = V::broadcast(0.0);
+    const V mu = V::broadcast(muValue);
+    
+    size_t i = begin;
+    for (; i + V::WIDTH <= end; i += V::WIDTH) {
+        V a = V::load(in.semiMajorAxis + i);
+        V e = V::load(in.eccentricity + i);
+        
+        V sinNu, cosNu, sinOmega, cosOmega, sinW, cosW, sinI, cosI;
+        sincos(V::load(in.trueAnomaly + i), sinNu, cosNu);
+        sincos(V::load(in.raan + i), sinOmega, cosOmega);
+        sincos(V::load(in.argOfPeriapsis + i), sinW, cosW);
+        sincos(V::load(in.inclination + i), sinI, cosI);
+        
+        // Perifocal position and velocity
+        V p = a * (one - e * e);
+        V r = p / (one + e * cosNu);
+        V rP = r * cosNu, rQ = r * sinNu;
+        V speed = mu / sqrt(mu * p);
+        V vP = (zero - sinNu) * speed, vQ = (e + cosNu) * speed;
+        
+        // Columns P and Q of the perifocal-to-inertial rotation
+        V px = cosOmega * cosW - sinOmega * sinW * cosI;
+        V py = sinOmega * cosW + cosOmega * sinW * cosI;
+        V pz = sinW * sinI;
+        V qx = zero - cosOmega * sinW - sinOmega * cosW * cosI;
+        V qy = zero - sinOmega * sinW + cosOmega * cosW * cosI;
+        V qz = cosW * sinI;
+        
+        (px * rP + qx * rQ).store(out.x + i);
+        (py * rP + qy * rQ).store(out.y + i);
+        (pz * rP + qz * rQ).store(out.z + i);
+        (px * vP + qx * vQ).store(out.vx + i);
+        (py * vP + qy * vQ).store(out.vy + i);
+        (pz * vP + qz * vQ).store(out.vz + i);
+    }
+    return i;
+}
+
+}  // namespace
+
+// Per-ISA entry points (defined only when the ISA is compiled in)
+size_t batchComputeElementsAvx2(const StateView& in, const ElementOutView& out, size_t begin, size_t end,
+                                double mu, double bodyRadius);
+size_t batchComputeStatesAvx2(const ElementView& in, const StateOutView& out, size_t begin, size_t end,
+                              double mu);
+size_t batchComputeElementsAvx512(const StateView& in, const ElementOutView& out, size_t begin, size_t end,
+                                  double mu, double bodyRadius);
+size_t batchComputeStatesAvx512(const ElementView& in, const StateOutView& out, size_t begin, size_t end,
+                                double mu);
@@ -0,0 +1,104 @@
+#include "BatchPropagator.h"
+#include "Simd.h"
+#include "BatchKernels.h"
+#include <algorithm>
+
+void StateBatch::resize(size_t count) {
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    vz.resize(count);
+}
+
+void StateBatch::set(size_t index, const glm::dvec3& position, const glm::dvec3& velocity) {
+    x[index] = position.x;
+    y[index] = position.y;
+    z[index] = position.z;
+    vx[index] = velocity.x;
+    vy[index] = velocity.y;
+    vz[index] = velocity.z;
+}
+
+bool BatchPropagator::isSupported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2:
+#if defined(ARTEMIS_HAVE_AVX2_KERNELS) && defined(__GNUC__)
+            return __builtin_cpu_supports("avx2");
+#elif defined(ARTEMIS_HAVE_AVX2_KERNELS) && defined(__AVX2__)
+            return true;
+#else
+            return false;
+#endif
+        case SimdLevel::AVX512:
+#if defined(ARTEMIS_HAVE_AVX512_KERNELS) && defined(__GNUC__)
+            return __builtin_cpu_supports("avx512f");
+#elif defined(ARTEMIS_HAVE_AVX512_KERNELS) && defined(__AVX512F__)
+            return true;
+#else
+            return false;
+#endif
+        case SimdLevel::Scalar:
+        default:
+            return true;
+    }
+}
+
+BatchPropagator::SimdLevel BatchPropagator::getBestSimdLevel() {
+    static const SimdLevel best = []() {
+        if (isSupported(SimdLevel::AVX512)) return SimdLevel::AVX512;
+        if (isSupported(SimdLevel::AVX2)) return SimdLevel::AVX2;
+        return SimdLevel::Scalar;
+    }();
+    return best;
+}
+
+const char* BatchPropagator::getSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+        case SimdLevel::Scalar:
+        default: return "scalar";
+    }
+}
+
+void BatchPropagator::propagateRK4(StateBatch& batch, double dt, int steps, double mu,
+                                   size_t begin, size_t end, SimdLevel level,
+                                   double* lowestRadiusSquared) {
+    end = std::min(end, batch.size());
+    if (begin >= end || steps <= 0) {
+        return;
+    }
+    
+    BatchView view{batch.x.data(), batch.y.data(), batch.z.data(),
+                   batch.vx.data(), batch.vy.data(), batch.vz.data(), lowestRadiusSquared};
+    
+    if (!isSupported(level)) {
+        level = SimdLevel::Scalar;
+    }
+    
+    size_t next = begin;
+    switch (level) {
+#if defined(ARTEMIS_HAVE_AVX512_KERNELS)
+        case SimdLevel::AVX512:
+            next = batchPropagateRK4Avx512(view, begin, end, dt, steps, mu);
+            break;
+#endif
+#if defined(ARTEMIS_HAVE_AVX2_KERNELS)
+        case SimdLevel::AVX2:
+            next = batchPropagateRK4Avx2(view, begin, end, dt, steps, mu);
+            break;
+#endif
+        default:
+            break;
+    }
+    
+    // Remaining lanes (or everything, without SIMD support)
+    PointMassKernel<simd::Scalar> gravity{simd::Scalar::broadcast(mu)};
+    propagateRK4Blocks<simd::Scalar>(view, next, end, dt, steps, gravity);
+}
+
+void BatchPropagator::propagateRK4(StateBatch& batch, double dt, int steps, double mu) {
+    propagateRK4(batch, dt, steps, mu, 0, batch.size(), getBestSimdLevel());
+}
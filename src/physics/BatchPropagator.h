@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// Structure-of-arrays translational states, one lane per spacecraft.
+// Only position and velocity are stored; attitude and mass are not needed
+// for coast propagation and would only dilute the cache lines.
+struct StateBatch {
+    std::vector<double> x, y, z;        // meters
+    std::vector<double> vx, vy, vz;     // m/s
+    
+    size_t size() const { return x.size(); }
+    void resize(size_t count);
+    
+    void set(size_t index, const glm::dvec3& position, const glm::dvec3& velocity);
+    glm::dvec3 getPosition(size_t index) const { return {x[index], y[index], z[index]}; }
+    glm::dvec3 getVelocity(size_t index) const { return {vx[index], vy[index], vz[index]}; }
+};
+
+// Propagates many states through the same coast with vectorized kernels.
+// The RK4 arithmetic matches Integrator::stepRK4 with PointMassForceModel
+// operation for operation, so every instruction set gives the same result.
+class BatchPropagator {
+public:
+    enum class SimdLevel {
+        Scalar,
+        AVX2,
+        AVX512
+    };
+    
+    // Widest instruction set both compiled in and supported by this CPU
+    static SimdLevel getBestSimdLevel();
+    static bool isSupported(SimdLevel level);
+    static const char* getSimdLevelName(SimdLevel level);
+    
+    // Advance states [begin, end) by steps RK4 steps of dt under point-mass
+    // gravity. Each block of lanes stays in registers for all steps. If
+    // lowestRadiusSquared is given, its entry for each lane is lowered to
+    // the smallest r^2 the lane reaches at a step end.
+    static void propagateRK4(StateBatch& batch, double dt, int steps, double mu,
+                             size_t begin, size_t end, SimdLevel level,
+                             double* lowestRadiusSquared = nullptr);
+    static void propagateRK4(StateBatch& batch, double dt, int steps, double mu);
+};
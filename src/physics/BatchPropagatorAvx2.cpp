@@ -0,0 +1,13 @@
+// Compiled with AVX2 flags (see CMakeLists.txt); only reached after a
+// runtime CPU check in BatchPropagator.cpp.
+
+#include "Simd.h"
+#include "BatchKernels.h"
+
+#if defined(__AVX2__)
+size_t batchPropagateRK4Avx2(const BatchView& b, size_t begin, size_t end,
+                             double dt, int steps, double mu) {
+    PointMassKernel<simd::Avx2> gravity{simd::Avx2::broadcast(mu)};
+    return propagateRK4Blocks<simd::Avx2>(b, begin, end, dt, steps, gravity);
+}
+#endif
@@ -0,0 +1,13 @@
+// Compiled with AVX-512F flags (see CMakeLists.txt); only reached after a
+// runtime CPU check in BatchPropagator.cpp.
+
+#include "Simd.h"
+#include "BatchKernels.h"
+
+#if defined(__AVX512F__)
+size_t batchPropagateRK4Avx512(const BatchView& b, size_t begin, size_t end,
+                               double dt, int steps, double mu) {
+    PointMassKernel<simd::Avx512> gravity{simd::Avx512::broadcast(mu)};
+    return propagateRK4Blocks<simd::Avx512>(b, begin, end, dt, steps, gravity);
+}
+#endif
@@ -0,0 +1,120 @@
+#include "CR3BP.h"
+#include "Gravity.h"
+#include <cmath>
+
+namespace {
+    // Barycenter relative to the Moon, in the rotating frame
+    constexpr double BARYCENTER_X = -(1.0 - CR3BP::MASS_RATIO) * CR3BP::DISTANCE;
+    
+    glm::dvec3 rotateZ(const glm::dvec3& v, double cosAngle, double sinAngle) {
+        return glm::dvec3(cosAngle * v.x - sinAngle * v.y,
+                          sinAngle * v.x + cosAngle * v.y,
+                          v.z);
+    }
+}
+
+double CR3BP::getMeanMotion() {
+    static const double meanMotion =
+        std::sqrt((Constants::EARTH_MU + Constants::MOON_MU) / (DISTANCE * DISTANCE * DISTANCE));
+    return meanMotion;
+}
+
+glm::dvec3 CR3BP::earthPosition(double time) {
+    double angle = getMeanMotion() * time;
+    return -DISTANCE * glm::dvec3(std::cos(angle), std::sin(angle), 0.0);
+}
+
+void CR3BP::inertialToRotating(const glm::dvec3& position, const glm::dvec3& velocity, double time,
+                               glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+    double n = getMeanMotion();
+    double angle = n * time;
+    glm::dvec3 r = rotateZ(position, std::cos(angle), -std::sin(angle));
+    glm::dvec3 v = rotateZ(velocity, std::cos(angle), -std::sin(angle));
+    
+    // Remove the frame's rotation: v_rot = v_in - omega x r
+    outPosition = r;
+    outVelocity = v - n * glm::dvec3(-r.y, r.x, 0.0);
+}
+
+void CR3BP::rotatingToInertial(const glm::dvec3& position, const glm::dvec3& velocity, double time,
+                               glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+    double n = getMeanMotion();
+    double angle = n * time;
+    glm::dvec3 v = velocity + n * glm::dvec3(-position.y, position.x, 0.0);
+    outPosition = rotateZ(position, std::cos(angle), std::sin(angle));
+    outVelocity = rotateZ(v, std::cos(angle), std::sin(angle));
+}
+
+void CR3BP::normalizedToRotating(const glm::dvec3& position, const glm::dvec3& velocity,
+                                 glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+    outPosition = (position - glm::dvec3(1.0 - MASS_RATIO, 0.0, 0.0)) * DISTANCE;
+    outVelocity = velocity * (DISTANCE * getMeanMotion());
+}
+
+void CR3BP::rotatingToNormalized(const glm::dvec3& position, const glm::dvec3& velocity,
+                                 glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+    outPosition = position / DISTANCE + glm::dvec3(1.0 - MASS_RATIO, 0.0, 0.0);
+    outVelocity = velocity / (DISTANCE * getMeanMotion());
+}
+
+double CR3BP::jacobiConstant(const glm::dvec3& position, const glm::dvec3& velocity) {
+    glm::dvec3 r, v;
+    rotatingToNormalized(position, velocity, r, v);
+    
+    double toEarth = glm::length(r - glm::dvec3(-MASS_RATIO, 0.0, 0.0));
+    double toMoon = glm::length(r - glm::dvec3(1.0 - MASS_RATIO, 0.0, 0.0));
+    return r.x * r.x + r.y * r.y + 2.0 * (1.0 - MASS_RATIO) / toEarth + 2.0 * MASS_RATIO / toMoon
+         - glm::dot(v, v);
+}
+
+SpacecraftState CR3BP::propagate(const SpacecraftState& state, double time, double duration,
+                                 const AdaptiveOptions& options, DenseTrajectory* outTrajectory,
+                                 AdaptiveStats* outStats, double bodyRadius) {
+    // The end time comes from the dense output, so always record one
+    DenseTrajectory local;
+    DenseTrajectory& path = outTrajectory ? *outTrajectory : local;
+    
+    SpacecraftState rotating = state;
+    inertialToRotating(state.position, state.velocity, time, rotating.position, rotating.velocity);
+    
+    SpacecraftState next = Integrator::propagateBulirschStoer(rotating, duration, CR3BPForceModel(), options,
+                                                              &path, outStats, bodyRadius);
+    
+    SpacecraftState result = state;
+    double elapsed = path.isEmpty() ? 0.0 : path.getEndTime();
+    rotatingToInertial(next.position, next.velocity, time + elapsed, result.position, result.velocity);
+    return result;
+}
+
+std::vector<glm::dvec3> CR3BP::resampleInertial(const DenseTrajectory& rotating, double startTime,
+                                                int count) {
+    std::vector<glm::dvec3> positions = rotating.resamplePositions(count);
+    double n = getMeanMotion();
+    double span = rotating.getEndTime() - rotating.getStartTime();
+    for (size_t i = 0; i < positions.size(); ++i) {
+        double t = (count > 1) ? rotating.getStartTime() + span * i / (count - 1) : rotating.getStartTime();
+        double angle = n * (startTime + t);
+        positions[i] = rotateZ(positions[i], std::cos(angle), std::sin(angle));
+    }
+    return positions;
+}
+
+CR3BPForceModel::CR3BPForceModel() : m_meanMotion(CR3BP::getMeanMotion()) {}
+
+void CR3BPForceModel::operator()(const SpacecraftState& state, glm::dvec3& outAccel,
+                                 glm::dvec3& outVelDeriv) const {
+    outVelDeriv = state.velocity;
+    const glm::dvec3& p = state.position;
+    const glm::dvec3& v = state.velocity;
+    
+    glm::dvec3 toEarth = p + glm::dvec3(CR3BP::DISTANCE, 0.0, 0.0);
+    
+    double n2 = m_meanMotion * m_meanMotion;
+    outAccel = Gravity::pointMass(p, Constants::MOON_MU)
+               + Gravity::pointMass(toEarth, Constants::EARTH_MU)
+               // Coriolis: -2 omega x v
+               + 2.0 * m_meanMotion * glm::dvec3(v.y, -v.x, 0.0)
+               // Centrifugal about the barycenter: -omega x (omega x (p - b))
+               + n2 * glm::dvec3(p.x - BARYCENTER_X, p.y, 0.0)
+               + thrustAccel;
+}
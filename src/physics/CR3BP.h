@@ -0,0 +1,77 @@
+#pragma once
+
+#include "DenseTrajectory.h"
+#include "Integrator.h"
+#include "Spacecraft.h"
+#include "core/Constants.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+// Circular restricted three-body problem of the Earth and the Moon: both
+// move on circles about their barycenter and the spacecraft does not
+// disturb them. Near-rectilinear halo orbits and the other libration point
+// orbits only exist in this model (or in a full ephemeris).
+//
+// Three frames are used:
+// - Inertial: the simulation's Moon-centered frame. The Earth-Moon plane is
+//   its XY plane, and at time zero the Earth lies on its -X axis.
+// - Rotating: Moon-centered, turning with the Earth-Moon line (Earth fixed
+//   on -X), in meters and seconds. The equations of motion are autonomous
+//   here, which is where they are integrated.
+// - Normalized: the textbook barycentric rotating frame, in units of the
+//   Earth-Moon distance and 1 / mean motion. Used for published initial
+//   conditions and for the Jacobi constant.
+class CR3BP {
+public:
+    static constexpr double DISTANCE = 384400e3;    // m, Earth-Moon
+    static constexpr double MASS_RATIO = Constants::MOON_MU / (Constants::EARTH_MU + Constants::MOON_MU);
+    
+    // Angular rate of the Earth-Moon line (rad/s) and its period (s)
+    static double getMeanMotion();
+    static double getPeriod() { return Constants::TWO_PI / getMeanMotion(); }
+    
+    // Earth relative to the Moon in the inertial frame at a simulation time
+    static glm::dvec3 earthPosition(double time);
+    
+    static void inertialToRotating(const glm::dvec3& position, const glm::dvec3& velocity, double time,
+                                   glm::dvec3& outPosition, glm::dvec3& outVelocity);
+    static void rotatingToInertial(const glm::dvec3& position, const glm::dvec3& velocity, double time,
+                                   glm::dvec3& outPosition, glm::dvec3& outVelocity);
+    static void normalizedToRotating(const glm::dvec3& position, const glm::dvec3& velocity,
+                                     glm::dvec3& outPosition, glm::dvec3& outVelocity);
+    static void rotatingToNormalized(const glm::dvec3& position, const glm::dvec3& velocity,
+                                     glm::dvec3& outPosition, glm::dvec3& outVelocity);
+    
+    // Jacobi constant C = x^2 + y^2 + 2(1 - mu)/r1 + 2 mu/r2 - v^2 of a
+    // rotating-frame state, in normalized units. Conserved while coasting;
+    // its drift measures the integration error.
+    static double jacobiConstant(const glm::dvec3& position, const glm::dvec3& velocity);
+    
+    // Coast an inertial state from time for duration. Integrates in the
+    // rotating frame with Bulirsch-Stoer; outTrajectory, if given, receives
+    // the rotating-frame dense output with times from the start.
+    static SpacecraftState propagate(const SpacecraftState& state, double time, double duration,
+                                     const AdaptiveOptions& options,
+                                     DenseTrajectory* outTrajectory = nullptr,
+                                     AdaptiveStats* outStats = nullptr,
+                                     double bodyRadius = 0.0);
+    
+    // Inertial positions at count evenly spaced times of a rotating-frame
+    // trajectory that started at simulation time startTime
+    static std::vector<glm::dvec3> resampleInertial(const DenseTrajectory& rotating, double startTime,
+                                                    int count);
+};
+
+// Equations of motion in the rotating frame: Moon and Earth point masses,
+// Coriolis and centrifugal terms, and a thrust acceleration (rotating
+// axes). Satisfies DerivativeModel.
+struct CR3BPForceModel {
+    glm::dvec3 thrustAccel{0.0};
+    
+    CR3BPForceModel();
+    
+    void operator()(const SpacecraftState& state, glm::dvec3& outAccel, glm::dvec3& outVelDeriv) const;
+
+private:
+    double m_meanMotion;
+};
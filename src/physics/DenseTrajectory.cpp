@@ -0,0 +1,103 @@
+#include "DenseTrajectory.h"
+#include <algorithm>
+
+namespace {
+    glm::dvec3 interpolate(const std::array<glm::dvec3, 5>& c, double theta) {
+        double theta1 = 1.0 - theta;
+        return c[0] + theta * (c[1] + theta1 * (c[2] + theta * (c[3] + theta1 * c[4])));
+    }
+}
+
+DenseTrajectory::Segment DenseTrajectory::makeHermite(double t0, double h,
+                                                      const glm::dvec3& r0, const glm::dvec3& v0, const glm::dvec3& a0,
+                                                      const glm::dvec3& r1, const glm::dvec3& v1, const glm::dvec3& a1) {
+    Segment segment;
+    segment.t0 = t0;
+    segment.h = h;
+    segment.position[0] = r0;
+    segment.position[1] = r1 - r0;
+    segment.position[2] = h * v0 - segment.position[1];
+    segment.position[3] = segment.position[1] - h * v1 - segment.position[2];
+    segment.position[4] = glm::dvec3(0.0);
+    segment.velocity[0] = v0;
+    segment.velocity[1] = v1 - v0;
+    segment.velocity[2] = h * a0 - segment.velocity[1];
+    segment.velocity[3] = segment.velocity[1] - h * a1 - segment.velocity[2];
+    segment.velocity[4] = glm::dvec3(0.0);
+    return segment;
+}
+
+void DenseTrajectory::evaluateSegment(const Segment& segment, double t, glm::dvec3& outPosition,
+                                      glm::dvec3& outVelocity) {
+    double theta = segment.h > 0.0 ? std::clamp((t - segment.t0) / segment.h, 0.0, 1.0) : 0.0;
+    outPosition = interpolate(segment.position, theta);
+    outVelocity = interpolate(segment.velocity, theta);
+}
+
+double DenseTrajectory::getStartTime() const {
+    return m_segments.empty() ? 0.0 : m_segments.front().t0;
+}
+
+double DenseTrajectory::getEndTime() const {
+    return m_segments.empty() ? 0.0 : m_segments.back().t0 + m_segments.back().h;
+}
+
+size_t DenseTrajectory::findSegment(double t) const {
+    // First segment whose end lies at or beyond t
+    auto it = std::lower_bound(m_segments.begin(), m_segments.end(), t,
+        [](const Segment& segment, double time) {
+            return segment.t0 + segment.h < time;
+        });
+    if (it == m_segments.end()) {
+        return m_segments.size() - 1;
+    }
+    return static_cast<size_t>(it - m_segments.begin());
+}
+
+void DenseTrajectory::evaluate(double t, glm::dvec3& outPosition, glm::dvec3& outVelocity) const {
+    if (m_segments.empty()) {
+        outPosition = glm::dvec3(0.0);
+        outVelocity = glm::dvec3(0.0);
+        return;
+    }
+    
+    const Segment& segment = m_segments[findSegment(t)];
+    double theta = std::clamp((t - segment.t0) / segment.h, 0.0, 1.0);
+    outPosition = interpolate(segment.position, theta);
+    outVelocity = interpolate(segment.velocity, theta);
+}
+
+glm::dvec3 DenseTrajectory::evaluatePosition(double t) const {
+    if (m_segments.empty()) {
+        return glm::dvec3(0.0);
+    }
+    
+    const Segment& segment = m_segments[findSegment(t)];
+    double theta = std::clamp((t - segment.t0) / segment.h, 0.0, 1.0);
+    return interpolate(segment.position, theta);
+}
+
+std::vector<glm::dvec3> DenseTrajectory::resamplePositions(int count) const {
+    std::vector<glm::dvec3> positions;
+    if (m_segments.empty() || count <= 0) {
+        return positions;
+    }
+    
+    positions.reserve(count);
+    double start = getStartTime();
+    double span = getEndTime() - start;
+    
+    // Sample times increase monotonically, so walk the segments forward
+    size_t index = 0;
+    for (int i = 0; i < count; ++i) {
+        double t = (count > 1) ? start + span * i / (count - 1) : start;
+        while (index + 1 < m_segments.size() && m_segments[index].t0 + m_segments[index].h < t) {
+            index++;
+        }
+        const Segment& segment = m_segments[index];
+        double theta = std::clamp((t - segment.t0) / segment.h, 0.0, 1.0);
+        positions.push_back(interpolate(segment.position, theta));
+    }
+    
+    return positions;
+}
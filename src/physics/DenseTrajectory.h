@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <vector>
+
+// Continuous trajectory built from the dense output of an adaptive
+// Runge-Kutta or Bulirsch-Stoer integration. Each accepted step stores the
+// coefficients of its interpolating polynomial, so the path can be
+// evaluated at any time inside the integrated span without further force
+// evaluations.
+class DenseTrajectory {
+public:
+    // Dormand-Prince 5(4) continuous extension (4th order), or Hermite
+    // through the step ends and midpoint for Bulirsch-Stoer:
+    // y(t0 + theta*h) = c0 + theta*(c1 + (1-theta)*(c2 + theta*(c3 + (1-theta)*c4)))
+    struct Segment {
+        double t0 = 0.0;
+        double h = 0.0;
+        std::array<glm::dvec3, 5> position;
+        std::array<glm::dvec3, 5> velocity;
+    };
+    
+    // Cubic Hermite segment through the states and accelerations at both
+    // ends of a step of length h, for steps without dense output of their own
+    static Segment makeHermite(double t0, double h,
+                               const glm::dvec3& r0, const glm::dvec3& v0, const glm::dvec3& a0,
+                               const glm::dvec3& r1, const glm::dvec3& v1, const glm::dvec3& a1);
+    static void evaluateSegment(const Segment& segment, double t, glm::dvec3& outPosition,
+                                glm::dvec3& outVelocity);
+    
+    void clear() { m_segments.clear(); }
+    void addSegment(const Segment& segment) { m_segments.push_back(segment); }
+    
+    bool isEmpty() const { return m_segments.empty(); }
+    size_t getSegmentCount() const { return m_segments.size(); }
+    const std::vector<Segment>& getSegments() const { return m_segments; }
+    
+    double getStartTime() const;
+    double getEndTime() const;
+    
+    // Interpolated state at time t (clamped to the covered span)
+    void evaluate(double t, glm::dvec3& outPosition, glm::dvec3& outVelocity) const;
+    glm::dvec3 evaluatePosition(double t) const;
+    
+    // Positions at count evenly spaced times covering the whole span
+    std::vector<glm::dvec3> resamplePositions(int count) const;
+
+private:
+    size_t findSegment(double t) const;
+    
+    std::vector<Segment> m_segments;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+// Forward-mode automatic differentiation. A Dual carries a value and its
+// gradient with respect to N seeded inputs; every operation applies the
+// chain rule to the gradient, so code templated on its scalar type yields
+// the exact Jacobian (to rounding) from the same source as the double
+// path, at a cost of about N + 1 evaluations and without the step-size
+// trade-off of finite differences.
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cmath>
+
+template <int N>
+struct Dual {
+    double value = 0.0;
+    std::array<double, N> grad{};
+    
+    Dual() = default;
+    
+    // A constant: zero gradient
+    Dual(double v) : value(v) {}
+    
+    // Input number index, with unit derivative along itself
+    static Dual variable(double v, int index) {
+        Dual d(v);
+        d.grad[index] = 1.0;
+        return d;
+    }
+    
+    Dual& operator+=(const Dual& b) {
+        value += b.value;
+        for (int i = 0; i < N; ++i) grad[i] += b.grad[i];
+        return *this;
+    }
+    
+    Dual& operator-=(const Dual& b) {
+        value -= b.value;
+        for (int i = 0; i < N; ++i) grad[i] -= b.grad[i];
+        return *this;
+    }
+    
+    Dual& operator*=(double b) {
+        value *= b;
+        for (int i = 0; i < N; ++i) grad[i] *= b;
+        return *this;
+    }
+    
+    Dual& operator*=(const Dual& b) { return *this = *this * b; }
+    Dual& operator/=(const Dual& b) { return *this = *this / b; }
+    
+    friend Dual operator-(Dual a) { return a *= -1.0; }
+    
+    friend Dual operator+(Dual a, const Dual& b) { return a += b; }
+    friend Dual operator-(Dual a, const Dual& b) { return a -= b; }
+    
+    // Scaling by a constant skips the product rule
+    friend Dual operator*(Dual a, double b) { return a *= b; }
+    friend Dual operator*(double a, Dual b) { return b *= a; }
+    friend Dual operator/(Dual a, double b) { return a *= 1.0 / b; }
+    
+    friend Dual operator*(const Dual& a, const Dual& b) {
+        Dual r(a.value * b.value);
+        for (int i = 0; i < N; ++i) r.grad[i] = a.grad[i] * b.value + a.value * b.grad[i];
+        return r;
+    }
+    
+    friend Dual operator/(const Dual& a, const Dual& b) {
+        double inv = 1.0 / b.value;
+        Dual r(a.value * inv);
+        for (int i = 0; i < N; ++i) r.grad[i] = (a.grad[i] - r.value * b.grad[i]) * inv;
+        return r;
+    }
+    
+    // Found by argument-dependent lookup, so templates call sqrt(x) after
+    // "using std::sqrt;" and get the right one for double or Dual
+    friend Dual sqrt(const Dual& a) {
+        double s = std::sqrt(a.value);
+        Dual r(s);
+        double d = 0.5 / s;
+        for (int i = 0; i < N; ++i) r.grad[i] = a.grad[i] * d;
+        return r;
+    }
+    
+    friend Dual sin(const Dual& a) {
+        Dual r(std::sin(a.value));
+        double d = std::cos(a.value);
+        for (int i = 0; i < N; ++i) r.grad[i] = a.grad[i] * d;
+        return r;
+    }
+    
+    friend Dual cos(const Dual& a) {
+        Dual r(std::cos(a.value));
+        double d = -std::sin(a.value);
+        for (int i = 0; i < N; ++i) r.grad[i] = a.grad[i] * d;
+        return r;
+    }
+    
+    friend Dual atan2(const Dual& y, const Dual& x) {
+        Dual r(std::atan2(y.value, x.value));
+        double inv = 1.0 / (x.value * x.value + y.value * y.value);
+        for (int i = 0; i < N; ++i) r.grad[i] = (x.value * y.grad[i] - y.value * x.grad[i]) * inv;
+        return r;
+    }
+};
+
+// A position as three independent variables, for the gradient of an
+// acceleration with respect to it
+using DualVec3 = std::array<Dual<3>, 3>;
+
+inline DualVec3 seedPosition(const glm::dvec3& position) {
+    return {Dual<3>::variable(position.x, 0),
+            Dual<3>::variable(position.y, 1),
+            Dual<3>::variable(position.z, 2)};
+}
+
+inline glm::dvec3 dualValue(const DualVec3& v) {
+    return glm::dvec3(v[0].value, v[1].value, v[2].value);
+}
+
+// Jacobian d v / d position; glm is column-major, so column j holds the
+// derivatives with respect to input j
+inline glm::dmat3 dualJacobian(const DualVec3& v) {
+    glm::dmat3 jacobian(0.0);
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            jacobian[col][row] = v[row].grad[col];
+        }
+    }
+    return jacobian;
+}
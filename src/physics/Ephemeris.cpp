@@ -0,0 +1,153 @@
+#include "Ephemeris.h"
+#include "core/Constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double ARCSEC_TO_RAD = Constants::DEG_TO_RAD / 3600.0;
+    constexpr double JULIAN_CENTURY_DAYS = 36525.0;
+    constexpr double J2000_JULIAN_DATE = 2451545.0;
+    
+    glm::dvec3 fromSpherical(double longitude, double latitude, double distance) {
+        double cosLatitude = std::cos(latitude);
+        return distance * glm::dvec3(cosLatitude * std::cos(longitude),
+                                     cosLatitude * std::sin(longitude),
+                                     std::sin(latitude));
+    }
+}
+
+glm::dvec3 Ephemeris::moonFromEarth(double julianDate) {
+    double t = (julianDate - J2000_JULIAN_DATE) / JULIAN_CENTURY_DAYS;
+    
+    // Mean arguments (deg): mean longitude referred to the J2000 equinox,
+    // Moon and Sun mean anomalies, argument of latitude, mean elongation
+    double meanLongitude = (218.31617 + 481267.88088 * t - 1.3972 * t) * Constants::DEG_TO_RAD;
+    double l = (134.96292 + 477198.86753 * t) * Constants::DEG_TO_RAD;
+    double lp = (357.52543 + 35999.04944 * t) * Constants::DEG_TO_RAD;
+    double f = (93.27283 + 483202.01873 * t) * Constants::DEG_TO_RAD;
+    double d = (297.85027 + 445267.11135 * t) * Constants::DEG_TO_RAD;
+    
+    double longitude = meanLongitude + ARCSEC_TO_RAD * (
+        22640.0 * std::sin(l) + 769.0 * std::sin(2.0 * l)
+        - 4586.0 * std::sin(l - 2.0 * d) + 2370.0 * std::sin(2.0 * d)
+        - 668.0 * std::sin(lp) - 412.0 * std::sin(2.0 * f)
+        - 212.0 * std::sin(2.0 * l - 2.0 * d) - 206.0 * std::sin(l + lp - 2.0 * d)
+        + 192.0 * std::sin(l + 2.0 * d) - 165.0 * std::sin(lp - 2.0 * d)
+        + 148.0 * std::sin(l - lp) - 125.0 * std::sin(d)
+        - 110.0 * std::sin(l + lp) - 55.0 * std::sin(2.0 * f - 2.0 * d));
+    
+    double latitude = ARCSEC_TO_RAD * (
+        18520.0 * std::sin(f + longitude - meanLongitude + ARCSEC_TO_RAD * (412.0 * std::sin(2.0 * f) + 541.0 * std::sin(lp)))
+        - 526.0 * std::sin(f - 2.0 * d) + 44.0 * std::sin(l + f - 2.0 * d)
+        - 31.0 * std::sin(-l + f - 2.0 * d) - 25.0 * std::sin(-2.0 * l + f)
+        - 23.0 * std::sin(lp + f - 2.0 * d) + 21.0 * std::sin(-l + f)
+        + 11.0 * std::sin(-lp + f - 2.0 * d));
+    
+    double distance = 1000.0 * (385000.0
+        - 20905.0 * std::cos(l) - 3699.0 * std::cos(2.0 * d - l)
+        - 2956.0 * std::cos(2.0 * d) - 570.0 * std::cos(2.0 * l)
+        + 246.0 * std::cos(2.0 * l - 2.0 * d) - 205.0 * std::cos(lp - 2.0 * d)
+        - 171.0 * std::cos(l + 2.0 * d) - 152.0 * std::cos(l + lp - 2.0 * d));
+    
+    return fromSpherical(longitude, latitude, distance);
+}
+
+glm::dvec3 Ephemeris::sunFromEarth(double julianDate) {
+    double t = (julianDate - J2000_JULIAN_DATE) / JULIAN_CENTURY_DAYS;
+    
+    // Mean anomaly and ecliptic longitude referred to the J2000 equinox
+    double m = (357.5256 + 35999.049 * t) * Constants::DEG_TO_RAD;
+    double longitude = 282.94 * Constants::DEG_TO_RAD + m
+        + ARCSEC_TO_RAD * (6892.0 * std::sin(m) + 72.0 * std::sin(2.0 * m));
+    double distance = 1e9 * (149.619 - 2.499 * std::cos(m) - 0.021 * std::cos(2.0 * m));
+    
+    return fromSpherical(longitude, 0.0, distance);
+}
+
+void Ephemeris::build(double epochJulianDate, double spanSeconds) {
+    m_epoch = epochJulianDate;
+    m_fitError = 0.0;
+    m_segmentLength = SEGMENT_DAYS * Constants::SECONDS_PER_DAY;
+    m_segmentCount = std::max(1, static_cast<int>(std::ceil(spanSeconds / m_segmentLength)));
+    m_coefficients.assign(static_cast<size_t>(m_segmentCount) * COMPONENTS * NODES, 0.0);
+    
+    double samples[NODES][COMPONENTS];
+    for (int segment = 0; segment < m_segmentCount; ++segment) {
+        double start = segment * m_segmentLength;
+        double halfLength = 0.5 * m_segmentLength;
+        
+        // Interpolate at the Chebyshev nodes x_k = cos(pi (k + 1/2) / N)
+        for (int k = 0; k < NODES; ++k) {
+            double x = std::cos(Constants::PI * (k + 0.5) / NODES);
+            glm::dvec3 earth, sun;
+            analyticPositions(start + halfLength * (x + 1.0), earth, sun);
+            for (int axis = 0; axis < 3; ++axis) {
+                samples[k][axis] = earth[axis];
+                samples[k][3 + axis] = sun[axis];
+            }
+        }
+        double* out = m_coefficients.data() + static_cast<size_t>(segment) * COMPONENTS * NODES;
+        for (int component = 0; component < COMPONENTS; ++component) {
+            for (int j = 0; j < NODES; ++j) {
+                double sum = 0.0;
+                for (int k = 0; k < NODES; ++k) {
+                    sum += samples[k][component] * std::cos(Constants::PI * j * (k + 0.5) / NODES);
+                }
+                out[component * NODES + j] = sum * (j == 0 ? 1.0 : 2.0) / NODES;
+            }
+        }
+        
+        // Check between the nodes, where the interpolation error peaks
+        for (int k = 0; k + 1 < NODES; ++k) {
+            double x = 0.5 * (std::cos(Constants::PI * (k + 0.5) / NODES) +
+                              std::cos(Constants::PI * (k + 1.5) / NODES));
+            double time = start + halfLength * (x + 1.0);
+            glm::dvec3 earth, sun, fittedEarth, fittedSun;
+            analyticPositions(time, earth, sun);
+            getPositions(time, fittedEarth, fittedSun);
+            m_fitError = std::max({m_fitError, glm::length(fittedEarth - earth), glm::length(fittedSun - sun)});
+        }
+    }
+    
+    // Mean-Earth convention: the prime meridian faces the Earth at epoch
+    glm::dvec3 earth, sun;
+    analyticPositions(0.0, earth, sun);
+    m_primeMeridian = std::atan2(earth.y, earth.x);
+}
+
+void Ephemeris::analyticPositions(double time, glm::dvec3& outEarth, glm::dvec3& outSun) const {
+    double julianDate = m_epoch + time / Constants::SECONDS_PER_DAY;
+    glm::dvec3 moon = moonFromEarth(julianDate);
+    outEarth = -moon;
+    outSun = sunFromEarth(julianDate) - moon;
+}
+
+void Ephemeris::evaluate(double time, double out[COMPONENTS]) const {
+    int segment = std::min(static_cast<int>(time / m_segmentLength), m_segmentCount - 1);
+    double x = 2.0 * (time - segment * m_segmentLength) / m_segmentLength - 1.0;
+    const double* c = m_coefficients.data() + static_cast<size_t>(segment) * COMPONENTS * NODES;
+    
+    // Clenshaw recurrence for the six components side by side
+    double b1[COMPONENTS] = {}, b2[COMPONENTS] = {};
+    for (int j = NODES - 1; j >= 1; --j) {
+        for (int i = 0; i < COMPONENTS; ++i) {
+            double b0 = 2.0 * x * b1[i] - b2[i] + c[i * NODES + j];
+            b2[i] = b1[i];
+            b1[i] = b0;
+        }
+    }
+    for (int i = 0; i < COMPONENTS; ++i) {
+        out[i] = x * b1[i] - b2[i] + c[i * NODES];
+    }
+}
+
+void Ephemeris::getPositions(double time, glm::dvec3& outEarth, glm::dvec3& outSun) const {
+    if (time < 0.0 || time >= getSpan()) {
+        analyticPositions(time, outEarth, outSun);
+        return;
+    }
+    double p[COMPONENTS];
+    evaluate(time, p);
+    outEarth = glm::dvec3(p[0], p[1], p[2]);
+    outSun = glm::dvec3(p[3], p[4], p[5]);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// Moon-centered positions of the Earth and the Sun for third-body
+// perturbations, in the simulation's inertial frame (mean ecliptic and
+// equinox of J2000; the lunar equator is within 1.5 deg of it).
+//
+// The positions come from low-precision analytic series (Montenbruck & Gill
+// 3.3.2: a few arcminutes for the Moon, about 0.1 deg for the Sun), which
+// take dozens of trigonometric calls each. build() fits them once into
+// Chebyshev segments, so an evaluation inside the fitted span is a table
+// lookup and a short Clenshaw recurrence. Outside it the series are
+// evaluated directly.
+//
+// Immutable after build(); share one instance between threads.
+class Ephemeris {
+public:
+    static constexpr double SEGMENT_DAYS = 4.0;
+    static constexpr int SEGMENT_DEGREE = 8;
+    
+    // Fit [0, spanSeconds] of simulation time, where time zero is the Julian
+    // date epochJulianDate (TT)
+    void build(double epochJulianDate, double spanSeconds);
+    
+    double getEpoch() const { return m_epoch; }
+    double getSpan() const { return m_segmentCount * m_segmentLength; }
+    
+    // Longitude of the Earth about z at time zero, where the Moon-fixed
+    // prime meridian points (mean-Earth convention)
+    double getPrimeMeridian() const { return m_primeMeridian; }
+    
+    // Largest difference between the fit and the series at the midpoints
+    // between fit nodes (m)
+    double getFitError() const { return m_fitError; }
+    
+    // Earth and Sun relative to the Moon at simulation time (m)
+    void getPositions(double time, glm::dvec3& outEarth, glm::dvec3& outSun) const;
+    
+    // Analytic series: geocentric Moon and Sun at a Julian date (m)
+    static glm::dvec3 moonFromEarth(double julianDate);
+    static glm::dvec3 sunFromEarth(double julianDate);
+
+private:
+    // Earth x, y, z, then Sun x, y, z; evaluated together so the six
+    // recurrences overlap
+    static constexpr int COMPONENTS = 6;
+    static constexpr int NODES = SEGMENT_DEGREE + 1;
+    
+    void analyticPositions(double time, glm::dvec3& outEarth, glm::dvec3& outSun) const;
+    void evaluate(double time, double out[COMPONENTS]) const;
+    
+    double m_epoch = 0.0;
+    double m_primeMeridian = 0.0;   // radians
+    double m_fitError = 0.0;
+    double m_segmentLength = 0.0;   // seconds
+    int m_segmentCount = 0;
+    std::vector<double> m_coefficients;     // [segment][component][node]
+};
@@ -0,0 +1,256 @@
+#include "EventDetector.h"
+#include "core/Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // A zero between a and b: g leaves one sign and reaches zero or the
+    // other. A start exactly at zero is the previous step's event.
+    bool crosses(double a, double b) {
+        return (a > 0.0 && b <= 0.0) || (a < 0.0 && b >= 0.0);
+    }
+    
+    bool matches(EventFunction::Direction direction, bool rising) {
+        return direction == EventFunction::Direction::Both ||
+               (direction == EventFunction::Direction::Rising) == rising;
+    }
+    
+    const char* getEventName(const EventFunction& function, bool rising) {
+        switch (function.type) {
+            case EventFunction::Type::Altitude:
+                if (function.value <= 0.0) {
+                    return rising ? "liftoff" : "impact";
+                }
+                return rising ? "ascent through altitude" : "descent through altitude";
+            case EventFunction::Type::RadialVelocity:
+                return rising ? "periapsis" : "apoapsis";
+            case EventFunction::Type::NodeCrossing:
+                return rising ? "ascending node" : "descending node";
+            case EventFunction::Type::Custom:
+            default:
+                return function.name;
+        }
+    }
+    
+    // Brent's method (Brent 1973, as zeroin): inverse quadratic and secant
+    // steps, falling back to bisection whenever they do not shrink the
+    // bracket fast enough. g(a) and g(b) must have opposite signs.
+    template <typename F>
+    double findZero(const F& g, double a, double b, double ga, double gb) {
+        double c = b, gc = gb;
+        double d = b - a, e = d;
+        for (int iteration = 0; iteration < EventDetector::MAX_ITERATIONS; ++iteration) {
+            if ((gb > 0.0 && gc > 0.0) || (gb < 0.0 && gc < 0.0)) {
+                c = a;
+                gc = ga;
+                d = b - a;
+                e = d;
+            }
+            if (std::abs(gc) < std::abs(gb)) {
+                a = b;
+                b = c;
+                c = a;
+                ga = gb;
+                gb = gc;
+                gc = ga;
+            }
+            double tolerance = 2.0 * std::numeric_limits<double>::epsilon() * std::abs(b) +
+                               0.5 * EventDetector::TIME_TOLERANCE;
+            double half = 0.5 * (c - b);
+            if (std::abs(half) <= tolerance || gb == 0.0) {
+                break;
+            }
+            
+            if (std::abs(e) >= tolerance && std::abs(ga) > std::abs(gb)) {
+                double s = gb / ga;
+                double p, q;
+                if (a == c) {
+                    // Secant
+                    p = 2.0 * half * s;
+                    q = 1.0 - s;
+                } else {
+                    // Inverse quadratic interpolation
+                    double qa = ga / gc;
+                    double r = gb / gc;
+                    p = s * (2.0 * half * qa * (qa - r) - (b - a) * (r - 1.0));
+                    q = (qa - 1.0) * (r - 1.0) * (s - 1.0);
+                }
+                if (p > 0.0) {
+                    q = -q;
+                }
+                p = std::abs(p);
+                if (2.0 * p < std::min(3.0 * half * q - std::abs(tolerance * q), std::abs(e * q))) {
+                    e = d;
+                    d = p / q;
+                } else {
+                    d = half;
+                    e = d;
+                }
+            } else {
+                d = half;
+                e = d;
+            }
+            
+            a = b;
+            ga = gb;
+            b += std::abs(d) > tolerance ? d : std::copysign(tolerance, half);
+            gb = g(b);
+        }
+        return b;
+    }
+    
+    struct Zero {
+        size_t function;
+        double time;
+        bool rising;
+    };
+}
+
+double EventFunction::evaluate(double t, const glm::dvec3& position, const glm::dvec3& velocity) const {
+    switch (type) {
+        case Type::Altitude:
+            return glm::length(position) - (Constants::MOON_RADIUS + value);
+        case Type::RadialVelocity: {
+            double radius = glm::length(position);
+            return radius > 0.0 ? glm::dot(position, velocity) / radius : 0.0;
+        }
+        case Type::NodeCrossing:
+            return position.z;
+        case Type::Custom:
+        default:
+            return custom ? custom(t, position, velocity) : 1.0;
+    }
+}
+
+EventFunction EventFunction::impact() {
+    EventFunction function;
+    function.type = Type::Altitude;
+    function.direction = Direction::Falling;
+    function.terminal = true;
+    return function;
+}
+
+EventFunction EventFunction::apsides() {
+    EventFunction function;
+    function.type = Type::RadialVelocity;
+    return function;
+}
+
+EventFunction EventFunction::nodes() {
+    EventFunction function;
+    function.type = Type::NodeCrossing;
+    return function;
+}
+
+void EventDetector::clear() {
+    m_functions.clear();
+    m_values.clear();
+    m_nextValues.clear();
+}
+
+int EventDetector::addFunction(const EventFunction& function) {
+    m_functions.push_back(function);
+    m_values.push_back(function.evaluate(m_time, m_position, m_velocity));
+    m_nextValues.push_back(0.0);
+    return static_cast<int>(m_functions.size()) - 1;
+}
+
+void EventDetector::begin(double t, const glm::dvec3& position, const glm::dvec3& velocity) {
+    m_time = t;
+    m_position = position;
+    m_velocity = velocity;
+    for (size_t i = 0; i < m_functions.size(); ++i) {
+        m_values[i] = m_functions[i].evaluate(t, position, velocity);
+    }
+}
+
+void EventDetector::accept(double t, const glm::dvec3& position, const glm::dvec3& velocity) {
+    m_values.swap(m_nextValues);
+    m_time = t;
+    m_position = position;
+    m_velocity = velocity;
+}
+
+bool EventDetector::mayHaveEvent(size_t index, const glm::dvec3& position, const glm::dvec3& velocity) const {
+    const EventFunction& function = m_functions[index];
+    double g0 = m_values[index];
+    double g1 = m_nextValues[index];
+    if (crosses(g0, g1)) {
+        return matches(function.direction, g0 < 0.0);
+    }
+    if (function.type != EventFunction::Type::Altitude) {
+        return false;
+    }
+    
+    // Same side at both ends, but the radius turns inside the step
+    double radial0 = glm::dot(m_position, m_velocity);
+    double radial1 = glm::dot(position, velocity);
+    return (g0 > 0.0 && g1 > 0.0 && radial0 < 0.0 && radial1 > 0.0) ||
+           (g0 < 0.0 && g1 < 0.0 && radial0 > 0.0 && radial1 < 0.0);
+}
+
+bool EventDetector::locate(double t, const glm::dvec3& position, const glm::dvec3& velocity,
+                           const StateInterpolant& interpolate, std::vector<Event>& outEvents) {
+    std::vector<Zero> zeros;
+    for (size_t i = 0; i < m_functions.size(); ++i) {
+        if (!mayHaveEvent(i, position, velocity)) {
+            continue;
+        }
+        const EventFunction& function = m_functions[i];
+        auto g = [&](double time) {
+            glm::dvec3 r, v;
+            interpolate(time, r, v);
+            return function.evaluate(time, r, v);
+        };
+        double g0 = m_values[i];
+        double g1 = m_nextValues[i];
+        
+        if (crosses(g0, g1)) {
+            zeros.push_back({i, findZero(g, m_time, t, g0, g1), g0 < 0.0});
+            continue;
+        }
+        
+        // Altitude extremum inside the step: a zero on either side of it
+        // if the orbit reaches across
+        auto radial = [&](double time) {
+            glm::dvec3 r, v;
+            interpolate(time, r, v);
+            return glm::dot(r, v);
+        };
+        double extremum = findZero(radial, m_time, t, glm::dot(m_position, m_velocity),
+                                   glm::dot(position, velocity));
+        double gm = g(extremum);
+        if (crosses(g0, gm) && matches(function.direction, g0 < 0.0)) {
+            zeros.push_back({i, findZero(g, m_time, extremum, g0, gm), g0 < 0.0});
+        }
+        if (crosses(gm, g1) && matches(function.direction, gm < 0.0)) {
+            zeros.push_back({i, findZero(g, extremum, t, gm, g1), gm < 0.0});
+        }
+    }
+    
+    std::sort(zeros.begin(), zeros.end(), [](const Zero& a, const Zero& b) { return a.time < b.time; });
+    for (const Zero& zero : zeros) {
+        const EventFunction& function = m_functions[zero.function];
+        Event event;
+        event.function = static_cast<int>(zero.function);
+        event.type = function.type;
+        event.name = getEventName(function, zero.rising);
+        event.rising = zero.rising;
+        event.terminal = function.terminal;
+        event.time = zero.time;
+        interpolate(zero.time, event.position, event.velocity);
+        outEvents.push_back(event);
+        
+        if (function.terminal) {
+            // Stand at the event. Its own function reads zero there so the
+            // same crossing is not found again if the caller carries on.
+            begin(event.time, event.position, event.velocity);
+            m_values[zero.function] = 0.0;
+            return true;
+        }
+    }
+    
+    accept(t, position, velocity);
+    return false;
+}
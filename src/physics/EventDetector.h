@@ -0,0 +1,115 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <functional>
+#include <vector>
+
+// A switching function g(t, r, v) along a trajectory; each zero it crosses
+// is an event. Position and velocity are Moon-centered inertial.
+struct EventFunction {
+    enum class Type {
+        Altitude,           // |r| - (R + value): impact at value 0, falling
+        RadialVelocity,     // r . v / |r|: periapsis rising, apoapsis falling
+        NodeCrossing,       // z: ascending node rising, descending node falling
+        Custom
+    };
+    
+    // Which zeros count, by the sign g takes after them
+    enum class Direction { Both, Rising, Falling };
+    
+    using CustomFunc = std::function<double(double, const glm::dvec3&, const glm::dvec3&)>;
+    
+    Type type = Type::Altitude;
+    Direction direction = Direction::Both;
+    double value = 0.0;             // Altitude: meters above the mean radius
+    bool terminal = false;          // the propagation stops at the event
+    CustomFunc custom;
+    const char* name = "custom";    // Custom only; the others are named by type
+    
+    double evaluate(double t, const glm::dvec3& position, const glm::dvec3& velocity) const;
+    
+    // Surface impact (terminal), both apsides, both nodes
+    static EventFunction impact();
+    static EventFunction apsides();
+    static EventFunction nodes();
+};
+
+struct Event {
+    int function = -1;              // index in the detector
+    EventFunction::Type type = EventFunction::Type::Custom;
+    const char* name = "";          // "impact", "periapsis", "ascending node", ...
+    bool rising = false;            // sign of g after the zero
+    bool terminal = false;
+    double time = 0.0;              // simulation seconds
+    glm::dvec3 position{0.0};
+    glm::dvec3 velocity{0.0};
+    
+    bool isImpact() const { return terminal && type == EventFunction::Type::Altitude && !rising; }
+};
+
+// Locates events to sub-step precision. After every step the integrator
+// hands over the step's end state and an interpolant of the step (dense
+// output, a Hermite cubic through the ends, or the exact Kepler flow).
+// Endpoint values of g are compared first, which costs a few dot products
+// per function; only a step that brackets a zero touches the interpolant,
+// where Brent's method finds the crossing to TIME_TOLERANCE.
+//
+// A sign change at the ends can hide two crossings inside one step (an
+// orbit that dips below an altitude and climbs back out). Altitude
+// functions catch that case too: when the radial velocity changes sign
+// inside the step, the extremum is located first and its altitude checked.
+// Other functions rely on steps short enough to see at most one zero.
+class EventDetector {
+public:
+    static constexpr double TIME_TOLERANCE = 1e-6;  // seconds
+    static constexpr int MAX_ITERATIONS = 100;      // per located zero
+    
+    // State anywhere inside the current step, at a simulation time
+    using StateInterpolant = std::function<void(double, glm::dvec3&, glm::dvec3&)>;
+    
+    void clear();
+    int addFunction(const EventFunction& function);    // returns its index
+    const std::vector<EventFunction>& getFunctions() const { return m_functions; }
+    bool isEmpty() const { return m_functions.empty(); }
+    
+    // Start at a state, or restart after it was changed outside a step
+    void begin(double t, const glm::dvec3& position, const glm::dvec3& velocity);
+    
+    // Advance to the end of a step. interpolate(t, r, v) must reproduce
+    // the step's start and end states and is called only if the step
+    // brackets an event. Located events are appended to outEvents in time
+    // order. Returns true if a terminal event ended the step early; the
+    // detector then stands at that event, which is outEvents.back(), and
+    // the caller should move its state there.
+    template <typename Interpolant>
+    bool step(double t, const glm::dvec3& position, const glm::dvec3& velocity,
+              Interpolant&& interpolate, std::vector<Event>& outEvents);
+
+private:
+    bool mayHaveEvent(size_t index, const glm::dvec3& position, const glm::dvec3& velocity) const;
+    bool locate(double t, const glm::dvec3& position, const glm::dvec3& velocity,
+                const StateInterpolant& interpolate, std::vector<Event>& outEvents);
+    void accept(double t, const glm::dvec3& position, const glm::dvec3& velocity);
+    
+    std::vector<EventFunction> m_functions;
+    std::vector<double> m_values;       // g at the last accepted point
+    std::vector<double> m_nextValues;   // g at the end of the step being checked
+    double m_time = 0.0;
+    glm::dvec3 m_position{0.0};
+    glm::dvec3 m_velocity{0.0};
+};
+
+template <typename Interpolant>
+bool EventDetector::step(double t, const glm::dvec3& position, const glm::dvec3& velocity,
+                         Interpolant&& interpolate, std::vector<Event>& outEvents) {
+    bool bracketed = false;
+    for (size_t i = 0; i < m_functions.size(); ++i) {
+        m_nextValues[i] = m_functions[i].evaluate(t, position, velocity);
+        bracketed = bracketed || mayHaveEvent(i, position, velocity);
+    }
+    if (!bracketed) {
+        accept(t, position, velocity);
+        return false;
+    }
+    return locate(t, position, velocity, std::ref(interpolate), outEvents);
+}
@@ -0,0 +1,230 @@
+#include "Fleet.h"
+#include "Orbit.h"
+#include "PoweredFlight.h"
+#include "core/Constants.h"
+#include "core/Random.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Burn time left over from rounding the step, not a burn
+    constexpr double BURN_TOLERANCE = 1e-9;     // seconds
+    
+    const VehicleClassInfo CLASS_INFO[] = {
+        {"Orion", 26500.0, 17000.0, 26700.0, 316.0},
+        {"Gateway", 40000.0, 34000.0, 2.5, 2600.0},     // Hall thrusters
+        {"Lander", 15000.0, 6000.0, 45000.0, 310.0},
+        {"Relay", 700.0, 550.0, 22.0, 220.0}
+    };
+}
+
+const VehicleClassInfo& Fleet::getClassInfo(VehicleClass vehicleClass) {
+    return CLASS_INFO[static_cast<int>(vehicleClass)];
+}
+
+const char* Fleet::getVehicleClassName(VehicleClass vehicleClass) {
+    return getClassInfo(vehicleClass).name;
+}
+
+bool Fleet::add(VehicleClass vehicleClass, const glm::dvec3& position, const glm::dvec3& velocity,
+                std::string& outError) {
+    if (size() >= MAX_VEHICLES) {
+        outError = "fleet is full";
+        return false;
+    }
+    if (glm::length(position) <= Constants::MOON_RADIUS) {
+        outError = "position is below the surface";
+        return false;
+    }
+    
+    size_t index = size();
+    resize(index + 1);
+    m_states.set(index, position, velocity);
+    m_mass[index] = getClassInfo(vehicleClass).mass;
+    m_class[index] = vehicleClass;
+    m_throttle[index] = 0.0;
+    m_burnRemaining[index] = 0.0;
+    m_mode[index] = Spacecraft::ThrustMode::Prograde;
+    return true;
+}
+
+void Fleet::spawn(size_t count, uint64_t seed) {
+    clear();
+    count = std::min(count, MAX_VEHICLES);
+    
+    double mu = Constants::MOON_MU;
+    double radius = Constants::MOON_RADIUS;
+    for (size_t i = 0; i < count; ++i) {
+        // A stream per vehicle: growing the fleet keeps the first ones
+        CounterRng rng(seed, i);
+        double raan = Constants::TWO_PI * rng.nextUniform();
+        double anomaly = Constants::TWO_PI * rng.nextUniform();
+        glm::dvec3 position, velocity;
+        VehicleClass vehicleClass;
+        
+        size_t slot = i % 10;
+        if (slot == 0) {
+            // Polar, high and eccentric
+            vehicleClass = VehicleClass::Gateway;
+            double inclination = (85.0 + 10.0 * rng.nextUniform()) * Constants::DEG_TO_RAD;
+            Orbit::createEllipticalOrbit(3000.0e3, 9000.0e3 + 3000.0e3 * rng.nextUniform(), inclination, raan,
+                                         Constants::TWO_PI * rng.nextUniform(), anomaly, mu, radius,
+                                         position, velocity);
+        } else if (slot == 1) {
+            vehicleClass = VehicleClass::Orion;
+            double inclination = Constants::PI * rng.nextUniform();
+            Orbit::createCircularOrbit(100.0e3 + 300.0e3 * rng.nextUniform(), inclination, raan, anomaly,
+                                       mu, radius, position, velocity);
+        } else if (slot < 6) {
+            vehicleClass = VehicleClass::Lander;
+            double inclination = Constants::PI * rng.nextUniform();
+            Orbit::createCircularOrbit(15.0e3 + 85.0e3 * rng.nextUniform(), inclination, raan, anomaly,
+                                       mu, radius, position, velocity);
+        } else {
+            // Frozen-orbit inclinations, where the field barely moves periapsis
+            vehicleClass = VehicleClass::Relay;
+            double inclination = (55.0 + 10.0 * rng.nextUniform()) * Constants::DEG_TO_RAD;
+            Orbit::createEllipticalOrbit(500.0e3 + 1000.0e3 * rng.nextUniform(),
+                                         5000.0e3 + 3000.0e3 * rng.nextUniform(), inclination, raan,
+                                         0.5 * Constants::PI, anomaly, mu, radius, position, velocity);
+        }
+        
+        std::string error;
+        add(vehicleClass, position, velocity, error);
+    }
+}
+
+void Fleet::clear() {
+    resize(0);
+}
+
+bool Fleet::startBurn(size_t index, double throttle, Spacecraft::ThrustMode mode, double duration) {
+    if (index >= size() || mode == Spacecraft::ThrustMode::Custom) {
+        return false;
+    }
+    if (m_mass[index] <= getClassInfo(m_class[index]).dryMass) {
+        return false;
+    }
+    m_throttle[index] = std::clamp(throttle, 0.0, 1.0);
+    m_mode[index] = mode;
+    m_burnRemaining[index] = m_throttle[index] > 0.0 ? std::max(0.0, duration) : 0.0;
+    return true;
+}
+
+size_t Fleet::getBurningCount() const {
+    return static_cast<size_t>(std::count_if(m_burnRemaining.begin(), m_burnRemaining.end(),
+                                             [](double remaining) { return remaining > 0.0; }));
+}
+
+size_t Fleet::advance(double dt, double mu) {
+    size_t count = size();
+    if (count == 0 || !(dt > 0.0)) {
+        return 0;
+    }
+    
+    int steps = std::max(1, static_cast<int>(std::ceil(dt / MAX_STEP)));
+    double h = dt / steps;
+    
+    // A long tick can dip below the surface and climb out again between
+    // its ends, so every step end counts
+    m_lowest.assign(count, std::numeric_limits<double>::infinity());
+    
+    // Coasting vehicles in runs between the burning ones, one kernel call
+    // per run; with nobody burning that is the whole fleet at once
+    size_t runBegin = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (m_burnRemaining[i] > 0.0) {
+            BatchPropagator::propagateRK4(m_states, h, steps, mu, runBegin, i, m_simdLevel, m_lowest.data());
+            advanceBurning(i, h, steps, mu);
+            runBegin = i + 1;
+        }
+    }
+    BatchPropagator::propagateRK4(m_states, h, steps, mu, runBegin, count, m_simdLevel, m_lowest.data());
+    
+    return removeImpacted();
+}
+
+void Fleet::advanceBurning(size_t index, double h, int steps, double mu) {
+    const VehicleClassInfo& info = getClassInfo(m_class[index]);
+    PoweredFlightModel model;
+    model.gravity.mu = mu;
+    model.thrust = m_throttle[index] * info.maxThrust;
+    model.exhaustVelocity = info.isp * Constants::G0;
+    model.dryMass = info.dryMass;
+    model.mode = m_mode[index];
+    PoweredFlightModel unpowered = model;
+    unpowered.thrust = 0.0;
+    
+    SpacecraftState state;
+    state.position = m_states.getPosition(index);
+    state.velocity = m_states.getVelocity(index);
+    state.mass = m_mass[index];
+    
+    // Cutoff inside a step splits it, so the burn lasts exactly its duration
+    double remaining = m_burnRemaining[index];
+    double lowest = m_lowest[index];
+    for (int i = 0; i < steps; ++i) {
+        double burn = std::min(h, remaining);
+        if (burn > 0.0) {
+            PoweredFlight::step(state, i * h, burn, model);
+            remaining -= burn;
+        }
+        if (burn < h) {
+            PoweredFlight::step(state, i * h + burn, h - burn, unpowered);
+        }
+        lowest = std::min(lowest, glm::dot(state.position, state.position));
+    }
+    m_lowest[index] = lowest;
+    if (remaining <= BURN_TOLERANCE || state.mass <= info.dryMass) {
+        remaining = 0.0;
+        m_throttle[index] = 0.0;
+    }
+    
+    m_states.set(index, state.position, state.velocity);
+    m_mass[index] = state.mass;
+    m_burnRemaining[index] = remaining;
+}
+
+size_t Fleet::removeImpacted() {
+    size_t count = size();
+    size_t kept = 0;
+    double surface = Constants::MOON_RADIUS * Constants::MOON_RADIUS;
+    for (size_t i = 0; i < count; ++i) {
+        if (m_lowest[i] <= surface) {
+            continue;
+        }
+        if (kept != i) {
+            m_states.set(kept, m_states.getPosition(i), m_states.getVelocity(i));
+            m_mass[kept] = m_mass[i];
+            m_class[kept] = m_class[i];
+            m_throttle[kept] = m_throttle[i];
+            m_burnRemaining[kept] = m_burnRemaining[i];
+            m_mode[kept] = m_mode[i];
+        }
+        ++kept;
+    }
+    resize(kept);
+    return count - kept;
+}
+
+void Fleet::resize(size_t count) {
+    m_states.resize(count);
+    m_mass.resize(count);
+    m_class.resize(count);
+    m_throttle.resize(count);
+    m_burnRemaining.resize(count);
+    m_mode.resize(count);
+}
+
+void Fleet::exportInstances(std::vector<FleetInstance>& outInstances) const {
+    size_t count = size();
+    outInstances.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        FleetInstance& instance = outInstances[i];
+        instance.position = m_states.getPosition(i);
+        instance.velocity = m_states.getVelocity(i);
+        instance.vehicleClass = m_class[i];
+        instance.throttle = m_burnRemaining[i] > 0.0 ? static_cast<float>(m_throttle[i]) : 0.0f;
+    }
+}
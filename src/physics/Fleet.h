@@ -0,0 +1,111 @@
+#pragma once
+
+#include "BatchPropagator.h"
+#include "Spacecraft.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Vehicle types of a fleet: mass, engine and how they are drawn
+enum class VehicleClass : uint8_t {
+    Orion,
+    Gateway,
+    Lander,
+    Relay
+};
+
+struct VehicleClassInfo {
+    const char* name;
+    double mass;                // kg, fully fuelled
+    double dryMass;             // kg
+    double maxThrust;           // N
+    double isp;                 // s
+};
+
+// What the renderer needs of one vehicle
+struct FleetInstance {
+    glm::dvec3 position{0.0};
+    glm::dvec3 velocity{0.0};
+    VehicleClass vehicleClass = VehicleClass::Orion;
+    float throttle = 0.0f;      // 0 while coasting
+};
+
+// Many vehicles besides the player's spacecraft, in structure-of-arrays
+// layout. Positions and velocities live in a StateBatch, and the coasting
+// vehicles, normally all but a few, go through BatchPropagator's
+// vectorized RK4 in runs of consecutive lanes, so a tick costs a handful of
+// kernel calls rather than one integrator call per vehicle. A burning
+// vehicle breaks a run and is stepped on its own with PoweredFlight, from
+// its own thrust state. The fleet flies point-mass lunar gravity (the
+// batched kernels have no field) and has no attitude: vehicles are drawn
+// nose along the velocity. Vehicles below the surface at any step end of a
+// tick are removed, even if they climb out again before the tick ends.
+class Fleet {
+public:
+    static constexpr size_t MAX_VEHICLES = 1024;
+    static constexpr double MAX_STEP = 10.0;    // seconds per RK4 step
+    
+    static const VehicleClassInfo& getClassInfo(VehicleClass vehicleClass);
+    static const char* getVehicleClassName(VehicleClass vehicleClass);
+    
+    // Returns false with outError if the fleet is full or the position is
+    // below the surface
+    bool add(VehicleClass vehicleClass, const glm::dvec3& position, const glm::dvec3& velocity,
+             std::string& outError);
+    
+    // Replace the fleet with count vehicles (at most MAX_VEHICLES) on
+    // random orbits, one Gateway and one Orion per ten, the rest
+    // landers low and relays high. The same seed gives the same fleet.
+    void spawn(size_t count, uint64_t seed);
+    void clear();
+    
+    // Burn vehicle index for duration seconds of its advance() time at a
+    // throttle, pointing by mode (Custom is not available: there is no
+    // direction per vehicle). Returns false if there is no such vehicle or
+    // it has no propellant left.
+    bool startBurn(size_t index, double throttle, Spacecraft::ThrustMode mode, double duration);
+    
+    // Advance every vehicle by dt seconds, in equal steps of at most
+    // MAX_STEP; the burns end within the steps exactly on time. Returns
+    // how many vehicles hit the surface and were removed.
+    size_t advance(double dt, double mu);
+    
+    size_t size() const { return m_states.size(); }
+    bool isEmpty() const { return m_states.size() == 0; }
+    size_t getBurningCount() const;
+    bool isBurning(size_t index) const { return m_burnRemaining[index] > 0.0; }
+    
+    glm::dvec3 getPosition(size_t index) const { return m_states.getPosition(index); }
+    glm::dvec3 getVelocity(size_t index) const { return m_states.getVelocity(index); }
+    double getMass(size_t index) const { return m_mass[index]; }
+    VehicleClass getVehicleClass(size_t index) const { return m_class[index]; }
+    
+    // Render view of every vehicle, reusing outInstances' capacity
+    void exportInstances(std::vector<FleetInstance>& outInstances) const;
+
+private:
+    // One burning vehicle through the whole advance: steps of h, the
+    // engine on for the first burnRemaining seconds
+    void advanceBurning(size_t index, double h, int steps, double mu);
+    
+    // Drop the vehicles that went below the surface during the advance,
+    // keeping the others in order
+    size_t removeImpacted();
+    
+    void resize(size_t count);
+    
+    StateBatch m_states;
+    std::vector<double> m_mass;             // kg
+    std::vector<VehicleClass> m_class;
+    
+    // Thrust state per vehicle; burnRemaining 0 = coasting
+    std::vector<double> m_throttle;
+    std::vector<double> m_burnRemaining;    // seconds
+    std::vector<Spacecraft::ThrustMode> m_mode;
+    
+    // Scratch for advance(): lowest r^2 per vehicle at the step ends
+    std::vector<double> m_lowest;
+    
+    BatchPropagator::SimdLevel m_simdLevel = BatchPropagator::getBestSimdLevel();
+};
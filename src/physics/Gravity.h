@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Dual.h"
+#include "Spacecraft.h"
+#include <glm/glm.hpp>
+#include <cmath>
+
+class Gravity {
+public:
+    // Two-body point mass acceleration: a = -mu * r / |r|^3
+    static glm::dvec3 pointMass(const glm::dvec3& position, double mu) {
+        double r2 = glm::dot(position, position);
+        if (r2 > 1.0) {  // Avoid division by zero
+            // One divide instead of three: scale by -mu / r^3
+            double r = std::sqrt(r2);
+            return position * (-mu / (r2 * r));
+        }
+        return glm::dvec3(0.0);
+    }
+    
+    // Perturbation from a third body at bodyPosition, in a frame centered
+    // on the primary: the body's pull on the spacecraft minus its pull on
+    // the primary (the frame's own acceleration)
+    static glm::dvec3 thirdBody(const glm::dvec3& position, const glm::dvec3& bodyPosition, double mu) {
+        glm::dvec3 relative = bodyPosition - position;
+        double d2 = glm::dot(relative, relative);
+        double s2 = glm::dot(bodyPosition, bodyPosition);
+        return mu * (relative / (d2 * std::sqrt(d2)) - bodyPosition / (s2 * std::sqrt(s2)));
+    }
+    
+    // The same with the gradient d a / d position, by dual numbers
+    static glm::dvec3 pointMass(const glm::dvec3& position, double mu, glm::dmat3& outGradient) {
+        if (glm::dot(position, position) <= 1.0) {
+            outGradient = glm::dmat3(0.0);
+            return glm::dvec3(0.0);
+        }
+        DualVec3 a = pointMass(seedPosition(position), mu);
+        outGradient = dualJacobian(a);
+        return dualValue(a);
+    }
+    
+    static glm::dvec3 thirdBody(const glm::dvec3& position, const glm::dvec3& bodyPosition, double mu,
+                                glm::dmat3& outGradient) {
+        // The primary's term does not depend on the spacecraft
+        DualVec3 a = pointMass(seedPosition(position - bodyPosition), mu);
+        outGradient = dualJacobian(a);
+        double s2 = glm::dot(bodyPosition, bodyPosition);
+        return dualValue(a) - mu * bodyPosition / (s2 * std::sqrt(s2));
+    }
+    
+    // Point mass for any scalar with the arithmetic operators and sqrt
+    template <typename T>
+    static std::array<T, 3> pointMass(const std::array<T, 3>& position, double mu) {
+        using std::sqrt;
+        T r2 = position[0] * position[0] + position[1] * position[1] + position[2] * position[2];
+        T scale = -mu / (r2 * sqrt(r2));
+        return {position[0] * scale, position[1] * scale, position[2] * scale};
+    }
+};
+
+// Point-mass gravity plus a thrust acceleration held constant over the step.
+// Satisfies DerivativeModel, so integrator kernels inline it, and
+// DifferentiableModel for state transition matrices.
+struct PointMassForceModel {
+    double mu = 0.0;
+    glm::dvec3 thrustAccel{0.0};
+    
+    void operator()(const SpacecraftState& state, glm::dvec3& outAccel, glm::dvec3& outVelDeriv) const {
+        outAccel = Gravity::pointMass(state.position, mu) + thrustAccel;
+        outVelDeriv = state.velocity;
+    }
+    
+    void operator()(const SpacecraftState& state, glm::dvec3& outAccel, glm::dvec3& outVelDeriv,
+                    glm::dmat3& outGradient) const {
+        outAccel = Gravity::pointMass(state.position, mu, outGradient) + thrustAccel;
+        outVelDeriv = state.velocity;
+    }
+};
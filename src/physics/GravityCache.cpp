@@ -0,0 +1,405 @@
+#include "GravityCache.h"
+#include "Gravity.h"
+#include "core/Constants.h"
+#include "core/Random.h"
+#include "core/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    constexpr char FILE_MAGIC[8] = {'A', 'R', 'T', 'G', 'C', 'A', 'C', 'H'};
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+    constexpr size_t DATA_ALIGNMENT = 64;
+    constexpr size_t PROBES_PER_CHUNK = 256;
+    
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t degree;
+        uint32_t faceNodes;
+        uint32_t shellCount;
+        uint32_t reserved;
+        uint64_t fingerprint;
+        double minRadius;
+        double maxRadius;
+        double maxError;
+        double rmsError;
+        double maxRelativeError;
+        uint64_t errorSamples;
+        uint64_t dataOffset;
+        uint64_t dataCount;     // floats
+    };
+    
+    // Cube face f looks along axis f / 2, positive for even f; the face
+    // coordinates are the next two axes in cyclic order
+    constexpr int faceAxis(int face) { return face / 2; }
+    constexpr double faceSign(int face) { return (face % 2 == 0) ? 1.0 : -1.0; }
+    
+    size_t nodeCount(int faceNodes, int shellCount) {
+        size_t side = static_cast<size_t>(faceNodes) + 2;
+        return (static_cast<size_t>(shellCount) + 2) * 6 * side * side;
+    }
+    
+    // Catmull-Rom weights for nodes -1, 0, 1, 2 at t in [0, 1]
+    void splineWeights(double t, double w[4]) {
+        double t2 = t * t;
+        double t3 = t2 * t;
+        w[0] = 0.5 * (-t3 + 2.0 * t2 - t);
+        w[1] = 0.5 * (3.0 * t3 - 5.0 * t2 + 2.0);
+        w[2] = 0.5 * (-3.0 * t3 + 4.0 * t2 + t);
+        w[3] = 0.5 * (t3 - t2);
+    }
+    
+    // Cell containing coordinate x, measured in node spacings from the
+    // first node that is not a ghost; returns the cell's lower node index
+    // (ghosts included) and the position within it
+    int locateCell(double x, int nodes, double& outT) {
+        int cell = std::clamp(static_cast<int>(std::floor(x)), 0, nodes - 2);
+        outT = x - cell;
+        return cell + 1;
+    }
+    
+    void hashBytes(uint64_t& hash, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+    }
+}
+
+bool GravityCache::build(const GravityField& field, const BuildOptions& options, ThreadPool& pool,
+                         std::string& outError) {
+    int degree = std::min(options.degree, field.getDegree());
+    if (degree < 2) {
+        outError = "the gravity field has no terms above degree 1";
+        return false;
+    }
+    if (options.minRadius <= 0.0 || options.maxRadius <= options.minRadius) {
+        outError = "invalid radius range";
+        return false;
+    }
+    if (options.tolerance <= 0.0) {
+        outError = "tolerance must be positive";
+        return false;
+    }
+    
+    // First grid: about four nodes per wavelength of the highest degree
+    // along the face centers, and one shell per two decay lengths r / (n + 3)
+    // of the degree-n terms
+    int faceNodes = std::max(9, static_cast<int>(std::ceil(4.0 * degree / Constants::PI)) + 1);
+    int shellCount = std::max(4, static_cast<int>(std::ceil(
+        (options.maxRadius - options.minRadius) * (degree + 3) / (2.0 * options.minRadius))) + 1);
+    // The ghost shell below minRadius must stay clear of the center
+    shellCount = std::max(shellCount, static_cast<int>(std::ceil(
+        2.0 * (options.maxRadius - options.minRadius) / options.minRadius)) + 2);
+    if (nodeCount(faceNodes, shellCount) * 3 * sizeof(float) > options.maxBytes) {
+        outError = "the coarsest grid for degree " + std::to_string(degree) + " exceeds the size limit";
+        return false;
+    }
+    
+    uint64_t hash = fingerprint(field, degree);
+    size_t probes = std::max<size_t>(1000, options.errorSamples / 4);
+    for (;;) {
+        setGrid(degree, hash, options.minRadius, options.maxRadius, faceNodes, shellCount);
+        fill(field, pool);
+        
+        // Probes on the shells see only the angular interpolation error and
+        // probes along node directions only the radial one, so each axis
+        // is refined on its own
+        double target = 0.5 * options.tolerance;
+        double angularError = measure(field, probes, options.seed, Probe::OnShells, pool).maxError;
+        double radialError = measure(field, probes, options.seed, Probe::OnRays, pool).maxError;
+        if (angularError <= target && radialError <= target) {
+            break;
+        }
+        
+        // The spline error falls with the cube of the spacing
+        auto refine = [target](int nodes, double error) {
+            if (error <= target) return nodes;
+            double factor = std::clamp(1.1 * std::cbrt(error / target), 1.25, 4.0);
+            return static_cast<int>(std::ceil((nodes - 1) * factor)) + 1;
+        };
+        int nextFaceNodes = refine(faceNodes, angularError);
+        int nextShellCount = refine(shellCount, radialError);
+        if (nodeCount(nextFaceNodes, nextShellCount) * 3 * sizeof(float) > options.maxBytes) {
+            break;
+        }
+        faceNodes = nextFaceNodes;
+        shellCount = nextShellCount;
+    }
+    
+    m_report = measure(field, options.errorSamples, options.seed, Probe::Random, pool);
+    return true;
+}
+
+void GravityCache::setGrid(int degree, uint64_t fingerprint, double minRadius, double maxRadius,
+                           int faceNodes, int shellCount) {
+    m_file.close();
+    m_degree = degree;
+    m_fingerprint = fingerprint;
+    m_minRadius = minRadius;
+    m_maxRadius = maxRadius;
+    m_faceNodes = faceNodes;
+    m_shellCount = shellCount;
+    m_faceSpacing = 2.0 / (faceNodes - 1);
+    m_shellSpacing = (maxRadius - minRadius) / (shellCount - 1);
+    m_nodeCount = nodeCount(faceNodes, shellCount);
+    m_report = ErrorReport();
+}
+
+void GravityCache::fill(const GravityField& field, ThreadPool& pool) {
+    m_storage.assign(m_nodeCount * 3, 0.0f);
+    m_storage.shrink_to_fit();
+    m_data = m_storage.data();
+    
+    std::vector<GravityField::Workspace> workspaces(pool.getThreadCount() + 1);
+    const int side = m_faceNodes + 2;
+    const double mu = field.getMu();
+    
+    pool.parallelFor(static_cast<size_t>(m_shellCount + 2) * 6, [&](size_t task) {
+        GravityField::Workspace& workspace = workspaces[pool.getCurrentWorkerIndex()];
+        int shell = static_cast<int>(task / 6);
+        int face = static_cast<int>(task % 6);
+        float* out = m_storage.data() + task * side * side * 3;
+        for (int j = 0; j < side; ++j) {
+            for (int i = 0; i < side; ++i) {
+                glm::dvec3 position = nodePosition(shell, face, j, i);
+                glm::dvec3 a = field.acceleration(position, m_degree, workspace) - Gravity::pointMass(position, mu);
+                *out++ = static_cast<float>(a.x);
+                *out++ = static_cast<float>(a.y);
+                *out++ = static_cast<float>(a.z);
+            }
+        }
+    });
+}
+
+glm::dvec3 GravityCache::nodePosition(int shell, int face, int j, int i) const {
+    int axis = faceAxis(face);
+    glm::dvec3 direction(0.0);
+    direction[axis] = faceSign(face);
+    direction[(axis + 1) % 3] = -1.0 + (i - 1) * m_faceSpacing;
+    direction[(axis + 2) % 3] = -1.0 + (j - 1) * m_faceSpacing;
+    double radius = m_minRadius + (shell - 1) * m_shellSpacing;
+    return glm::normalize(direction) * radius;
+}
+
+glm::dvec3 GravityCache::perturbation(const glm::dvec3& position) const {
+    double ax = std::abs(position.x);
+    double ay = std::abs(position.y);
+    double az = std::abs(position.z);
+    int axis = (ax >= ay && ax >= az) ? 0 : (ay >= az ? 1 : 2);
+    double major = position[axis];
+    int face = 2 * axis + (major < 0.0 ? 1 : 0);
+    
+    double inverse = 1.0 / std::abs(major);
+    double u = position[(axis + 1) % 3] * inverse;
+    double v = position[(axis + 2) % 3] * inverse;
+    double r = std::sqrt(glm::dot(position, position));
+    
+    double ti, tj, tr;
+    int i = locateCell((u + 1.0) / m_faceSpacing, m_faceNodes, ti);
+    int j = locateCell((v + 1.0) / m_faceSpacing, m_faceNodes, tj);
+    int shell = locateCell((r - m_minRadius) / m_shellSpacing, m_shellCount, tr);
+    
+    double wi[4], wj[4], wr[4];
+    splineWeights(ti, wi);
+    splineWeights(tj, wj);
+    splineWeights(tr, wr);
+    
+    const size_t side = static_cast<size_t>(m_faceNodes) + 2;
+    double sx = 0.0, sy = 0.0, sz = 0.0;
+    for (int ks = 0; ks < 4; ++ks) {
+        size_t faceBase = (static_cast<size_t>(shell - 1 + ks) * 6 + face) * side * side;
+        double rx = 0.0, ry = 0.0, rz = 0.0;
+        for (int kj = 0; kj < 4; ++kj) {
+            // Four nodes along a row are 12 contiguous floats
+            const float* node = m_data + (faceBase + (j - 1 + kj) * side + (i - 1)) * 3;
+            double x = wi[0] * node[0] + wi[1] * node[3] + wi[2] * node[6] + wi[3] * node[9];
+            double y = wi[0] * node[1] + wi[1] * node[4] + wi[2] * node[7] + wi[3] * node[10];
+            double z = wi[0] * node[2] + wi[1] * node[5] + wi[2] * node[8] + wi[3] * node[11];
+            rx += wj[kj] * x;
+            ry += wj[kj] * y;
+            rz += wj[kj] * z;
+        }
+        sx += wr[ks] * rx;
+        sy += wr[ks] * ry;
+        sz += wr[ks] * rz;
+    }
+    return glm::dvec3(sx, sy, sz);
+}
+
+GravityCache::ErrorReport GravityCache::measureError(const GravityField& field, size_t samples, uint64_t seed,
+                                                     ThreadPool& pool) const {
+    return measure(field, samples, seed, Probe::Random, pool);
+}
+
+GravityCache::ErrorReport GravityCache::measure(const GravityField& field, size_t samples, uint64_t seed,
+                                                Probe probe, ThreadPool& pool) const {
+    struct ChunkResult {
+        double maxError = 0.0;
+        double sumSquares = 0.0;
+        double maxRelative = 0.0;
+    };
+    
+    size_t chunkCount = (samples + PROBES_PER_CHUNK - 1) / PROBES_PER_CHUNK;
+    std::vector<ChunkResult> chunks(chunkCount);
+    std::vector<GravityField::Workspace> workspaces(pool.getThreadCount() + 1);
+    const double mu = field.getMu();
+    
+    // One random stream per chunk, so the report does not depend on the
+    // thread count
+    pool.parallelFor(chunkCount, [&](size_t chunk) {
+        GravityField::Workspace& workspace = workspaces[pool.getCurrentWorkerIndex()];
+        CounterRng rng(seed, (static_cast<uint64_t>(probe) << 32) | chunk);
+        ChunkResult& result = chunks[chunk];
+        size_t end = std::min(samples, (chunk + 1) * PROBES_PER_CHUNK);
+        
+        for (size_t sample = chunk * PROBES_PER_CHUNK; sample < end; ++sample) {
+            glm::dvec3 position;
+            if (probe == Probe::OnRays) {
+                int face = static_cast<int>(rng.nextUint32() % 6);
+                int j = 1 + static_cast<int>(rng.nextUint32() % m_faceNodes);
+                int i = 1 + static_cast<int>(rng.nextUint32() % m_faceNodes);
+                glm::dvec3 direction = glm::normalize(nodePosition(1, face, j, i));
+                position = direction * (m_minRadius + rng.nextUniform() * (m_maxRadius - m_minRadius));
+            } else {
+                glm::dvec3 direction(rng.nextNormal(), rng.nextNormal(), rng.nextNormal());
+                direction = glm::normalize(direction);
+                double radius = (probe == Probe::OnShells)
+                    ? m_minRadius + (rng.nextUint32() % m_shellCount) * m_shellSpacing
+                    : m_minRadius + rng.nextUniform() * (m_maxRadius - m_minRadius);
+                position = direction * radius;
+            }
+            
+            glm::dvec3 exact = field.acceleration(position, m_degree, workspace);
+            glm::dvec3 expected = exact - Gravity::pointMass(position, mu);
+            double error = glm::length(perturbation(position) - expected);
+            result.maxError = std::max(result.maxError, error);
+            result.sumSquares += error * error;
+            result.maxRelative = std::max(result.maxRelative, error / glm::length(exact));
+        }
+    });
+    
+    ErrorReport report;
+    double sumSquares = 0.0;
+    for (const ChunkResult& chunk : chunks) {
+        report.maxError = std::max(report.maxError, chunk.maxError);
+        report.maxRelativeError = std::max(report.maxRelativeError, chunk.maxRelative);
+        sumSquares += chunk.sumSquares;
+    }
+    report.samples = samples;
+    report.rmsError = samples > 0 ? std::sqrt(sumSquares / samples) : 0.0;
+    return report;
+}
+
+bool GravityCache::save(const std::string& path, std::string& outError) const {
+    if (!isValid()) {
+        outError = "no cache to save";
+        return false;
+    }
+    
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.degree = static_cast<uint32_t>(m_degree);
+    header.faceNodes = static_cast<uint32_t>(m_faceNodes);
+    header.shellCount = static_cast<uint32_t>(m_shellCount);
+    header.fingerprint = m_fingerprint;
+    header.minRadius = m_minRadius;
+    header.maxRadius = m_maxRadius;
+    header.maxError = m_report.maxError;
+    header.rmsError = m_report.rmsError;
+    header.maxRelativeError = m_report.maxRelativeError;
+    header.errorSamples = m_report.samples;
+    header.dataOffset = (sizeof(FileHeader) + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+    header.dataCount = m_nodeCount * 3;
+    
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        outError = "cannot create '" + path + "'";
+        return false;
+    }
+    char padding[DATA_ALIGNMENT] = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(padding, static_cast<std::streamsize>(header.dataOffset - sizeof(header)));
+    file.write(reinterpret_cast<const char*>(m_data), static_cast<std::streamsize>(header.dataCount * sizeof(float)));
+    if (!file) {
+        outError = "cannot write '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool GravityCache::load(const std::string& path, std::string& outError) {
+    MappedFile file;
+    if (!file.open(path, outError)) {
+        return false;
+    }
+    
+    FileHeader header;
+    if (file.getSize() < sizeof(header)) {
+        outError = "'" + path + "' is not a gravity cache";
+        return false;
+    }
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        outError = "'" + path + "' is not a gravity cache";
+        return false;
+    }
+    if (header.version != FILE_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+        outError = "'" + path + "' was written by another version or a machine of different byte order";
+        return false;
+    }
+    if (header.faceNodes < 2 || header.shellCount < 2 || header.degree < 2 ||
+        header.degree > static_cast<uint32_t>(GravityField::MAX_DEGREE) ||
+        header.minRadius <= 0.0 || header.maxRadius <= header.minRadius ||
+        header.dataOffset % alignof(float) != 0 ||
+        header.dataCount != nodeCount(header.faceNodes, header.shellCount) * 3 ||
+        file.getSize() < header.dataOffset + header.dataCount * sizeof(float)) {
+        outError = "'" + path + "' is truncated or corrupt";
+        return false;
+    }
+    
+    setGrid(static_cast<int>(header.degree), header.fingerprint, header.minRadius, header.maxRadius,
+            static_cast<int>(header.faceNodes), static_cast<int>(header.shellCount));
+    m_report.maxError = header.maxError;
+    m_report.rmsError = header.rmsError;
+    m_report.maxRelativeError = header.maxRelativeError;
+    m_report.samples = header.errorSamples;
+    
+    m_storage.clear();
+    m_storage.shrink_to_fit();
+    m_file = std::move(file);
+    m_data = reinterpret_cast<const float*>(m_file.getData() + header.dataOffset);
+    return true;
+}
+
+uint64_t GravityCache::fingerprint(const GravityField& field, int degree) {
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ull;
+    degree = std::min(degree, field.getDegree());
+    double mu = field.getMu();
+    double radius = field.getReferenceRadius();
+    hashBytes(hash, &degree, sizeof(degree));
+    hashBytes(hash, &mu, sizeof(mu));
+    hashBytes(hash, &radius, sizeof(radius));
+    for (int n = 0; n <= degree; ++n) {
+        for (int m = 0; m <= n; ++m) {
+            double c = field.getC(n, m);
+            double s = field.getS(n, m);
+            hashBytes(hash, &c, sizeof(c));
+            hashBytes(hash, &s, sizeof(s));
+        }
+    }
+    return hash;
+}
+
+bool GravityCache::matches(const GravityField& field) const {
+    return isValid() && field.getDegree() >= m_degree && fingerprint(field, m_degree) == m_fingerprint;
+}
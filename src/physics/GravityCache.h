@@ -0,0 +1,122 @@
+#pragma once
+
+#include "GravityField.h"
+#include "core/MappedFile.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Precomputed perturbing acceleration (field minus point mass) of a
+// GravityField on a shell grid around the Moon, interpolated at runtime.
+//
+// Directions are indexed with a gnomonic cube sphere: the largest
+// coordinate picks one of six faces, and the other two divided by it give
+// face coordinates in [-1, 1]. Finding a cell needs no trigonometry and the
+// grid has no poles. Shells are evenly spaced in radius. Values are
+// interpolated with Catmull-Rom splines along all three axes (64 nodes),
+// which is continuous across cells within a face and reproduces quadratics
+// exactly. Adjacent faces sample different grids, so at a face edge the
+// value jumps by up to the interpolation error (at most the measured error
+// on each side). Every axis carries one extra node beyond each end, so the
+// stencil never leaves the grid.
+//
+// Each node stores the Moon-fixed acceleration as three floats. The
+// perturbation is at most a few hundredths of a m/s^2, so float rounding
+// stays far below any useful tolerance.
+//
+// Caches are saved to a binary file in native byte order and loaded with a
+// memory mapping. A fingerprint of the coefficients guards against using a
+// cache with a different field.
+class GravityCache {
+public:
+    struct BuildOptions {
+        int degree = GravityField::MAX_DEGREE;  // clamped to the field's degree
+        double minRadius = 0.0;                 // m, shell covered by the cache
+        double maxRadius = 0.0;                 // m
+        double tolerance = 1e-6;                // m/s^2, target max interpolation error
+        size_t maxBytes = 256u << 20;           // grid size cap
+        size_t errorSamples = 20000;            // random probes for the error report
+        uint64_t seed = 1;
+    };
+    
+    // Interpolation error against direct evaluation at random points in the
+    // shell
+    struct ErrorReport {
+        double maxError = 0.0;          // m/s^2
+        double rmsError = 0.0;          // m/s^2
+        double maxRelativeError = 0.0;  // of the full acceleration
+        size_t samples = 0;
+    };
+    
+    // Sample the field on a grid fine enough to meet options.tolerance. The
+    // grid is refined along whichever axis (angle or radius) misses the
+    // tolerance until it does or the next grid would exceed maxBytes; the
+    // final report then shows the error actually reached. Returns false for
+    // invalid options.
+    bool build(const GravityField& field, const BuildOptions& options, ThreadPool& pool,
+               std::string& outError);
+    
+    bool save(const std::string& path, std::string& outError) const;
+    bool load(const std::string& path, std::string& outError);
+    
+    // Error against direct evaluation of field at random points in the shell
+    ErrorReport measureError(const GravityField& field, size_t samples, uint64_t seed,
+                             ThreadPool& pool) const;
+    
+    // Hash of the field parameters and coefficients up to degree
+    static uint64_t fingerprint(const GravityField& field, int degree);
+    
+    // True if this cache was built from field (at any degree it provides)
+    bool matches(const GravityField& field) const;
+    
+    bool isValid() const { return m_data != nullptr; }
+    int getDegree() const { return m_degree; }
+    double getMinRadius() const { return m_minRadius; }
+    double getMaxRadius() const { return m_maxRadius; }
+    int getFaceNodes() const { return m_faceNodes; }
+    int getShellCount() const { return m_shellCount; }
+    size_t getByteSize() const { return m_nodeCount * 3 * sizeof(float); }
+    
+    // Report stored by build() and saved with the cache
+    const ErrorReport& getErrorReport() const { return m_report; }
+    
+    bool contains(const glm::dvec3& position) const {
+        double r2 = glm::dot(position, position);
+        return r2 >= m_minRadius * m_minRadius && r2 <= m_maxRadius * m_maxRadius;
+    }
+    
+    // Perturbing acceleration at a Moon-fixed position inside the shell
+    // (m/s^2); add the point mass for the total
+    glm::dvec3 perturbation(const glm::dvec3& position) const;
+
+private:
+    enum class Probe { Random, OnShells, OnRays };
+    
+    void setGrid(int degree, uint64_t fingerprint, double minRadius, double maxRadius,
+                 int faceNodes, int shellCount);
+    void fill(const GravityField& field, ThreadPool& pool);
+    ErrorReport measure(const GravityField& field, size_t samples, uint64_t seed, Probe probe,
+                        ThreadPool& pool) const;
+    
+    // Moon-fixed position of a grid node (indices include the ghost nodes)
+    glm::dvec3 nodePosition(int shell, int face, int j, int i) const;
+    
+    int m_degree = 0;
+    uint64_t m_fingerprint = 0;
+    double m_minRadius = 0.0;
+    double m_maxRadius = 0.0;
+    int m_faceNodes = 0;        // nodes spanning [-1, 1] on each face axis
+    int m_shellCount = 0;       // shells spanning [minRadius, maxRadius]
+    double m_faceSpacing = 0.0;
+    double m_shellSpacing = 0.0;
+    size_t m_nodeCount = 0;     // including ghost nodes
+    ErrorReport m_report;
+    
+    // Nodes as [shell][face][j][i][xyz], owned or memory-mapped
+    const float* m_data = nullptr;
+    std::vector<float> m_storage;
+    MappedFile m_file;
+};
@@ -0,0 +1,401 @@
+#include "GravityField.h"
+#include "CR3BP.h"
+#include "Ephemeris.h"
+#include "Gravity.h"
+#include "GravityCache.h"
+#include "core/Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    // Split a data line on commas and whitespace into numbers
+    bool parseFields(std::string line, std::vector<double>& outFields) {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream stream(line);
+        outFields.clear();
+        std::string token;
+        while (stream >> token) {
+            // Fortran-style exponents appear in some published tables
+            std::replace(token.begin(), token.end(), 'D', 'E');
+            std::replace(token.begin(), token.end(), 'd', 'e');
+            char* end = nullptr;
+            double value = std::strtod(token.c_str(), &end);
+            if (end == token.c_str() || *end != '\0') {
+                return false;
+            }
+            outFields.push_back(value);
+        }
+        return true;
+    }
+}
+
+bool GravityField::loadFromFile(const std::string& path, int maxDegree, std::string& outError) {
+    std::ifstream file(path);
+    if (!file) {
+        outError = "cannot open '" + path + "'";
+        return false;
+    }
+    
+    maxDegree = std::clamp(maxDegree, 0, MAX_DEGREE);
+    
+    double radius = 0.0;
+    double mu = 0.0;
+    bool haveHeader = false;
+    int degree = 0;
+    std::vector<double> c(index(maxDegree + 1, 0), 0.0);
+    std::vector<double> s(index(maxDegree + 1, 0), 0.0);
+    
+    std::string line;
+    std::vector<double> fields;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line = line.substr(0, comment);
+        }
+        if (!parseFields(line, fields)) {
+            outError = path + ":" + std::to_string(lineNumber) + ": invalid number";
+            return false;
+        }
+        if (fields.empty()) continue;
+        
+        if (!haveHeader) {
+            if (fields.size() < 2 || fields[0] <= 0.0 || fields[1] <= 0.0) {
+                outError = path + ":" + std::to_string(lineNumber) + ": expected 'R_ref_km, GM_km3_s2' header";
+                return false;
+            }
+            if (fields.size() >= 6 && fields[5] == 0.0) {
+                outError = path + ": unnormalized coefficients are not supported";
+                return false;
+            }
+            radius = fields[0] * 1000.0;
+            mu = fields[1] * 1e9;
+            haveHeader = true;
+            continue;
+        }
+        
+        if (fields.size() < 4) {
+            outError = path + ":" + std::to_string(lineNumber) + ": expected 'n, m, C, S'";
+            return false;
+        }
+        int n = static_cast<int>(fields[0]);
+        int m = static_cast<int>(fields[1]);
+        if (n != fields[0] || m != fields[1] || n < 0 || m < 0 || m > n) {
+            outError = path + ":" + std::to_string(lineNumber) + ": invalid degree/order";
+            return false;
+        }
+        if (n > maxDegree) continue;
+        
+        c[index(n, m)] = fields[2];
+        s[index(n, m)] = (m == 0) ? 0.0 : fields[3];
+        degree = std::max(degree, n);
+    }
+    
+    if (!haveHeader) {
+        outError = path + ": no header line";
+        return false;
+    }
+    
+    setCoefficients(mu, radius, degree, std::move(c), std::move(s));
+    return true;
+}
+
+void GravityField::setCoefficients(double mu, double referenceRadius, int degree,
+                                   std::vector<double> c, std::vector<double> s) {
+    degree = std::clamp(degree, 0, MAX_DEGREE);
+    c.resize(index(degree + 1, 0), 0.0);
+    s.resize(index(degree + 1, 0), 0.0);
+    c.shrink_to_fit();
+    s.shrink_to_fit();
+    
+    // The central term is the point mass itself, whatever the table says
+    c[0] = 1.0;
+    for (int n = 0; n <= degree; ++n) {
+        s[index(n, 0)] = 0.0;
+    }
+    
+    m_degree = degree;
+    m_mu = mu;
+    m_radius = referenceRadius;
+    m_c = std::move(c);
+    m_s = std::move(s);
+    precomputeFactors();
+}
+
+void GravityField::setPointMass(double mu, double referenceRadius) {
+    setCoefficients(mu, referenceRadius, 0, {}, {});
+}
+
+void GravityField::precomputeFactors() {
+    // Normalized forms of the Cunningham recursions (Montenbruck & Gill
+    // 3.2.4): each unnormalized coefficient times the ratio of the
+    // normalization factors N_nm = sqrt((2 - d_m0)(2n + 1)(n - m)! / (n + m)!)
+    int top = m_degree + 1;
+    size_t count = index(top + 1, 0);
+    m_sectoral.assign(top + 1, 0.0);
+    m_alpha.assign(count, 0.0);
+    m_beta.assign(count, 0.0);
+    
+    for (int m = 1; m <= top; ++m) {
+        double mm = m;
+        m_sectoral[m] = (m == 1) ? std::sqrt(3.0) : std::sqrt((2.0 * mm + 1.0) / (2.0 * mm));
+    }
+    for (int n = 1; n <= top; ++n) {
+        for (int m = 0; m < n; ++m) {
+            double nn = n, mm = m;
+            m_alpha[index(n, m)] = std::sqrt((2.0 * nn - 1.0) * (2.0 * nn + 1.0) / ((nn - mm) * (nn + mm)));
+            if (m <= n - 2) {
+                m_beta[index(n, m)] = std::sqrt((2.0 * nn + 1.0) * (nn + mm - 1.0) * (nn - mm - 1.0) /
+                                                ((2.0 * nn - 3.0) * (nn + mm) * (nn - mm)));
+            }
+        }
+    }
+    
+    // Acceleration factors, premultiplied into the coefficients
+    for (std::vector<double>* terms : {&m_cUp, &m_sUp, &m_cDown, &m_sDown, &m_cZ, &m_sZ}) {
+        terms->assign(m_c.size(), 0.0);
+    }
+    for (int n = 0; n <= m_degree; ++n) {
+        for (int m = 0; m <= n; ++m) {
+            double nn = n, mm = m;
+            double scale = (2.0 * nn + 1.0) / (2.0 * nn + 3.0);
+            size_t i = index(n, m);
+            double up = 0.0, down = 0.0;
+            if (m == 0) {
+                up = std::sqrt(scale * (nn + 1.0) * (nn + 2.0) / 2.0);
+            } else {
+                double orderRatio = (m == 1) ? 2.0 : 1.0;  // (2 - d_m0) / (2 - d_(m-1)0)
+                up = 0.5 * std::sqrt(scale * (nn + mm + 1.0) * (nn + mm + 2.0));
+                down = 0.5 * std::sqrt(scale * orderRatio * (nn - mm + 1.0) * (nn - mm + 2.0));
+            }
+            double z = std::sqrt(scale * (nn + mm + 1.0) * (nn - mm + 1.0));
+            m_cUp[i] = up * m_c[i];
+            m_sUp[i] = up * m_s[i];
+            m_cDown[i] = down * m_c[i];
+            m_sDown[i] = down * m_s[i];
+            m_cZ[i] = z * m_c[i];
+            m_sZ[i] = z * m_s[i];
+        }
+    }
+    
+    m_degreeBound.assign(m_degree + 1, 0.0);
+    for (int n = 2; n <= m_degree; ++n) {
+        double power = 0.0;
+        for (int m = 0; m <= n; ++m) {
+            power += m_c[index(n, m)] * m_c[index(n, m)] + m_s[index(n, m)] * m_s[index(n, m)];
+        }
+        m_degreeBound[n] = (2.0 * n + 1.0) * std::sqrt((n + 1.0) * power);
+    }
+}
+
+double GravityField::perturbationBound(double radius, int degree) const {
+    degree = std::min(degree, m_degree);
+    if (degree < 2 || radius <= 0.0) {
+        return 0.0;
+    }
+    
+    // Horner in R / r from the top degree down
+    double q = m_radius / radius;
+    double sum = 0.0;
+    for (int n = degree; n >= 2; --n) {
+        sum = (sum + m_degreeBound[n]) * q;
+    }
+    return m_mu / (radius * radius) * sum * q;
+}
+
+glm::dvec3 GravityField::acceleration(const glm::dvec3& position, int degree, Workspace& workspace) const {
+    double r2 = glm::dot(position, position);
+    degree = std::min(degree, m_degree);
+    if (degree < 2 || r2 <= 1.0) {
+        return Gravity::pointMass(position, m_mu);
+    }
+    std::array<double, 3> a = evaluate(std::array<double, 3>{position.x, position.y, position.z},
+                                       degree, workspace.v, workspace.w);
+    return glm::dvec3(a[0], a[1], a[2]);
+}
+
+glm::dvec3 GravityField::acceleration(const glm::dvec3& position, int degree, Workspace& workspace,
+                                      glm::dmat3& outGradient) const {
+    double r2 = glm::dot(position, position);
+    degree = std::min(degree, m_degree);
+    if (degree < 2 || r2 <= 1.0) {
+        return Gravity::pointMass(position, m_mu, outGradient);
+    }
+    DualVec3 a = evaluate(seedPosition(position), degree, workspace.dualV, workspace.dualW);
+    outGradient = dualJacobian(a);
+    return dualValue(a);
+}
+
+template <typename T>
+std::array<T, 3> GravityField::evaluate(const std::array<T, 3>& position, int degree,
+                                        std::vector<T>& vBuffer, std::vector<T>& wBuffer) const {
+    using std::sqrt;
+    
+    // V_nm and W_nm up to degree + 1, which the degree-n terms need
+    const int top = degree + 1;
+    size_t count = index(top + 1, 0);
+    if (vBuffer.size() < count) {
+        vBuffer.resize(count);
+        wBuffer.resize(count);
+    }
+    T* v = vBuffer.data();
+    T* w = wBuffer.data();
+    
+    T r2 = position[0] * position[0] + position[1] * position[1] + position[2] * position[2];
+    T rho = m_radius / r2;
+    T x = position[0] * rho;
+    T y = position[1] * rho;
+    T z = position[2] * rho;
+    T rho2 = m_radius * rho;   // (R / r)^2
+    
+    v[0] = m_radius / sqrt(r2);
+    w[0] = 0.0;
+    
+    // One degree at a time: the orders of a row depend only on the two
+    // rows before it, so the inner loop has no dependency chain
+    for (int n = 1; n <= top; ++n) {
+        T* vn = v + index(n, 0);
+        T* wn = w + index(n, 0);
+        const T* v1 = v + index(n - 1, 0);
+        const T* w1 = w + index(n - 1, 0);
+        const double* alpha = m_alpha.data() + index(n, 0);
+        
+        if (n >= 2) {
+            const T* v2 = v + index(n - 2, 0);
+            const T* w2 = w + index(n - 2, 0);
+            const double* beta = m_beta.data() + index(n, 0);
+            for (int m = 0; m <= n - 2; ++m) {
+                T a = alpha[m] * z;
+                T b = beta[m] * rho2;
+                vn[m] = a * v1[m] - b * v2[m];
+                wn[m] = a * w1[m] - b * w2[m];
+            }
+        }
+        
+        T a = alpha[n - 1] * z;
+        vn[n - 1] = a * v1[n - 1];
+        wn[n - 1] = a * w1[n - 1];
+        
+        // Multiple-angle step: (V + iW)_nn = f_n (x + iy) (V + iW)_(n-1)(n-1)
+        double f = m_sectoral[n];
+        vn[n] = f * (x * v1[n - 1] - y * w1[n - 1]);
+        wn[n] = f * (x * w1[n - 1] + y * v1[n - 1]);
+    }
+    
+    // Degree n, order m needs V_(n+1)(m-1), V_(n+1)m and V_(n+1)(m+1), all
+    // from row n + 1. Summed from the highest degree down so the small
+    // terms are not lost.
+    T ax = 0.0, ay = 0.0, az = 0.0;
+    for (int n = degree; n >= 0; --n) {
+        size_t row = index(n, 0);
+        const double* cUp = m_cUp.data() + row;
+        const double* sUp = m_sUp.data() + row;
+        const double* cDown = m_cDown.data() + row;
+        const double* sDown = m_sDown.data() + row;
+        const double* cZ = m_cZ.data() + row;
+        const double* sZ = m_sZ.data() + row;
+        const T* vn = v + index(n + 1, 0);
+        const T* wn = w + index(n + 1, 0);
+        
+        // Per-row partial sums keep the long accumulation chains short
+        T rx = -cUp[0] * vn[1];
+        T ry = -cUp[0] * wn[1];
+        T rz = -cZ[0] * vn[0];
+        for (int m = 1; m <= n; ++m) {
+            rx += cDown[m] * vn[m - 1] + sDown[m] * wn[m - 1] - cUp[m] * vn[m + 1] - sUp[m] * wn[m + 1];
+            ry += sDown[m] * vn[m - 1] - cDown[m] * wn[m - 1] + sUp[m] * vn[m + 1] - cUp[m] * wn[m + 1];
+            rz -= cZ[m] * vn[m] + sZ[m] * wn[m];
+        }
+        ax += rx;
+        ay += ry;
+        az += rz;
+    }
+    
+    double scale = m_mu / (m_radius * m_radius);
+    return {ax * scale, ay * scale, az * scale};
+}
+
+double GravityFieldForceModel::getRotationAngle(double time) const {
+    double primeMeridian = ephemeris ? ephemeris->getPrimeMeridian() : 0.0;
+    return primeMeridian + Constants::MOON_ROTATION_RATE * time;
+}
+
+void GravityFieldForceModel::setTime(double time) {
+    double angle = getRotationAngle(time);
+    m_cosRotation = std::cos(angle);
+    m_sinRotation = std::sin(angle);
+    if (ephemeris) {
+        ephemeris->getPositions(time, m_earthPosition, m_sunPosition);
+    } else if (circularEarth) {
+        m_earthPosition = CR3BP::earthPosition(time);
+    }
+}
+
+void GravityFieldForceModel::operator()(const SpacecraftState& state, glm::dvec3& outAccel,
+                                        glm::dvec3& outVelDeriv) const {
+    outVelDeriv = state.velocity;
+    const glm::dvec3& p = state.position;
+    
+    glm::dvec3 gravity;
+    if (!hasField()) {
+        gravity = Gravity::pointMass(p, mu);
+    } else {
+        glm::dvec3 fixed(m_cosRotation * p.x + m_sinRotation * p.y,
+                         -m_sinRotation * p.x + m_cosRotation * p.y,
+                         p.z);
+        glm::dvec3 a;
+        if (cache && cache->getDegree() == std::min(degree, field->getDegree()) && cache->contains(fixed)) {
+            a = Gravity::pointMass(fixed, field->getMu()) + cache->perturbation(fixed);
+        } else {
+            a = field->acceleration(fixed, degree, m_workspace);
+        }
+        gravity = glm::dvec3(m_cosRotation * a.x - m_sinRotation * a.y,
+                             m_sinRotation * a.x + m_cosRotation * a.y,
+                             a.z);
+    }
+    
+    if (ephemeris) {
+        gravity += Gravity::thirdBody(p, m_earthPosition, Constants::EARTH_MU) +
+                   Gravity::thirdBody(p, m_sunPosition, Constants::SUN_MU);
+    } else if (circularEarth) {
+        gravity += Gravity::thirdBody(p, m_earthPosition, Constants::EARTH_MU);
+    }
+    outAccel = gravity + thrustAccel;
+}
+
+void GravityFieldForceModel::operator()(const SpacecraftState& state, glm::dvec3& outAccel,
+                                        glm::dvec3& outVelDeriv, glm::dmat3& outGradient) const {
+    outVelDeriv = state.velocity;
+    const glm::dvec3& p = state.position;
+    
+    glm::dvec3 gravity;
+    if (!hasField()) {
+        gravity = Gravity::pointMass(p, mu, outGradient);
+    } else {
+        // fixed = R p and a = R^T a_fixed(R p), so the gradient is R^T G R
+        glm::dmat3 rotation(m_cosRotation, -m_sinRotation, 0.0,
+                            m_sinRotation, m_cosRotation, 0.0,
+                            0.0, 0.0, 1.0);
+        glm::dmat3 gradient;
+        glm::dvec3 a = field->acceleration(rotation * p, degree, m_workspace, gradient);
+        glm::dmat3 inverse = glm::transpose(rotation);
+        gravity = inverse * a;
+        outGradient = inverse * gradient * rotation;
+    }
+    
+    glm::dmat3 gradient;
+    if (ephemeris) {
+        gravity += Gravity::thirdBody(p, m_earthPosition, Constants::EARTH_MU, gradient);
+        outGradient += gradient;
+        gravity += Gravity::thirdBody(p, m_sunPosition, Constants::SUN_MU, gradient);
+        outGradient += gradient;
+    } else if (circularEarth) {
+        gravity += Gravity::thirdBody(p, m_earthPosition, Constants::EARTH_MU, gradient);
+        outGradient += gradient;
+    }
+    outAccel = gravity + thrustAccel;
+}
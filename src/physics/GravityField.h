@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Dual.h"
+#include "Spacecraft.h"
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+class Ephemeris;
+class GravityCache;
+
+// Spherical-harmonic gravity field in the Moon-fixed frame, with fully
+// normalized (4 pi) coefficients C_nm, S_nm as published for the GRAIL
+// solutions. Accelerations use the normalized Cunningham V_nm/W_nm
+// recursion, which is free of the pole singularity of latitude/longitude
+// formulations. The sectoral terms V_mm, W_mm carry cos(m lon) and
+// sin(m lon) and are built once per evaluation by complex multiplication,
+// then shared by every degree of that order.
+//
+// The field is immutable after loading and can be shared between threads;
+// each thread needs its own Workspace.
+class GravityField {
+public:
+    static constexpr int MAX_DEGREE = 1200;
+    
+    struct Workspace {
+        std::vector<double> v;
+        std::vector<double> w;
+        
+        // For the gradient
+        std::vector<Dual<3>> dualV;
+        std::vector<Dual<3>> dualW;
+    };
+    
+    // Load a coefficient table. The first data line is the header
+    // "R_ref_km, GM_km3_s2[, sigma_GM, degree, order, normalized, ...]",
+    // followed by one "n, m, C_nm, S_nm[, sigma_C, sigma_S]" line per
+    // coefficient; commas or whitespace separate fields and '#' starts a
+    // comment. Terms above maxDegree are ignored.
+    bool loadFromFile(const std::string& path, int maxDegree, std::string& outError);
+    
+    // Set the coefficients directly; c and s are triangular arrays indexed
+    // n (n + 1) / 2 + m for n up to degree. C_00 is forced to 1.
+    void setCoefficients(double mu, double referenceRadius, int degree,
+                         std::vector<double> c, std::vector<double> s);
+    
+    // Point mass only (degree 0)
+    void setPointMass(double mu, double referenceRadius);
+    
+    static size_t index(int n, int m) { return static_cast<size_t>(n) * (n + 1) / 2 + m; }
+    
+    int getDegree() const { return m_degree; }
+    double getMu() const { return m_mu; }
+    double getReferenceRadius() const { return m_radius; }
+    double getC(int n, int m) const { return m_c[index(n, m)]; }
+    double getS(int n, int m) const { return m_s[index(n, m)]; }
+    
+    // Acceleration at a Moon-fixed position (m/s^2), truncated at degree
+    // (clamped to the loaded degree; below 2 this is the point mass)
+    glm::dvec3 acceleration(const glm::dvec3& position, int degree, Workspace& workspace) const;
+    
+    // The same with its gradient d a / d position. The recursion runs on
+    // Dual<3>, which costs five to six times the plain evaluation.
+    glm::dvec3 acceleration(const glm::dvec3& position, int degree, Workspace& workspace,
+                            glm::dmat3& outGradient) const;
+    
+    // Upper bound on the magnitude of the terms of degree 2 to degree (the
+    // acceleration minus the point mass) anywhere at or above radius. By
+    // the addition theorem, degree n contributes at most
+    // (GM / r^2) (R / r)^n (2n + 1) sqrt(n + 1) sigma_n, where sigma_n^2 is
+    // the sum of C_nm^2 + S_nm^2 over its orders.
+    double perturbationBound(double radius, int degree) const;
+
+private:
+    void precomputeFactors();
+    
+    // The recursion and sums for double or Dual<3>, degree >= 2
+    template <typename T>
+    std::array<T, 3> evaluate(const std::array<T, 3>& position, int degree,
+                              std::vector<T>& vBuffer, std::vector<T>& wBuffer) const;
+    
+    int m_degree = 0;
+    double m_mu = 0.0;
+    double m_radius = 1.0;
+    std::vector<double> m_c;
+    std::vector<double> m_s;
+    
+    // Recursion factors, up to degree m_degree + 1
+    std::vector<double> m_sectoral;  // V_mm from V_(m-1)(m-1)
+    std::vector<double> m_alpha;     // V_nm from V_(n-1)m
+    std::vector<double> m_beta;      // V_nm from V_(n-2)m
+    
+    // Acceleration factors times C_nm and S_nm
+    std::vector<double> m_cUp, m_sUp;      // order m+1 terms (x, y)
+    std::vector<double> m_cDown, m_sDown;  // order m-1 terms (x, y)
+    std::vector<double> m_cZ, m_sZ;        // order m terms (z)
+    
+    // (2n + 1) sqrt(n + 1) sigma_n per degree, for perturbationBound()
+    std::vector<double> m_degreeBound;
+};
+
+// Field gravity, optional Earth and Sun third-body perturbations (or the
+// CR3BP's circular Earth), and a thrust acceleration held constant over the
+// step. The Moon's orientation and the third-body positions are those of
+// the last setTime() and are held between calls; over a step, or over a 2
+// hour prediction, the Moon turns by at most 1 deg and the Earth moves by
+// about 1 deg about it. Without a field (or below degree 2) the central
+// term is a point mass of mu. Satisfies DerivativeModel and
+// DifferentiableModel (the gradient bypasses the cache); each copy owns its
+// scratch space, so give every thread its own instance.
+struct GravityFieldForceModel {
+    double mu = 0.0;
+    const GravityField* field = nullptr;
+    int degree = 0;
+    
+    // Optional precomputed field, used inside its shell when it was built
+    // from field at the degree in use
+    const GravityCache* cache = nullptr;
+    
+    // Optional Earth and Sun perturbations
+    const Ephemeris* ephemeris = nullptr;
+    
+    // Earth on its circular CR3BP orbit instead (no Sun). With no field
+    // this is the Earth-Moon CR3BP written in the inertial frame.
+    bool circularEarth = false;
+    
+    glm::dvec3 thrustAccel{0.0};
+    
+    // Orient the Moon-fixed field and place the third bodies at a
+    // simulation time (seconds since Constants::EPOCH_JULIAN_DATE)
+    void setTime(double time);
+    
+    // Rotation of the Moon-fixed frame about z at a simulation time: the
+    // sidereal rate from the ephemeris' prime meridian, or from +x without
+    // an ephemeris
+    double getRotationAngle(double time) const;
+    
+    bool hasField() const { return field && degree >= 2 && field->getDegree() >= 2; }
+    
+    // Central point mass only: the case the analytic Kepler coast covers.
+    // Otherwise the model depends on time and needs setTime() per step.
+    bool isPointMass() const { return !hasField() && !ephemeris && !circularEarth; }
+    
+    // Exactly the CR3BP, which CR3BP::propagate integrates faster
+    bool isCR3BP() const { return circularEarth && !hasField() && !ephemeris; }
+    
+    void operator()(const SpacecraftState& state, glm::dvec3& outAccel, glm::dvec3& outVelDeriv) const;
+    void operator()(const SpacecraftState& state, glm::dvec3& outAccel, glm::dvec3& outVelDeriv,
+                    glm::dmat3& outGradient) const;
+
+private:
+    double m_cosRotation = 1.0;
+    double m_sinRotation = 0.0;
+    glm::dvec3 m_earthPosition{0.0};
+    glm::dvec3 m_sunPosition{0.0};
+    mutable GravityField::Workspace m_workspace;
+};
@@ -0,0 +1,540 @@
+#include "HaloFamily.h"
+#include "CR3BP.h"
+#include "core/Constants.h"
+#include "core/MappedFile.h"
+#include "core/ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+
+namespace {
+    constexpr char FILE_MAGIC[8] = {'A', 'R', 'T', 'H', 'A', 'L', 'O', 'F'};
+    constexpr uint32_t FILE_VERSION = 1;
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+    
+    constexpr double SYNODIC_MONTH = 29.530589 * Constants::SECONDS_PER_DAY;
+    constexpr double CONTINUATION_TOLERANCE = 1e-8;     // first pass
+    constexpr int STEP_HALVINGS = 4;                    // retries of a failed continuation step
+    constexpr int MAX_STEPS = 200000;
+    constexpr double PLANAR_LIMIT = 1e-3;               // |z0| where halos meet the planar Lyapunov family
+    
+    constexpr int STATE_SIZE = 6;
+    constexpr int FULL_SIZE = STATE_SIZE + STATE_SIZE * STATE_SIZE;
+    
+    // State followed by the STM, row-major
+    using Vector = std::array<double, FULL_SIZE>;
+    using Parameters = std::array<double, 4>;   // x0, z0, vy0, T
+    
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t memberCount;
+        uint32_t reserved;
+        double massRatio;
+        double distance;
+    };
+    
+    struct FileMember {
+        double x0, z0, vy0, period;
+        double jacobi;
+        double periluneRadius, apoluneRadius;
+        double stabilityIndex;
+        double closureError;
+    };
+    
+    // Equations of motion in normalized units; with size FULL_SIZE also the
+    // variational equations dPhi/dt = A Phi, A = [[0, I], [Uxx, 2 Omega]]
+    void derivatives(const Vector& y, int size, Vector& out) {
+        const double mu = CR3BP::MASS_RATIO;
+        double dx1 = y[0] + mu;
+        double dx2 = y[0] - 1.0 + mu;
+        double yz2 = y[1] * y[1] + y[2] * y[2];
+        double r1sq = dx1 * dx1 + yz2;
+        double r2sq = dx2 * dx2 + yz2;
+        double r1 = std::sqrt(r1sq);
+        double r2 = std::sqrt(r2sq);
+        double k1 = (1.0 - mu) / (r1sq * r1);
+        double k2 = mu / (r2sq * r2);
+        
+        out[0] = y[3];
+        out[1] = y[4];
+        out[2] = y[5];
+        out[3] = 2.0 * y[4] + y[0] - k1 * dx1 - k2 * dx2;
+        out[4] = -2.0 * y[3] + y[1] - (k1 + k2) * y[1];
+        out[5] = -(k1 + k2) * y[2];
+        if (size == STATE_SIZE) {
+            return;
+        }
+        
+        // Hessian of the pseudo-potential U = (x^2 + y^2)/2 + (1 - mu)/r1 + mu/r2
+        double l1 = 3.0 * k1 / r1sq;
+        double l2 = 3.0 * k2 / r2sq;
+        double uxx = 1.0 - k1 - k2 + l1 * dx1 * dx1 + l2 * dx2 * dx2;
+        double uyy = 1.0 - k1 - k2 + (l1 + l2) * y[1] * y[1];
+        double uzz = -k1 - k2 + (l1 + l2) * y[2] * y[2];
+        double uxy = (l1 * dx1 + l2 * dx2) * y[1];
+        double uxz = (l1 * dx1 + l2 * dx2) * y[2];
+        double uyz = (l1 + l2) * y[1] * y[2];
+        
+        const double* phi = y.data() + STATE_SIZE;
+        double* dphi = out.data() + STATE_SIZE;
+        for (int j = 0; j < STATE_SIZE; ++j) {
+            double p0 = phi[j], p1 = phi[6 + j], p2 = phi[12 + j];
+            double p3 = phi[18 + j], p4 = phi[24 + j], p5 = phi[30 + j];
+            dphi[j] = p3;
+            dphi[6 + j] = p4;
+            dphi[12 + j] = p5;
+            dphi[18 + j] = uxx * p0 + uxy * p1 + uxz * p2 + 2.0 * p4;
+            dphi[24 + j] = uxy * p0 + uyy * p1 + uyz * p2 - 2.0 * p3;
+            dphi[30 + j] = uxz * p0 + uyz * p1 + uzz * p2;
+        }
+    }
+    
+    double moonDistance(const Vector& y) {
+        double dx = y[0] - (1.0 - CR3BP::MASS_RATIO);
+        return std::sqrt(dx * dx + y[1] * y[1] + y[2] * y[2]);
+    }
+    
+    // Dormand-Prince 5(4) over the first size components, with error
+    // control on all of them. Tracks the distance from the Moon at step
+    // ends. Returns false if the step size collapses.
+    bool integrate(Vector& y, int size, double duration, double tolerance,
+                   double& minRadius, double& maxRadius) {
+        static constexpr double a21 = 1.0 / 5.0;
+        static constexpr double a31 = 3.0 / 40.0, a32 = 9.0 / 40.0;
+        static constexpr double a41 = 44.0 / 45.0, a42 = -56.0 / 15.0, a43 = 32.0 / 9.0;
+        static constexpr double a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0, a53 = 64448.0 / 6561.0,
+                                a54 = -212.0 / 729.0;
+        static constexpr double a61 = 9017.0 / 3168.0, a62 = -355.0 / 33.0, a63 = 46732.0 / 5247.0,
+                                a64 = 49.0 / 176.0, a65 = -5103.0 / 18656.0;
+        static constexpr double b1 = 35.0 / 384.0, b3 = 500.0 / 1113.0, b4 = 125.0 / 192.0,
+                                b5 = -2187.0 / 6784.0, b6 = 11.0 / 84.0;
+        static constexpr double e1 = 71.0 / 57600.0, e3 = -71.0 / 16695.0, e4 = 71.0 / 1920.0,
+                                e5 = -17253.0 / 339200.0, e6 = 22.0 / 525.0, e7 = -1.0 / 40.0;
+        
+        Vector k1, k2, k3, k4, k5, k6, k7, stage, next;
+        double t = 0.0;
+        double h = std::min(duration, 1e-3);
+        minRadius = maxRadius = moonDistance(y);
+        derivatives(y, size, k1);
+        
+        for (int steps = 0; t < duration; ++steps) {
+            if (steps >= MAX_STEPS || h < 1e-14) {
+                return false;
+            }
+            bool last = (h >= duration - t);
+            if (last) {
+                h = duration - t;
+            }
+            
+            for (int i = 0; i < size; ++i) stage[i] = y[i] + h * a21 * k1[i];
+            derivatives(stage, size, k2);
+            for (int i = 0; i < size; ++i) stage[i] = y[i] + h * (a31 * k1[i] + a32 * k2[i]);
+            derivatives(stage, size, k3);
+            for (int i = 0; i < size; ++i) stage[i] = y[i] + h * (a41 * k1[i] + a42 * k2[i] + a43 * k3[i]);
+            derivatives(stage, size, k4);
+            for (int i = 0; i < size; ++i) {
+                stage[i] = y[i] + h * (a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i]);
+            }
+            derivatives(stage, size, k5);
+            for (int i = 0; i < size; ++i) {
+                stage[i] = y[i] + h * (a61 * k1[i] + a62 * k2[i] + a63 * k3[i] + a64 * k4[i] + a65 * k5[i]);
+            }
+            derivatives(stage, size, k6);
+            for (int i = 0; i < size; ++i) {
+                next[i] = y[i] + h * (b1 * k1[i] + b3 * k3[i] + b4 * k4[i] + b5 * k5[i] + b6 * k6[i]);
+            }
+            derivatives(next, size, k7);
+            
+            double sum = 0.0;
+            for (int i = 0; i < size; ++i) {
+                double error = h * (e1 * k1[i] + e3 * k3[i] + e4 * k4[i] + e5 * k5[i] + e6 * k6[i] + e7 * k7[i]);
+                double scale = tolerance * (1.0 + std::max(std::abs(y[i]), std::abs(next[i])));
+                sum += (error / scale) * (error / scale);
+            }
+            double error = std::sqrt(sum / size);
+            
+            if (error <= 1.0) {
+                t = last ? duration : t + h;
+                y = next;
+                k1 = k7;
+                double radius = moonDistance(y);
+                minRadius = std::min(minRadius, radius);
+                maxRadius = std::max(maxRadius, radius);
+            }
+            h *= std::clamp(0.9 * std::pow(std::max(error, 1e-10), -0.2), 0.2, 5.0);
+        }
+        return true;
+    }
+    
+    Parameters toParameters(const HaloFamily::Member& member) {
+        return {member.x0, member.z0, member.vy0, member.period};
+    }
+    
+    void setParameters(HaloFamily::Member& member, const Parameters& x) {
+        member.x0 = x[0];
+        member.z0 = x[1];
+        member.vy0 = x[2];
+        member.period = x[3];
+    }
+    
+    Vector initialVector(const HaloFamily::Member& member) {
+        Vector y{};
+        y[0] = member.x0;
+        y[2] = member.z0;
+        y[4] = member.vy0;
+        for (int i = 0; i < STATE_SIZE; ++i) {
+            y[STATE_SIZE + i * STATE_SIZE + i] = 1.0;
+        }
+        return y;
+    }
+    
+    double jacobiConstant(const Vector& y) {
+        const double mu = CR3BP::MASS_RATIO;
+        double r1 = std::sqrt((y[0] + mu) * (y[0] + mu) + y[1] * y[1] + y[2] * y[2]);
+        double r2 = moonDistance(y);
+        return y[0] * y[0] + y[1] * y[1] + 2.0 * (1.0 - mu) / r1 + 2.0 * mu / r2
+             - (y[3] * y[3] + y[4] * y[4] + y[5] * y[5]);
+    }
+    
+    double determinant3(const double m[3][3]) {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+             - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+             + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    }
+    
+    // Unit vector spanning the null space of the 3x4 constraint Jacobian:
+    // the family's tangent. Components are the signed 3x3 minors.
+    Parameters nullVector(const double jacobian[3][4]) {
+        Parameters t{};
+        double norm = 0.0;
+        for (int skip = 0; skip < 4; ++skip) {
+            double minor[3][3];
+            for (int row = 0; row < 3; ++row) {
+                for (int col = 0, k = 0; col < 4; ++col) {
+                    if (col != skip) minor[row][k++] = jacobian[row][col];
+                }
+            }
+            t[skip] = ((skip % 2 == 0) ? 1.0 : -1.0) * determinant3(minor);
+            norm += t[skip] * t[skip];
+        }
+        norm = std::sqrt(norm);
+        for (double& component : t) component /= norm;
+        return t;
+    }
+    
+    // Solve a x = b in place by Gaussian elimination with partial pivoting
+    bool solve4(double a[4][4], double b[4]) {
+        for (int col = 0; col < 4; ++col) {
+            int pivot = col;
+            for (int row = col + 1; row < 4; ++row) {
+                if (std::abs(a[row][col]) > std::abs(a[pivot][col])) pivot = row;
+            }
+            if (std::abs(a[pivot][col]) < 1e-300) {
+                return false;
+            }
+            std::swap(a[col], a[pivot]);
+            std::swap(b[col], b[pivot]);
+            for (int row = col + 1; row < 4; ++row) {
+                double factor = a[row][col] / a[col][col];
+                for (int k = col; k < 4; ++k) a[row][k] -= factor * a[col][k];
+                b[row] -= factor * b[col];
+            }
+        }
+        for (int row = 3; row >= 0; --row) {
+            for (int k = row + 1; k < 4; ++k) b[row] -= a[row][k] * b[k];
+            b[row] /= a[row][row];
+        }
+        return true;
+    }
+    
+    // Newton iteration on the half-period crossing conditions
+    // F(x) = (y, vx, vz)(T/2) = 0, closed with the pseudo-arclength condition
+    // (x - anchor) . tangent = step. On success outJacobian holds dF/dx at
+    // the corrected member and outMinRadius the perilune distance.
+    bool correct(HaloFamily::Member& member, const Parameters& anchor, const Parameters& tangent,
+                 double step, double tolerance, int maxIterations,
+                 double outJacobian[3][4], double& outMinRadius) {
+        double integrationTolerance = std::max(0.01 * tolerance, 1e-14);
+        for (int iteration = 0; iteration <= maxIterations; ++iteration) {
+            Vector y = initialVector(member);
+            double maxRadius = 0.0;
+            if (!integrate(y, FULL_SIZE, 0.5 * member.period, integrationTolerance, outMinRadius, maxRadius)) {
+                return false;
+            }
+            Vector rate;
+            derivatives(y, STATE_SIZE, rate);
+            
+            // Rows y, vx, vz; columns x0, z0, vy0 from the STM, and T, which
+            // moves the end point along the flow at half rate
+            const int rows[3] = {1, 3, 5};
+            const int cols[3] = {0, 2, 4};
+            Parameters x = toParameters(member);
+            double residual[4];
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    outJacobian[i][j] = y[STATE_SIZE + rows[i] * STATE_SIZE + cols[j]];
+                }
+                outJacobian[i][3] = 0.5 * rate[rows[i]];
+                residual[i] = y[rows[i]];
+            }
+            residual[3] = -step;
+            for (int j = 0; j < 4; ++j) {
+                residual[3] += (x[j] - anchor[j]) * tangent[j];
+            }
+            
+            double worst = 0.0;
+            for (double r : residual) worst = std::max(worst, std::abs(r));
+            if (worst <= tolerance) {
+                return true;
+            }
+            if (iteration == maxIterations) {
+                break;
+            }
+            
+            double a[4][4];
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 4; ++j) a[i][j] = outJacobian[i][j];
+            }
+            for (int j = 0; j < 4; ++j) a[3][j] = tangent[j];
+            if (!solve4(a, residual)) {
+                return false;
+            }
+            for (int j = 0; j < 4; ++j) x[j] -= residual[j];
+            if (!(x[3] > 0.0)) {
+                return false;
+            }
+            setParameters(member, x);
+        }
+        return false;
+    }
+    
+    // Full-period propagation: closure, extent and monodromy stability
+    bool characterize(HaloFamily::Member& member, double tolerance) {
+        Vector y0 = initialVector(member);
+        Vector y = y0;
+        double minRadius = 0.0, maxRadius = 0.0;
+        if (!integrate(y, FULL_SIZE, member.period, std::max(0.01 * tolerance, 1e-14), minRadius, maxRadius)) {
+            return false;
+        }
+        
+        double closure = 0.0;
+        for (int i = 0; i < STATE_SIZE; ++i) {
+            closure += (y[i] - y0[i]) * (y[i] - y0[i]);
+        }
+        
+        // The monodromy matrix M is symplectic with eigenvalues 1, 1,
+        // l1, 1/l1, l2, 1/l2. With s = l + 1/l, tr M = 2 + s1 + s2 and
+        // tr M^2 = s1^2 + s2^2 - 2, so s1, s2 follow from two traces.
+        const double* m = y.data() + STATE_SIZE;
+        double trace = 0.0, trace2 = 0.0;
+        for (int i = 0; i < STATE_SIZE; ++i) {
+            trace += m[i * STATE_SIZE + i];
+            for (int k = 0; k < STATE_SIZE; ++k) {
+                trace2 += m[i * STATE_SIZE + k] * m[k * STATE_SIZE + i];
+            }
+        }
+        double sum = trace - 2.0;
+        double product = 0.5 * (sum * sum - (trace2 + 2.0));
+        double discriminant = sum * sum - 4.0 * product;
+        double largest = (discriminant >= 0.0)
+            ? 0.5 * (std::abs(sum) + std::sqrt(discriminant))
+            : std::sqrt(std::abs(product));     // complex pair of equal modulus
+        
+        member.jacobi = jacobiConstant(y0);
+        member.periluneRadius = minRadius * CR3BP::DISTANCE;
+        member.apoluneRadius = maxRadius * CR3BP::DISTANCE;
+        member.stabilityIndex = 0.5 * largest;
+        member.closureError = std::sqrt(closure);
+        return true;
+    }
+}
+
+HaloFamily::Member HaloFamily::nrhoSeed() {
+    Member seed;
+    seed.x0 = 1.022028214025913;
+    seed.z0 = -0.182101394052293;
+    seed.vy0 = -0.103270947609587;
+    seed.period = 2.0 * SYNODIC_MONTH / 9.0 * CR3BP::getMeanMotion();
+    return seed;
+}
+
+bool HaloFamily::generate(const Member& seed, const Options& options, ThreadPool& pool,
+                          std::vector<Member>& outMembers, std::string& outError) {
+    // First pass: the seed with its period held, then walk both ways
+    Member start = seed;
+    double jacobian[3][4];
+    double minRadius = 0.0;
+    if (!correct(start, toParameters(seed), Parameters{0.0, 0.0, 0.0, 1.0}, 0.0,
+                 CONTINUATION_TOLERANCE, options.maxIterations, jacobian, minRadius)) {
+        outError = "seed orbit did not converge";
+        return false;
+    }
+    
+    const Parameters startTangent = nullVector(jacobian);
+    std::deque<Member> members{start};
+    std::deque<Parameters> tangents{startTangent};
+    const double minRadiusAllowed = (Constants::MOON_RADIUS + options.minPeriluneAltitude) / CR3BP::DISTANCE;
+    
+    for (double side : {-1.0, 1.0}) {
+        Member current = start;
+        Parameters tangent = startTangent;
+        for (double& component : tangent) component *= side;
+        
+        for (int count = 0; count < options.membersPerSide; ++count) {
+            Member next;
+            bool converged = false;
+            double step = options.stepSize;
+            for (int attempt = 0; attempt <= STEP_HALVINGS && !converged; ++attempt, step *= 0.5) {
+                Parameters x = toParameters(current);
+                for (int j = 0; j < 4; ++j) x[j] += step * tangent[j];
+                setParameters(next, x);
+                converged = correct(next, toParameters(current), tangent, step, CONTINUATION_TOLERANCE,
+                                    options.maxIterations, jacobian, minRadius);
+            }
+            // Stop at the surface, or where the family turns planar
+            if (!converged || minRadius < minRadiusAllowed ||
+                next.z0 * start.z0 <= 0.0 || std::abs(next.z0) < PLANAR_LIMIT) {
+                break;
+            }
+            
+            // Keep walking the same way along the curve
+            Parameters nextTangent = nullVector(jacobian);
+            double dot = 0.0;
+            for (int j = 0; j < 4; ++j) dot += nextTangent[j] * tangent[j];
+            if (dot < 0.0) {
+                for (double& component : nextTangent) component = -component;
+            }
+            
+            if (side < 0.0) {
+                members.push_front(next);
+                tangents.push_front(nextTangent);
+            } else {
+                members.push_back(next);
+                tangents.push_back(nextTangent);
+            }
+            current = next;
+            tangent = nextTangent;
+        }
+    }
+    
+    // Second pass: polish and characterize every member independently,
+    // holding each on the hyperplane through its first-pass solution
+    std::vector<Member> polished(members.begin(), members.end());
+    std::vector<char> valid(polished.size(), 0);
+    pool.parallelFor(polished.size(), [&](size_t i) {
+        double localJacobian[3][4];
+        double localMinRadius = 0.0;
+        valid[i] = correct(polished[i], toParameters(polished[i]), tangents[i], 0.0, options.tolerance,
+                           options.maxIterations, localJacobian, localMinRadius)
+                && characterize(polished[i], options.tolerance);
+    });
+    
+    outMembers.clear();
+    for (size_t i = 0; i < polished.size(); ++i) {
+        if (valid[i]) {
+            outMembers.push_back(polished[i]);
+        }
+    }
+    return true;
+}
+
+HaloFamily::Member HaloFamily::mirror(const Member& member) {
+    Member mirrored = member;
+    mirrored.z0 = -member.z0;
+    return mirrored;
+}
+
+std::string HaloFamily::describe(const Member& member) {
+    const char* point = (member.x0 > 1.0 - CR3BP::MASS_RATIO) ? "L2" : "L1";
+    const char* branch = (member.z0 < 0.0) ? "South" : "North";
+    double days = member.period / CR3BP::getMeanMotion() / Constants::SECONDS_PER_DAY;
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s %s halo, %.2f d, perilune %.0f km",
+                  point, branch, days, member.periluneRadius / 1000.0);
+    return label;
+}
+
+bool HaloFamily::save(const std::string& path, const std::vector<Member>& members, std::string& outError) {
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.memberCount = static_cast<uint32_t>(members.size());
+    header.massRatio = CR3BP::MASS_RATIO;
+    header.distance = CR3BP::DISTANCE;
+    
+    std::vector<FileMember> records;
+    records.reserve(members.size());
+    for (const Member& m : members) {
+        records.push_back({m.x0, m.z0, m.vy0, m.period, m.jacobi, m.periluneRadius, m.apoluneRadius,
+                           m.stabilityIndex, m.closureError});
+    }
+    
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        outError = "cannot create '" + path + "'";
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()),
+               static_cast<std::streamsize>(records.size() * sizeof(FileMember)));
+    if (!file) {
+        outError = "cannot write '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool HaloFamily::load(const std::string& path, std::vector<Member>& outMembers, std::string& outError) {
+    MappedFile file;
+    if (!file.open(path, outError)) {
+        return false;
+    }
+    
+    FileHeader header;
+    if (file.getSize() < sizeof(header)) {
+        outError = "'" + path + "' is not a halo family table";
+        return false;
+    }
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        outError = "'" + path + "' is not a halo family table";
+        return false;
+    }
+    if (header.version != FILE_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+        outError = "'" + path + "' was written by another version or a machine of different byte order";
+        return false;
+    }
+    if (file.getSize() != sizeof(header) + header.memberCount * sizeof(FileMember)) {
+        outError = "'" + path + "' is truncated or corrupt";
+        return false;
+    }
+    if (header.massRatio != CR3BP::MASS_RATIO || header.distance != CR3BP::DISTANCE) {
+        outError = "'" + path + "' was generated for other Earth-Moon parameters; regenerate it with artemis-halo-family";
+        return false;
+    }
+    
+    outMembers.resize(header.memberCount);
+    for (uint32_t i = 0; i < header.memberCount; ++i) {
+        FileMember record;
+        std::memcpy(&record, file.getData() + sizeof(header) + i * sizeof(FileMember), sizeof(record));
+        Member& m = outMembers[i];
+        m.x0 = record.x0;
+        m.z0 = record.z0;
+        m.vy0 = record.vy0;
+        m.period = record.period;
+        m.jacobi = record.jacobi;
+        m.periluneRadius = record.periluneRadius;
+        m.apoluneRadius = record.apoluneRadius;
+        m.stabilityIndex = record.stabilityIndex;
+        m.closureError = record.closureError;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Families of periodic halo orbits of the Earth-Moon CR3BP, from classic
+// halos to near-rectilinear ones, generated by differential correction and
+// pseudo-arclength continuation from a seed orbit.
+//
+// Works in the normalized rotating frame of CR3BP.h, with its own
+// equations of motion, variational equations for the state transition
+// matrix (STM) and integrator, so it does not depend on the simulation's
+// force models. Halos are symmetric about the xz plane. A member is fixed
+// by where it crosses that plane heading in y, (x0, 0, z0) with velocity
+// (0, vy0, 0), and its period T. It is periodic when the half-period state
+// crosses the plane perpendicularly again: y = vx = vz = 0 at T/2.
+//
+// Continuation runs in two passes. The first walks the family at a loose
+// tolerance; each step depends on the last, so it is sequential but cheap.
+// The second polishes every member at the final tolerance and integrates
+// a full period for its monodromy matrix. Members are independent there,
+// so that pass, which holds most of the work, runs across the thread pool.
+class HaloFamily {
+public:
+    struct Member {
+        double x0 = 0.0;
+        double z0 = 0.0;
+        double vy0 = 0.0;
+        double period = 0.0;
+        
+        // Filled in by generate()
+        double jacobi = 0.0;
+        double periluneRadius = 0.0;    // m, from the Moon's center
+        double apoluneRadius = 0.0;     // m
+        double stabilityIndex = 0.0;    // largest |lambda + 1/lambda| / 2 of the monodromy; <= 1 is stable
+        double closureError = 0.0;      // |state(T) - state(0)|, normalized
+    };
+    
+    struct Options {
+        int membersPerSide = 30;            // continued each way from the seed
+        double stepSize = 0.05;             // pseudo-arclength in (x0, z0, vy0, T)
+        double tolerance = 1e-11;           // final constraint residual
+        double minPeriluneAltitude = 250e3; // m, continuation stops below
+        int maxIterations = 20;             // Newton iterations per member
+    };
+    
+    // 9:2 synodic resonant L2 southern NRHO (6.56 days, 3250 km perilune)
+    static Member nrhoSeed();
+    
+    // Correct seed with its period held, then continue the family both ways.
+    // Members are ordered along the family with the seed in the middle.
+    // Returns false only if the seed itself cannot be corrected.
+    static bool generate(const Member& seed, const Options& options, ThreadPool& pool,
+                         std::vector<Member>& outMembers, std::string& outError);
+    
+    // Mirror image across the Earth-Moon plane (northern <-> southern)
+    static Member mirror(const Member& member);
+    
+    // Label such as "L2 South halo, 6.56 d, perilune 3250 km"
+    static std::string describe(const Member& member);
+    
+    // Compact binary table in native byte order. load() rejects tables
+    // generated for other Earth-Moon parameters.
+    static bool save(const std::string& path, const std::vector<Member>& members, std::string& outError);
+    static bool load(const std::string& path, std::vector<Member>& outMembers, std::string& outError);
+};
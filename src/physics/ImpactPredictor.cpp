@@ -0,0 +1,353 @@
+#include "ImpactPredictor.h"
+#include "CR3BP.h"
+#include "DenseTrajectory.h"
+#include "EventDetector.h"
+#include "GravityCache.h"
+#include "Orbit.h"
+#include "core/Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Vis-viva speed at radius r; inverseA = 1 / a is negative on an open orbit
+    double speedAt(double r, double mu, double inverseA) {
+        return std::sqrt(std::max(0.0, mu * (2.0 / r - inverseA)));
+    }
+    
+    // Largest r^3 v on the conic between two radii: r^6 v^2 = mu (2 r^5 - r^6 / a)
+    // rises up to r = 5a / 3 and falls after it
+    double maxCubeSpeed(double minRadius, double maxRadius, double mu, double inverseA) {
+        double r = maxRadius;
+        if (inverseA > 0.0) {
+            r = std::clamp(5.0 / (3.0 * inverseA), minRadius, maxRadius);
+        }
+        return r * r * r * speedAt(r, mu, inverseA);
+    }
+    
+    // Third body at distance d from the Moon: the point-mass field's
+    // gradient is at most 2 mu / rho^3, so its tidal acceleration at radius
+    // r is at most 2 mu r / (d - r)^3
+    double tidalFactor(double bodyMu, double distance, double maxRadius) {
+        double gap = distance - maxRadius;
+        if (gap <= 0.0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return 2.0 * bodyMu / (gap * gap * gap);
+    }
+    
+    // Sum of the tidal factors of the model's third bodies; times r gives
+    // the acceleration bound at radius r <= maxRadius
+    double tidalBound(const GravityFieldForceModel& forceModel, double maxRadius) {
+        if (forceModel.ephemeris) {
+            return tidalFactor(Constants::EARTH_MU, ImpactPredictor::EARTH_MIN_DISTANCE, maxRadius) +
+                   tidalFactor(Constants::SUN_MU, ImpactPredictor::SUN_MIN_DISTANCE, maxRadius);
+        }
+        if (forceModel.circularEarth) {
+            return tidalFactor(Constants::EARTH_MU, CR3BP::DISTANCE, maxRadius);
+        }
+        return 0.0;
+    }
+    
+    // Field terms above the point mass at radius r and beyond, and the
+    // cache's interpolation error (twice the measured worst case)
+    double fieldBound(const GravityFieldForceModel& forceModel, double r) {
+        if (!forceModel.hasField()) {
+            return 0.0;
+        }
+        double bound = forceModel.field->perturbationBound(r, forceModel.degree);
+        if (forceModel.cache) {
+            bound += 2.0 * forceModel.cache->getErrorReport().maxError;
+        }
+        return bound;
+    }
+    
+    // Largest rate (m/s) at which the osculating periapsis radius can move
+    // while the spacecraft stays between floor and maxRadius: 4 F r^2 v / mu
+    // at the worst radius. The field's share falls with r and peaks at the
+    // floor; the third bodies' share, tidal factor times r^3 v, grows with r.
+    double periapsisDriftRate(const GravityFieldForceModel& forceModel, double floor, double maxRadius,
+                              double inverseA) {
+        const double mu = forceModel.mu;
+        double speed = ImpactPredictor::BOUND_SLACK * speedAt(floor, mu, inverseA);
+        double field = 0.0;
+        if (forceModel.hasField()) {
+            field = forceModel.field->perturbationBound(floor, forceModel.degree) * floor * floor * speed;
+            if (forceModel.cache) {
+                // The interpolation error does not fall with r
+                double outer = std::max(floor, std::min(maxRadius, forceModel.cache->getMaxRadius()));
+                field += 2.0 * forceModel.cache->getErrorReport().maxError * outer * outer * speed;
+            }
+        }
+        double tidal = tidalBound(forceModel, maxRadius);
+        double third = 0.0;
+        if (tidal > 0.0) {
+            third = tidal * ImpactPredictor::BOUND_SLACK * maxCubeSpeed(floor, maxRadius, mu, inverseA);
+        }
+        return 4.0 * (field + third) / mu;
+    }
+    
+    void setImpact(const glm::dvec3& position, const glm::dvec3& velocity, double time,
+                   const GravityFieldForceModel& forceModel, ImpactPrediction& out) {
+        out.impact = true;
+        out.impactTime = time;
+        out.impactSpeed = glm::length(velocity);
+        ImpactPredictor::toMoonFixed(position, time, forceModel, out.latitude, out.longitude);
+        out.closestTime = time;
+        out.closestAltitude = 0.0;
+        out.minimumAltitude = 0.0;
+    }
+    
+    void setClosest(double radius, double time, ImpactPrediction& out) {
+        out.closestTime = time;
+        out.closestAltitude = radius - Constants::MOON_RADIUS;
+        out.minimumAltitude = out.closestAltitude;
+    }
+}
+
+const char* ImpactPrediction::getMethodName(Method method) {
+    switch (method) {
+        case Method::Bound: return "bound";
+        case Method::Kepler: return "Kepler";
+        case Method::Numeric: return "numeric";
+        case Method::None:
+        default: return "none";
+    }
+}
+
+bool ImpactPredictor::predictAnalytic(const glm::dvec3& position, const glm::dvec3& velocity,
+                                      double time, double horizon, const GravityFieldForceModel& forceModel,
+                                      ImpactPrediction& out) {
+    const double R = Constants::MOON_RADIUS;
+    const double mu = forceModel.mu;
+    out = ImpactPrediction();
+    out.horizonEnd = time + horizon;
+    
+    double r0 = glm::length(position);
+    if (r0 <= R) {
+        // Already on the surface
+        out.method = ImpactPrediction::Method::Kepler;
+        setImpact(position, velocity, time, forceModel, out);
+        return true;
+    }
+    
+    OrbitalElements elements = Orbit::computeElements(position, velocity, mu);
+    double h = elements.angularMomentum;
+    double e = elements.eccentricity;
+    if (h <= 0.0 || !std::isfinite(elements.specificEnergy)) {
+        return false;
+    }
+    double p = h * h / mu;
+    double periapsis = p / (1.0 + e);
+    double inverseA = -2.0 * elements.specificEnergy / mu;
+    
+    // Lowest point of the conic inside the horizon: the periapsis if it is
+    // passed, otherwise one of the ends
+    glm::dvec3 endPosition, endVelocity;
+    if (!Orbit::propagateKepler(position, velocity, horizon, mu, endPosition, endVelocity)) {
+        return false;
+    }
+    double endRadius = glm::length(endPosition);
+    double toPeriapsis = Orbit::computeTimeToPeriapsis(elements, mu);
+    
+    if (forceModel.isPointMass()) {
+        out.method = ImpactPrediction::Method::Kepler;
+        if (periapsis <= R) {
+            // The descending crossing of the surface, at
+            // cos(nu) = (p / R - 1) / e before periapsis
+            double crossing = -std::acos(std::clamp((p / R - 1.0) / e, -1.0, 1.0));
+            double dt = Orbit::computeTimeSincePeriapsis(crossing, e, h, mu) -
+                        Orbit::computeTimeSincePeriapsis(elements.trueAnomaly, e, h, mu);
+            if (dt < 0.0 && e < 1.0) {
+                dt += elements.orbitalPeriod;
+            }
+            glm::dvec3 impactPosition, impactVelocity;
+            if (dt >= 0.0 && dt <= horizon &&
+                Orbit::propagateKepler(position, velocity, dt, mu, impactPosition, impactVelocity)) {
+                setImpact(impactPosition, impactVelocity, time + dt, forceModel, out);
+                return true;
+            }
+        }
+        if (toPeriapsis <= horizon && periapsis > R) {
+            setClosest(periapsis, time + toPeriapsis, out);
+        } else if (endRadius < r0) {
+            setClosest(endRadius, time + horizon, out);
+        } else {
+            setClosest(r0, time, out);
+        }
+        return true;
+    }
+    
+    // Farthest the coast can go: the apoapsis, or on an open orbit the
+    // farther end
+    double maxRadius = BOUND_SLACK * (inverseA > 0.0 && e < 1.0 ? p / (1.0 - e) : std::max(r0, endRadius));
+    
+    // Lowest point of the conic inside the horizon: the periapsis if it is
+    // passed, otherwise the lower end
+    double conicRadius = r0, conicTime = time;
+    if (toPeriapsis <= horizon) {
+        conicRadius = periapsis;
+        conicTime = time + toPeriapsis;
+    } else if (endRadius < r0) {
+        conicRadius = endRadius;
+        conicTime = time + horizon;
+    }
+    
+    // Each bound holds while the spacecraft stays above the floor it was
+    // evaluated at, and proves that it does if what it guarantees lies
+    // above that floor. lowest is the best guarantee.
+    double lowest = -std::numeric_limits<double>::infinity();
+    
+    // The osculating periapsis can drift by at most the rate times the
+    // horizon. The surface always works as the floor; one halfway to the
+    // periapsis sees a much smaller field at high degree.
+    if (periapsis > R) {
+        for (double fraction : {0.0, 0.5}) {
+            double floor = R + fraction * (periapsis - R);
+            double reach = periapsis - periapsisDriftRate(forceModel, floor, maxRadius, inverseA) * horizon;
+            if (reach > floor) {
+                lowest = std::max(lowest, reach);
+            }
+        }
+    }
+    
+    // A tube about the conic, for coasts that stay high until the horizon
+    // (no periapsis inside it). The deviation d from the conic obeys
+    // |d''| <= F + (2 mu / r^3) |d|, so by Gronwall
+    // |d(t)| <= (F / k^2)(cosh(k t) - 1) with k^2 = 2 mu / floor^3.
+    if (conicRadius > R) {
+        double floor = R + 0.5 * (conicRadius - R);
+        double k2 = 2.0 * mu / (floor * floor * floor);
+        double force = fieldBound(forceModel, floor) + tidalBound(forceModel, maxRadius) * maxRadius;
+        double deviation = force / k2 * (std::cosh(std::sqrt(k2) * horizon) - 1.0);
+        if (conicRadius - deviation > floor) {
+            lowest = std::max(lowest, conicRadius - deviation);
+        }
+    }
+    
+    if (lowest <= R) {
+        return false;
+    }
+    out.method = ImpactPrediction::Method::Bound;
+    setClosest(conicRadius, conicTime, out);
+    out.minimumAltitude = lowest - R;
+    return true;
+}
+
+ImpactPrediction ImpactPredictor::search(const DenseTrajectory& path, double startTime,
+                                         const GravityFieldForceModel& forceModel) {
+    ImpactPrediction out;
+    if (path.isEmpty()) {
+        return out;
+    }
+    out.method = ImpactPrediction::Method::Numeric;
+    out.horizonEnd = startTime + path.getEndTime();
+    
+    EventDetector detector;
+    detector.addFunction(EventFunction::impact());
+    EventFunction periapsis = EventFunction::apsides();
+    periapsis.direction = EventFunction::Direction::Rising;
+    detector.addFunction(periapsis);
+    
+    bool rotating = forceModel.isCR3BP();
+    const DenseTrajectory::Segment* segment = &path.getSegments().front();
+    auto interpolate = [&](double t, glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+        DenseTrajectory::evaluateSegment(*segment, t - startTime, outPosition, outVelocity);
+        if (rotating) {
+            CR3BP::rotatingToInertial(outPosition, outVelocity, t, outPosition, outVelocity);
+        }
+    };
+    
+    glm::dvec3 position, velocity;
+    double t = startTime + segment->t0;
+    interpolate(t, position, velocity);
+    detector.begin(t, position, velocity);
+    setClosest(glm::length(position), t, out);
+    
+    std::vector<Event> events;
+    for (const DenseTrajectory::Segment& step : path.getSegments()) {
+        segment = &step;
+        t = startTime + step.t0 + step.h;
+        interpolate(t, position, velocity);
+        
+        events.clear();
+        bool stopped = detector.step(t, position, velocity, interpolate, events);
+        for (const Event& event : events) {
+            double altitude = glm::length(event.position) - Constants::MOON_RADIUS;
+            if (!event.isImpact() && altitude < out.closestAltitude) {
+                setClosest(glm::length(event.position), event.time, out);
+            }
+        }
+        if (stopped) {
+            const Event& impact = events.back();
+            setImpact(impact.position, impact.velocity, impact.time, forceModel, out);
+            return out;
+        }
+        if (glm::length(position) - Constants::MOON_RADIUS < out.closestAltitude) {
+            setClosest(glm::length(position), t, out);
+        }
+    }
+    return out;
+}
+
+ImpactPrediction ImpactPredictor::predict(const SpacecraftState& state, double time, double horizon,
+                                          const GravityFieldForceModel& forceModel,
+                                          const AdaptiveOptions& options) {
+    GravityFieldForceModel coast = forceModel;
+    coast.thrustAccel = glm::dvec3(0.0);
+    coast.setTime(time);
+    
+    ImpactPrediction prediction;
+    if (predictAnalytic(state.position, state.velocity, time, horizon, coast, prediction)) {
+        return prediction;
+    }
+    
+    // The CR3BP integrates in its rotating frame, where it is cheaper
+    DenseTrajectory path;
+    if (coast.isCR3BP()) {
+        CR3BP::propagate(state, time, horizon, options, &path, nullptr, Constants::MOON_RADIUS);
+    } else {
+        // The model holds the Moon's orientation and the third bodies from
+        // setTime(), so a long horizon is flown in legs that each refresh
+        // them, the way stepped propagation does per step
+        SpacecraftState legState = state;
+        DenseTrajectory leg;
+        double elapsed = 0.0;
+        while (elapsed < horizon) {
+            double legDuration = std::min(MODEL_HOLD_TIME, horizon - elapsed);
+            coast.setTime(time + elapsed);
+            legState = Integrator::propagateAdaptive(legState, legDuration, coast, options, &leg, nullptr,
+                                                     Constants::MOON_RADIUS);
+            if (leg.isEmpty()) {
+                break;
+            }
+            for (DenseTrajectory::Segment segment : leg.getSegments()) {
+                segment.t0 += elapsed;
+                path.addSegment(segment);
+            }
+            // Stopped short: at the surface, out of steps or cancelled
+            if (leg.getEndTime() < (1.0 - 1e-12) * legDuration ||
+                glm::length(legState.position) <= Constants::MOON_RADIUS) {
+                break;
+            }
+            elapsed += legDuration;
+        }
+    }
+    prediction = search(path, time, coast);
+    prediction.horizonEnd = time + horizon;
+    return prediction;
+}
+
+void ImpactPredictor::toMoonFixed(const glm::dvec3& position, double time,
+                                  const GravityFieldForceModel& forceModel, double& outLatitude,
+                                  double& outLongitude) {
+    // The rotation GravityFieldForceModel::setTime() applies
+    double angle = forceModel.getRotationAngle(time);
+    double c = std::cos(angle);
+    double s = std::sin(angle);
+    double x = c * position.x + s * position.y;
+    double y = -s * position.x + c * position.y;
+    double r = glm::length(position);
+    outLatitude = r > 0.0 ? std::asin(std::clamp(position.z / r, -1.0, 1.0)) : 0.0;
+    outLongitude = std::atan2(y, x);
+}
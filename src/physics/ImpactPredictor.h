@@ -0,0 +1,108 @@
+#pragma once
+
+#include "GravityField.h"
+#include "Integrator.h"
+#include "Spacecraft.h"
+#include <glm/glm.hpp>
+
+class DenseTrajectory;
+
+// Surface impact or closest approach over a coast of a given horizon
+struct ImpactPrediction {
+    enum class Method {
+        None,       // nothing predicted yet
+        Bound,      // proven clear by the perturbation bound, no integration
+        Kepler,     // point-mass gravity, solved on the conic
+        Numeric     // located on an integrated path
+    };
+    
+    Method method = Method::None;
+    bool impact = false;
+    double horizonEnd = 0.0;        // simulation time the prediction covers up to
+    
+    // Impact: simulation time, speed and Moon-fixed latitude/longitude
+    double impactTime = 0.0;
+    double impactSpeed = 0.0;       // m/s
+    double latitude = 0.0;          // radians
+    double longitude = 0.0;         // radians, east
+    
+    // Lowest point before the horizon (or the impact): on the osculating
+    // conic for Bound, on the path otherwise. minimumAltitude is what is
+    // guaranteed: the bound's floor, or the closest approach itself.
+    double closestTime = 0.0;
+    double closestAltitude = 0.0;   // meters
+    double minimumAltitude = 0.0;   // meters
+    
+    bool isValid() const { return method != Method::None; }
+    
+    static const char* getMethodName(Method method);
+};
+
+// Predicts whether a coast reaches the surface, deciding the common cases
+// without integrating.
+//
+// Two O(1) bounds, each evaluated with the perturbing acceleration F
+// bounded from the field's coefficient power and the third bodies' tidal
+// gradient, and r and v taken from the osculating conic:
+//
+// - Periapsis drift. A point of the coast is never lower than the periapsis
+//   of its osculating conic, and F moves that periapsis radius by at most
+//   4 F r^2 v / mu per second (Gauss's equations for h and the
+//   eccentricity vector, bounded term by term). If the periapsis stays
+//   above the surface after drifting at that rate for the whole horizon,
+//   so does the coast. Suits near-circular orbits.
+// - Tube about the conic. The time to periapsis says whether the conic
+//   passes its periapsis within the horizon, and so how low it gets; the
+//   real path stays within (F / k^2)(cosh(k t) - 1) of it (Gronwall). Suits
+//   short horizons and high arcs, such as the coast from an apoapsis.
+//
+// Under point-mass gravity the conic is the path, and time to periapsis and
+// the surface crossing come straight from Kepler's equation. Only a coast
+// none of this clears is searched numerically: impact and periapsis
+// switching functions on the dense output of an integration, which touch
+// the interpolant only in steps that bracket a pass. The worst-case bounds
+// loosen quickly with field degree; below 100 km under a degree-50 field
+// they rarely clear a two hour horizon.
+class ImpactPredictor {
+public:
+    // Widening of the conic's extreme radius and speed, to cover their own
+    // drift over the horizon
+    static constexpr double BOUND_SLACK = 1.1;
+    
+    // Closest the third bodies come to the Moon: Earth at perigee, the Sun
+    // at perihelion less the Moon's distance
+    static constexpr double EARTH_MIN_DISTANCE = 356.0e6;      // m
+    static constexpr double SUN_MIN_DISTANCE = 1.467e11;       // m
+    
+    // Longest leg the numeric search integrates per setTime(): the span
+    // over which GravityFieldForceModel may hold the Moon's orientation and
+    // the third bodies
+    static constexpr double MODEL_HOLD_TIME = 7200.0;           // s
+    
+    // O(1) part. Returns true with out filled if the coast of horizon
+    // seconds from position and velocity at simulation time is decided
+    // without integration: cleared by the bound, or solved on the conic for
+    // a point-mass model. Returns false if only a numeric search can tell.
+    static bool predictAnalytic(const glm::dvec3& position, const glm::dvec3& velocity,
+                                double time, double horizon, const GravityFieldForceModel& forceModel,
+                                ImpactPrediction& out);
+    
+    // Numeric part: impact and closest approach along a coast already
+    // integrated under forceModel from simulation time startTime. Segment
+    // times are relative to startTime; a CR3BP model's path is in its
+    // rotating frame.
+    static ImpactPrediction search(const DenseTrajectory& path, double startTime,
+                                   const GravityFieldForceModel& forceModel);
+    
+    // The analytic test, and an adaptive integration searched numerically
+    // when it cannot decide. A time-dependent model is integrated in legs of
+    // at most MODEL_HOLD_TIME, each starting with setTime().
+    static ImpactPrediction predict(const SpacecraftState& state, double time, double horizon,
+                                    const GravityFieldForceModel& forceModel,
+                                    const AdaptiveOptions& options = AdaptiveOptions{});
+    
+    // Moon-fixed latitude and longitude (radians) of an inertial position
+    // at simulation time, in the frame forceModel orients its field in
+    static void toMoonFixed(const glm::dvec3& position, double time, const GravityFieldForceModel& forceModel,
+                            double& outLatitude, double& outLongitude);
+};
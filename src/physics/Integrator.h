@@ -1,24 +1,159 @@
 #pragma once
 
 #include "Spacecraft.h"
+#include "DenseTrajectory.h"
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <vector>
 #include <functional>
+#include <concepts>
+#include <string>
 
 // Derivative function type: takes state, returns derivatives
 using DerivativeFunc = std::function<void(const SpacecraftState&, glm::dvec3&, glm::dvec3&)>;
 
+// Any callable with the DerivativeFunc signature. Passing a concrete force
+// model (lambda or functor) instead of a DerivativeFunc lets the compiler
+// inline the derivative evaluation into every integrator stage.
+template <typename F>
+concept DerivativeModel = std::invocable<const F&, const SpacecraftState&, glm::dvec3&, glm::dvec3&>;
+
+// Error control for adaptive propagation. A step is accepted when the RMS
+// of err_i / (absTol + relTol * |y_i|) over the six state components is <= 1.
+struct AdaptiveOptions {
+    double relTol = 1e-10;
+    double absTol = 1e-4;        // meters and m/s
+    double initialStep = 0.0;    // seconds, 0 = estimate from the state
+    double maxStep = 0.0;        // seconds, 0 = unlimited
+    double minStep = 1e-6;       // seconds
+    int maxSteps = 1000000;
+    
+    // Checked before every step; propagation stops early once it is set
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+struct AdaptiveStats {
+    int acceptedSteps = 0;
+    int rejectedSteps = 0;
+    int evaluations = 0;         // derivative (force model) evaluations
+};
+
+// A DerivativeModel that also gives the gradient of the acceleration with
+// respect to position, d a / d r, for the variational equations. Models
+// whose acceleration depends on velocity (the Coriolis term of
+// CR3BPForceModel) do not qualify.
+template <typename F>
+concept DifferentiableModel = DerivativeModel<F> &&
+    std::invocable<const F&, const SpacecraftState&, glm::dvec3&, glm::dvec3&, glm::dmat3&>;
+
+// 6x6 state transition matrix d(r, v) / d(r0, v0) in 3x3 blocks: rv holds
+// d r / d v0, and so on. glm matrices are column-major, so rv[j][i] is
+// d r_i / d v0_j.
+struct StateTransition {
+    glm::dmat3 rr{1.0};
+    glm::dmat3 rv{0.0};
+    glm::dmat3 vr{0.0};
+    glm::dmat3 vv{1.0};
+    
+    // Element of the full matrix, rows and columns ordered x, y, z, vx, vy, vz
+    double get(int row, int col) const {
+        const glm::dmat3& block = (row < 3) ? (col < 3 ? rr : rv) : (col < 3 ? vr : vv);
+        return block[col % 3][row % 3];
+    }
+    
+    // Phi(t2, t0) from later = Phi(t2, t1) and earlier = Phi(t1, t0)
+    static StateTransition compose(const StateTransition& later, const StateTransition& earlier) {
+        StateTransition result;
+        result.rr = later.rr * earlier.rr + later.rv * earlier.vr;
+        result.rv = later.rr * earlier.rv + later.rv * earlier.vv;
+        result.vr = later.vr * earlier.rr + later.vv * earlier.vr;
+        result.vv = later.vr * earlier.rv + later.vv * earlier.vv;
+        return result;
+    }
+    
+    // Blockwise arithmetic for Runge-Kutta stages
+    friend StateTransition operator+(const StateTransition& a, const StateTransition& b) {
+        StateTransition result;
+        result.rr = a.rr + b.rr;
+        result.rv = a.rv + b.rv;
+        result.vr = a.vr + b.vr;
+        result.vv = a.vv + b.vv;
+        return result;
+    }
+    
+    friend StateTransition operator*(double s, const StateTransition& a) {
+        StateTransition result;
+        result.rr = s * a.rr;
+        result.rv = s * a.rv;
+        result.vr = s * a.vr;
+        result.vv = s * a.vv;
+        return result;
+    }
+};
+
+// State of N plain components, for systems that integrate more than
+// position and velocity (a burn's mass, see PoweredFlight). Componentwise
+// arithmetic for Runge-Kutta stages.
+template <size_t N>
+struct StateVector {
+    std::array<double, N> values{};
+    
+    double& operator[](size_t i) { return values[i]; }
+    double operator[](size_t i) const { return values[i]; }
+    
+    friend StateVector operator+(StateVector a, const StateVector& b) {
+        for (size_t i = 0; i < N; ++i) {
+            a.values[i] += b.values[i];
+        }
+        return a;
+    }
+    
+    friend StateVector operator*(double s, StateVector a) {
+        for (size_t i = 0; i < N; ++i) {
+            a.values[i] *= s;
+        }
+        return a;
+    }
+};
+
+// dy / dt = f(t, y): any callable f(t, y, outDerivative) on StateVector<N>
+template <typename F, size_t N>
+concept VectorField = std::invocable<const F&, double, const StateVector<N>&, StateVector<N>&>;
+
 class Integrator {
 public:
     enum class Type {
         Euler,
         SemiImplicitEuler,
-        RK4
+        RK4,
+        // Symplectic: bounded energy error over long coasts
+        VelocityVerlet,
+        ForestRuth,
+        Yoshida4,
+        Yoshida6
     };
     
+    static constexpr int NUM_TYPES = 7;
+    
+    static bool isSymplectic(Type type) { return type >= Type::VelocityVerlet; }
+    
+    // Force evaluations per step (stateless; no reuse across steps)
+    static int getEvaluationsPerStep(Type type);
+    
+    // Short command-line name ("euler", "rk4", "yoshida6", ...)
+    static const char* getName(Type type);
+    static bool parseName(const std::string& name, Type& outType);
+    
     static void step(SpacecraftState& state, double dt, Type type, 
                     const DerivativeFunc& computeDerivatives);
     
+    template <DerivativeModel F>
+    static void step(SpacecraftState& state, double dt, Type type,
+                    const F& computeDerivatives);
+    
     // Predict future trajectory (no thrust)
     static std::vector<glm::dvec3> predictTrajectory(
         const SpacecraftState& initialState,
@@ -28,11 +163,898 @@ public:
         const DerivativeFunc& computeDerivatives,
         double bodyRadius = 0.0);  // Stop if hits body
     
+    template <DerivativeModel F>
+    static std::vector<glm::dvec3> predictTrajectory(
+        const SpacecraftState& initialState,
+        double duration,
+        double dt,
+        int maxSteps,
+        const F& computeDerivatives,
+        double bodyRadius = 0.0);
+    
+    // Adaptive Dormand-Prince 5(4) propagation. Returns the state at
+    // duration (or at the end of the first step that reaches bodyRadius).
+    // If outTrajectory is given it receives the dense output, with times
+    // measured from the initial state.
+    template <DerivativeModel F>
+    static SpacecraftState propagateAdaptive(
+        const SpacecraftState& initialState,
+        double duration,
+        const F& computeDerivatives,
+        const AdaptiveOptions& options = AdaptiveOptions{},
+        DenseTrajectory* outTrajectory = nullptr,
+        AdaptiveStats* outStats = nullptr,
+        double bodyRadius = 0.0);
+    
+    // Gragg-Bulirsch-Stoer extrapolation with order and step size control,
+    // for smooth dynamics at tight tolerances, where it takes far longer
+    // steps than Dormand-Prince. Same contract as propagateAdaptive; the
+    // dense output is the cubic Hermite interpolant of each step with a
+    // quartic correction through its midpoint.
+    template <DerivativeModel F>
+    static SpacecraftState propagateBulirschStoer(
+        const SpacecraftState& initialState,
+        double duration,
+        const F& computeDerivatives,
+        const AdaptiveOptions& options = AdaptiveOptions{},
+        DenseTrajectory* outTrajectory = nullptr,
+        AdaptiveStats* outStats = nullptr,
+        double bodyRadius = 0.0);
+    
+    // Adaptive Dormand-Prince 5(4) propagation of the state together with
+    // its state transition matrix. The matrix follows the variational
+    // equations d Phi / dt = [0 I; G 0] Phi, with the gravity gradient G
+    // from the model at every stage, so it is the exact derivative of the
+    // discrete map that advances the state, not an approximation of it.
+    // Error control looks at the state only. Costs 4.5x (point mass) to
+    // 6.5x (degree 50) a plain propagation, against 7x for one-sided finite
+    // differences, which also lose half the digits (artemis-bench stm).
+    template <DifferentiableModel F>
+    static SpacecraftState propagateWithTransition(
+        const SpacecraftState& initialState,
+        double duration,
+        const F& computeDerivatives,
+        StateTransition& outTransition,
+        const AdaptiveOptions& options = AdaptiveOptions{},
+        AdaptiveStats* outStats = nullptr);
+    
+    // Single-method kernels, for callers that pick the method at compile time
+    template <DerivativeModel F>
+    static void stepEuler(SpacecraftState& state, double dt, const F& computeDerivatives);
+    template <DerivativeModel F>
+    static void stepSemiImplicitEuler(SpacecraftState& state, double dt, const F& computeDerivatives);
+    template <DerivativeModel F>
+    static void stepRK4(SpacecraftState& state, double dt, const F& computeDerivatives);
+    // RK4 that also advances transition, as propagateWithTransition does
+    template <DifferentiableModel F>
+    static void stepRK4(SpacecraftState& state, StateTransition& transition, double dt,
+                        const F& computeDerivatives);
+    // RK4 on a general state from time t, every component in every stage
+    template <size_t N, typename F>
+        requires VectorField<F, N>
+    static void stepRK4(StateVector<N>& y, double t, double dt, const F& computeDerivative);
+    template <DerivativeModel F>
+    static void stepVelocityVerlet(SpacecraftState& state, double dt, const F& computeDerivatives);
+    template <DerivativeModel F>
+    static void stepForestRuth(SpacecraftState& state, double dt, const F& computeDerivatives);
+    template <DerivativeModel F>
+    static void stepYoshida4(SpacecraftState& state, double dt, const F& computeDerivatives);
+    template <DerivativeModel F>
+    static void stepYoshida6(SpacecraftState& state, double dt, const F& computeDerivatives);
+    
 private:
-    static void stepEuler(SpacecraftState& state, double dt, 
-                         const DerivativeFunc& computeDerivatives);
-    static void stepSemiImplicitEuler(SpacecraftState& state, double dt,
-                                     const DerivativeFunc& computeDerivatives);
-    static void stepRK4(SpacecraftState& state, double dt,
-                       const DerivativeFunc& computeDerivatives);
+    // d Phi / dt for the variational equations, from the gravity gradient
+    static StateTransition transitionRate(const StateTransition& phi, const glm::dmat3& gradient) {
+        StateTransition rate;
+        rate.rr = phi.vr;
+        rate.rv = phi.vv;
+        rate.vr = gradient * phi.rr;
+        rate.vv = gradient * phi.rv;
+        return rate;
+    }
+    
+    // RMS over the six state components of err_i / (absTol + relTol * |y_i|),
+    // taking the larger of the start and end magnitudes
+    static double scaledError(const glm::dvec3& r0, const glm::dvec3& v0,
+                              const glm::dvec3& r1, const glm::dvec3& v1,
+                              const glm::dvec3& errR, const glm::dvec3& errV,
+                              const AdaptiveOptions& options);
+    
+    // Modified midpoint steps in one Bulirsch-Stoer extrapolation: n_k = 2(k + 1)
+    static constexpr int BS_COLUMNS = 8;
+    
+    // Symmetric composition S2(w_1 dt) ... S2(w_n dt) of the 2nd order
+    // leapfrog. The kick-drift-kick form reuses the closing kick's
+    // acceleration for the next substep (n + 1 evaluations); the
+    // drift-kick-drift form needs one evaluation per substep (n).
+    template <DerivativeModel F>
+    static void stepKickDriftKick(SpacecraftState& state, double dt, const F& computeDerivatives,
+                                  const double* weights, int count);
+    template <DerivativeModel F>
+    static void stepDriftKickDrift(SpacecraftState& state, double dt, const F& computeDerivatives,
+                                   const double* weights, int count);
+    
+    // Triple-jump weights for 4th order: w1 = 1 / (2 - 2^(1/3)), w0 = 1 - 2 w1
+    static constexpr double TRIPLE_JUMP_W1 = 1.3512071919596578;
+    static constexpr double TRIPLE_JUMP_W0 = -1.7024143839193156;
+    static constexpr double TRIPLE_JUMP[3] = {TRIPLE_JUMP_W1, TRIPLE_JUMP_W0, TRIPLE_JUMP_W1};
+    
+    // Yoshida (1990) 6th order, solution A
+    static constexpr double YOSHIDA6_W1 = -1.17767998417887;
+    static constexpr double YOSHIDA6_W2 = 0.235573213359357;
+    static constexpr double YOSHIDA6_W3 = 0.784513610477560;
+    static constexpr double YOSHIDA6_W0 = 1.0 - 2.0 * (YOSHIDA6_W1 + YOSHIDA6_W2 + YOSHIDA6_W3);
+    static constexpr double YOSHIDA6[7] = {YOSHIDA6_W3, YOSHIDA6_W2, YOSHIDA6_W1, YOSHIDA6_W0,
+                                           YOSHIDA6_W1, YOSHIDA6_W2, YOSHIDA6_W3};
 };
+
+template <DerivativeModel F>
+void Integrator::step(SpacecraftState& state, double dt, Type type,
+                     const F& computeDerivatives) {
+    switch (type) {
+        case Type::Euler:
+            stepEuler(state, dt, computeDerivatives);
+            break;
+        case Type::SemiImplicitEuler:
+            stepSemiImplicitEuler(state, dt, computeDerivatives);
+            break;
+        case Type::VelocityVerlet:
+            stepVelocityVerlet(state, dt, computeDerivatives);
+            break;
+        case Type::ForestRuth:
+            stepForestRuth(state, dt, computeDerivatives);
+            break;
+        case Type::Yoshida4:
+            stepYoshida4(state, dt, computeDerivatives);
+            break;
+        case Type::Yoshida6:
+            stepYoshida6(state, dt, computeDerivatives);
+            break;
+        case Type::RK4:
+        default:
+            stepRK4(state, dt, computeDerivatives);
+            break;
+    }
+}
+
+template <DerivativeModel F>
+void Integrator::stepEuler(SpacecraftState& state, double dt,
+                          const F& computeDerivatives) {
+    glm::dvec3 accel(0.0);
+    glm::dvec3 velocityDeriv(0.0);
+    computeDerivatives(state, accel, velocityDeriv);
+    
+    state.position += state.velocity * dt;
+    state.velocity += accel * dt;
+}
+
+template <DerivativeModel F>
+void Integrator::stepSemiImplicitEuler(SpacecraftState& state, double dt,
+                                      const F& computeDerivatives) {
+    glm::dvec3 accel(0.0);
+    glm::dvec3 velocityDeriv(0.0);
+    computeDerivatives(state, accel, velocityDeriv);
+    
+    // Update velocity first, then position
+    state.velocity += accel * dt;
+    state.position += state.velocity * dt;
+}
+
+template <DerivativeModel F>
+void Integrator::stepRK4(SpacecraftState& state, double dt,
+                        const F& computeDerivatives) {
+    // k1
+    glm::dvec3 k1v(0.0), k1a(0.0);
+    computeDerivatives(state, k1a, k1v);
+    k1v = state.velocity;
+    
+    // k2
+    SpacecraftState state2 = state;
+    state2.position = state.position + k1v * (dt * 0.5);
+    state2.velocity = state.velocity + k1a * (dt * 0.5);
+    glm::dvec3 k2v(0.0), k2a(0.0);
+    computeDerivatives(state2, k2a, k2v);
+    k2v = state2.velocity;
+    
+    // k3
+    SpacecraftState state3 = state;
+    state3.position = state.position + k2v * (dt * 0.5);
+    state3.velocity = state.velocity + k2a * (dt * 0.5);
+    glm::dvec3 k3v(0.0), k3a(0.0);
+    computeDerivatives(state3, k3a, k3v);
+    k3v = state3.velocity;
+    
+    // k4
+    SpacecraftState state4 = state;
+    state4.position = state.position + k3v * dt;
+    state4.velocity = state.velocity + k3a * dt;
+    glm::dvec3 k4v(0.0), k4a(0.0);
+    computeDerivatives(state4, k4a, k4v);
+    k4v = state4.velocity;
+    
+    // Combine
+    state.position += (k1v + 2.0 * k2v + 2.0 * k3v + k4v) * (dt / 6.0);
+    state.velocity += (k1a + 2.0 * k2a + 2.0 * k3a + k4a) * (dt / 6.0);
+}
+
+template <size_t N, typename F>
+    requires VectorField<F, N>
+void Integrator::stepRK4(StateVector<N>& y, double t, double dt, const F& computeDerivative) {
+    StateVector<N> k1, k2, k3, k4;
+    computeDerivative(t, y, k1);
+    computeDerivative(t + 0.5 * dt, y + (0.5 * dt) * k1, k2);
+    computeDerivative(t + 0.5 * dt, y + (0.5 * dt) * k2, k3);
+    computeDerivative(t + dt, y + dt * k3, k4);
+    y = y + (dt / 6.0) * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+}
+
+template <DifferentiableModel F>
+void Integrator::stepRK4(SpacecraftState& state, StateTransition& transition, double dt,
+                        const F& computeDerivatives) {
+    glm::dvec3 unused(0.0);
+    glm::dmat3 gradient(0.0);
+    
+    glm::dvec3 k1v = state.velocity, k1a(0.0);
+    computeDerivatives(state, k1a, unused, gradient);
+    StateTransition k1 = transitionRate(transition, gradient);
+    
+    SpacecraftState stage = state;
+    stage.position = state.position + k1v * (dt * 0.5);
+    stage.velocity = state.velocity + k1a * (dt * 0.5);
+    StateTransition phi = transition + (dt * 0.5) * k1;
+    glm::dvec3 k2v = stage.velocity, k2a(0.0);
+    computeDerivatives(stage, k2a, unused, gradient);
+    StateTransition k2 = transitionRate(phi, gradient);
+    
+    stage.position = state.position + k2v * (dt * 0.5);
+    stage.velocity = state.velocity + k2a * (dt * 0.5);
+    phi = transition + (dt * 0.5) * k2;
+    glm::dvec3 k3v = stage.velocity, k3a(0.0);
+    computeDerivatives(stage, k3a, unused, gradient);
+    StateTransition k3 = transitionRate(phi, gradient);
+    
+    stage.position = state.position + k3v * dt;
+    stage.velocity = state.velocity + k3a * dt;
+    phi = transition + dt * k3;
+    glm::dvec3 k4v = stage.velocity, k4a(0.0);
+    computeDerivatives(stage, k4a, unused, gradient);
+    StateTransition k4 = transitionRate(phi, gradient);
+    
+    state.position += (k1v + 2.0 * k2v + 2.0 * k3v + k4v) * (dt / 6.0);
+    state.velocity += (k1a + 2.0 * k2a + 2.0 * k3a + k4a) * (dt / 6.0);
+    transition = transition + (dt / 6.0) * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+}
+
+template <DerivativeModel F>
+void Integrator::stepKickDriftKick(SpacecraftState& state, double dt, const F& computeDerivatives,
+                                  const double* weights, int count) {
+    glm::dvec3 accel(0.0), velocityDeriv(0.0);
+    computeDerivatives(state, accel, velocityDeriv);
+    
+    for (int i = 0; i < count; ++i) {
+        double h = weights[i] * dt;
+        state.velocity += accel * (h * 0.5);
+        state.position += state.velocity * h;
+        computeDerivatives(state, accel, velocityDeriv);
+        state.velocity += accel * (h * 0.5);
+    }
+}
+
+template <DerivativeModel F>
+void Integrator::stepDriftKickDrift(SpacecraftState& state, double dt, const F& computeDerivatives,
+                                   const double* weights, int count) {
+    glm::dvec3 accel(0.0), velocityDeriv(0.0);
+    
+    for (int i = 0; i < count; ++i) {
+        double h = weights[i] * dt;
+        state.position += state.velocity * (h * 0.5);
+        computeDerivatives(state, accel, velocityDeriv);
+        state.velocity += accel * h;
+        state.position += state.velocity * (h * 0.5);
+    }
+}
+
+template <DerivativeModel F>
+void Integrator::stepVelocityVerlet(SpacecraftState& state, double dt,
+                                   const F& computeDerivatives) {
+    constexpr double single[1] = {1.0};
+    stepKickDriftKick(state, dt, computeDerivatives, single, 1);
+}
+
+template <DerivativeModel F>
+void Integrator::stepForestRuth(SpacecraftState& state, double dt,
+                               const F& computeDerivatives) {
+    // Forest & Ruth (1990): position-first form of the triple jump
+    stepDriftKickDrift(state, dt, computeDerivatives, TRIPLE_JUMP, 3);
+}
+
+template <DerivativeModel F>
+void Integrator::stepYoshida4(SpacecraftState& state, double dt,
+                             const F& computeDerivatives) {
+    // Yoshida (1990): triple jump composed from velocity Verlet
+    stepKickDriftKick(state, dt, computeDerivatives, TRIPLE_JUMP, 3);
+}
+
+template <DerivativeModel F>
+void Integrator::stepYoshida6(SpacecraftState& state, double dt,
+                             const F& computeDerivatives) {
+    stepDriftKickDrift(state, dt, computeDerivatives, YOSHIDA6, 7);
+}
+
+template <DerivativeModel F>
+std::vector<glm::dvec3> Integrator::predictTrajectory(
+    const SpacecraftState& initialState,
+    double duration,
+    double dt,
+    int maxSteps,
+    const F& computeDerivatives,
+    double bodyRadius) {
+    
+    std::vector<glm::dvec3> trajectory;
+    trajectory.reserve(maxSteps);
+    
+    SpacecraftState state = initialState;
+    double t = 0.0;
+    int steps = 0;
+    
+    trajectory.push_back(state.position);
+    
+    while (t < duration && steps < maxSteps) {
+        stepRK4(state, dt, computeDerivatives);
+        t += dt;
+        steps++;
+        
+        // Check for collision with body
+        if (bodyRadius > 0.0 && glm::length(state.position) <= bodyRadius) {
+            trajectory.push_back(state.position);
+            break;
+        }
+        
+        trajectory.push_back(state.position);
+    }
+    
+    return trajectory;
+}
+
+template <DerivativeModel F>
+SpacecraftState Integrator::propagateAdaptive(
+    const SpacecraftState& initialState,
+    double duration,
+    const F& computeDerivatives,
+    const AdaptiveOptions& options,
+    DenseTrajectory* outTrajectory,
+    AdaptiveStats* outStats,
+    double bodyRadius) {
+    
+    // Dormand-Prince 5(4) tableau
+    constexpr double a21 = 1.0 / 5.0;
+    constexpr double a31 = 3.0 / 40.0, a32 = 9.0 / 40.0;
+    constexpr double a41 = 44.0 / 45.0, a42 = -56.0 / 15.0, a43 = 32.0 / 9.0;
+    constexpr double a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0,
+                     a53 = 64448.0 / 6561.0, a54 = -212.0 / 729.0;
+    constexpr double a61 = 9017.0 / 3168.0, a62 = -355.0 / 33.0, a63 = 46732.0 / 5247.0,
+                     a64 = 49.0 / 176.0, a65 = -5103.0 / 18656.0;
+    constexpr double a71 = 35.0 / 384.0, a73 = 500.0 / 1113.0, a74 = 125.0 / 192.0,
+                     a75 = -2187.0 / 6784.0, a76 = 11.0 / 84.0;
+    // Difference between the 5th and embedded 4th order weights
+    constexpr double e1 = 71.0 / 57600.0, e3 = -71.0 / 16695.0, e4 = 71.0 / 1920.0,
+                     e5 = -17253.0 / 339200.0, e6 = 22.0 / 525.0, e7 = -1.0 / 40.0;
+    // Continuous extension (Hairer, Norsett & Wanner)
+    constexpr double d1 = -12715105075.0 / 11282082432.0, d3 = 87487479700.0 / 32700410799.0,
+                     d4 = -10690763975.0 / 1880347072.0, d5 = 701980252875.0 / 199316789632.0,
+                     d6 = -1453857185.0 / 822651844.0, d7 = 69997945.0 / 29380423.0;
+    
+    AdaptiveStats stats;
+    if (outTrajectory) {
+        outTrajectory->clear();
+    }
+    
+    SpacecraftState state = initialState;
+    if (duration <= 0.0) {
+        if (outStats) *outStats = stats;
+        return state;
+    }
+    
+    glm::dvec3 unused(0.0);
+    auto evaluate = [&](const SpacecraftState& s, glm::dvec3& outAccel) {
+        computeDerivatives(s, outAccel, unused);
+        stats.evaluations++;
+    };
+    
+    // First stage, reused across steps (first-same-as-last)
+    glm::dvec3 k1r = state.velocity, k1v(0.0);
+    evaluate(state, k1v);
+    
+    double h = options.initialStep;
+    if (h <= 0.0) {
+        // A hundredth of the local radius / speed time scale
+        double speed = glm::length(state.velocity);
+        h = 0.01 * glm::length(state.position) / std::max(speed, 1e-3);
+    }
+    if (options.maxStep > 0.0) {
+        h = std::min(h, options.maxStep);
+    }
+    
+    double t = 0.0;
+    int steps = 0;
+    SpacecraftState stage = state;
+    
+    while (t < duration && steps < options.maxSteps) {
+        if (options.cancel && options.cancel->load(std::memory_order_relaxed)) {
+            break;
+        }
+        
+        bool lastStep = false;
+        if (t + h >= duration) {
+            h = duration - t;
+            lastStep = true;
+        }
+        
+        const glm::dvec3& r0 = state.position;
+        const glm::dvec3& v0 = state.velocity;
+        
+        stage.position = r0 + h * (a21 * k1r);
+        stage.velocity = v0 + h * (a21 * k1v);
+        glm::dvec3 k2r = stage.velocity, k2v(0.0);
+        evaluate(stage, k2v);
+        
+        stage.position = r0 + h * (a31 * k1r + a32 * k2r);
+        stage.velocity = v0 + h * (a31 * k1v + a32 * k2v);
+        glm::dvec3 k3r = stage.velocity, k3v(0.0);
+        evaluate(stage, k3v);
+        
+        stage.position = r0 + h * (a41 * k1r + a42 * k2r + a43 * k3r);
+        stage.velocity = v0 + h * (a41 * k1v + a42 * k2v + a43 * k3v);
+        glm::dvec3 k4r = stage.velocity, k4v(0.0);
+        evaluate(stage, k4v);
+        
+        stage.position = r0 + h * (a51 * k1r + a52 * k2r + a53 * k3r + a54 * k4r);
+        stage.velocity = v0 + h * (a51 * k1v + a52 * k2v + a53 * k3v + a54 * k4v);
+        glm::dvec3 k5r = stage.velocity, k5v(0.0);
+        evaluate(stage, k5v);
+        
+        stage.position = r0 + h * (a61 * k1r + a62 * k2r + a63 * k3r + a64 * k4r + a65 * k5r);
+        stage.velocity = v0 + h * (a61 * k1v + a62 * k2v + a63 * k3v + a64 * k4v + a65 * k5v);
+        glm::dvec3 k6r = stage.velocity, k6v(0.0);
+        evaluate(stage, k6v);
+        
+        // 5th order solution, also the 7th stage point
+        glm::dvec3 r1 = r0 + h * (a71 * k1r + a73 * k3r + a74 * k4r + a75 * k5r + a76 * k6r);
+        glm::dvec3 v1 = v0 + h * (a71 * k1v + a73 * k3v + a74 * k4v + a75 * k5v + a76 * k6v);
+        stage.position = r1;
+        stage.velocity = v1;
+        glm::dvec3 k7r = v1, k7v(0.0);
+        evaluate(stage, k7v);
+        
+        glm::dvec3 errR = h * (e1 * k1r + e3 * k3r + e4 * k4r + e5 * k5r + e6 * k6r + e7 * k7r);
+        glm::dvec3 errV = h * (e1 * k1v + e3 * k3v + e4 * k4v + e5 * k5v + e6 * k6v + e7 * k7v);
+        
+        double err = scaledError(r0, v0, r1, v1, errR, errV, options);
+        
+        // Standard step size controller, exponent 1/5 for the 4th order estimate
+        double factor = (err > 0.0) ? 0.9 * std::pow(err, -0.2) : 5.0;
+        
+        if (err > 1.0 && h > options.minStep) {
+            stats.rejectedSteps++;
+            h = std::max(h * std::max(0.2, factor), options.minStep);
+            continue;
+        }
+        
+        if (outTrajectory) {
+            DenseTrajectory::Segment segment;
+            segment.t0 = t;
+            segment.h = h;
+            segment.position[0] = r0;
+            segment.position[1] = r1 - r0;
+            segment.position[2] = h * k1r - segment.position[1];
+            segment.position[3] = segment.position[1] - h * k7r - segment.position[2];
+            segment.position[4] = h * (d1 * k1r + d3 * k3r + d4 * k4r + d5 * k5r + d6 * k6r + d7 * k7r);
+            segment.velocity[0] = v0;
+            segment.velocity[1] = v1 - v0;
+            segment.velocity[2] = h * k1v - segment.velocity[1];
+            segment.velocity[3] = segment.velocity[1] - h * k7v - segment.velocity[2];
+            segment.velocity[4] = h * (d1 * k1v + d3 * k3v + d4 * k4v + d5 * k5v + d6 * k6v + d7 * k7v);
+            outTrajectory->addSegment(segment);
+        }
+        
+        stats.acceptedSteps++;
+        steps++;
+        t = lastStep ? duration : t + h;
+        state.position = r1;
+        state.velocity = v1;
+        k1r = k7r;
+        k1v = k7v;
+        
+        if (bodyRadius > 0.0 && glm::length(r1) <= bodyRadius) {
+            break;
+        }
+        
+        h *= std::min(5.0, factor);
+        if (options.maxStep > 0.0) {
+            h = std::min(h, options.maxStep);
+        }
+    }
+    
+    if (outStats) {
+        *outStats = stats;
+    }
+    return state;
+}
+
+template <DifferentiableModel F>
+SpacecraftState Integrator::propagateWithTransition(
+    const SpacecraftState& initialState,
+    double duration,
+    const F& computeDerivatives,
+    StateTransition& outTransition,
+    const AdaptiveOptions& options,
+    AdaptiveStats* outStats) {
+    
+    // Dormand-Prince 5(4), as in propagateAdaptive
+    constexpr double a21 = 1.0 / 5.0;
+    constexpr double a31 = 3.0 / 40.0, a32 = 9.0 / 40.0;
+    constexpr double a41 = 44.0 / 45.0, a42 = -56.0 / 15.0, a43 = 32.0 / 9.0;
+    constexpr double a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0,
+                     a53 = 64448.0 / 6561.0, a54 = -212.0 / 729.0;
+    constexpr double a61 = 9017.0 / 3168.0, a62 = -355.0 / 33.0, a63 = 46732.0 / 5247.0,
+                     a64 = 49.0 / 176.0, a65 = -5103.0 / 18656.0;
+    constexpr double a71 = 35.0 / 384.0, a73 = 500.0 / 1113.0, a74 = 125.0 / 192.0,
+                     a75 = -2187.0 / 6784.0, a76 = 11.0 / 84.0;
+    constexpr double e1 = 71.0 / 57600.0, e3 = -71.0 / 16695.0, e4 = 71.0 / 1920.0,
+                     e5 = -17253.0 / 339200.0, e6 = 22.0 / 525.0, e7 = -1.0 / 40.0;
+    
+    AdaptiveStats stats;
+    SpacecraftState state = initialState;
+    StateTransition phi0;
+    outTransition = phi0;
+    if (duration <= 0.0) {
+        if (outStats) *outStats = stats;
+        return state;
+    }
+    
+    glm::dvec3 unused(0.0);
+    glm::dmat3 gradient(0.0);
+    auto evaluate = [&](const SpacecraftState& s, const StateTransition& phi,
+                        glm::dvec3& outAccel, StateTransition& outRate) {
+        computeDerivatives(s, outAccel, unused, gradient);
+        outRate = transitionRate(phi, gradient);
+        stats.evaluations++;
+    };
+    
+    // First stage, reused across steps (first-same-as-last)
+    glm::dvec3 k1r = state.velocity, k1v(0.0);
+    StateTransition k1;
+    evaluate(state, phi0, k1v, k1);
+    
+    double h = options.initialStep;
+    if (h <= 0.0) {
+        double speed = glm::length(state.velocity);
+        h = 0.01 * glm::length(state.position) / std::max(speed, 1e-3);
+    }
+    if (options.maxStep > 0.0) {
+        h = std::min(h, options.maxStep);
+    }
+    
+    double t = 0.0;
+    int steps = 0;
+    SpacecraftState stage = state;
+    StateTransition phi;
+    
+    while (t < duration && steps < options.maxSteps) {
+        if (options.cancel && options.cancel->load(std::memory_order_relaxed)) {
+            break;
+        }
+        
+        bool lastStep = false;
+        if (t + h >= duration) {
+            h = duration - t;
+            lastStep = true;
+        }
+        
+        const glm::dvec3& r0 = state.position;
+        const glm::dvec3& v0 = state.velocity;
+        
+        stage.position = r0 + h * (a21 * k1r);
+        stage.velocity = v0 + h * (a21 * k1v);
+        phi = phi0 + (h * a21) * k1;
+        glm::dvec3 k2r = stage.velocity, k2v(0.0);
+        StateTransition k2;
+        evaluate(stage, phi, k2v, k2);
+        
+        stage.position = r0 + h * (a31 * k1r + a32 * k2r);
+        stage.velocity = v0 + h * (a31 * k1v + a32 * k2v);
+        phi = phi0 + h * (a31 * k1 + a32 * k2);
+        glm::dvec3 k3r = stage.velocity, k3v(0.0);
+        StateTransition k3;
+        evaluate(stage, phi, k3v, k3);
+        
+        stage.position = r0 + h * (a41 * k1r + a42 * k2r + a43 * k3r);
+        stage.velocity = v0 + h * (a41 * k1v + a42 * k2v + a43 * k3v);
+        phi = phi0 + h * (a41 * k1 + a42 * k2 + a43 * k3);
+        glm::dvec3 k4r = stage.velocity, k4v(0.0);
+        StateTransition k4;
+        evaluate(stage, phi, k4v, k4);
+        
+        stage.position = r0 + h * (a51 * k1r + a52 * k2r + a53 * k3r + a54 * k4r);
+        stage.velocity = v0 + h * (a51 * k1v + a52 * k2v + a53 * k3v + a54 * k4v);
+        phi = phi0 + h * (a51 * k1 + a52 * k2 + a53 * k3 + a54 * k4);
+        glm::dvec3 k5r = stage.velocity, k5v(0.0);
+        StateTransition k5;
+        evaluate(stage, phi, k5v, k5);
+        
+        stage.position = r0 + h * (a61 * k1r + a62 * k2r + a63 * k3r + a64 * k4r + a65 * k5r);
+        stage.velocity = v0 + h * (a61 * k1v + a62 * k2v + a63 * k3v + a64 * k4v + a65 * k5v);
+        phi = phi0 + h * (a61 * k1 + a62 * k2 + a63 * k3 + a64 * k4 + a65 * k5);
+        glm::dvec3 k6r = stage.velocity, k6v(0.0);
+        StateTransition k6;
+        evaluate(stage, phi, k6v, k6);
+        
+        glm::dvec3 r1 = r0 + h * (a71 * k1r + a73 * k3r + a74 * k4r + a75 * k5r + a76 * k6r);
+        glm::dvec3 v1 = v0 + h * (a71 * k1v + a73 * k3v + a74 * k4v + a75 * k5v + a76 * k6v);
+        StateTransition phi1 = phi0 + h * (a71 * k1 + a73 * k3 + a74 * k4 + a75 * k5 + a76 * k6);
+        stage.position = r1;
+        stage.velocity = v1;
+        glm::dvec3 k7r = v1, k7v(0.0);
+        StateTransition k7;
+        evaluate(stage, phi1, k7v, k7);
+        
+        glm::dvec3 errR = h * (e1 * k1r + e3 * k3r + e4 * k4r + e5 * k5r + e6 * k6r + e7 * k7r);
+        glm::dvec3 errV = h * (e1 * k1v + e3 * k3v + e4 * k4v + e5 * k5v + e6 * k6v + e7 * k7v);
+        
+        double err = scaledError(r0, v0, r1, v1, errR, errV, options);
+        double factor = (err > 0.0) ? 0.9 * std::pow(err, -0.2) : 5.0;
+        
+        if (err > 1.0 && h > options.minStep) {
+            stats.rejectedSteps++;
+            h = std::max(h * std::max(0.2, factor), options.minStep);
+            continue;
+        }
+        
+        stats.acceptedSteps++;
+        steps++;
+        t = lastStep ? duration : t + h;
+        state.position = r1;
+        state.velocity = v1;
+        phi0 = phi1;
+        k1r = k7r;
+        k1v = k7v;
+        k1 = k7;
+        
+        h *= std::min(5.0, factor);
+        if (options.maxStep > 0.0) {
+            h = std::min(h, options.maxStep);
+        }
+    }
+    
+    outTransition = phi0;
+    if (outStats) {
+        *outStats = stats;
+    }
+    return state;
+}
+
+inline double Integrator::scaledError(const glm::dvec3& r0, const glm::dvec3& v0,
+                                      const glm::dvec3& r1, const glm::dvec3& v1,
+                                      const glm::dvec3& errR, const glm::dvec3& errV,
+                                      const AdaptiveOptions& options) {
+    double sum = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        double scaleR = options.absTol + options.relTol * std::max(std::abs(r0[i]), std::abs(r1[i]));
+        double scaleV = options.absTol + options.relTol * std::max(std::abs(v0[i]), std::abs(v1[i]));
+        sum += (errR[i] / scaleR) * (errR[i] / scaleR) + (errV[i] / scaleV) * (errV[i] / scaleV);
+    }
+    return std::sqrt(sum / 6.0);
+}
+
+template <DerivativeModel F>
+SpacecraftState Integrator::propagateBulirschStoer(
+    const SpacecraftState& initialState,
+    double duration,
+    const F& computeDerivatives,
+    const AdaptiveOptions& options,
+    DenseTrajectory* outTrajectory,
+    AdaptiveStats* outStats,
+    double bodyRadius) {
+    
+    // Evaluations for columns 0..k, counting the one at the step start
+    // (shared by all columns and carried over from the previous step)
+    double work[BS_COLUMNS];
+    for (int k = 0; k < BS_COLUMNS; ++k) {
+        work[k] = (k == 0 ? 1.0 : work[k - 1]) + (2.0 * (k + 1) - 1.0);
+    }
+    
+    AdaptiveStats stats;
+    if (outTrajectory) {
+        outTrajectory->clear();
+    }
+    
+    SpacecraftState state = initialState;
+    if (duration <= 0.0) {
+        if (outStats) *outStats = stats;
+        return state;
+    }
+    
+    glm::dvec3 unused(0.0);
+    auto evaluate = [&](const SpacecraftState& s, glm::dvec3& outAccel) {
+        computeDerivatives(s, outAccel, unused);
+        stats.evaluations++;
+    };
+    
+    glm::dvec3 a0(0.0);
+    evaluate(state, a0);
+    
+    double h = options.initialStep;
+    if (h <= 0.0) {
+        // Extrapolation steps are long: a tenth of the local time scale
+        double speed = glm::length(state.velocity);
+        h = 0.1 * glm::length(state.position) / std::max(speed, 1e-3);
+    }
+    if (options.maxStep > 0.0) {
+        h = std::min(h, options.maxStep);
+    }
+    
+    // Extrapolation tableau (position and velocity), and the midpoint value
+    // of every sequence for dense output
+    glm::dvec3 tableR[BS_COLUMNS][BS_COLUMNS], tableV[BS_COLUMNS][BS_COLUMNS];
+    glm::dvec3 midR[BS_COLUMNS], midV[BS_COLUMNS];
+    double optimalStep[BS_COLUMNS] = {};
+    int target = 4;     // column expected to converge
+    auto costPerTime = [&](int k) { return work[k] / optimalStep[k]; };
+    
+    double t = 0.0;
+    int steps = 0;
+    SpacecraftState stage = state;
+    
+    while (t < duration && steps < options.maxSteps) {
+        if (options.cancel && options.cancel->load(std::memory_order_relaxed)) {
+            break;
+        }
+        
+        bool lastStep = false;
+        if (t + h >= duration) {
+            h = duration - t;
+            lastStep = true;
+        }
+        
+        const glm::dvec3& r0 = state.position;
+        const glm::dvec3& v0 = state.velocity;
+        
+        // Columns target - 1 to target + 1 may accept the step
+        int column = 0;
+        bool converged = false;
+        int lastColumn = std::min(target + 1, BS_COLUMNS - 1);
+        for (int k = 0; k <= lastColumn; ++k) {
+            // Modified midpoint rule with n substeps (no final smoothing)
+            int n = 2 * (k + 1);
+            double sub = h / n;
+            glm::dvec3 prevR = r0, prevV = v0;
+            glm::dvec3 r = r0 + sub * v0, v = v0 + sub * a0;
+            for (int m = 1; m < n; ++m) {
+                if (m == n / 2) {
+                    midR[k] = r;
+                    midV[k] = v;
+                }
+                stage.position = r;
+                stage.velocity = v;
+                glm::dvec3 a(0.0);
+                evaluate(stage, a);
+                glm::dvec3 nextR = prevR + 2.0 * sub * v;
+                glm::dvec3 nextV = prevV + 2.0 * sub * a;
+                prevR = r;
+                prevV = v;
+                r = nextR;
+                v = nextV;
+            }
+            
+            // Aitken-Neville extrapolation to zero substep in powers of sub^2
+            tableR[k][0] = r;
+            tableV[k][0] = v;
+            for (int j = 1; j <= k; ++j) {
+                double ratio = static_cast<double>(k + 1) / (k - j + 1);
+                double factor = 1.0 / (ratio * ratio - 1.0);
+                tableR[k][j] = tableR[k][j - 1] + (tableR[k][j - 1] - tableR[k - 1][j - 1]) * factor;
+                tableV[k][j] = tableV[k][j - 1] + (tableV[k][j - 1] - tableV[k - 1][j - 1]) * factor;
+            }
+            if (k == 0) {
+                continue;
+            }
+            
+            // The difference between the two highest orders estimates the
+            // error of the lower one, of order 2k - 1 in h
+            double err = scaledError(r0, v0, tableR[k][k], tableV[k][k],
+                                     tableR[k][k] - tableR[k][k - 1], tableV[k][k] - tableV[k][k - 1],
+                                     options);
+            double factor = (err > 0.0) ? 0.94 * std::pow(0.65 / err, 1.0 / (2 * k + 1)) : 4.0;
+            optimalStep[k] = h * std::clamp(factor, 0.05, 4.0);
+            column = k;
+            
+            if (err <= 1.0 && k >= target - 1) {
+                converged = true;
+                break;
+            }
+        }
+        
+        if (!converged && h > options.minStep) {
+            stats.rejectedSteps++;
+            h = std::max(std::min(optimalStep[std::min(target, column)], 0.5 * h), options.minStep);
+            continue;
+        }
+        
+        glm::dvec3 r1 = tableR[column][column], v1 = tableV[column][column];
+        stage.position = r1;
+        stage.velocity = v1;
+        glm::dvec3 a1(0.0);
+        evaluate(stage, a1);
+        
+        if (outTrajectory) {
+            // The midpoint value of a sequence has an expansion in even
+            // powers of the substep when it falls on an even substep, i.e.
+            // for odd k; extrapolate those the same way as the end point
+            int count = 0;
+            glm::dvec3 extrapolatedR[BS_COLUMNS], extrapolatedV[BS_COLUMNS];
+            for (int k = 1; k <= column; k += 2) {
+                extrapolatedR[count] = midR[k];
+                extrapolatedV[count] = midV[k];
+                for (int j = count - 1; j >= 0; --j) {
+                    double ratio = static_cast<double>(k + 1) / (2 * j + 2);
+                    double factor = 1.0 / (ratio * ratio - 1.0);
+                    extrapolatedR[j] = extrapolatedR[j + 1] + (extrapolatedR[j + 1] - extrapolatedR[j]) * factor;
+                    extrapolatedV[j] = extrapolatedV[j + 1] + (extrapolatedV[j + 1] - extrapolatedV[j]) * factor;
+                }
+                count++;
+            }
+            glm::dvec3 middleR = extrapolatedR[0], middleV = extrapolatedV[0];
+            
+            // Cubic Hermite through both ends, plus the quartic term that
+            // passes through the midpoint: theta = 1/2 weighs c4 by 1/16
+            DenseTrajectory::Segment segment;
+            segment.t0 = t;
+            segment.h = h;
+            segment.position[0] = r0;
+            segment.position[1] = r1 - r0;
+            segment.position[2] = h * v0 - segment.position[1];
+            segment.position[3] = segment.position[1] - h * v1 - segment.position[2];
+            segment.position[4] = 16.0 * (middleR - r0) - 8.0 * segment.position[1]
+                                - 4.0 * segment.position[2] - 2.0 * segment.position[3];
+            segment.velocity[0] = v0;
+            segment.velocity[1] = v1 - v0;
+            segment.velocity[2] = h * a0 - segment.velocity[1];
+            segment.velocity[3] = segment.velocity[1] - h * a1 - segment.velocity[2];
+            segment.velocity[4] = 16.0 * (middleV - v0) - 8.0 * segment.velocity[1]
+                                - 4.0 * segment.velocity[2] - 2.0 * segment.velocity[3];
+            outTrajectory->addSegment(segment);
+        }
+        
+        stats.acceptedSteps++;
+        steps++;
+        t = lastStep ? duration : t + h;
+        state.position = r1;
+        state.velocity = v1;
+        a0 = a1;
+        
+        if (bodyRadius > 0.0 && glm::length(r1) <= bodyRadius) {
+            break;
+        }
+        
+        // Order control (Hairer, Norsett & Wanner II.9): move to the
+        // neighbouring column when it costs clearly less per unit time
+        int next = column;
+        if (column >= 2 && costPerTime(column - 1) < 0.8 * costPerTime(column)) {
+            next = column - 1;
+        } else if (column <= target && column + 1 < BS_COLUMNS &&
+                   costPerTime(column) < 0.9 * costPerTime(column - 1)) {
+            next = column + 1;
+        }
+        h = (next > column) ? optimalStep[column] * work[next] / work[column] : optimalStep[next];
+        target = std::clamp(next, 2, BS_COLUMNS - 2);
+        
+        if (options.maxStep > 0.0) {
+            h = std::min(h, options.maxStep);
+        }
+    }
+    
+    if (outStats) {
+        *outStats = stats;
+    }
+    return state;
+}
@@ -0,0 +1,78 @@
+#include "ManeuverTimeline.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+bool ManeuverTimeline::add(const BurnNode& node, double now, uint32_t& outId, std::string& outError) {
+    if (!(node.duration > 0.0)) {
+        outError = "burn duration must be positive";
+        return false;
+    }
+    if (node.startTime < now - TIME_TOLERANCE) {
+        outError = "burn starts in the past";
+        return false;
+    }
+    if (m_nodes.size() >= MAX_NODES) {
+        outError = "maneuver timeline is full";
+        return false;
+    }
+    
+    auto position = std::upper_bound(m_nodes.begin(), m_nodes.end(), node.startTime,
+                                     [](double time, const BurnNode& other) { return time < other.startTime; });
+    if (position != m_nodes.end() && node.getEndTime() > position->startTime + TIME_TOLERANCE) {
+        outError = "burn overlaps the next planned burn";
+        return false;
+    }
+    if (position != m_nodes.begin() && std::prev(position)->getEndTime() > node.startTime + TIME_TOLERANCE) {
+        outError = "burn overlaps the previous planned burn";
+        return false;
+    }
+    
+    BurnNode inserted = node;
+    inserted.id = m_nextId++;
+    m_nodes.insert(position, inserted);
+    outId = inserted.id;
+    return true;
+}
+
+bool ManeuverTimeline::remove(uint32_t id) {
+    auto it = std::find_if(m_nodes.begin(), m_nodes.end(), [id](const BurnNode& node) { return node.id == id; });
+    if (it == m_nodes.end()) {
+        return false;
+    }
+    m_nodes.erase(it);
+    return true;
+}
+
+const BurnNode* ManeuverTimeline::findActive(double time) const {
+    for (const BurnNode& node : m_nodes) {
+        if (node.startTime > time + TIME_TOLERANCE) {
+            break;
+        }
+        if (node.getEndTime() > time + TIME_TOLERANCE) {
+            return &node;
+        }
+    }
+    return nullptr;
+}
+
+double ManeuverTimeline::getNextBoundary(double time) const {
+    for (const BurnNode& node : m_nodes) {
+        if (node.startTime > time + TIME_TOLERANCE) {
+            return node.startTime;
+        }
+        if (node.getEndTime() > time + TIME_TOLERANCE) {
+            return node.getEndTime();
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+size_t ManeuverTimeline::retire(double time) {
+    size_t count = 0;
+    while (count < m_nodes.size() && m_nodes[count].getEndTime() <= time + TIME_TOLERANCE) {
+        ++count;
+    }
+    m_nodes.erase(m_nodes.begin(), m_nodes.begin() + count);
+    return count;
+}
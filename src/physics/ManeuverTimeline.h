@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Spacecraft.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One planned burn, on simulation time
+struct BurnNode {
+    uint32_t id = 0;                // assigned by ManeuverTimeline::add
+    double startTime = 0.0;         // simulation time of ignition (seconds)
+    double duration = 0.0;          // seconds
+    double throttle = 1.0;          // 0..1
+    Spacecraft::ThrustMode mode = Spacecraft::ThrustMode::Prograde;
+    glm::dvec3 direction{1.0, 0.0, 0.0};    // inertial unit, for ThrustMode::Custom
+    
+    double getEndTime() const { return startTime + duration; }
+};
+
+// Queue of planned burns, sorted by ignition time and never overlapping.
+// The warp scheduler reads it each frame and ends every segment on the next
+// ignition or cutoff, so burns start and stop on the exact simulation time
+// whatever the step, the warp or the frame rate. Burns that have ended are
+// retired by the owner.
+class ManeuverTimeline {
+public:
+    static constexpr size_t MAX_NODES = 32;
+    
+    // Boundaries closer than this to a time count as reached, so rounding
+    // in the accumulated clock never leaves a sliver of a segment
+    static constexpr double TIME_TOLERANCE = 1e-9;     // seconds
+    
+    // Insert a node, not before now. Returns false with outError if it is
+    // empty, starts in the past, overlaps another node or the queue is
+    // full; otherwise outId is its id.
+    bool add(const BurnNode& node, double now, uint32_t& outId, std::string& outError);
+    
+    // Returns false if there is no node with the id
+    bool remove(uint32_t id);
+    void clear() { m_nodes.clear(); }
+    
+    // Node burning at time (start <= time < end, within TIME_TOLERANCE), or
+    // nullptr while coasting
+    const BurnNode* findActive(double time) const;
+    
+    // First ignition or cutoff later than time, infinity if none
+    double getNextBoundary(double time) const;
+    
+    // Drop the nodes that have ended by time; returns how many
+    size_t retire(double time);
+    
+    const std::vector<BurnNode>& getNodes() const { return m_nodes; }
+    bool isEmpty() const { return m_nodes.empty(); }
+
+private:
+    std::vector<BurnNode> m_nodes;      // by start time
+    uint32_t m_nextId = 1;
+};
@@ -0,0 +1,260 @@
+#include "MonteCarlo.h"
+#include "GravityField.h"
+#include "Orbit.h"
+#include "PoweredFlight.h"
+#include "core/Constants.h"
+#include "core/Random.h"
+#include "core/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+    
+    uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+        return hash;
+    }
+    
+    uint64_t hashResult(uint64_t hash, const SampleResult& result) {
+        const double values[] = {result.impactTime, result.periapsisAltitude,
+                                 result.apoapsisAltitude, result.finalMass};
+        unsigned char impacted = result.impacted ? 1 : 0;
+        hash = hashBytes(hash, &impacted, 1);
+        return hashBytes(hash, values, sizeof(values));
+    }
+    
+    // Statistics of one chunk of consecutive samples
+    struct ChunkSummary {
+        size_t impactCount = 0;
+        RunningStats periapsis;
+        RunningStats apoapsis;
+        RunningStats impactTime;
+        uint64_t digest = FNV_OFFSET;
+    };
+}
+
+void RunningStats::add(double value) {
+    if (count == 0) {
+        min = max = value;
+    } else {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    count++;
+    double delta = value - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (value - mean);
+}
+
+void RunningStats::merge(const RunningStats& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    
+    double n1 = static_cast<double>(count);
+    double n2 = static_cast<double>(other.count);
+    double n = n1 + n2;
+    double delta = other.mean - mean;
+    mean += delta * (n2 / n);
+    m2 += other.m2 + delta * delta * (n1 * n2 / n);
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    count += other.count;
+}
+
+double RunningStats::getStdDev() const {
+    return (count > 1) ? std::sqrt(m2 / static_cast<double>(count - 1)) : 0.0;
+}
+
+double MonteCarloResult::getPeriapsisPercentile(double q) const {
+    uint64_t total = histogramUnderflow + histogramOverflow;
+    for (uint64_t count : periapsisHistogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    
+    double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(total);
+    double cumulative = static_cast<double>(histogramUnderflow);
+    if (rank <= cumulative) {
+        return histogramMin;
+    }
+    
+    for (size_t bin = 0; bin < periapsisHistogram.size(); ++bin) {
+        double count = static_cast<double>(periapsisHistogram[bin]);
+        if (count > 0.0 && rank <= cumulative + count) {
+            double fraction = (rank - cumulative) / count;
+            return histogramMin + (static_cast<double>(bin) + fraction) * histogramBinWidth;
+        }
+        cumulative += count;
+    }
+    return histogramMin + static_cast<double>(periapsisHistogram.size()) * histogramBinWidth;
+}
+
+SampleResult MonteCarlo::runSample(const MonteCarloConfig& config, size_t sampleIndex) {
+    const DispersionModel& dispersion = config.dispersion;
+    CounterRng rng(config.seed, sampleIndex);
+    
+    // Draw every dispersion up front, in a fixed order, so adding a new
+    // dispersion at the end does not reshuffle the existing ones
+    Spacecraft spacecraft = config.nominal;
+    SpacecraftState& state = spacecraft.getState();
+    state.position += glm::dvec3(rng.nextNormal(), rng.nextNormal(), rng.nextNormal()) * dispersion.positionSigma;
+    state.velocity += glm::dvec3(rng.nextNormal(), rng.nextNormal(), rng.nextNormal()) * dispersion.velocitySigma;
+    double thrustScale = 1.0 + dispersion.thrustBias + rng.nextNormal() * dispersion.thrustSigma;
+    double ispScale = 1.0 + rng.nextNormal() * dispersion.ispSigma;
+    double pointing1 = rng.nextNormal() * dispersion.pointingSigma;
+    double pointing2 = rng.nextNormal() * dispersion.pointingSigma;
+    
+    spacecraft.setThrust(config.nominal.getMaxThrust() * std::max(0.0, thrustScale),
+                         config.nominal.getIsp() * std::max(1e-3, ispScale));
+    
+    PoweredFlightModel model;
+    model.thrust = config.burn.throttle * spacecraft.getMaxThrust();
+    model.exhaustVelocity = spacecraft.getIsp() * Constants::G0;
+    model.dryMass = spacecraft.getDryMass();
+    model.mode = config.burn.mode;
+    model.customDirection = spacecraft.getThrustDirection();
+    model.pointingError1 = pointing1;
+    model.pointingError2 = pointing2;
+    
+    GravityFieldForceModel& forceModel = model.gravity;
+    forceModel.mu = Constants::MOON_MU;
+    forceModel.field = config.gravityField;
+    forceModel.degree = config.gravityDegree;
+    forceModel.cache = config.gravityCache;
+    forceModel.ephemeris = config.ephemeris;
+    forceModel.circularEarth = config.circularEarth;
+    const bool timeDependent = !forceModel.isPointMass();
+    const double burnStart = config.burn.startTime;
+    const double burnEnd = config.burn.startTime + config.burn.duration;
+    
+    SampleResult result;
+    double t = 0.0;
+    while (t < config.duration) {
+        // Land step boundaries exactly on the burn start and end
+        double dt = std::min(config.dt, config.duration - t);
+        if (t < burnStart) {
+            dt = std::min(dt, burnStart - t);
+        } else if (t < burnEnd) {
+            dt = std::min(dt, burnEnd - t);
+        }
+        bool burning = (t >= burnStart && t < burnEnd);
+        
+        if (timeDependent) {
+            forceModel.setTime(t);
+        }
+        if (burning && model.thrust > 0.0 && state.mass > model.dryMass) {
+            // Mass in the state vector, direction per stage (always RK4)
+            PoweredFlight::step(state, t, dt, model);
+        } else {
+            Integrator::step(state, dt, config.integrator, forceModel);
+        }
+        t += dt;
+        
+        if (Orbit::computeAltitude(state.position, Constants::MOON_RADIUS) <= 0.0) {
+            result.impacted = true;
+            result.impactTime = t;
+            break;
+        }
+    }
+    
+    OrbitalElements elements = Orbit::computeElements(state.position, state.velocity, Constants::MOON_MU);
+    result.periapsisAltitude = elements.periapsisAltitude;
+    result.apoapsisAltitude = elements.apoapsisAltitude;
+    result.finalMass = state.mass;
+    return result;
+}
+
+MonteCarloResult MonteCarlo::run(const MonteCarloConfig& config, ThreadPool& pool) {
+    auto wallStart = std::chrono::steady_clock::now();
+    
+    MonteCarloResult result;
+    result.sampleCount = config.sampleCount;
+    result.histogramMin = config.histogramMin;
+    result.histogramBinWidth = config.histogramBinWidth;
+    size_t binCount = static_cast<size_t>(std::max(1.0, std::ceil(
+        (config.histogramMax - config.histogramMin) / config.histogramBinWidth)));
+    
+    // Histogram counts are integers, so per-thread histograms can be summed
+    // in any order. The floating-point moments are kept per chunk and merged
+    // in chunk order below.
+    struct ThreadHistogram {
+        std::vector<uint64_t> bins;
+        uint64_t underflow = 0;
+        uint64_t overflow = 0;
+    };
+    std::vector<ThreadHistogram> histograms(pool.getThreadCount() + 1);
+    for (ThreadHistogram& histogram : histograms) {
+        histogram.bins.assign(binCount, 0);
+    }
+    
+    size_t chunkCount = (config.sampleCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<ChunkSummary> chunks(chunkCount);
+    
+    pool.parallelFor(chunkCount, [&](size_t chunkIndex) {
+        ChunkSummary& chunk = chunks[chunkIndex];
+        ThreadHistogram& histogram = histograms[pool.getCurrentWorkerIndex()];
+        size_t begin = chunkIndex * CHUNK_SIZE;
+        size_t end = std::min(begin + CHUNK_SIZE, config.sampleCount);
+        
+        for (size_t i = begin; i < end; ++i) {
+            SampleResult sample = runSample(config, i);
+            
+            chunk.periapsis.add(sample.periapsisAltitude);
+            if (sample.impacted) {
+                chunk.impactCount++;
+                chunk.impactTime.add(sample.impactTime);
+            } else if (std::isfinite(sample.apoapsisAltitude)) {
+                chunk.apoapsis.add(sample.apoapsisAltitude);
+            }
+            chunk.digest = hashResult(chunk.digest, sample);
+            
+            double bin = std::floor((sample.periapsisAltitude - config.histogramMin) / config.histogramBinWidth);
+            if (bin < 0.0) {
+                histogram.underflow++;
+            } else if (bin >= static_cast<double>(binCount)) {
+                histogram.overflow++;
+            } else {
+                histogram.bins[static_cast<size_t>(bin)]++;
+            }
+        }
+    });
+    
+    result.digest = FNV_OFFSET;
+    for (const ChunkSummary& chunk : chunks) {
+        result.impactCount += chunk.impactCount;
+        result.periapsisAltitude.merge(chunk.periapsis);
+        result.apoapsisAltitude.merge(chunk.apoapsis);
+        result.impactTime.merge(chunk.impactTime);
+        result.digest = hashBytes(result.digest, &chunk.digest, sizeof(chunk.digest));
+    }
+    
+    result.periapsisHistogram.assign(binCount, 0);
+    for (const ThreadHistogram& histogram : histograms) {
+        for (size_t bin = 0; bin < binCount; ++bin) {
+            result.periapsisHistogram[bin] += histogram.bins[bin];
+        }
+        result.histogramUnderflow += histogram.underflow;
+        result.histogramOverflow += histogram.overflow;
+    }
+    
+    result.impactProbability = (config.sampleCount > 0)
+        ? static_cast<double>(result.impactCount) / static_cast<double>(config.sampleCount)
+        : 0.0;
+    
+    auto wallEnd = std::chrono::steady_clock::now();
+    result.wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    return result;
+}
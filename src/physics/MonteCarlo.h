@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Integrator.h"
+#include "Spacecraft.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Ephemeris;
+class GravityCache;
+class GravityField;
+class ThreadPool;
+
+// A single finite burn inside the coast, as set up in the Maneuver Planner
+struct BurnPlan {
+    Spacecraft::ThrustMode mode = Spacecraft::ThrustMode::Prograde;
+    double throttle = 1.0;          // 0..1
+    double startTime = 0.0;         // seconds after the start of the run
+    double duration = 0.0;          // seconds (0 = pure coast)
+};
+
+// 1-sigma Gaussian dispersions, drawn independently per sample
+struct DispersionModel {
+    double positionSigma = 0.0;     // meters, per inertial axis
+    double velocitySigma = 0.0;     // m/s, per inertial axis
+    double thrustSigma = 0.0;       // fraction of max thrust
+    double pointingSigma = 0.0;     // radians, per axis perpendicular to the thrust
+    double ispSigma = 0.0;          // fraction of Isp
+    double thrustBias = 0.0;        // fraction applied to every sample (0.02 = 2% hot)
+};
+
+struct MonteCarloConfig {
+    Spacecraft nominal;             // initial state, mass and engine
+    BurnPlan burn;
+    DispersionModel dispersion;
+    
+    double duration = 7200.0;       // seconds
+    double dt = 1.0;                // seconds
+    Integrator::Type integrator = Integrator::Type::RK4;   // coast; burns are RK4 (PoweredFlight)
+    
+    // Gravity: point mass of MOON_MU without a field (or below degree 2).
+    // The cache, if set, must have been built from the field at the degree
+    // in use. Both are shared read-only by every sample.
+    const GravityField* gravityField = nullptr;
+    int gravityDegree = 0;
+    const GravityCache* gravityCache = nullptr;
+    
+    // Earth and Sun perturbations, with time zero at the ephemeris epoch
+    const Ephemeris* ephemeris = nullptr;
+    
+    // Earth on its circular CR3BP orbit instead (point-mass Moon, no Sun)
+    bool circularEarth = false;
+    
+    size_t sampleCount = 1000;
+    uint64_t seed = 1;
+    
+    // Periapsis altitude histogram backing the percentile estimates
+    double histogramMin = -200000.0;    // meters
+    double histogramMax = 5000000.0;    // meters
+    double histogramBinWidth = 100.0;   // meters
+};
+
+struct SampleResult {
+    bool impacted = false;
+    double impactTime = 0.0;            // seconds
+    double periapsisAltitude = 0.0;     // meters, at end of run or at impact
+    double apoapsisAltitude = 0.0;      // meters (infinite if unbound)
+    double finalMass = 0.0;             // kg
+};
+
+// Welford accumulator; merge() combines two partial runs (Chan et al.)
+struct RunningStats {
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    
+    void add(double value);
+    void merge(const RunningStats& other);
+    double getStdDev() const;
+};
+
+struct MonteCarloResult {
+    size_t sampleCount = 0;
+    size_t impactCount = 0;
+    double impactProbability = 0.0;
+    
+    RunningStats periapsisAltitude;     // all samples
+    RunningStats apoapsisAltitude;      // bound, non-impacting samples
+    RunningStats impactTime;            // impacting samples
+    
+    std::vector<uint64_t> periapsisHistogram;
+    uint64_t histogramUnderflow = 0;
+    uint64_t histogramOverflow = 0;
+    double histogramMin = 0.0;
+    double histogramBinWidth = 0.0;
+    
+    // Hash of every sample result in sample order; equal digests mean
+    // bitwise-identical runs
+    uint64_t digest = 0;
+    double wallSeconds = 0.0;
+    
+    // Periapsis altitude at quantile q in [0, 1], interpolated within a
+    // histogram bin and clamped to the histogram range
+    double getPeriapsisPercentile(double q) const;
+};
+
+// Monte Carlo dispersion runner. Every sample draws from its own counter-based
+// RNG stream and partial statistics are merged in a fixed order, so results
+// are bitwise identical for any thread count.
+class MonteCarlo {
+public:
+    // Samples per task; also the granularity at which statistics are merged
+    static constexpr size_t CHUNK_SIZE = 64;
+    
+    static SampleResult runSample(const MonteCarloConfig& config, size_t sampleIndex);
+    static MonteCarloResult run(const MonteCarloConfig& config, ThreadPool& pool);
+};
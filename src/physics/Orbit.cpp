@@ -56,6 +56,12 @@ OrbitalElements Orbit::computeElements(const glm::dvec3& position,
         if (eVec.z < 0) {
             elements.argOfPeriapsis = Constants::TWO_PI - elements.argOfPeriapsis;
         }
+    } else if (elements.eccentricity > 1e-10) {
+        // Equatorial orbit - longitude of periapsis, in the direction of motion
+        elements.argOfPeriapsis = std::atan2(eVec.y * h.z, eVec.x * hMag);
+        if (elements.argOfPeriapsis < 0) {
+            elements.argOfPeriapsis += Constants::TWO_PI;
+        }
     }
     
     // True anomaly
@@ -73,6 +79,12 @@ OrbitalElements Orbit::computeElements(const glm::dvec3& position,
             if (position.z < 0) {
                 elements.trueAnomaly = Constants::TWO_PI - elements.trueAnomaly;
             }
+        } else {
+            // Also equatorial - true longitude
+            elements.trueAnomaly = std::atan2(position.y * h.z, position.x * hMag);
+            if (elements.trueAnomaly < 0) {
+                elements.trueAnomaly += Constants::TWO_PI;
+            }
         }
     }
     
@@ -119,7 +131,6 @@ void Orbit::computeStateFromElements(const OrbitalElements& elements,
     glm::dvec3 vPQW(-std::sin(nu), e + std::cos(nu), 0.0);
     vPQW *= mu / h;
     
-    // Rotation matrix from perifocal to inertial
     double cosOmega = std::cos(omega);
     double sinOmega = std::sin(omega);
     double cosW = std::cos(w);
@@ -127,15 +138,17 @@ void Orbit::computeStateFromElements(const OrbitalElements& elements,
     double cosI = std::cos(i);
     double sinI = std::sin(i);
     
+    // Rotation matrix from perifocal to inertial; glm is column-major, so
+    // rotMat[c][r] holds row r of column c
     glm::dmat3 rotMat;
     rotMat[0][0] = cosOmega * cosW - sinOmega * sinW * cosI;
-    rotMat[0][1] = -cosOmega * sinW - sinOmega * cosW * cosI;
-    rotMat[0][2] = sinOmega * sinI;
-    rotMat[1][0] = sinOmega * cosW + cosOmega * sinW * cosI;
+    rotMat[0][1] = sinOmega * cosW + cosOmega * sinW * cosI;
+    rotMat[0][2] = sinW * sinI;
+    rotMat[1][0] = -cosOmega * sinW - sinOmega * cosW * cosI;
     rotMat[1][1] = -sinOmega * sinW + cosOmega * cosW * cosI;
-    rotMat[1][2] = -cosOmega * sinI;
-    rotMat[2][0] = sinW * sinI;
-    rotMat[2][1] = cosW * sinI;
+    rotMat[1][2] = cosW * sinI;
+    rotMat[2][0] = sinOmega * sinI;
+    rotMat[2][1] = -cosOmega * sinI;
     rotMat[2][2] = cosI;
     
     outPosition = rotMat * rPQW;
@@ -184,6 +197,331 @@ void Orbit::createEllipticalOrbit(double periapsisAltitude,
     computeStateFromElements(elements, mu, outPosition, outVelocity);
 }
 
+double Orbit::stumpffC(double z) {
+    if (z > 1e-3) {
+        // 1 - cos x = 2 sin^2(x/2), without the cancellation near x = 2*pi*k
+        double halfSqrtZ = 0.5 * std::sqrt(z);
+        double s = std::sin(halfSqrtZ);
+        return 2.0 * s * s / z;
+    } else if (z < -1e-3) {
+        return (std::cosh(std::sqrt(-z)) - 1.0) / (-z);
+    }
+    // Series for small |z|
+    return 1.0 / 2.0 - z / 24.0 + z * z / 720.0 - z * z * z / 40320.0;
+}
+
+double Orbit::stumpffS(double z) {
+    if (z > 1e-3) {
+        double sqrtZ = std::sqrt(z);
+        return (sqrtZ - std::sin(sqrtZ)) / (sqrtZ * sqrtZ * sqrtZ);
+    } else if (z < -1e-3) {
+        double sqrtZ = std::sqrt(-z);
+        return (std::sinh(sqrtZ) - sqrtZ) / (sqrtZ * sqrtZ * sqrtZ);
+    }
+    return 1.0 / 6.0 - z / 120.0 + z * z / 5040.0 - z * z * z / 362880.0;
+}
+
+bool Orbit::propagateKepler(const glm::dvec3& position,
+                            const glm::dvec3& velocity,
+                            double dt, double mu,
+                            glm::dvec3& outPosition,
+                            glm::dvec3& outVelocity) {
+    double r0 = glm::length(position);
+    if (r0 <= 0.0 || mu <= 0.0) {
+        return false;
+    }
+    if (dt == 0.0) {
+        outPosition = position;
+        outVelocity = velocity;
+        return true;
+    }
+    
+    double sqrtMu = std::sqrt(mu);
+    double v0Squared = glm::dot(velocity, velocity);
+    double rDotV = glm::dot(position, velocity);
+    double alpha = 2.0 / r0 - v0Squared / mu;  // 1/a; > 0 elliptic, < 0 hyperbolic
+    
+    // Whole revolutions leave an ellipse unchanged; dropping them keeps the
+    // universal anomaly below 2*pi*sqrt(a) so Newton converges for any warp
+    if (alpha > 1e-12) {
+        double period = Constants::TWO_PI / (sqrtMu * alpha * std::sqrt(alpha));
+        dt = std::fmod(dt, period);
+    }
+    
+    // Initial guess for the universal anomaly chi (Vallado, Algorithm 8)
+    double chi;
+    if (alpha > 1e-12) {
+        chi = sqrtMu * dt * alpha;
+    } else if (alpha < -1e-12) {
+        double a = 1.0 / alpha;
+        double sign = (dt > 0.0) ? 1.0 : -1.0;
+        double arg = (-2.0 * mu * alpha * dt) /
+                     (rDotV + sign * std::sqrt(-mu * a) * (1.0 - r0 * alpha));
+        chi = (arg > 0.0) ? sign * std::sqrt(-a) * std::log(arg) : sqrtMu * dt / r0;
+    } else {
+        chi = sqrtMu * dt / r0;
+    }
+    
+    // Newton iteration on the universal Kepler equation
+    const double rDotVOverSqrtMu = rDotV / sqrtMu;
+    double chi2 = 0.0, z = 0.0, c = 0.0, sFunc = 0.0, r = r0;
+    bool converged = false;
+    for (int iteration = 0; iteration < 50; ++iteration) {
+        chi2 = chi * chi;
+        z = alpha * chi2;
+        c = stumpffC(z);
+        sFunc = stumpffS(z);
+        
+        double f = rDotVOverSqrtMu * chi2 * c + (1.0 - alpha * r0) * chi2 * chi * sFunc
+                 + r0 * chi - sqrtMu * dt;
+        r = rDotVOverSqrtMu * chi * (1.0 - z * sFunc) + (1.0 - alpha * r0) * chi2 * c + r0;
+        double delta = f / r;
+        chi -= delta;
+        
+        if (std::abs(delta) <= 1e-13 * std::max(1.0, std::abs(chi))) {
+            converged = true;
+            break;
+        }
+    }
+    if (!converged || !std::isfinite(chi)) {
+        return false;
+    }
+    
+    // Lagrange coefficients at the converged chi
+    chi2 = chi * chi;
+    z = alpha * chi2;
+    c = stumpffC(z);
+    sFunc = stumpffS(z);
+    
+    double f = 1.0 - chi2 / r0 * c;
+    double g = dt - chi2 * chi * sFunc / sqrtMu;
+    glm::dvec3 newPosition = f * position + g * velocity;
+    double rNew = glm::length(newPosition);
+    
+    double fDot = sqrtMu / (rNew * r0) * (z * chi * sFunc - chi);
+    double gDot = 1.0 - chi2 / rNew * c;
+    
+    // Outputs may alias the inputs
+    glm::dvec3 newVelocity = fDot * position + gDot * velocity;
+    outPosition = newPosition;
+    outVelocity = newVelocity;
+    return true;
+}
+
+namespace {
+    // Lambert's problem in Izzo's nondimensional form: the time of flight T
+    // as a function of x for the geometry parameter lambda (-1..1) and N
+    // revolutions. The iteration on x converges in 2-3 steps from the
+    // initial guesses below. Series and Lagrange forms cover the range
+    // near x = 1 (parabolic) where Lancaster's expression cancels.
+    constexpr double LAMBERT_BATTIN_RANGE = 0.01;
+    constexpr double LAMBERT_LAGRANGE_RANGE = 0.2;
+    constexpr int LAMBERT_MAX_ITERATIONS = 15;
+    
+    // Gauss hypergeometric 2F1(3, 1, 5/2, z)
+    double hypergeometricF(double z) {
+        double sum = 1.0, term = 1.0;
+        for (int j = 0; j < 100 && std::abs(term) > 1e-11; ++j) {
+            term *= (3.0 + j) * (1.0 + j) / (2.5 + j) * z / (j + 1.0);
+            sum += term;
+        }
+        return sum;
+    }
+    
+    double lambertTimeLagrange(double x, int revolutions, double lambda) {
+        double a = 1.0 / (1.0 - x * x);
+        double sign = (lambda < 0.0) ? -1.0 : 1.0;
+        if (a > 0.0) {
+            double alpha = 2.0 * std::acos(x);
+            double beta = sign * 2.0 * std::asin(std::sqrt(lambda * lambda / a));
+            return a * std::sqrt(a) * ((alpha - std::sin(alpha)) - (beta - std::sin(beta)) +
+                                       Constants::TWO_PI * revolutions) / 2.0;
+        }
+        double alpha = 2.0 * std::acosh(x);
+        double beta = sign * 2.0 * std::asinh(std::sqrt(-lambda * lambda / a));
+        return -a * std::sqrt(-a) * ((beta - std::sinh(beta)) - (alpha - std::sinh(alpha))) / 2.0;
+    }
+    
+    double lambertTime(double x, int revolutions, double lambda) {
+        double distance = std::abs(x - 1.0);
+        if (distance < LAMBERT_LAGRANGE_RANGE && distance > LAMBERT_BATTIN_RANGE) {
+            return lambertTimeLagrange(x, revolutions, lambda);
+        }
+        
+        double e = x * x - 1.0;
+        double rho = std::abs(e);
+        double z = std::sqrt(1.0 + lambda * lambda * e);
+        if (distance < LAMBERT_BATTIN_RANGE) {
+            double eta = z - lambda * x;
+            double q = 4.0 / 3.0 * hypergeometricF(0.5 * (1.0 - lambda - x * eta));
+            return (eta * eta * eta * q + 4.0 * lambda * eta) / 2.0 +
+                   revolutions * Constants::PI / std::pow(rho, 1.5);
+        }
+        
+        // Lancaster and Blanchard
+        double y = std::sqrt(rho);
+        double g = x * z - lambda * e;
+        double d = (e < 0.0) ? revolutions * Constants::PI + std::acos(g)
+                             : std::log(y * (z - lambda * x) + g);
+        return (x - lambda * z - d / y) / e;
+    }
+    
+    // First three derivatives of T(x), given T at x
+    void lambertTimeDerivatives(double x, double t, double lambda, double& dt, double& ddt, double& dddt) {
+        double l2 = lambda * lambda;
+        double l3 = l2 * lambda;
+        double oneMinusX2 = 1.0 - x * x;
+        double y = std::sqrt(1.0 - l2 * oneMinusX2);
+        double y3 = y * y * y;
+        dt = (3.0 * t * x - 2.0 + 2.0 * l3 * x / y) / oneMinusX2;
+        ddt = (3.0 * t + 5.0 * x * dt + 2.0 * (1.0 - l2) * l3 / y3) / oneMinusX2;
+        dddt = (7.0 * x * ddt + 8.0 * dt - 6.0 * (1.0 - l2) * l2 * l3 * x / (y3 * y * y)) / oneMinusX2;
+    }
+    
+    // Third-order (Householder) iteration on T(x) = target
+    bool solveLambertX(double target, double x, int revolutions, double lambda, double tolerance,
+                       double& outX, int& outIterations) {
+        for (int iteration = 1; iteration <= LAMBERT_MAX_ITERATIONS; ++iteration) {
+            double t = lambertTime(x, revolutions, lambda);
+            double dt, ddt, dddt;
+            lambertTimeDerivatives(x, t, lambda, dt, ddt, dddt);
+            double delta = t - target;
+            double dt2 = dt * dt;
+            double next = x - delta * (dt2 - delta * ddt / 2.0) /
+                              (dt * (dt2 - delta * ddt) + dddt * delta * delta / 6.0);
+            if (!std::isfinite(next)) {
+                return false;
+            }
+            double change = std::abs(next - x);
+            x = next;
+            if (change <= tolerance) {
+                outX = x;
+                outIterations = iteration;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+int Orbit::solveLambert(const glm::dvec3& r1, const glm::dvec3& r2,
+                        double timeOfFlight, double mu,
+                        int maxRevolutions, bool retrograde,
+                        std::vector<LambertSolution>& outSolutions) {
+    outSolutions.clear();
+    double r1Norm = glm::length(r1);
+    double r2Norm = glm::length(r2);
+    double chord = glm::length(r2 - r1);
+    if (timeOfFlight <= 0.0 || mu <= 0.0 || r1Norm <= 0.0 || r2Norm <= 0.0 || chord <= 0.0) {
+        return 0;
+    }
+    
+    glm::dvec3 ir1 = r1 / r1Norm;
+    glm::dvec3 ir2 = r2 / r2Norm;
+    glm::dvec3 ih = glm::cross(ir1, ir2);
+    double sinAngle = glm::length(ih);
+    if (sinAngle < 1e-12) {
+        return 0;
+    }
+    ih /= sinAngle;
+    
+    // Geometry: lambda's sign says whether the transfer angle exceeds 180
+    // degrees in the requested direction; it1 and it2 are the in-plane
+    // directions of motion at each end
+    double semiPerimeter = 0.5 * (r1Norm + r2Norm + chord);
+    double lambda2 = 1.0 - chord / semiPerimeter;
+    double lambda = std::sqrt(lambda2);
+    glm::dvec3 it1, it2;
+    if (ih.z < 0.0) {
+        lambda = -lambda;
+        it1 = glm::cross(ir1, ih);
+        it2 = glm::cross(ir2, ih);
+    } else {
+        it1 = glm::cross(ih, ir1);
+        it2 = glm::cross(ih, ir2);
+    }
+    if (retrograde) {
+        lambda = -lambda;
+        it1 = -it1;
+        it2 = -it2;
+    }
+    double lambda3 = lambda * lambda2;
+    double t = std::sqrt(2.0 * mu / (semiPerimeter * semiPerimeter * semiPerimeter)) * timeOfFlight;
+    
+    // Most revolutions the flight time allows: below T0 the N-revolution
+    // minimum time, found by Halley's method, decides
+    int revolutionsMax = static_cast<int>(t / Constants::PI);
+    double t00 = std::acos(lambda) + lambda * std::sqrt(1.0 - lambda2);
+    double t0 = t00 + revolutionsMax * Constants::PI;
+    double t1 = 2.0 / 3.0 * (1.0 - lambda3);
+    if (revolutionsMax > 0 && revolutionsMax <= maxRevolutions && t < t0) {
+        double x = 0.0, tMin = t0;
+        for (int iteration = 0; iteration < 12; ++iteration) {
+            double dt, ddt, dddt;
+            lambertTimeDerivatives(x, tMin, lambda, dt, ddt, dddt);
+            if (dt == 0.0) {
+                break;
+            }
+            double next = x - dt * ddt / (ddt * ddt - dt * dddt / 2.0);
+            double change = std::abs(next - x);
+            x = next;
+            tMin = lambertTime(x, revolutionsMax, lambda);
+            if (change < 1e-13) {
+                break;
+            }
+        }
+        if (tMin > t) {
+            --revolutionsMax;
+        }
+    }
+    revolutionsMax = std::min(revolutionsMax, std::max(maxRevolutions, 0));
+    
+    // Velocities from x: radial and tangential components at each end
+    const double gamma = std::sqrt(mu * semiPerimeter / 2.0);
+    const double rho = (r1Norm - r2Norm) / chord;
+    const double sigma = std::sqrt(1.0 - rho * rho);
+    auto addSolution = [&](double x, int revolutions, bool rightBranch, int iterations) {
+        double y = std::sqrt(1.0 - lambda2 + lambda2 * x * x);
+        double radial = lambda * y - x;
+        double tangential = lambda * y + x;
+        double vt = gamma * sigma * (y + lambda * x);
+        LambertSolution solution;
+        solution.departureVelocity = gamma * (radial - rho * tangential) / r1Norm * ir1 + vt / r1Norm * it1;
+        solution.arrivalVelocity = -gamma * (radial + rho * tangential) / r2Norm * ir2 + vt / r2Norm * it2;
+        solution.revolutions = revolutions;
+        solution.rightBranch = rightBranch;
+        solution.iterations = iterations;
+        outSolutions.push_back(solution);
+    };
+    
+    // Direct arc; the initial guess is within a few percent everywhere
+    double x0;
+    if (t >= t00) {
+        x0 = -(t - t00) / (t - t00 + 4.0);
+    } else if (t <= t1) {
+        x0 = t1 * (t1 - t) / (2.0 / 5.0 * (1.0 - lambda2 * lambda3) * t) + 1.0;
+    } else {
+        x0 = std::pow(t / t00, std::log(2.0) / std::log(t1 / t00)) - 1.0;
+    }
+    double x;
+    int iterations;
+    if (solveLambertX(t, x0, 0, lambda, 1e-5, x, iterations)) {
+        addSolution(x, 0, false, iterations);
+    }
+    
+    for (int n = 1; n <= revolutionsMax; ++n) {
+        double left = std::pow((n * Constants::PI + Constants::PI) / (8.0 * t), 2.0 / 3.0);
+        if (solveLambertX(t, (left - 1.0) / (left + 1.0), n, lambda, 1e-8, x, iterations)) {
+            addSolution(x, n, false, iterations);
+        }
+        double right = std::pow(8.0 * t / (n * Constants::PI), 2.0 / 3.0);
+        if (solveLambertX(t, (right - 1.0) / (right + 1.0), n, lambda, 1e-8, x, iterations)) {
+            addSolution(x, n, true, iterations);
+        }
+    }
+    return static_cast<int>(outSolutions.size());
+}
+
 double Orbit::computeOrbitalVelocity(double radius, double mu, double semiMajorAxis) {
     return std::sqrt(mu * (2.0 / radius - 1.0 / semiMajorAxis));
 }
@@ -200,6 +538,41 @@ double Orbit::computePeriod(double semiMajorAxis, double mu) {
     return Constants::TWO_PI * std::sqrt(semiMajorAxis * semiMajorAxis * semiMajorAxis / mu);
 }
 
+double Orbit::computeTimeSincePeriapsis(double trueAnomaly, double eccentricity,
+                                        double angularMomentum, double mu) {
+    double nu = std::remainder(trueAnomaly, Constants::TWO_PI);
+    double e = eccentricity;
+    double p = angularMomentum * angularMomentum / mu;
+    
+    // Barker's equation, where the elliptic and hyperbolic forms lose
+    // their precision
+    if (std::abs(e - 1.0) < 1e-4) {
+        double d = std::tan(0.5 * nu);
+        return 0.5 * std::sqrt(p * p * p / mu) * (d + d * d * d / 3.0);
+    }
+    
+    if (e < 1.0) {
+        double a = p / (1.0 - e * e);
+        double E = 2.0 * std::atan2(std::sqrt(1.0 - e) * std::sin(0.5 * nu),
+                                    std::sqrt(1.0 + e) * std::cos(0.5 * nu));
+        return (E - e * std::sin(E)) * std::sqrt(a * a * a / mu);
+    }
+    
+    double a = p / (e * e - 1.0);
+    double x = std::clamp(std::sqrt((e - 1.0) / (e + 1.0)) * std::tan(0.5 * nu), -1.0 + 1e-15, 1.0 - 1e-15);
+    double F = 2.0 * std::atanh(x);
+    return (e * std::sinh(F) - F) * std::sqrt(a * a * a / mu);
+}
+
+double Orbit::computeTimeToPeriapsis(const OrbitalElements& elements, double mu) {
+    double since = computeTimeSincePeriapsis(elements.trueAnomaly, elements.eccentricity,
+                                             elements.angularMomentum, mu);
+    if (elements.eccentricity < 1.0 && std::isfinite(elements.orbitalPeriod)) {
+        return since > 0.0 ? elements.orbitalPeriod - since : -since;
+    }
+    return since < 0.0 ? -since : std::numeric_limits<double>::infinity();
+}
+
 double Orbit::computeAltitude(const glm::dvec3& position, double bodyRadius) {
     return glm::length(position) - bodyRadius;
 }
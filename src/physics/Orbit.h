@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <vector>
 
 struct OrbitalElements {
     double semiMajorAxis = 0.0;      // meters
@@ -16,9 +17,22 @@ struct OrbitalElements {
     double angularMomentum = 0.0;    // m²/s
 };
 
+// One two-body arc between two positions (Orbit::solveLambert)
+struct LambertSolution {
+    glm::dvec3 departureVelocity{0.0};
+    glm::dvec3 arrivalVelocity{0.0};
+    int revolutions = 0;            // complete revolutions before arrival
+    bool rightBranch = false;       // which of an N-revolution pair (Izzo's left/right)
+    int iterations = 0;             // Householder iterations taken
+};
+
 class Orbit {
 public:
-    // Compute orbital elements from state vector
+    // Compute orbital elements from state vector. Without an ascending node
+    // (equatorial) the RAAN is 0 and the argument of periapsis is the
+    // longitude of periapsis; on a circle the argument of periapsis is 0 and
+    // the true anomaly is measured from the node, or from +x if also
+    // equatorial. computeStateFromElements inverts all of these.
     static OrbitalElements computeElements(const glm::dvec3& position, 
                                            const glm::dvec3& velocity, 
                                            double mu);
@@ -44,12 +58,49 @@ public:
                                      glm::dvec3& outPosition,
                                      glm::dvec3& outVelocity);
     
+    // Analytic two-body propagation (universal variables). Advances the state
+    // by dt (either sign, any length, any conic) in O(1). Returns false if the
+    // Kepler solve did not converge; outputs are then left unchanged.
+    static bool propagateKepler(const glm::dvec3& position,
+                                const glm::dvec3& velocity,
+                                double dt, double mu,
+                                glm::dvec3& outPosition,
+                                glm::dvec3& outVelocity);
+    
+    // Lambert's problem: the two-body arcs from r1 to r2 taking
+    // timeOfFlight, by Izzo's algorithm (Celest Mech Dyn Astr 121, 2015).
+    // Clears outSolutions, keeping its capacity, and fills it with the
+    // direct arc and, for each N up to maxRevolutions that the flight time
+    // allows, both N-revolution arcs; returns how many. The arcs run
+    // counterclockwise about +z, or clockwise if retrograde. A transfer
+    // angle of exactly 0 or 180 degrees leaves the plane undefined and
+    // gives none.
+    static int solveLambert(const glm::dvec3& r1, const glm::dvec3& r2,
+                            double timeOfFlight, double mu,
+                            int maxRevolutions, bool retrograde,
+                            std::vector<LambertSolution>& outSolutions);
+    
+    // Stumpff functions C(z) and S(z)
+    static double stumpffC(double z);
+    static double stumpffS(double z);
+    
     // Utility functions
     static double computeOrbitalVelocity(double radius, double mu, double semiMajorAxis);
     static double computeCircularVelocity(double radius, double mu);
     static double computeEscapeVelocity(double radius, double mu);
     static double computePeriod(double semiMajorAxis, double mu);
     
+    // Signed time from periapsis passage to a true anomaly (wrapped to
+    // (-pi, pi]) on the conic of this eccentricity and specific angular
+    // momentum, from Kepler's equation in the eccentric, hyperbolic or,
+    // close to e = 1, parabolic anomaly
+    static double computeTimeSincePeriapsis(double trueAnomaly, double eccentricity,
+                                            double angularMomentum, double mu);
+    
+    // Time until the next periapsis passage; infinity on an open orbit
+    // that has already passed it
+    static double computeTimeToPeriapsis(const OrbitalElements& elements, double mu);
+    
     // Helper to compute altitude from position
     static double computeAltitude(const glm::dvec3& position, double bodyRadius);
 };
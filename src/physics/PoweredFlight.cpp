@@ -0,0 +1,92 @@
+#include "PoweredFlight.h"
+#include <algorithm>
+#include <cmath>
+
+glm::dvec3 PoweredFlightModel::computeDirection(const SpacecraftState& state) const {
+    glm::dvec3 direction = Spacecraft::computeDirection(mode, state, customDirection);
+    if (pointingError1 != 0.0 || pointingError2 != 0.0) {
+        direction = PoweredFlight::applyPointingError(direction, glm::normalize(state.position),
+                                                      pointingError1, pointingError2);
+    }
+    return direction;
+}
+
+void PoweredFlightModel::operator()(double, const PoweredState& y, PoweredState& outDerivative) const {
+    SpacecraftState state;
+    PoweredFlight::unpack(y, state);
+    glm::dvec3 accel, velocity;
+    gravity(state, accel, velocity);
+    accel += (thrust / state.mass) * computeDirection(state);
+    
+    for (int i = 0; i < 3; ++i) {
+        outDerivative[i] = velocity[i];
+        outDerivative[3 + i] = accel[i];
+    }
+    outDerivative[6] = -getMassFlow();
+}
+
+PoweredState PoweredFlight::pack(const SpacecraftState& state) {
+    PoweredState y;
+    for (int i = 0; i < 3; ++i) {
+        y[i] = state.position[i];
+        y[3 + i] = state.velocity[i];
+    }
+    y[6] = state.mass;
+    return y;
+}
+
+void PoweredFlight::unpack(const PoweredState& y, SpacecraftState& state) {
+    for (int i = 0; i < 3; ++i) {
+        state.position[i] = y[i];
+        state.velocity[i] = y[3 + i];
+    }
+    state.mass = y[6];
+}
+
+double PoweredFlight::step(SpacecraftState& state, double t, double h, const PoweredFlightModel& model) {
+    double flow = model.getMassFlow();
+    double burnTime = 0.0;
+    if (flow > 0.0 && state.mass > model.dryMass) {
+        burnTime = std::min(h, (state.mass - model.dryMass) / flow);
+        PoweredState y = pack(state);
+        Integrator::stepRK4(y, t, burnTime, model);
+        unpack(y, state);
+        if (burnTime < h) {
+            // Burnout: the propellant left is rounding, not fuel
+            state.mass = model.dryMass;
+        }
+    }
+    
+    double coast = h - burnTime;
+    if (coast > 0.0) {
+        PoweredFlightModel unpowered = model;
+        unpowered.thrust = 0.0;
+        PoweredState y = pack(state);
+        Integrator::stepRK4(y, t + burnTime, coast, unpowered);
+        unpack(y, state);
+    }
+    return burnTime;
+}
+
+glm::dvec3 PoweredFlight::computeAcceleration(const SpacecraftState& state, const PoweredFlightModel& model) {
+    glm::dvec3 accel, velocity;
+    model.gravity(state, accel, velocity);
+    if (model.thrust > 0.0 && state.mass > model.dryMass) {
+        accel += (model.thrust / state.mass) * model.computeDirection(state);
+    }
+    return accel;
+}
+
+glm::dvec3 PoweredFlight::applyPointingError(const glm::dvec3& direction, const glm::dvec3& reference,
+                                             double angle1, double angle2) {
+    glm::dvec3 perp1 = glm::cross(direction, reference);
+    if (glm::length(perp1) < 1e-10) {
+        perp1 = glm::cross(direction, glm::dvec3(0.0, 0.0, 1.0));
+        if (glm::length(perp1) < 1e-10) {
+            perp1 = glm::dvec3(1.0, 0.0, 0.0);
+        }
+    }
+    perp1 = glm::normalize(perp1);
+    glm::dvec3 perp2 = glm::cross(direction, perp1);
+    return glm::normalize(direction + perp1 * std::tan(angle1) + perp2 * std::tan(angle2));
+}
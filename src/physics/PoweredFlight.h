@@ -0,0 +1,70 @@
+#pragma once
+
+#include "GravityField.h"
+#include "Integrator.h"
+#include "Spacecraft.h"
+#include <glm/glm.hpp>
+
+// Position (components 0-2), velocity (3-5) and mass (6) of a vehicle
+using PoweredState = StateVector<7>;
+
+// Equations of motion of a finite burn, with the mass a state variable:
+//
+//   r' = v,   v' = g(r) + (T / m) d(r, v),   m' = -T / ve
+//
+// The thrust direction d is the thrust mode's at each stage's own position
+// and velocity, so a prograde burn follows the velocity vector as it turns
+// within a step. Gravity is taken at the time last set on it, held over a
+// step as for a coast; its thrustAccel is left zero.
+struct PoweredFlightModel {
+    GravityFieldForceModel gravity;
+    double thrust = 0.0;                // N, at the throttle in use
+    double exhaustVelocity = 1.0;       // m/s, Isp * g0
+    double dryMass = 0.0;               // kg, the engine stops here
+    Spacecraft::ThrustMode mode = Spacecraft::ThrustMode::Prograde;
+    glm::dvec3 customDirection{1.0, 0.0, 0.0};  // unit, for ThrustMode::Custom
+    
+    // Misalignment of the engine, radians about two axes across the thrust
+    double pointingError1 = 0.0;
+    double pointingError2 = 0.0;
+    
+    double getMassFlow() const { return thrust / exhaustVelocity; }
+    
+    // Unit thrust direction at a position and velocity
+    glm::dvec3 computeDirection(const SpacecraftState& state) const;
+    
+    void operator()(double t, const PoweredState& y, PoweredState& outDerivative) const;
+};
+
+// Finite burns integrated with the mass inside the state vector.
+//
+// Taking the thrust acceleration and direction at the start of a step and
+// holding them while the position and velocity are integrated, then taking
+// the propellant off afterwards, is first order in the step however
+// accurate the integrator: T / m rises and a steered direction turns
+// across the step, and neither is seen. With m in the state and the
+// direction evaluated per stage, every RK4 stage sees both, and the burn
+// is fourth order like the coast around it. The mass equation is linear in
+// time, so RK4 integrates it exactly and burnout falls at a known time;
+// a step that reaches it is split there and coasts the rest.
+class PoweredFlight {
+public:
+    static PoweredState pack(const SpacecraftState& state);
+    
+    // Position, velocity and mass back into state; attitude is untouched
+    static void unpack(const PoweredState& y, SpacecraftState& state);
+    
+    // One RK4 step of h seconds from simulation time t. The engine runs
+    // while the mass is above model.dryMass. Returns the seconds of thrust
+    // in the step.
+    static double step(SpacecraftState& state, double t, double h, const PoweredFlightModel& model);
+    
+    // Gravity plus thrust at a state (thrust off at or below the dry mass),
+    // for interpolating a step
+    static glm::dvec3 computeAcceleration(const SpacecraftState& state, const PoweredFlightModel& model);
+    
+    // Rotate a unit vector by small angles about two axes perpendicular to
+    // it, the first also perpendicular to reference
+    static glm::dvec3 applyPointingError(const glm::dvec3& direction, const glm::dvec3& reference,
+                                         double angle1, double angle2);
+};
@@ -0,0 +1,236 @@
+#include "Scenario.h"
+#include "AttitudeDynamics.h"
+#include "CR3BP.h"
+#include "Orbit.h"
+#include "core/Constants.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+namespace {
+    std::string trim(const std::string& s) {
+        size_t start = s.find_first_not_of(" \t\r");
+        if (start == std::string::npos) return "";
+        size_t end = s.find_last_not_of(" \t\r");
+        return s.substr(start, end - start + 1);
+    }
+    
+    bool parseNumber(const std::string& text, double& out) {
+        std::istringstream iss(text);
+        iss >> out;
+        return !iss.fail();
+    }
+    
+    bool parseVector(const std::string& text, glm::dvec3& out) {
+        std::string cleaned = text;
+        std::replace(cleaned.begin(), cleaned.end(), ',', ' ');
+        std::istringstream iss(cleaned);
+        iss >> out.x >> out.y >> out.z;
+        return !iss.fail();
+    }
+}
+
+int Scenarios::getBuiltInCount() {
+    return 4;
+}
+
+Scenario Scenarios::getBuiltIn(int index) {
+    Scenario scenario;
+    scenario.mass = Constants::DEFAULT_MASS;
+    scenario.dryMass = Constants::DEFAULT_DRY_MASS;
+    scenario.maxThrust = Constants::DEFAULT_MAX_THRUST;
+    scenario.isp = Constants::DEFAULT_ISP;
+    
+    switch (index) {
+        case 0:  // Circular Low Lunar Orbit (100km)
+        default:
+            scenario.name = "Circular Low Lunar Orbit (100km)";
+            scenario.periapsisAltitude = 100000.0;
+            scenario.apoapsisAltitude = 100000.0;
+            scenario.inclination = 28.0 * Constants::DEG_TO_RAD;
+            break;
+            
+        case 1:  // Elliptical Capture Orbit
+            scenario.name = "Elliptical Capture Orbit";
+            scenario.periapsisAltitude = 100000.0;   // 100 km periapsis
+            scenario.apoapsisAltitude = 5000000.0;   // 5000 km apoapsis
+            scenario.inclination = 90.0 * Constants::DEG_TO_RAD;  // polar orbit
+            scenario.trueAnomaly = 180.0 * Constants::DEG_TO_RAD;  // start at apoapsis
+            break;
+            
+        case 2:  // Near Surface Skimming
+            scenario.name = "Near Surface Skimming";
+            scenario.periapsisAltitude = 15000.0;    // 15 km periapsis
+            scenario.apoapsisAltitude = 120000.0;    // 120 km apoapsis
+            scenario.inclination = 45.0 * Constants::DEG_TO_RAD;
+            break;
+            
+        case 3: {  // Gateway-class NRHO
+            // L2 southern near-rectilinear halo orbit in 9:2 resonance with
+            // the synodic month (6.56 day period, 3250 km perilune radius),
+            // corrected to be periodic in this model. Starts at apolune.
+            scenario = fromHaloMember(HaloFamily::nrhoSeed());
+            scenario.name = "9:2 L2 Southern NRHO (CR3BP)";
+            break;
+        }
+    }
+    
+    return scenario;
+}
+
+Scenario Scenarios::fromHaloMember(const HaloFamily::Member& member) {
+    Scenario scenario = getBuiltIn(0);
+    scenario.name = HaloFamily::describe(member);
+    scenario.dynamics = Scenario::Dynamics::EarthMoonCR3BP;
+    scenario.hasStateVector = true;
+    glm::dvec3 position, velocity;
+    CR3BP::normalizedToRotating(glm::dvec3(member.x0, 0.0, member.z0), glm::dvec3(0.0, member.vy0, 0.0),
+                                position, velocity);
+    CR3BP::rotatingToInertial(position, velocity, 0.0, scenario.position, scenario.velocity);
+    return scenario;
+}
+
+bool Scenarios::loadPresets(const std::string& path, std::vector<Scenario>& outScenarios,
+                            std::string& outError) {
+    std::vector<HaloFamily::Member> members;
+    if (!HaloFamily::load(path, members, outError)) {
+        return false;
+    }
+    outScenarios.clear();
+    for (const HaloFamily::Member& member : members) {
+        outScenarios.push_back(fromHaloMember(member));
+    }
+    return true;
+}
+
+bool Scenarios::loadFromFile(const std::string& path, Scenario& outScenario,
+                             std::string& outError) {
+    std::ifstream file(path);
+    if (!file) {
+        outError = "cannot open '" + path + "'";
+        return false;
+    }
+    
+    Scenario scenario = getBuiltIn(0);
+    scenario.name = path;
+    
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line = line.substr(0, comment);
+        }
+        line = trim(line);
+        if (line.empty()) continue;
+        
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            outError = path + ":" + std::to_string(lineNumber) + ": expected 'key = value'";
+            return false;
+        }
+        
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        
+        bool ok = true;
+        double number = 0.0;
+        if (key == "name") {
+            scenario.name = value;
+        } else if (key == "dynamics") {
+            if (value == "lunar") {
+                scenario.dynamics = Scenario::Dynamics::LunarGravity;
+            } else if (value == "cr3bp") {
+                scenario.dynamics = Scenario::Dynamics::EarthMoonCR3BP;
+            } else {
+                ok = false;
+            }
+        } else if (key == "position_m") {
+            ok = parseVector(value, scenario.position);
+            scenario.hasStateVector = true;
+        } else if (key == "velocity_mps") {
+            ok = parseVector(value, scenario.velocity);
+            scenario.hasStateVector = true;
+        } else if (!parseNumber(value, number)) {
+            ok = false;
+        } else if (key == "periapsis_alt_km") {
+            scenario.periapsisAltitude = number * 1000.0;
+        } else if (key == "apoapsis_alt_km") {
+            scenario.apoapsisAltitude = number * 1000.0;
+        } else if (key == "inclination_deg") {
+            scenario.inclination = number * Constants::DEG_TO_RAD;
+        } else if (key == "raan_deg") {
+            scenario.raan = number * Constants::DEG_TO_RAD;
+        } else if (key == "arg_periapsis_deg") {
+            scenario.argOfPeriapsis = number * Constants::DEG_TO_RAD;
+        } else if (key == "true_anomaly_deg") {
+            scenario.trueAnomaly = number * Constants::DEG_TO_RAD;
+        } else if (key == "mass_kg") {
+            scenario.mass = number;
+        } else if (key == "dry_mass_kg") {
+            scenario.dryMass = number;
+        } else if (key == "max_thrust_n") {
+            scenario.maxThrust = number;
+        } else if (key == "isp_s") {
+            scenario.isp = number;
+        } else {
+            outError = path + ":" + std::to_string(lineNumber) + ": unknown key '" + key + "'";
+            return false;
+        }
+        
+        if (!ok) {
+            outError = path + ":" + std::to_string(lineNumber) + ": invalid value for '" + key + "'";
+            return false;
+        }
+    }
+    
+    if (!scenario.hasStateVector && scenario.apoapsisAltitude < scenario.periapsisAltitude) {
+        outError = path + ": apoapsis_alt_km must not be below periapsis_alt_km";
+        return false;
+    }
+    
+    outScenario = scenario;
+    return true;
+}
+
+void Scenarios::apply(const Scenario& scenario, Spacecraft& spacecraft) {
+    spacecraft.init();
+    spacecraft.setMass(scenario.mass, scenario.dryMass);
+    spacecraft.setThrust(scenario.maxThrust, scenario.isp);
+    
+    SpacecraftState& state = spacecraft.getState();
+    
+    if (scenario.hasStateVector) {
+        state.position = scenario.position;
+        state.velocity = scenario.velocity;
+    } else if (scenario.apoapsisAltitude == scenario.periapsisAltitude) {
+        Orbit::createCircularOrbit(
+            scenario.periapsisAltitude,
+            scenario.inclination,
+            scenario.raan,
+            scenario.trueAnomaly,
+            Constants::MOON_MU,
+            Constants::MOON_RADIUS,
+            state.position,
+            state.velocity
+        );
+    } else {
+        Orbit::createEllipticalOrbit(
+            scenario.periapsisAltitude,
+            scenario.apoapsisAltitude,
+            scenario.inclination,
+            scenario.raan,
+            scenario.argOfPeriapsis,
+            scenario.trueAnomaly,
+            Constants::MOON_MU,
+            Constants::MOON_RADIUS,
+            state.position,
+            state.velocity
+        );
+    }
+    
+    // Start settled in the default hold, nose prograde
+    state.attitude = AttitudeDynamics::computeHoldAttitude(state.velocity, state.position, state.velocity);
+}
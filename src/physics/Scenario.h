@@ -0,0 +1,62 @@
+#pragma once
+
+#include "HaloFamily.h"
+#include "Spacecraft.h"
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Initial conditions for a simulation run. Shared by the interactive
+// application and the headless tools so both start from identical states.
+struct Scenario {
+    enum class Dynamics {
+        LunarGravity,   // Moon field, optional Earth and Sun perturbations
+        EarthMoonCR3BP  // circular restricted three-body problem
+    };
+    
+    std::string name;
+    Dynamics dynamics = Dynamics::LunarGravity;
+    
+    // Orbit (altitudes above the mean lunar radius)
+    double periapsisAltitude = 100000.0;  // meters
+    double apoapsisAltitude = 100000.0;   // meters
+    double inclination = 0.0;             // radians
+    double raan = 0.0;                    // radians
+    double argOfPeriapsis = 0.0;          // radians
+    double trueAnomaly = 0.0;             // radians
+    
+    // Optional explicit state vector (overrides the orbit above)
+    bool hasStateVector = false;
+    glm::dvec3 position{0.0};             // meters
+    glm::dvec3 velocity{0.0};             // m/s
+    
+    // Vehicle
+    double mass = 26000.0;                // kg
+    double dryMass = 18000.0;             // kg
+    double maxThrust = 25000.0;           // N
+    double isp = 320.0;                   // s
+};
+
+class Scenarios {
+public:
+    static int getBuiltInCount();
+    static Scenario getBuiltIn(int index);
+    
+    // Load a scenario from a "key = value" text file. Angles are given in
+    // degrees and altitudes in km; see docs/Tools.md for the key list.
+    static bool loadFromFile(const std::string& path, Scenario& outScenario,
+                             std::string& outError);
+    
+    // CR3BP scenario starting where a halo family member crosses the xz
+    // plane, at simulation time zero
+    static Scenario fromHaloMember(const HaloFamily::Member& member);
+    
+    // Scenarios for every member of a halo family table written by
+    // artemis-halo-family, named after the members
+    static bool loadPresets(const std::string& path, std::vector<Scenario>& outScenarios,
+                            std::string& outError);
+    
+    // Reset the spacecraft and place it on the scenario's initial state,
+    // nose prograde
+    static void apply(const Scenario& scenario, Spacecraft& spacecraft);
+};
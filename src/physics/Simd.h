@@ -0,0 +1,91 @@
+#pragma once
+
+// Thin wrappers over double-precision SIMD registers, so batch kernels can be
+// written once as templates and instantiated per instruction set. Each wrapper
+// is only defined in translation units compiled with the matching ISA flags
+// (see BatchPropagatorAvx2.cpp / BatchPropagatorAvx512.cpp and the BatchOrbit
+// counterparts).
+
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+struct Scalar {
+    static constexpr int WIDTH = 1;
+    using Mask = bool;
+    
+    double v;
+    
+    static Scalar load(const double* p) { return {*p}; }
+    static Scalar broadcast(double x) { return {x}; }
+    void store(double* p) const { *p = v; }
+    
+    friend Scalar operator+(Scalar a, Scalar b) { return {a.v + b.v}; }
+    friend Scalar operator-(Scalar a, Scalar b) { return {a.v - b.v}; }
+    friend Scalar operator*(Scalar a, Scalar b) { return {a.v * b.v}; }
+    friend Scalar operator/(Scalar a, Scalar b) { return {a.v / b.v}; }
+    friend Scalar sqrt(Scalar a) { return {std::sqrt(a.v)}; }
+    friend Scalar min(Scalar a, Scalar b) { return {a.v < b.v ? a.v : b.v}; }
+    friend Scalar max(Scalar a, Scalar b) { return {a.v > b.v ? a.v : b.v}; }
+    friend Scalar floor(Scalar a) { return {std::floor(a.v)}; }
+    friend Mask greater(Scalar a, Scalar b) { return a.v > b.v; }
+    friend Scalar select(Mask m, Scalar a, Scalar b) { return m ? a : b; }
+};
+
+#if defined(__AVX2__)
+struct Avx2 {
+    static constexpr int WIDTH = 4;
+    using Mask = __m256d;
+    
+    __m256d v;
+    
+    static Avx2 load(const double* p) { return {_mm256_loadu_pd(p)}; }
+    static Avx2 broadcast(double x) { return {_mm256_set1_pd(x)}; }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+    
+    friend Avx2 operator+(Avx2 a, Avx2 b) { return {_mm256_add_pd(a.v, b.v)}; }
+    friend Avx2 operator-(Avx2 a, Avx2 b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    friend Avx2 operator*(Avx2 a, Avx2 b) { return {_mm256_mul_pd(a.v, b.v)}; }
+    friend Avx2 operator/(Avx2 a, Avx2 b) { return {_mm256_div_pd(a.v, b.v)}; }
+    friend Avx2 sqrt(Avx2 a) { return {_mm256_sqrt_pd(a.v)}; }
+    friend Avx2 min(Avx2 a, Avx2 b) { return {_mm256_min_pd(a.v, b.v)}; }
+    friend Avx2 max(Avx2 a, Avx2 b) { return {_mm256_max_pd(a.v, b.v)}; }
+    friend Avx2 floor(Avx2 a) { return {_mm256_floor_pd(a.v)}; }
+    friend Mask greater(Avx2 a, Avx2 b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+    friend Avx2 select(Mask m, Avx2 a, Avx2 b) { return {_mm256_blendv_pd(b.v, a.v, m)}; }
+};
+#endif
+
+#if defined(__AVX512F__)
+struct Avx512 {
+    static constexpr int WIDTH = 8;
+    using Mask = __mmask8;
+    
+    __m512d v;
+    
+    static Avx512 load(const double* p) { return {_mm512_loadu_pd(p)}; }
+    static Avx512 broadcast(double x) { return {_mm512_set1_pd(x)}; }
+    void store(double* p) const { _mm512_storeu_pd(p, v); }
+    
+    friend Avx512 operator+(Avx512 a, Avx512 b) { return {_mm512_add_pd(a.v, b.v)}; }
+    friend Avx512 operator-(Avx512 a, Avx512 b) { return {_mm512_sub_pd(a.v, b.v)}; }
+    friend Avx512 operator*(Avx512 a, Avx512 b) { return {_mm512_mul_pd(a.v, b.v)}; }
+    friend Avx512 operator/(Avx512 a, Avx512 b) { return {_mm512_div_pd(a.v, b.v)}; }
+    // Masked forms avoid a spurious GCC 12 -Wmaybe-uninitialized in the
+    // unmasked intrinsics
+    friend Avx512 sqrt(Avx512 a) { return {_mm512_maskz_sqrt_pd(0xFF, a.v)}; }
+    friend Avx512 min(Avx512 a, Avx512 b) { return {_mm512_maskz_min_pd(0xFF, a.v, b.v)}; }
+    friend Avx512 max(Avx512 a, Avx512 b) { return {_mm512_maskz_max_pd(0xFF, a.v, b.v)}; }
+    friend Avx512 floor(Avx512 a) {
+        return {_mm512_maskz_roundscale_pd(0xFF, a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)};
+    }
+    friend Mask greater(Avx512 a, Avx512 b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ); }
+    friend Avx512 select(Mask m, Avx512 a, Avx512 b) { return {_mm512_mask_blend_pd(m, b.v, a.v)}; }
+};
+#endif
+
+}  // namespace simd
@@ -11,6 +11,7 @@ void Spacecraft::init() {
     m_isp = Constants::DEFAULT_ISP;
     m_throttle = 0.0;
     m_thrustMode = ThrustMode::Prograde;
+    m_body = RigidBody{};
     m_initialState = m_state;
 }
 
@@ -39,12 +40,14 @@ glm::dvec3 Spacecraft::computeThrustVector() const {
     if (m_throttle < 1e-10 || !hasFuel()) {
         return glm::dvec3(0.0);
     }
-    
-    glm::dvec3 direction;
-    
+    return computeDirection(m_thrustMode, m_state, m_thrustDirection) * m_throttle * m_maxThrust;
+}
+
+glm::dvec3 Spacecraft::computeDirection(ThrustMode mode, const SpacecraftState& state,
+                                        const glm::dvec3& customDirection) {
     // Compute direction vectors based on orbital mechanics
-    glm::dvec3 radial = glm::normalize(m_state.position);
-    glm::dvec3 prograde = glm::normalize(m_state.velocity);
+    glm::dvec3 radial = glm::normalize(state.position);
+    glm::dvec3 prograde = glm::normalize(state.velocity);
     glm::dvec3 normal = glm::cross(radial, prograde);
     if (glm::length(normal) > 1e-10) {
         normal = glm::normalize(normal);
@@ -52,51 +55,23 @@ glm::dvec3 Spacecraft::computeThrustVector() const {
         normal = glm::dvec3(0.0, 0.0, 1.0);
     }
     
-    switch (m_thrustMode) {
+    switch (mode) {
         case ThrustMode::Prograde:
-            direction = prograde;
-            break;
+            return prograde;
         case ThrustMode::Retrograde:
-            direction = -prograde;
-            break;
+            return -prograde;
         case ThrustMode::RadialIn:
-            direction = -radial;
-            break;
+            return -radial;
         case ThrustMode::RadialOut:
-            direction = radial;
-            break;
+            return radial;
         case ThrustMode::Normal:
-            direction = normal;
-            break;
+            return normal;
         case ThrustMode::AntiNormal:
-            direction = -normal;
-            break;
+            return -normal;
         case ThrustMode::Custom:
         default:
-            direction = m_thrustDirection;
-            break;
+            return customDirection;
     }
-    
-    return direction * m_throttle * m_maxThrust;
-}
-
-double Spacecraft::applyThrust(double dt) {
-    if (m_throttle < 1e-10 || !hasFuel()) {
-        return 0.0;
-    }
-    
-    double thrust = m_throttle * m_maxThrust;
-    double massFlowRate = thrust / (m_isp * Constants::G0);
-    double massConsumed = massFlowRate * dt;
-    
-    // Don't consume more fuel than we have
-    double fuelAvailable = m_state.mass - m_dryMass;
-    massConsumed = std::min(massConsumed, fuelAvailable);
-    
-    m_state.mass -= massConsumed;
-    m_state.mass = std::max(m_state.mass, m_dryMass);
-    
-    return massConsumed;
 }
 
 void Spacecraft::reset() {
@@ -11,6 +11,19 @@ struct SpacecraftState {
     double mass = 26000.0;           // kg
 };
 
+// Mass properties and reaction control of the vehicle. Body axes are the
+// model's: +x right, +y the nose and thrust axis, +z up. They are taken as
+// principal axes, so the inertia tensor is diagonal in them.
+struct RigidBody {
+    glm::dvec3 inertia{180000.0, 85000.0, 175000.0};  // kg m², about body x, y, z
+    double rcsTorque = 2000.0;                          // N m, most the RCS gives per axis
+    
+    // Euler's equations: body angular acceleration under a body torque
+    glm::dvec3 angularAcceleration(const glm::dvec3& angularVelocity, const glm::dvec3& torque) const {
+        return (torque - glm::cross(angularVelocity, inertia * angularVelocity)) / inertia;
+    }
+};
+
 class Spacecraft {
 public:
     void init();
@@ -52,8 +65,13 @@ public:
     // Compute actual thrust vector based on mode and current state
     glm::dvec3 computeThrustVector() const;
     
-    // Apply thrust for a duration (returns mass consumed)
-    double applyThrust(double dt);
+    // Unit inertial direction of a thrust mode at a state; customDirection
+    // (unit) is used for ThrustMode::Custom
+    static glm::dvec3 computeDirection(ThrustMode mode, const SpacecraftState& state,
+                                       const glm::dvec3& customDirection);
+    
+    const RigidBody& getRigidBody() const { return m_body; }
+    void setRigidBody(const RigidBody& body) { m_body = body; }
     
     // Reset to initial state
     void reset();
@@ -68,4 +86,5 @@ private:
     double m_throttle = 0.0;       // 0..1
     glm::dvec3 m_thrustDirection{1.0, 0.0, 0.0};
     ThrustMode m_thrustMode = ThrustMode::Prograde;
+    RigidBody m_body;
 };
@@ -0,0 +1,361 @@
+#include "Targeting.h"
+#include "Dual.h"
+#include "Integrator.h"
+#include "core/Constants.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr int MAX_EQUATIONS = 3;
+    
+    template <typename T>
+    using Vec = std::array<T, 3>;
+    
+    template <typename T>
+    T dot(const Vec<T>& a, const Vec<T>& b) {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+    
+    template <typename T>
+    Vec<T> cross(const Vec<T>& a, const Vec<T>& b) {
+        return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    }
+    
+    // What the inclination goal keeps from before the burn
+    struct Reference {
+        double energy = 0.0;
+        double angularMomentum = 0.0;
+        double speed = 0.0;
+        double radius = 0.0;
+    };
+    
+    // Goal errors at the end of the burn, each over its tolerance, so the
+    // solve has converged when all are within [-1, 1]. Returns how many.
+    template <typename T>
+    int residuals(const Vec<T>& r, const Vec<T>& v, const Targeting::Target& target,
+                  const Reference& reference, const Targeting::Options& options, T* out) {
+        using std::atan2;
+        using std::sqrt;
+        const double mu = Constants::MOON_MU;
+        T radius = sqrt(dot(r, r));
+        T speed2 = dot(v, v);
+        
+        switch (target.goal) {
+            case Targeting::Goal::PeriapsisAltitude: {
+                // r_p = h^2 / (mu (1 + e)), from the eccentricity vector
+                Vec<T> h = cross(r, v);
+                T rv = dot(r, v);
+                T c = speed2 - mu / radius;
+                Vec<T> e = {(c * r[0] - rv * v[0]) / mu, (c * r[1] - rv * v[1]) / mu, (c * r[2] - rv * v[2]) / mu};
+                T periapsis = dot(h, h) / (mu * (1.0 + sqrt(dot(e, e))));
+                out[0] = (periapsis - (Constants::MOON_RADIUS + target.value)) / options.positionTolerance;
+                return 1;
+            }
+            case Targeting::Goal::Circularize:
+                out[0] = dot(r, v) / radius / options.velocityTolerance;
+                out[1] = (sqrt(speed2) - sqrt(mu / radius)) / options.velocityTolerance;
+                return 2;
+            case Targeting::Goal::Inclination: {
+                // Energy and |h| fix the size and shape; scaled to m/s
+                Vec<T> h = cross(r, v);
+                out[0] = (atan2(sqrt(h[0] * h[0] + h[1] * h[1]), h[2]) - target.value) / options.angleTolerance;
+                out[1] = (0.5 * speed2 - mu / radius - reference.energy) /
+                         (reference.speed * options.velocityTolerance);
+                out[2] = (sqrt(dot(h, h)) - reference.angularMomentum) /
+                         (reference.radius * options.velocityTolerance);
+                return 3;
+            }
+            case Targeting::Goal::None:
+            default:
+                return 0;
+        }
+    }
+    
+    double largest(const double* values, int count) {
+        double result = 0.0;
+        for (int i = 0; i < count; ++i) {
+            result = std::max(result, std::abs(values[i]));
+        }
+        return result;
+    }
+    
+    // Solve a x = b in place by Gaussian elimination with partial pivoting
+    bool solveSmall(double a[MAX_EQUATIONS][MAX_EQUATIONS], double* b, int n) {
+        for (int col = 0; col < n; ++col) {
+            int pivot = col;
+            for (int row = col + 1; row < n; ++row) {
+                if (std::abs(a[row][col]) > std::abs(a[pivot][col])) pivot = row;
+            }
+            if (std::abs(a[pivot][col]) < 1e-300) return false;
+            std::swap(a[col], a[pivot]);
+            std::swap(b[col], b[pivot]);
+            for (int row = col + 1; row < n; ++row) {
+                double f = a[row][col] / a[col][col];
+                for (int k = col; k < n; ++k) a[row][k] -= f * a[col][k];
+                b[row] -= f * b[col];
+            }
+        }
+        for (int row = n - 1; row >= 0; --row) {
+            for (int k = row + 1; k < n; ++k) b[row] -= a[row][k] * b[k];
+            b[row] /= a[row][row];
+        }
+        return true;
+    }
+    
+    // Prograde, normal and radial-out unit vectors as columns
+    glm::dmat3 localFrame(const SpacecraftState& state) {
+        glm::dvec3 prograde = glm::normalize(state.velocity);
+        glm::dvec3 normal = glm::cross(state.position, state.velocity);
+        normal = (glm::length(normal) > 0.0) ? glm::normalize(normal) : glm::dvec3(0.0, 0.0, 1.0);
+        return glm::dmat3(prograde, normal, glm::cross(prograde, normal));
+    }
+    
+    // Impulsive delta-v that reaches the goal from here. False if none does.
+    bool impulsiveGuess(const SpacecraftState& state, const Targeting::Target& target, glm::dvec3& outDeltaV) {
+        const double mu = Constants::MOON_MU;
+        double r = glm::length(state.position);
+        glm::dvec3 radial = state.position / r;
+        glm::dvec3 horizontal = state.velocity - glm::dot(state.velocity, radial) * radial;
+        double horizontalSpeed = glm::length(horizontal);
+        if (horizontalSpeed <= 0.0) {
+            return false;
+        }
+        glm::dvec3 along = horizontal / horizontalSpeed;
+        
+        switch (target.goal) {
+            case Targeting::Goal::PeriapsisAltitude: {
+                // Make this point the other apsis; no orbit through it has
+                // its periapsis any higher
+                double periapsis = Constants::MOON_RADIUS + target.value;
+                if (periapsis <= 0.0 || periapsis > r) {
+                    return false;
+                }
+                outDeltaV = std::sqrt(2.0 * mu * periapsis / (r * (r + periapsis))) * along - state.velocity;
+                return true;
+            }
+            case Targeting::Goal::Circularize:
+                outDeltaV = std::sqrt(mu / r) * along - state.velocity;
+                return true;
+            case Targeting::Goal::Inclination: {
+                // Turn the horizontal velocity about the radial direction by
+                // beta, which keeps energy and |h|. The new orbit normal is
+                // cos(beta) n - sin(beta) t; solve for its z = cos(i).
+                glm::dvec3 normal = glm::cross(radial, along);
+                double a = normal.z, b = along.z;
+                double amplitude = std::sqrt(a * a + b * b);
+                double c = std::cos(target.value);
+                if (amplitude <= 0.0 || std::abs(c) > amplitude) {
+                    return false;   // inclination below this latitude
+                }
+                double phase = std::atan2(b, a);
+                double spread = std::acos(c / amplitude);
+                double beta = std::remainder(spread - phase, 2.0 * Constants::PI);
+                double other = std::remainder(-spread - phase, 2.0 * Constants::PI);
+                if (std::abs(other) < std::abs(beta)) beta = other;
+                glm::dvec3 turned = std::cos(beta) * along + std::sin(beta) * normal;
+                outDeltaV = horizontalSpeed * (turned - along);
+                return true;
+            }
+            case Targeting::Goal::None:
+            default:
+                return false;
+        }
+    }
+}
+
+const char* Targeting::getName(Goal goal) {
+    switch (goal) {
+        case Goal::PeriapsisAltitude: return "periapsis";
+        case Goal::Circularize: return "circularize";
+        case Goal::Inclination: return "inclination";
+        case Goal::None:
+        default: return "none";
+    }
+}
+
+bool Targeting::parseName(const char* name, Goal& outGoal) {
+    for (int i = 0; i < NUM_GOALS; ++i) {
+        Goal goal = static_cast<Goal>(i);
+        if (std::strcmp(name, getName(goal)) == 0) {
+            outGoal = goal;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Targeting::getStatusName(Status status) {
+    switch (status) {
+        case Status::Converged: return "converged";
+        case Status::NoThrust: return "no thrust";
+        case Status::Unreachable: return "unreachable from here";
+        case Status::OutOfFuel: return "not enough propellant";
+        case Status::NotConverged:
+        default: return "not converged";
+    }
+}
+
+Targeting::Engine Targeting::getEngine(const Spacecraft& spacecraft, double throttle) {
+    Engine engine;
+    engine.thrust = throttle * spacecraft.getMaxThrust();
+    engine.isp = spacecraft.getIsp();
+    engine.dryMass = spacecraft.getDryMass();
+    return engine;
+}
+
+SpacecraftState Targeting::simulateBurn(const SpacecraftState& state, const glm::dvec3& direction,
+                                        double duration, const Engine& engine,
+                                        const GravityFieldForceModel& forceModel, int steps) {
+    GravityFieldForceModel model = forceModel;
+    double flow = engine.thrust / (engine.isp * Constants::G0);
+    double h = duration / steps;
+    SpacecraftState result = state;
+    for (int k = 0; k < steps; ++k) {
+        model.thrustAccel = engine.thrust / (state.mass - flow * h * (k + 0.5)) * direction;
+        Integrator::stepRK4(result, h, model);
+    }
+    result.mass = state.mass - flow * duration;
+    return result;
+}
+
+Targeting::Solution Targeting::solve(const SpacecraftState& state, const Target& target, const Engine& engine,
+                                     const GravityFieldForceModel& forceModel, const Options& options,
+                                     const Solution* guess) {
+    Solution solution;
+    if (engine.thrust <= 0.0) {
+        solution.status = Status::NoThrust;
+        return solution;
+    }
+    
+    Reference reference;
+    reference.radius = glm::length(state.position);
+    reference.speed = glm::length(state.velocity);
+    reference.energy = 0.5 * reference.speed * reference.speed - Constants::MOON_MU / reference.radius;
+    reference.angularMomentum = glm::length(glm::cross(state.position, state.velocity));
+    
+    // Nothing to do if the orbit already meets the goal
+    double g[MAX_EQUATIONS];
+    Vec<double> r0 = {state.position.x, state.position.y, state.position.z};
+    Vec<double> v0 = {state.velocity.x, state.velocity.y, state.velocity.z};
+    int count = residuals(r0, v0, target, reference, options, g);
+    solution.residual = largest(g, count);
+    if (count == 0 || solution.residual <= 1.0) {
+        solution.status = (count == 0) ? Status::Unreachable : Status::Converged;
+        return solution;
+    }
+    
+    const glm::dmat3 frame = localFrame(state);
+    glm::dvec3 u;
+    if (guess && glm::length(guess->localDeltaV) > 0.0) {
+        u = frame * guess->localDeltaV;
+    } else if (!impulsiveGuess(state, target, u)) {
+        solution.status = Status::Unreachable;
+        return solution;
+    }
+    
+    const double exhaust = engine.isp * Constants::G0;
+    const double flow = engine.thrust / exhaust;
+    const double h0 = 1.0 / options.steps;
+    GravityFieldForceModel model = forceModel;
+    
+    for (int iteration = 1; iteration <= options.maxIterations; ++iteration) {
+        double magnitude = glm::length(u);
+        if (magnitude <= 1e-9) {
+            break;
+        }
+        glm::dvec3 direction = u / magnitude;
+        double endMass = state.mass * std::exp(-magnitude / exhaust);
+        double duration = (state.mass - endMass) / flow;
+        double h = duration * h0;
+        
+        // The burn with its transition matrix. Thrust alpha(t) d enters as
+        // B = [0; I], so d x(T) / d d = Phi(T) * integral of Phi(t)^-1 B
+        // alpha dt, and Phi^-1 B = [-rv^T; rr^T] by symplecticity; the
+        // integral is taken by the trapezoidal rule over each step.
+        SpacecraftState end = state;
+        StateTransition phi;
+        glm::dmat3 qr(0.0), qv(0.0);
+        for (int k = 0; k < options.steps; ++k) {
+            double accel = engine.thrust / (state.mass - flow * h * (k + 0.5));
+            model.thrustAccel = accel * direction;
+            glm::dmat3 before = glm::transpose(phi.rv);
+            glm::dmat3 beforeV = glm::transpose(phi.rr);
+            Integrator::stepRK4(end, phi, h, model);
+            qr -= (0.5 * h * accel) * (before + glm::transpose(phi.rv));
+            qv += (0.5 * h * accel) * (beforeV + glm::transpose(phi.rr));
+        }
+        end.mass = endMass;
+        
+        // End-state sensitivity to u: direction through the quadrature,
+        // length through the duration, d T / d |u| = m(T) / thrust
+        glm::dvec3 accel(0.0), unused(0.0);
+        model.thrustAccel = engine.thrust / endMass * direction;
+        model(end, accel, unused);
+        glm::dmat3 across = (glm::dmat3(1.0) - glm::outerProduct(direction, direction)) * (1.0 / magnitude);
+        double along = endMass / engine.thrust;
+        glm::dmat3 dRdu = (phi.rr * qr + phi.rv * qv) * across + glm::outerProduct(end.velocity, direction) * along;
+        glm::dmat3 dVdu = (phi.vr * qr + phi.vv * qv) * across + glm::outerProduct(accel, direction) * along;
+        
+        // Goal errors and their gradient in the end state
+        Vec<Dual<6>> r, v;
+        for (int i = 0; i < 3; ++i) {
+            r[i] = Dual<6>::variable(end.position[i], i);
+            v[i] = Dual<6>::variable(end.velocity[i], i + 3);
+        }
+        Dual<6> errors[MAX_EQUATIONS];
+        residuals(r, v, target, reference, options, errors);
+        
+        solution.deltaV = u;
+        solution.localDeltaV = glm::transpose(frame) * u;
+        solution.direction = direction;
+        solution.duration = duration;
+        solution.propellant = state.mass - endMass;
+        solution.iterations = iteration;
+        for (int i = 0; i < count; ++i) g[i] = errors[i].value;
+        solution.residual = largest(g, count);
+        if (solution.residual <= 1.0) {
+            solution.status = (endMass < engine.dryMass) ? Status::OutOfFuel : Status::Converged;
+            return solution;
+        }
+        
+        // Minimum-norm Newton step: du = -J^T (J J^T)^-1 g
+        double jacobian[MAX_EQUATIONS][3];
+        for (int i = 0; i < count; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                double sum = 0.0;
+                for (int k = 0; k < 3; ++k) {
+                    sum += errors[i].grad[k] * dRdu[j][k] + errors[i].grad[k + 3] * dVdu[j][k];
+                }
+                jacobian[i][j] = sum;
+            }
+        }
+        double normal[MAX_EQUATIONS][MAX_EQUATIONS];
+        for (int i = 0; i < count; ++i) {
+            for (int k = 0; k < count; ++k) {
+                normal[i][k] = jacobian[i][0] * jacobian[k][0] + jacobian[i][1] * jacobian[k][1] +
+                               jacobian[i][2] * jacobian[k][2];
+            }
+        }
+        if (!solveSmall(normal, g, count)) {
+            break;
+        }
+        glm::dvec3 step(0.0);
+        for (int i = 0; i < count; ++i) {
+            step -= g[i] * glm::dvec3(jacobian[i][0], jacobian[i][1], jacobian[i][2]);
+        }
+        
+        // Far from the solution the linearization overshoots; limit how far
+        // one step can move the burn
+        double limit = std::max(0.5 * magnitude, 10.0);
+        double length = glm::length(step);
+        if (length > limit) {
+            step *= limit / length;
+        }
+        u += step;
+    }
+    
+    solution.status = Status::NotConverged;
+    return solution;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "GravityField.h"
+#include "Spacecraft.h"
+#include <glm/glm.hpp>
+
+// Solves for a finite burn, started now, that reaches an orbit goal: a
+// periapsis altitude, a circular orbit, or an inclination with the orbit's
+// size and shape kept. The burn holds an inertially fixed direction for a
+// duration at the engine's thrust (Spacecraft::ThrustMode::Custom).
+//
+// The unknown is the ideal delta-v vector; the rocket equation turns its
+// length into a duration. Each Newton iteration integrates the burn once
+// with its state transition matrix (Integrator::stepRK4 with a
+// StateTransition). The sensitivity of the end state to the thrust
+// direction follows from it by quadrature, since the matrix of a
+// gravitational flow is symplectic and inverts by transposition, and the
+// goal's gradient comes from evaluating it on Dual<6>. With fewer goal
+// equations than unknowns the step is the minimum-norm one, so the burn
+// converges to the nearest, close to cheapest, solution. From the impulsive
+// estimate a solve takes 2-4 iterations; warm-started from the previous
+// solution it takes 1-2, cheap enough to repeat on every physics tick.
+class Targeting {
+public:
+    enum class Goal {
+        None,
+        PeriapsisAltitude,  // value: altitude above the mean radius (m)
+        Circularize,        // at the radius where the burn ends
+        Inclination         // value: radians; energy and |h| unchanged
+    };
+    
+    static constexpr int NUM_GOALS = 4;
+    
+    // Short command-line name ("periapsis", "circularize", "inclination")
+    static const char* getName(Goal goal);
+    static bool parseName(const char* name, Goal& outGoal);
+    
+    struct Target {
+        Goal goal = Goal::None;
+        double value = 0.0;
+        
+        bool operator==(const Target& other) const = default;
+    };
+    
+    // Engine at the throttle the burn will use
+    struct Engine {
+        double thrust = 0.0;     // N
+        double isp = 0.0;        // s
+        double dryMass = 0.0;    // kg
+    };
+    
+    static Engine getEngine(const Spacecraft& spacecraft, double throttle);
+    
+    enum class Status {
+        Converged,
+        NoThrust,       // throttle is zero
+        Unreachable,    // no burn from here reaches the goal (e.g. periapsis above the current radius)
+        OutOfFuel,      // converged, but needs more propellant than is left
+        NotConverged
+    };
+    
+    static const char* getStatusName(Status status);
+    
+    struct Options {
+        int maxIterations = 12;
+        int steps = 32;                     // RK4 steps over the burn
+        double positionTolerance = 1.0;     // m
+        double velocityTolerance = 1e-3;    // m/s
+        double angleTolerance = 1e-6;       // rad
+    };
+    
+    struct Solution {
+        Status status = Status::NotConverged;
+        glm::dvec3 deltaV{0.0};         // ideal, inertial (m/s)
+        
+        // The same in the prograde, normal and radial-out frame at the
+        // start of the burn (v, h and v x h), which turns with the orbit:
+        // for display, and to warm-start the next solve
+        glm::dvec3 localDeltaV{0.0};
+        
+        glm::dvec3 direction{1.0, 0.0, 0.0};    // unit, inertial, held for the burn
+        double duration = 0.0;          // s
+        double propellant = 0.0;        // kg
+        double residual = 0.0;          // largest goal error over its tolerance
+        int iterations = 0;
+        
+        bool isExecutable() const { return status == Status::Converged && duration > 0.0; }
+    };
+    
+    // guess, if given, warm-starts from its localDeltaV. forceModel's thrust
+    // is ignored; its time is held over the burn.
+    static Solution solve(const SpacecraftState& state, const Target& target, const Engine& engine,
+                          const GravityFieldForceModel& forceModel, const Options& options,
+                          const Solution* guess = nullptr);
+    
+    // The burn as the solver models it: fixed direction, thrust over the
+    // mass at each step's midpoint
+    static SpacecraftState simulateBurn(const SpacecraftState& state, const glm::dvec3& direction,
+                                        double duration, const Engine& engine,
+                                        const GravityFieldForceModel& forceModel, int steps);
+};
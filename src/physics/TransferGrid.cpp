@@ -0,0 +1,210 @@
+#include "TransferGrid.h"
+#include "core/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Rows of the orbit-plane frame: x along the departure position, z along
+    // its angular momentum
+    struct PlaneFrame {
+        glm::dvec3 x, y, z;
+        
+        glm::dvec3 toPlane(const glm::dvec3& v) const {
+            return glm::dvec3(glm::dot(v, x), glm::dot(v, y), glm::dot(v, z));
+        }
+        glm::dvec3 fromPlane(const glm::dvec3& v) const { return v.x * x + v.y * y + v.z * z; }
+    };
+    
+    bool makePlaneFrame(const glm::dvec3& position, const glm::dvec3& velocity, PlaneFrame& out) {
+        glm::dvec3 h = glm::cross(position, velocity);
+        double hNorm = glm::length(h);
+        if (hNorm <= 0.0) {
+            return false;
+        }
+        out.z = h / hNorm;
+        out.x = glm::normalize(position);
+        out.y = glm::cross(out.z, out.x);
+        return true;
+    }
+    
+    double gridStep(double start, double end, int count) {
+        return count > 1 ? (end - start) / (count - 1) : 0.0;
+    }
+    
+    // States of one orbit along a grid line, in the plane frame
+    bool sampleOrbit(const glm::dvec3& position, const glm::dvec3& velocity, double mu,
+                     double start, double step, int count, const PlaneFrame& frame,
+                     std::vector<glm::dvec3>& outPositions, std::vector<glm::dvec3>& outVelocities) {
+        outPositions.resize(count);
+        outVelocities.resize(count);
+        for (int i = 0; i < count; ++i) {
+            glm::dvec3 r, v;
+            if (!Orbit::propagateKepler(position, velocity, start + i * step, mu, r, v)) {
+                return false;
+            }
+            outPositions[i] = frame.toPlane(r);
+            outVelocities[i] = frame.toPlane(v);
+        }
+        return true;
+    }
+    
+    // Cheapest of the arcs just solved; returns its index, or -1
+    int cheapestArc(const std::vector<LambertSolution>& arcs, const glm::dvec3& departureVelocity,
+                    const glm::dvec3& arrivalVelocity, bool rendezvous, double& outDeparture,
+                    double& outArrival) {
+        int best = -1;
+        double bestTotal = std::numeric_limits<double>::infinity();
+        for (size_t k = 0; k < arcs.size(); ++k) {
+            double departure = glm::length(arcs[k].departureVelocity - departureVelocity);
+            double arrival = rendezvous ? glm::length(arrivalVelocity - arcs[k].arrivalVelocity) : 0.0;
+            if (departure + arrival < bestTotal) {
+                bestTotal = departure + arrival;
+                best = static_cast<int>(k);
+                outDeparture = departure;
+                outArrival = arrival;
+            }
+        }
+        return best;
+    }
+}
+
+bool TransferGrid::compute(const Options& options, ThreadPool& pool, Result& outResult, std::string& outError) {
+    auto startTime = std::chrono::steady_clock::now();
+    
+    if (options.departureCount <= 0 || options.arrivalCount <= 0) {
+        outError = "empty grid";
+        return false;
+    }
+    if (options.mu <= 0.0) {
+        outError = "gravitational parameter must be positive";
+        return false;
+    }
+    PlaneFrame frame;
+    if (!makePlaneFrame(options.departurePosition, options.departureVelocity, frame) ||
+        glm::length(options.arrivalPosition) <= 0.0) {
+        outError = "degenerate departure or arrival state";
+        return false;
+    }
+    
+    Result& result = outResult;
+    result.departureCount = options.departureCount;
+    result.arrivalCount = options.arrivalCount;
+    result.departureStart = options.departureStart;
+    result.departureStep = gridStep(options.departureStart, options.departureEnd, options.departureCount);
+    result.arrivalStart = options.arrivalStart;
+    result.arrivalStep = gridStep(options.arrivalStart, options.arrivalEnd, options.arrivalCount);
+    
+    std::vector<glm::dvec3> r1, v1, r2, v2;
+    if (!sampleOrbit(options.departurePosition, options.departureVelocity, options.mu,
+                     result.departureStart, result.departureStep, options.departureCount, frame, r1, v1) ||
+        !sampleOrbit(options.arrivalPosition, options.arrivalVelocity, options.mu,
+                     result.arrivalStart, result.arrivalStep, options.arrivalCount, frame, r2, v2)) {
+        outError = "endpoint orbit could not be propagated";
+        return false;
+    }
+    
+    const size_t cells = static_cast<size_t>(options.departureCount) * options.arrivalCount;
+    const float missing = std::numeric_limits<float>::quiet_NaN();
+    result.departureDeltaV.assign(cells, missing);
+    result.arrivalDeltaV.assign(cells, missing);
+    result.revolutions.assign(cells, 0);
+    
+    // Per-worker scratch and counters, merged after the rows finish
+    struct Scratch {
+        std::vector<LambertSolution> arcs;
+        size_t solved = 0;
+        size_t arcCount = 0;
+        size_t iterations = 0;
+    };
+    std::vector<Scratch> scratch(pool.getThreadCount() + 1);
+    
+    pool.parallelFor(static_cast<size_t>(options.departureCount), [&](size_t i) {
+        Scratch& local = scratch[pool.getCurrentWorkerIndex()];
+        const double departureTime = result.getDepartureTime(static_cast<int>(i));
+        const size_t row = i * options.arrivalCount;
+        
+        for (int j = 0; j < options.arrivalCount; ++j) {
+            double flightTime = result.getArrivalTime(j) - departureTime;
+            if (flightTime <= 0.0) {
+                continue;
+            }
+            Orbit::solveLambert(r1[i], r2[j], flightTime, options.mu, options.maxRevolutions,
+                                options.retrograde, local.arcs);
+            double departure = 0.0, arrival = 0.0;
+            int best = cheapestArc(local.arcs, v1[i], v2[j], options.rendezvous, departure, arrival);
+            if (best < 0) {
+                continue;
+            }
+            result.departureDeltaV[row + j] = static_cast<float>(departure);
+            result.arrivalDeltaV[row + j] = static_cast<float>(arrival);
+            result.revolutions[row + j] = static_cast<uint8_t>(local.arcs[best].revolutions);
+            local.solved++;
+            for (const LambertSolution& arc : local.arcs) {
+                local.iterations += arc.iterations;
+            }
+            local.arcCount += local.arcs.size();
+        }
+    });
+    
+    size_t arcCount = 0, iterations = 0;
+    result.solvedCells = 0;
+    for (const Scratch& local : scratch) {
+        result.solvedCells += local.solved;
+        arcCount += local.arcCount;
+        iterations += local.iterations;
+    }
+    result.meanIterations = arcCount > 0 ? static_cast<double>(iterations) / arcCount : 0.0;
+    
+    result.bestIndex = 0;
+    result.bestDeltaV = std::numeric_limits<float>::infinity();
+    for (size_t k = 0; k < cells; ++k) {
+        float total = result.getTotalDeltaV(k);
+        if (total < result.bestDeltaV) {
+            result.bestDeltaV = total;
+            result.bestIndex = k;
+        }
+    }
+    
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    result.wallSeconds = elapsed.count();
+    return true;
+}
+
+bool TransferGrid::solveCell(const Options& options, double departureTime, double arrivalTime,
+                             LambertSolution& outSolution, glm::dvec3& outDepartureDeltaV,
+                             glm::dvec3& outArrivalDeltaV) {
+    PlaneFrame frame;
+    if (arrivalTime <= departureTime ||
+        !makePlaneFrame(options.departurePosition, options.departureVelocity, frame)) {
+        return false;
+    }
+    glm::dvec3 r1, v1, r2, v2;
+    if (!Orbit::propagateKepler(options.departurePosition, options.departureVelocity, departureTime,
+                                options.mu, r1, v1) ||
+        !Orbit::propagateKepler(options.arrivalPosition, options.arrivalVelocity, arrivalTime,
+                                options.mu, r2, v2)) {
+        return false;
+    }
+    
+    std::vector<LambertSolution> arcs;
+    r1 = frame.toPlane(r1);
+    v1 = frame.toPlane(v1);
+    r2 = frame.toPlane(r2);
+    v2 = frame.toPlane(v2);
+    Orbit::solveLambert(r1, r2, arrivalTime - departureTime, options.mu, options.maxRevolutions,
+                        options.retrograde, arcs);
+    double departure = 0.0, arrival = 0.0;
+    int best = cheapestArc(arcs, v1, v2, options.rendezvous, departure, arrival);
+    if (best < 0) {
+        return false;
+    }
+    
+    outSolution = arcs[best];
+    outSolution.departureVelocity = frame.fromPlane(outSolution.departureVelocity);
+    outSolution.arrivalVelocity = frame.fromPlane(outSolution.arrivalVelocity);
+    outDepartureDeltaV = frame.fromPlane(arcs[best].departureVelocity - v1);
+    outArrivalDeltaV = options.rendezvous ? frame.fromPlane(v2 - arcs[best].arrivalVelocity) : glm::dvec3(0.0);
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Orbit.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Transfer-window ("porkchop") grid: the two-impulse delta-v of the cheapest
+// Lambert arc from one two-body orbit to another, for every pair of
+// departure and arrival times. Both orbits are point-mass conics about mu.
+//
+// Each endpoint orbit is Kepler-propagated once per grid line, not per
+// cell, and the states are rotated into the departure orbit's plane so
+// "prograde" (Orbit::solveLambert's +z) follows its motion. What remains
+// per cell is one Lambert solve, of 2-3 Householder iterations per arc,
+// and rows of cells run in parallel on the pool.
+class TransferGrid {
+public:
+    struct Options {
+        // Both orbits as states at time zero (the departure orbit is the
+        // spacecraft's; the arrival orbit is the target's)
+        glm::dvec3 departurePosition{0.0};
+        glm::dvec3 departureVelocity{0.0};
+        glm::dvec3 arrivalPosition{0.0};
+        glm::dvec3 arrivalVelocity{0.0};
+        double mu = 0.0;
+        
+        // Grid lines, seconds after time zero, endpoints included
+        double departureStart = 0.0;
+        double departureEnd = 0.0;
+        int departureCount = 0;
+        double arrivalStart = 0.0;
+        double arrivalEnd = 0.0;
+        int arrivalCount = 0;
+        
+        int maxRevolutions = 2;     // of the transfer arc
+        bool retrograde = false;    // arcs against the departure orbit's motion
+        bool rendezvous = true;     // false: arrival velocity is free (flyby), only departure counts
+    };
+    
+    struct Result {
+        int departureCount = 0;
+        int arrivalCount = 0;
+        double departureStart = 0.0;
+        double departureStep = 0.0;
+        double arrivalStart = 0.0;
+        double arrivalStep = 0.0;
+        
+        // Per cell, departure-major (index = departure * arrivalCount +
+        // arrival). NaN where the arrival is not after the departure or no
+        // arc exists.
+        std::vector<float> departureDeltaV;     // m/s
+        std::vector<float> arrivalDeltaV;       // m/s
+        std::vector<uint8_t> revolutions;       // of the cheapest arc
+        
+        size_t bestIndex = 0;       // lowest total delta-v
+        float bestDeltaV = 0.0f;
+        size_t solvedCells = 0;
+        double meanIterations = 0.0;    // Householder iterations per arc
+        double wallSeconds = 0.0;
+        
+        float getTotalDeltaV(size_t index) const { return departureDeltaV[index] + arrivalDeltaV[index]; }
+        double getDepartureTime(int i) const { return departureStart + i * departureStep; }
+        double getArrivalTime(int j) const { return arrivalStart + j * arrivalStep; }
+        size_t getCellCount() const { return departureDeltaV.size(); }
+    };
+    
+    // Returns false with outError on invalid options (empty grid, no mu, a
+    // state at the origin, or an endpoint orbit that cannot be propagated)
+    static bool compute(const Options& options, ThreadPool& pool, Result& outResult, std::string& outError);
+    
+    // The cheapest arc for one cell, in the input frame: for showing or
+    // flying a selected transfer. Returns false if there is none.
+    static bool solveCell(const Options& options, double departureTime, double arrivalTime,
+                          LambertSolution& outSolution, glm::dvec3& outDepartureDeltaV,
+                          glm::dvec3& outArrivalDeltaV);
+};
@@ -0,0 +1,363 @@
+#include "WarpScheduler.h"
+#include "CR3BP.h"
+#include "DenseTrajectory.h"
+#include "Orbit.h"
+#include "PoweredFlight.h"
+#include "core/Constants.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+    double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    // Segments shorter than this are left in the backlog
+    constexpr double MIN_SEGMENT = 1e-9;
+    
+    GravityFieldForceModel makeForceModel(const WarpRequest& request, double time) {
+        GravityFieldForceModel forceModel;
+        forceModel.mu = Constants::MOON_MU;
+        forceModel.field = request.gravityField;
+        forceModel.degree = request.gravityDegree;
+        forceModel.cache = request.gravityCache;
+        forceModel.ephemeris = request.ephemeris;
+        forceModel.circularEarth = request.circularEarth;
+        forceModel.setTime(time);
+        return forceModel;
+    }
+    
+    // Hermite cubic through one fixed step, for locating events inside it.
+    // The end accelerations include the thrust at the mass there.
+    DenseTrajectory::Segment hermiteStep(PoweredFlightModel& model, bool timeDependent,
+                                         const SpacecraftState& start, const SpacecraftState& end,
+                                         double t0, double h) {
+        if (timeDependent) {
+            model.gravity.setTime(t0);
+        }
+        glm::dvec3 startAccel = PoweredFlight::computeAcceleration(start, model);
+        if (timeDependent) {
+            model.gravity.setTime(t0 + h);
+        }
+        glm::dvec3 endAccel = PoweredFlight::computeAcceleration(end, model);
+        return DenseTrajectory::makeHermite(t0, h, start.position, start.velocity, startAccel,
+                                            end.position, end.velocity, endAccel);
+    }
+    
+    // Burn in progress at a simulation time, if any
+    const BurnNode* findBurn(const WarpRequest& request, double time) {
+        return request.maneuvers ? request.maneuvers->findActive(time) : nullptr;
+    }
+    
+    // Attitude the RCS holds at a state: nose along the burn's direction, or
+    // the planner's between burns
+    glm::dquat holdAttitude(const WarpRequest& request, const BurnNode* burn, const SpacecraftState& state) {
+        glm::dvec3 pointing = burn ? Spacecraft::computeDirection(burn->mode, state, burn->direction)
+                                   : Spacecraft::computeDirection(request.thrustMode, state, request.thrustDirection);
+        return AttitudeDynamics::computeHoldAttitude(pointing, state.position, state.velocity);
+    }
+    
+    // Move the state to the terminal event that just ended a step; returns
+    // the event's time
+    double stopAtEvent(SpacecraftState& state, WarpFrameStats& stats) {
+        const Event& event = stats.events.back();
+        state.position = event.position;
+        state.velocity = event.velocity;
+        stats.impacted = stats.impacted || event.isImpact();
+        return event.time;
+    }
+}
+
+WarpScheduler::WarpScheduler() {
+    m_events.addFunction(EventFunction::impact());
+}
+
+const char* WarpFrameStats::getMethodName(Method method) {
+    switch (method) {
+        case Method::Analytic: return "analytic";
+        case Method::FixedStep: return "fixed step";
+        case Method::EnlargedStep: return "enlarged step";
+        case Method::Adaptive: return "adaptive";
+        case Method::Idle:
+        default: return "idle";
+    }
+}
+
+void WarpScheduler::reset() {
+    m_backlog = 0.0;
+    m_achievedWarp = 1.0;
+    m_totalDropped = 0.0;
+    m_lastStats = WarpFrameStats{};
+}
+
+double WarpScheduler::runFixedSteps(Spacecraft& spacecraft, double duration, double h, const BurnNode* burn,
+                                   const WarpRequest& request, double startTime, double deadline,
+                                   WarpFrameStats& stats) {
+    PoweredFlightModel model;
+    model.gravity = makeForceModel(request, startTime);
+    GravityFieldForceModel& forceModel = model.gravity;
+    bool timeDependent = !forceModel.isPointMass();
+    SpacecraftState& state = spacecraft.getState();
+    spacecraft.setThrottle(burn ? burn->throttle : 0.0);
+    if (burn) {
+        spacecraft.setThrustMode(burn->mode);
+        if (burn->mode == Spacecraft::ThrustMode::Custom) {
+            spacecraft.setThrustDirection(burn->direction);
+        }
+    }
+    model.thrust = spacecraft.getThrottle() * spacecraft.getMaxThrust();
+    model.exhaustVelocity = spacecraft.getIsp() * Constants::G0;
+    model.dryMass = spacecraft.getDryMass();
+    model.mode = spacecraft.getThrustMode();
+    model.customDirection = spacecraft.getThrustDirection();
+    
+    double advanced = 0.0;
+    int steps = 0;
+    double start = now();
+    
+    // Whole steps only; a remainder shorter than h stays in the backlog
+    while (duration - advanced >= h * (1.0 - 1e-12)) {
+        const double stepStart = startTime + advanced;
+        if (timeDependent) {
+            forceModel.setTime(stepStart);
+        }
+        const SpacecraftState stepStartState = state;
+        if (model.thrust > 0.0 && state.mass > model.dryMass) {
+            // Thrust and mass flow inside the derivative: always RK4
+            PoweredFlight::step(state, stepStart, h, model);
+        } else {
+            Integrator::step(state, h, request.integrator, forceModel);
+        }
+        advanced += h;
+        steps++;
+        
+        // The interpolant costs two force evaluations, spent only on steps
+        // that bracket an event
+        DenseTrajectory::Segment segment;
+        bool interpolated = false;
+        auto interpolate = [&](double t, glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+            if (!interpolated) {
+                segment = hermiteStep(model, timeDependent, stepStartState, state, stepStart, h);
+                interpolated = true;
+            }
+            DenseTrajectory::evaluateSegment(segment, t, outPosition, outVelocity);
+        };
+        if (m_events.step(stepStart + h, state.position, state.velocity, interpolate, stats.events)) {
+            advanced = stopAtEvent(state, stats) - startTime;
+            break;
+        }
+        // Checking the clock every step would cost more than a step
+        if ((steps & 63) == 0 && now() > deadline) {
+            break;
+        }
+    }
+    
+    if (steps > 0) {
+        double perStep = (now() - start) / steps;
+        m_secondsPerStep = 0.8 * m_secondsPerStep + 0.2 * perStep;
+    }
+    stats.steps += steps;
+    stats.stepSize = std::max(stats.stepSize, h);
+    return advanced;
+}
+
+double WarpScheduler::coastAnalytic(SpacecraftState& state, double duration, double period, double startTime,
+                                    WarpFrameStats& stats) {
+    double piece = duration;
+    if (!m_events.isEmpty() && period > 0.0 && std::isfinite(period)) {
+        piece = period / EVENT_KEPLER_PIECES;
+    }
+    
+    double advanced = 0.0;
+    while (duration - advanced > MIN_SEGMENT) {
+        const double h = std::min(piece, duration - advanced);
+        const double pieceStart = startTime + advanced;
+        const glm::dvec3 startPosition = state.position;
+        const glm::dvec3 startVelocity = state.velocity;
+        glm::dvec3 position, velocity;
+        if (!Orbit::propagateKepler(startPosition, startVelocity, h, Constants::MOON_MU, position, velocity)) {
+            break;
+        }
+        state.position = position;
+        state.velocity = velocity;
+        advanced += h;
+        
+        // The Kepler flow is its own exact interpolant
+        auto interpolate = [&](double t, glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+            Orbit::propagateKepler(startPosition, startVelocity, t - pieceStart, Constants::MOON_MU,
+                                   outPosition, outVelocity);
+        };
+        if (m_events.step(pieceStart + h, state.position, state.velocity, interpolate, stats.events)) {
+            advanced = stopAtEvent(state, stats) - startTime;
+            break;
+        }
+    }
+    return advanced;
+}
+
+WarpFrameStats WarpScheduler::advance(Spacecraft& spacecraft, const WarpRequest& request) {
+    double frameStart = now();
+    double deadline = frameStart + m_frameBudget;
+    
+    WarpFrameStats stats;
+    stats.requestedTime = request.realDeltaTime * request.timeWarp;
+    m_backlog += stats.requestedTime;
+    
+    SpacecraftState& state = spacecraft.getState();
+    const SpacecraftState startState = state;
+    const BurnNode* startBurn = findBurn(request, request.simulationTime);
+    m_events.begin(request.simulationTime, state.position, state.velocity);
+    
+    while (m_backlog > MIN_SEGMENT && !stats.impacted && now() < deadline) {
+        // Segments end on the timeline's next ignition or cutoff. A burn
+        // runs on simulated time even once the tanks are dry.
+        double segmentStart = request.simulationTime + stats.advancedTime;
+        const BurnNode* burn = findBurn(request, segmentStart);
+        double boundary = request.maneuvers ? request.maneuvers->getNextBoundary(segmentStart)
+                                            : std::numeric_limits<double>::infinity();
+        bool atBoundary = boundary - segmentStart <= m_backlog;
+        double segment = atBoundary ? boundary - segmentStart : m_backlog;
+        bool burning = burn && burn->throttle > 0.0 && spacecraft.hasFuel();
+        double advanced = 0.0;
+        GravityFieldForceModel forceModel = makeForceModel(request, segmentStart);
+        
+        if (!burning && request.analyticCoast && forceModel.isPointMass()) {
+            // Exact coast, if it cannot reach the surface
+            OrbitalElements elements = Orbit::computeElements(state.position, state.velocity, Constants::MOON_MU);
+            if (elements.periapsisAltitude > 0.0) {
+                advanced = coastAnalytic(state, segment, elements.orbitalPeriod, segmentStart, stats);
+            }
+        }
+        
+        if (advanced > 0.0) {
+            stats.method = WarpFrameStats::Method::Analytic;
+            stats.stepSize = std::max(stats.stepSize, advanced);
+        } else {
+            double budgetLeft = std::max(0.0, deadline - now());
+            double affordableSteps = std::max(1.0, budgetLeft / m_secondsPerStep);
+            double h = request.fixedStep;
+            
+            if (segment < h) {
+                // Less than one step owed: wait for the next frame, unless
+                // the segment ends on an ignition or cutoff, which is
+                // reached exactly
+                if (!atBoundary) {
+                    break;
+                }
+                h = segment;
+                stats.method = WarpFrameStats::Method::FixedStep;
+            } else if (segment / h <= affordableSteps) {
+                stats.method = WarpFrameStats::Method::FixedStep;
+            } else if (burning) {
+                // Keep up with larger steps; the mass and direction are
+                // integrated, so the cap only bounds the RK4 error
+                h = std::min(segment / affordableSteps, MAX_BURN_STEP);
+                stats.method = WarpFrameStats::Method::EnlargedStep;
+            } else {
+                // Coast towards the surface: error-controlled steps stretch
+                // far beyond the fixed step. CR3BP coasts use Bulirsch-
+                // Stoer, whose steps cost about a dozen fixed steps each.
+                bool extrapolate = forceModel.isCR3BP();
+                AdaptiveOptions options;
+                options.relTol = Constants::ORBIT_PREDICTION_TOLERANCE;
+                options.absTol = Constants::ORBIT_PREDICTION_TOLERANCE * 1000.0;
+                options.maxSteps = static_cast<int>(std::clamp(affordableSteps / (extrapolate ? 12.0 : 1.0), 1.0, 1e6));
+                
+                DenseTrajectory trajectory;
+                AdaptiveStats adaptiveStats;
+                double mass = state.mass;
+                SpacecraftState next = extrapolate
+                    ? CR3BP::propagate(state, segmentStart, segment, options, &trajectory, &adaptiveStats,
+                                       Constants::MOON_RADIUS)
+                    : Integrator::propagateAdaptive(state, segment, forceModel, options,
+                                                    &trajectory, &adaptiveStats, Constants::MOON_RADIUS);
+                state.position = next.position;
+                state.velocity = next.velocity;
+                state.mass = mass;
+                
+                advanced = trajectory.isEmpty() ? 0.0 : trajectory.getEndTime();
+                stats.method = WarpFrameStats::Method::Adaptive;
+                stats.steps += adaptiveStats.acceptedSteps;
+                if (adaptiveStats.acceptedSteps > 0) {
+                    stats.stepSize = std::max(stats.stepSize, advanced / adaptiveStats.acceptedSteps);
+                }
+                
+                // Events on the dense output, step by step. The integration
+                // stops at the end of the step that reaches the surface;
+                // the impact inside it is located here.
+                for (const DenseTrajectory::Segment& denseStep : trajectory.getSegments()) {
+                    auto interpolate = [&](double t, glm::dvec3& outPosition, glm::dvec3& outVelocity) {
+                        DenseTrajectory::evaluateSegment(denseStep, t - segmentStart, outPosition, outVelocity);
+                        if (extrapolate) {
+                            CR3BP::rotatingToInertial(outPosition, outVelocity, t, outPosition, outVelocity);
+                        }
+                    };
+                    double stepEnd = segmentStart + denseStep.t0 + denseStep.h;
+                    glm::dvec3 position, velocity;
+                    interpolate(stepEnd, position, velocity);
+                    if (m_events.step(stepEnd, position, velocity, interpolate, stats.events)) {
+                        advanced = stopAtEvent(state, stats) - segmentStart;
+                        break;
+                    }
+                }
+            }
+            
+            if (stats.method != WarpFrameStats::Method::Adaptive) {
+                advanced = runFixedSteps(spacecraft, segment, h, burning ? burn : nullptr, request,
+                                         segmentStart, deadline, stats);
+            }
+        }
+        
+        if (advanced <= 0.0) {
+            break;
+        }
+        m_backlog = std::max(0.0, m_backlog - advanced);
+        stats.advancedTime += advanced;
+        if (burn) {
+            stats.burnTime += advanced;
+        }
+    }
+    
+    const BurnNode* endBurn = findBurn(request, request.simulationTime + stats.advancedTime);
+    spacecraft.setThrottle(endBurn ? endBurn->throttle : 0.0);
+    
+    // Attitude over the same time, at its own rate
+    if (stats.advancedTime > 0.0) {
+        AttitudeSpan span;
+        span.duration = stats.advancedTime;
+        span.startPosition = startState.position;
+        span.endPosition = state.position;
+        span.hold = request.attitudeHold;
+        span.startTarget = holdAttitude(request, startBurn, startState);
+        span.endTarget = holdAttitude(request, endBurn, state);
+        stats.attitudeSteps = AttitudeDynamics::advance(state, spacecraft.getRigidBody(), span, Constants::MOON_MU);
+        if (stats.attitudeSteps > 0) {
+            stats.attitudeStepSize = span.duration / stats.attitudeSteps;
+        }
+    }
+    
+    if (stats.impacted) {
+        m_backlog = 0.0;
+    }
+    
+    // Bound the backlog so a slow machine catches up instead of spiralling;
+    // whatever is discarded is reported, never silently lost
+    double maxBacklog = std::max(request.fixedStep, BACKLOG_LIMIT * request.timeWarp);
+    if (m_backlog > maxBacklog) {
+        stats.droppedTime = m_backlog - maxBacklog;
+        m_totalDropped += stats.droppedTime;
+        m_backlog = maxBacklog;
+    }
+    stats.backlog = m_backlog;
+    
+    if (request.realDeltaTime > 0.0) {
+        double warp = stats.advancedTime / request.realDeltaTime;
+        m_achievedWarp = 0.9 * m_achievedWarp + 0.1 * warp;
+    }
+    
+    stats.cpuTime = now() - frameStart;
+    m_lastStats = stats;
+    return stats;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "AttitudeDynamics.h"
+#include "EventDetector.h"
+#include "GravityField.h"
+#include "Integrator.h"
+#include "ManeuverTimeline.h"
+#include "Spacecraft.h"
+#include <vector>
+
+// What one frame asks of the physics
+struct WarpRequest {
+    double realDeltaTime = 0.0;     // wall-clock seconds since the last frame
+    int timeWarp = 1;
+    double fixedStep = 0.02;        // preferred integrator step (seconds)
+    Integrator::Type integrator = Integrator::Type::RK4;
+    bool analyticCoast = true;      // allow Kepler jumps while coasting
+    
+    // Planned burns, executed on their exact simulation times; none if null
+    const ManeuverTimeline* maneuvers = nullptr;
+    
+    // Pointing between burns (as set in the Maneuver Planner); during a burn
+    // the nose follows the burn's own direction
+    Spacecraft::ThrustMode thrustMode = Spacecraft::ThrustMode::Prograde;
+    glm::dvec3 thrustDirection{1.0, 0.0, 0.0};  // inertial, for ThrustMode::Custom
+    bool attitudeHold = true;       // RCS points the nose along the thrust mode's direction
+    
+    // Gravity model. No field, or a degree below 2, is the point mass, the
+    // only case the analytic coast applies to.
+    const GravityField* gravityField = nullptr;
+    int gravityDegree = 0;
+    const GravityCache* gravityCache = nullptr;     // see GravityFieldForceModel
+    const Ephemeris* ephemeris = nullptr;           // Earth and Sun perturbations
+    bool circularEarth = false;                     // CR3BP Earth; see GravityFieldForceModel
+    double simulationTime = 0.0;    // orients the field, places the third bodies
+};
+
+// What the scheduler did with it
+struct WarpFrameStats {
+    enum class Method {
+        Idle,
+        Analytic,       // Kepler jump
+        FixedStep,      // selected integrator at the selected step
+        EnlargedStep,   // selected integrator at a larger step to keep up
+        Adaptive        // Dormand-Prince or Bulirsch-Stoer coast with error control
+    };
+    
+    Method method = Method::Idle;
+    double requestedTime = 0.0;     // sim seconds asked for this frame
+    double advancedTime = 0.0;      // sim seconds actually integrated
+    double burnTime = 0.0;          // of advancedTime, seconds under thrust
+    double droppedTime = 0.0;       // sim seconds discarded this frame
+    double backlog = 0.0;           // sim seconds carried to the next frame
+    double stepSize = 0.0;          // largest step taken (seconds)
+    int steps = 0;
+    int attitudeSteps = 0;          // 0 with time advanced: the hold settled the frame
+    double attitudeStepSize = 0.0;  // seconds
+    double cpuTime = 0.0;           // seconds
+    bool impacted = false;          // an impact event ended the frame
+    std::vector<Event> events;      // located this frame, in time order
+    
+    static const char* getMethodName(Method method);
+};
+
+// Advances the spacecraft by the simulated time each frame requests, within
+// a per-frame CPU budget. Coasts that cannot reach the surface are jumped
+// analytically; otherwise the selected integrator runs at the selected step,
+// and when that cannot keep up within the budget the scheduler switches to
+// larger fixed steps (burns) or adaptive Dormand-Prince (coasts; Bulirsch-
+// Stoer in the rotating frame for the Earth-Moon CR3BP). Thrusting steps
+// integrate the mass with the position and velocity (PoweredFlight, RK4),
+// which is what lets burn steps stretch to MAX_BURN_STEP. Time that
+// does not fit is carried as a backlog, and only dropped, and counted, once
+// the backlog exceeds BACKLOG_LIMIT of real time at the requested warp.
+//
+// Segments end on every ignition and cutoff of the request's maneuver
+// timeline, the last step of each shortened to land on it, so burns begin
+// and end on their exact times at any warp.
+//
+// Every step, whichever method took it, is checked by the event detector,
+// so impacts, apsides and the other tracked events get exact times however
+// long the steps are. A terminal event cuts its step short at the event;
+// an impact also ends the frame.
+//
+// The attitude then follows over the time advanced, at its own rate (see
+// AttitudeDynamics), between the frame's start and end positions.
+class WarpScheduler {
+public:
+    static constexpr double DEFAULT_FRAME_BUDGET = 0.008;  // seconds of CPU
+    static constexpr double BACKLOG_LIMIT = 0.25;          // seconds of real time
+    static constexpr double MAX_BURN_STEP = 30.0;          // seconds
+    static constexpr double EVENT_KEPLER_PIECES = 8.0;     // per period, for events in analytic coasts
+    
+    // Tracks surface impact from the start; add further events through
+    // getEventDetector()
+    WarpScheduler();
+    
+    void reset();
+    
+    EventDetector& getEventDetector() { return m_events; }
+    
+    void setFrameBudget(double seconds) { m_frameBudget = seconds; }
+    double getFrameBudget() const { return m_frameBudget; }
+    
+    WarpFrameStats advance(Spacecraft& spacecraft, const WarpRequest& request);
+    
+    const WarpFrameStats& getLastStats() const { return m_lastStats; }
+    double getAchievedWarp() const { return m_achievedWarp; }   // smoothed
+    double getTotalDroppedTime() const { return m_totalDropped; }
+
+private:
+    // Fixed steps of size h over at most duration, under burn's thrust if
+    // it is not null; stops on impact, when the budget runs out or at the
+    // end of the span. Returns time advanced.
+    double runFixedSteps(Spacecraft& spacecraft, double duration, double h, const BurnNode* burn,
+                         const WarpRequest& request, double startTime, double deadline,
+                         WarpFrameStats& stats);
+    
+    // Kepler jump over duration, in pieces of at most 1 / EVENT_KEPLER_PIECES
+    // of the period so the detector sees each apsis and node. Stops at a
+    // terminal event. Returns time advanced; 0 if Kepler's equation could
+    // not be solved.
+    double coastAnalytic(SpacecraftState& state, double duration, double period, double startTime,
+                         WarpFrameStats& stats);
+    
+    EventDetector m_events;
+    double m_frameBudget = DEFAULT_FRAME_BUDGET;
+    double m_backlog = 0.0;
+    double m_secondsPerStep = 1e-6;     // measured cost of one fixed step
+    double m_achievedWarp = 1.0;
+    double m_totalDropped = 0.0;
+    WarpFrameStats m_lastStats;
+};
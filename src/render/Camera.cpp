@@ -144,8 +144,9 @@ void Camera::processScroll(float yOffset) {
             
         case Mode::OrbitAroundMoon:
         case Mode::TopDown:
-            m_orbitDistance -= yOffset * m_zoomSpeed;
-            m_orbitDistance = std::clamp(m_orbitDistance, 100.0f, 50000.0f);
+            // Faster when far out, so halo orbit distances are in reach
+            m_orbitDistance -= yOffset * m_zoomSpeed * std::max(1.0f, m_orbitDistance / 5000.0f);
+            m_orbitDistance = std::clamp(m_orbitDistance, MIN_ORBIT_DISTANCE, MAX_ORBIT_DISTANCE);
             break;
             
         case Mode::Chase:
@@ -180,7 +181,7 @@ void Camera::setFov(float fov) {
 }
 
 void Camera::setOrbitDistance(float distance) {
-    m_orbitDistance = std::clamp(distance, 100.0f, 50000.0f);
+    m_orbitDistance = std::clamp(distance, MIN_ORBIT_DISTANCE, MAX_ORBIT_DISTANCE);
 }
 
 void Camera::updateCameraVectors() {
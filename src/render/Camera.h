@@ -44,7 +44,10 @@ public:
     float getMouseSensitivity() const { return m_mouseSensitivity; }
     void setMouseSensitivity(float sensitivity) { m_mouseSensitivity = sensitivity; }
     
-    // Orbit distance for OrbitAroundMoon mode
+    // Orbit distance for OrbitAroundMoon mode (km); the far end covers
+    // Earth-Moon halo orbits
+    static constexpr float MIN_ORBIT_DISTANCE = 100.0f;
+    static constexpr float MAX_ORBIT_DISTANCE = 200000.0f;
     float getOrbitDistance() const { return m_orbitDistance; }
     void setOrbitDistance(float distance);
     
@@ -67,7 +70,7 @@ private:
     
     float m_fov = 45.0f;
     float m_nearPlane = 0.1f;
-    float m_farPlane = 100000.0f;
+    float m_farPlane = 500000.0f;
     
     float m_moveSpeed = 500.0f;
     float m_mouseSensitivity = 0.1f;
@@ -1,6 +1,7 @@
 #include "Mesh.h"
 #include <glad/gl.h>
 #include <cmath>
+#include <cstddef>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -325,3 +326,32 @@ void Mesh::drawLines() const {
     glDrawArrays(GL_LINE_STRIP, 0, m_vertexCount);
     glBindVertexArray(0);
 }
+
+void Mesh::setInstanceBuffer(unsigned int buffer) {
+    if (m_vao == 0 || m_isLineStrip) return;
+    
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    
+    // A mat4 attribute takes four locations, one vec4 column each
+    for (unsigned int column = 0; column < 4; ++column) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(MeshInstance),
+                              (void*)(offsetof(MeshInstance, model) + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    
+    glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (void*)offsetof(MeshInstance, color));
+    glEnableVertexAttribArray(7);
+    glVertexAttribDivisor(7, 1);
+    
+    glBindVertexArray(0);
+}
+
+void Mesh::drawInstanced(unsigned int count) const {
+    if (m_vao == 0 || m_isLineStrip || count == 0) return;
+    
+    glBindVertexArray(m_vao);
+    glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0, count);
+    glBindVertexArray(0);
+}
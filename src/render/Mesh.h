@@ -3,6 +3,13 @@
 #include <vector>
 #include <glm/glm.hpp>
 
+// Per-instance attributes for Mesh::drawInstanced: the model matrix at
+// locations 3-6, one column each, and a colour at 7
+struct MeshInstance {
+    glm::mat4 model;
+    glm::vec3 color;
+};
+
 class Mesh {
 public:
     Mesh() = default;
@@ -31,6 +38,11 @@ public:
     void draw() const;
     void drawLines() const;
     
+    // Read MeshInstance attributes from buffer, one per instance, then draw
+    // count copies in a single call
+    void setInstanceBuffer(unsigned int buffer);
+    void drawInstanced(unsigned int count) const;
+    
     bool isValid() const { return m_vao != 0; }
     
 private:
@@ -1,43 +1,22 @@
 #include "Renderer.h"
+#include "core/Assets.h"
 #include "core/Constants.h"
 #include <glad/gl.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 #include <algorithm>
-#include <cstdlib>
-#include <filesystem>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-namespace {
-    // Helper function to find asset path
-    // Checks multiple locations for portable/installed execution
-    std::string findAssetPath(const std::string& relativePath) {
-        namespace fs = std::filesystem;
-        std::vector<fs::path> searchPaths;
-        
-        // Check environment variable first (for installed package)
-        const char* envPath = std::getenv("ARTEMIS_ASSETS_DIR");
-        if (envPath) {
-            searchPaths.push_back(fs::path(envPath) / relativePath);
-        }
-        
-        // Check relative paths (for development and portable builds)
-        searchPaths.push_back(fs::path("assets") / relativePath);
-        searchPaths.push_back(fs::path("..") / "share" / "ArtemisMoonOrbiterSim" / "assets" / relativePath);
-        searchPaths.push_back(fs::path("share") / "ArtemisMoonOrbiterSim" / "assets" / relativePath);
-        
-        for (const auto& path : searchPaths) {
-            if (fs::exists(path)) {
-                return path.string();
-            }
-        }
-        
-        // Return the default relative path if nothing found
-        return (fs::path("assets") / relativePath).string();
-    }
-}
+// Fleet vehicles by VehicleClass: Orion, Gateway, Lander, Relay
+static const float fleetClassScale[] = {1.0f, 1.5f, 0.8f, 0.6f};
+static const glm::vec3 fleetClassColors[] = {
+    {0.9f, 0.9f, 0.95f},
+    {0.95f, 0.8f, 0.3f},
+    {0.5f, 0.75f, 1.0f},
+    {0.55f, 0.9f, 0.5f}
+};
 
 // Shader sources
 static const char* litVertexShader = R"(
@@ -96,6 +75,46 @@ void main() {
 }
 )";
 
+// Lit, with the model matrix and colour per instance (MeshInstance). The
+// models are rotations times a uniform scale, so their upper 3x3 serves as
+// the normal matrix.
+static const char* instancedVertexShader = R"(
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 3) in mat4 aModel;
+layout(location = 7) in vec3 aColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 Normal;
+out vec3 Color;
+
+void main() {
+    Normal = mat3(aModel) * aNormal;
+    Color = aColor;
+    gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+}
+)";
+
+static const char* instancedFragmentShader = R"(
+#version 330 core
+in vec3 Normal;
+in vec3 Color;
+
+uniform vec3 lightDir;
+uniform float ambient;
+uniform float diffuseStrength;
+
+out vec4 FragColor;
+
+void main() {
+    float diff = max(dot(normalize(Normal), normalize(-lightDir)), 0.0) * diffuseStrength;
+    FragColor = vec4((ambient + diff) * Color, 1.0);
+}
+)";
+
 static const char* unlitVertexShader = R"(
 #version 330 core
 layout(location = 0) in vec3 aPos;
@@ -170,7 +189,7 @@ bool Renderer::init(int width, int height) {
     // Try to load moon texture
     stbi_set_flip_vertically_on_load(true);
     int texWidth, texHeight, nrChannels;
-    std::string moonTexturePath = findAssetPath("textures/moon_albedo.png");
+    std::string moonTexturePath = Assets::findPath("textures/moon_albedo.png");
     unsigned char* data = stbi_load(moonTexturePath.c_str(), 
                                     &texWidth, &texHeight, &nrChannels, 0);
     if (data) {
@@ -197,6 +216,10 @@ bool Renderer::init(int width, int height) {
 }
 
 void Renderer::shutdown() {
+    if (m_fleetInstanceBuffer != 0) {
+        glDeleteBuffers(1, &m_fleetInstanceBuffer);
+        m_fleetInstanceBuffer = 0;
+    }
     if (m_moonTexture != 0) {
         glDeleteTextures(1, &m_moonTexture);
         m_moonTexture = 0;
@@ -209,6 +232,11 @@ bool Renderer::initShaders() {
         return false;
     }
     
+    if (!m_instancedShader.loadFromSource(instancedVertexShader, instancedFragmentShader)) {
+        std::cerr << "Failed to load instanced shader" << std::endl;
+        return false;
+    }
+    
     if (!m_unlitShader.loadFromSource(unlitVertexShader, unlitFragmentShader)) {
         std::cerr << "Failed to load unlit shader" << std::endl;
         return false;
@@ -230,6 +258,12 @@ void Renderer::createMeshes() {
     // Spacecraft (simple arrow shape)
     m_spacecraftMesh.createArrow(20.0f, 5.0f);  // 20km long arrow for visibility
     
+    // Fleet vehicles: the same arrow at half size, drawn per instance from
+    // a buffer refilled every frame
+    m_fleetMesh.createArrow(10.0f, 2.5f);
+    glGenBuffers(1, &m_fleetInstanceBuffer);
+    m_fleetMesh.setInstanceBuffer(m_fleetInstanceBuffer);
+    
     // Thrust cone
     m_thrustConeMesh.createCone(3.0f, 15.0f, 16);
     
@@ -298,22 +332,13 @@ void Renderer::renderSpacecraft(const SpacecraftState& state, float throttle) {
     // Create model matrix with position and orientation
     glm::mat4 model = glm::translate(glm::mat4(1.0f), pos);
     
-    // Rotate to align with velocity direction for prograde orientation
-    glm::vec3 velocity = glm::normalize(glm::vec3(state.velocity));
-    if (glm::length(glm::vec3(state.velocity)) > 0.01f) {
-        glm::vec3 up = glm::normalize(pos);
-        glm::vec3 right = glm::cross(velocity, up);
-        if (glm::length(right) > 0.001f) {
-            right = glm::normalize(right);
-            up = glm::normalize(glm::cross(right, velocity));
-            
-            glm::mat4 orientMat(1.0f);
-            orientMat[0] = glm::vec4(right, 0.0f);
-            orientMat[1] = glm::vec4(velocity, 0.0f);
-            orientMat[2] = glm::vec4(up, 0.0f);
-            model = model * orientMat;
-        }
-    }
+    // Orient by the integrated attitude: body axes right, nose, up map to
+    // the model's x, y, z
+    glm::mat4 orientMat(1.0f);
+    orientMat[0] = glm::vec4(glm::vec3(state.attitude * glm::dvec3(1.0, 0.0, 0.0)), 0.0f);
+    orientMat[1] = glm::vec4(glm::vec3(state.attitude * glm::dvec3(0.0, 1.0, 0.0)), 0.0f);
+    orientMat[2] = glm::vec4(glm::vec3(state.attitude * glm::dvec3(0.0, 0.0, 1.0)), 0.0f);
+    model = model * orientMat;
     
     glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
     
@@ -350,6 +375,54 @@ void Renderer::renderSpacecraft(const SpacecraftState& state, float throttle) {
     }
 }
 
+void Renderer::renderFleet(const std::vector<FleetInstance>& fleet) {
+    if (fleet.empty()) return;
+    
+    // One transform per vehicle: nose along the velocity, top away from
+    // the Moon, as the spacecraft's body axes map to the model's x, y, z
+    m_fleetInstances.resize(fleet.size());
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        const FleetInstance& vehicle = fleet[i];
+        glm::vec3 nose = glm::normalize(glm::vec3(vehicle.velocity));
+        glm::vec3 radial = glm::normalize(glm::vec3(vehicle.position));
+        glm::vec3 right = glm::cross(nose, radial);
+        float rightLength = glm::length(right);
+        right = rightLength > 1e-6f ? right / rightLength : glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 up = glm::cross(right, nose);
+        
+        float scale = fleetClassScale[static_cast<int>(vehicle.vehicleClass)];
+        glm::mat4 model(1.0f);
+        model[0] = glm::vec4(right * scale, 0.0f);
+        model[1] = glm::vec4(nose * scale, 0.0f);
+        model[2] = glm::vec4(up * scale, 0.0f);
+        model[3] = glm::vec4(glm::vec3(vehicle.position / Constants::RENDER_SCALE), 1.0f);
+        
+        m_fleetInstances[i].model = model;
+        m_fleetInstances[i].color = vehicle.throttle > 0.0f
+            ? glm::vec3(1.0f, 0.5f, 0.2f)   // burning: orange, as the thrust cone
+            : fleetClassColors[static_cast<int>(vehicle.vehicleClass)];
+    }
+    
+    // Orphan and refill, so the driver need not wait for last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, m_fleetInstanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, m_fleetInstances.size() * sizeof(MeshInstance), m_fleetInstances.data(),
+                 GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    m_instancedShader.use();
+    
+    float aspectRatio = static_cast<float>(m_width) / static_cast<float>(m_height);
+    m_instancedShader.setMat4("view", m_camera.getViewMatrix());
+    m_instancedShader.setMat4("projection", m_camera.getProjectionMatrix(aspectRatio));
+    
+    glm::vec3 sunDir = glm::normalize(glm::vec3(1.0f, 0.2f, 0.1f));
+    m_instancedShader.setVec3("lightDir", sunDir);
+    m_instancedShader.setFloat("ambient", 0.3f);
+    m_instancedShader.setFloat("diffuseStrength", 0.7f);
+    
+    m_fleetMesh.drawInstanced(static_cast<unsigned int>(m_fleetInstances.size()));
+}
+
 void Renderer::renderOrbitPath(const std::vector<glm::dvec3>& trajectory, const glm::vec3& color) {
     if (trajectory.empty() || !m_showOrbitPath) return;
     
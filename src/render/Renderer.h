@@ -3,6 +3,7 @@
 #include "Camera.h"
 #include "Shader.h"
 #include "Mesh.h"
+#include "physics/Fleet.h"
 #include "physics/Spacecraft.h"
 #include <glm/glm.hpp>
 #include <vector>
@@ -20,6 +21,10 @@ public:
     // Rendering
     void renderMoon();
     void renderSpacecraft(const SpacecraftState& state, float throttle);
+    
+    // Every fleet vehicle in one instanced draw call, coloured by class
+    // (orange while burning)
+    void renderFleet(const std::vector<FleetInstance>& fleet);
     void renderOrbitPath(const std::vector<glm::dvec3>& trajectory, const glm::vec3& color);
     void renderVector(const glm::dvec3& origin, const glm::dvec3& direction, 
                      float length, const glm::vec3& color);
@@ -52,6 +57,7 @@ private:
     
     // Shaders
     Shader m_litShader;
+    Shader m_instancedShader;
     Shader m_unlitShader;
     Shader m_lineShader;
     
@@ -62,6 +68,11 @@ private:
     Mesh m_arrowMesh;
     Mesh m_orbitPathMesh;
     
+    // Fleet: instance data rebuilt each frame, reusing its capacity
+    Mesh m_fleetMesh;
+    unsigned int m_fleetInstanceBuffer = 0;
+    std::vector<MeshInstance> m_fleetInstances;
+    
     // Rendering options
     bool m_showOrbitPath = true;
     bool m_showVelocityVector = false;
@@ -4,7 +4,26 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace {
+    const char* getThrustModeName(Spacecraft::ThrustMode mode) {
+        switch (mode) {
+            case Spacecraft::ThrustMode::Prograde: return "Prograde";
+            case Spacecraft::ThrustMode::Retrograde: return "Retrograde";
+            case Spacecraft::ThrustMode::RadialIn: return "Radial In";
+            case Spacecraft::ThrustMode::RadialOut: return "Radial Out";
+            case Spacecraft::ThrustMode::Normal: return "Normal";
+            case Spacecraft::ThrustMode::AntiNormal: return "Anti-Normal";
+            case Spacecraft::ThrustMode::Custom:
+            default: return "Custom";
+        }
+    }
+}
 
 bool Ui::init(GLFWwindow* window) {
     IMGUI_CHECKVERSION();
@@ -57,6 +76,8 @@ void Ui::render(const SpacecraftState& state, const OrbitalElements& elements,
             ImGui::MenuItem("Camera", nullptr, &m_showCameraControls);
             ImGui::MenuItem("Graphs", nullptr, &m_showGraphs);
             ImGui::MenuItem("Performance", nullptr, &m_showPerformance);
+            ImGui::MenuItem("Transfer Window", nullptr, &m_showTransferWindow);
+            ImGui::MenuItem("Fleet", nullptr, &m_showFleet);
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
@@ -64,10 +85,12 @@ void Ui::render(const SpacecraftState& state, const OrbitalElements& elements,
     
     if (m_showSimControls) renderSimulationControls(time);
     if (m_showTelemetry) renderTelemetry(state, elements);
-    if (m_showManeuverPlanner) renderManeuverPlanner(state);
+    if (m_showManeuverPlanner) renderManeuverPlanner(state, elements);
     if (m_showCameraControls) renderCameraControls(camera, showOrbitPath, showVelocityVector, showThrustVector);
     if (m_showGraphs) renderGraphs();
     if (m_showPerformance) renderPerformanceOverlay(time);
+    if (m_showTransferWindow) renderTransferWindow();
+    if (m_showFleet) renderFleet();
     
     if (m_impactOccurred) {
         renderImpactScreen();
@@ -109,24 +132,57 @@ void Ui::renderSimulationControls(Time& time) {
         
         // Scenario selector
         ImGui::Separator();
-        const char* scenarios[] = { 
-            "Circular Low Lunar Orbit (100km)",
-            "Elliptical Capture Orbit",
-            "Near Surface Skimming"
-        };
-        if (ImGui::Combo("Scenario", &m_selectedScenario, scenarios, 3)) {
-            if (m_resetCallback) {
-                m_resetCallback(m_selectedScenario);
+        const char* preview = (m_selectedScenario < static_cast<int>(m_scenarioNames.size()))
+                            ? m_scenarioNames[m_selectedScenario].c_str() : "";
+        if (ImGui::BeginCombo("Scenario", preview)) {
+            for (int i = 0; i < static_cast<int>(m_scenarioNames.size()); ++i) {
+                if (ImGui::Selectable(m_scenarioNames[i].c_str(), i == m_selectedScenario) &&
+                    i != m_selectedScenario) {
+                    m_selectedScenario = i;
+                    if (m_resetCallback) {
+                        m_resetCallback(m_selectedScenario);
+                    }
+                    m_impactOccurred = false;
+                }
             }
-            m_impactOccurred = false;
+            ImGui::EndCombo();
         }
         
         // Integrator selector
-        const char* integrators[] = { "Euler", "Semi-Implicit Euler", "RK4" };
-        ImGui::Combo("Integrator", &m_selectedIntegrator, integrators, 3);
+        const char* integrators[] = {
+            "Euler", "Semi-Implicit Euler", "RK4",
+            "Velocity Verlet", "Forest-Ruth", "Yoshida 4", "Yoshida 6"
+        };
+        ImGui::Combo("Integrator", &m_selectedIntegrator, integrators, 7);
         
-        // Fixed timestep display
-        ImGui::Text("Fixed dt: %.3f s", Constants::FIXED_TIMESTEP);
+        // Fixed timestep selector (large steps are meant for the
+        // symplectic integrators on long coasts)
+        const char* timesteps[] = { "0.02 s (50 Hz)", "0.1 s", "1 s", "5 s", "10 s" };
+        ImGui::Combo("Fixed dt", &m_selectedTimestep, timesteps, 5);
+        if (m_selectedTimestep > 0 && m_selectedIntegrator < 3) {
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "Large steps drift; prefer a symplectic method");
+        }
+        
+        // Exact two-body coasting; the integrator is only used during burns
+        // and on orbits that intersect the surface
+        ImGui::Checkbox("Analytic coast (Kepler)", &m_analyticCoast);
+        
+        // Spherical-harmonic gravity, capped by the degree of the loaded
+        // coefficient file
+        const char* gravityModels[] = { "Point mass", "Degree 2", "Degree 10", "Degree 50", "Full field" };
+        if (m_cr3bp) {
+            // The scenario fixes the model: point-mass Earth and Moon on circles
+            ImGui::Text("Dynamics: Earth-Moon CR3BP");
+        } else {
+            ImGui::Combo("Gravity", &m_selectedGravity, gravityModels, 5);
+            if (m_gravityDegreeInUse >= 2) {
+                ImGui::Text("Field in use: degree %d%s", m_gravityDegreeInUse, m_gravityCached ? " (cached)" : "");
+            }
+            ImGui::Checkbox("Earth/Sun perturbations", &m_thirdBodies);
+        }
+        if (m_analyticCoast && (m_gravityDegreeInUse >= 2 || m_thirdBodies || m_cr3bp)) {
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "Analytic coast needs point-mass gravity");
+        }
         
         // Simulation time
         double simTime = time.getSimulationTime();
@@ -187,55 +243,176 @@ void Ui::renderTelemetry(const SpacecraftState& state, const OrbitalElements& el
             ImGui::Text("Period: N/A (escape)");
         }
         
+        // Impact or closest approach over the prediction horizon. A bound
+        // result also shows the altitude the coast is proven to stay above.
+        const ImpactPrediction& prediction = m_impactPrediction;
+        if (prediction.isValid()) {
+            ImGui::Separator();
+            const char* method = ImpactPrediction::getMethodName(prediction.method);
+            if (prediction.impact) {
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Predicted impact in %.1f s (%s)",
+                                   prediction.impactTime - m_predictionClock, method);
+                ImGui::Text("  T %.3f s, %.1f m/s", prediction.impactTime, prediction.impactSpeed);
+                ImGui::Text("  Lat %.2f°, Lon %.2f°", prediction.latitude * Constants::RAD_TO_DEG,
+                            prediction.longitude * Constants::RAD_TO_DEG);
+            } else {
+                ImGui::Text("No impact before T %.0f s (%s)", prediction.horizonEnd, method);
+                ImGui::Text("  Closest: %.2f km at T %.1f s", prediction.closestAltitude / 1000.0,
+                            prediction.closestTime);
+                if (prediction.method == ImpactPrediction::Method::Bound) {
+                    ImGui::Text("  Stays above %.2f km", prediction.minimumAltitude / 1000.0);
+                }
+            }
+        }
+        
         // Energy & Angular Momentum
         ImGui::Separator();
         ImGui::Text("Specific Energy: %.0f J/kg", elements.specificEnergy);
         ImGui::Text("Ang. Momentum: %.0f m²/s", elements.angularMomentum);
         
+        // Jacobi constant: conserved while coasting, so its drift is the
+        // integration error
+        if (m_cr3bp) {
+            ImGui::Separator();
+            ImGui::Text("Jacobi Constant: %.10f", m_jacobiConstant);
+            ImGui::Text("  Drift: %.2e", m_jacobiDrift);
+        }
+        
+        // Events, newest first, at the times the detector located them
+        if (!m_eventLog.empty()) {
+            ImGui::Separator();
+            ImGui::Text("Events:");
+            for (auto it = m_eventLog.rbegin(); it != m_eventLog.rend(); ++it) {
+                double eventAltitude = glm::length(it->position) - Constants::MOON_RADIUS;
+                ImGui::Text("  %-15s T %10.3f s  %8.2f km", it->name, it->time, eventAltitude / 1000.0);
+            }
+        }
+        
         // Mass
         ImGui::Separator();
         ImGui::Text("Mass: %.1f kg", state.mass);
+        ImGui::Text("Body rate: %.3f°/s", glm::length(state.angularVelocity) * Constants::RAD_TO_DEG);
     }
     ImGui::End();
 }
 
-void Ui::renderManeuverPlanner(const SpacecraftState& state) {
+Targeting::Target Ui::getTarget() const {
+    Targeting::Target target;
+    if (!m_targetingMode) {
+        return target;
+    }
+    target.goal = m_targetGoal;
+    if (m_targetGoal == Targeting::Goal::PeriapsisAltitude) {
+        target.value = m_targetPeriapsis * 1000.0;
+    } else if (m_targetGoal == Targeting::Goal::Inclination) {
+        target.value = m_targetInclination * Constants::DEG_TO_RAD;
+    }
+    return target;
+}
+
+void Ui::setTargetingSolution(const Targeting::Solution& solution) {
+    m_targeting = solution;
+    if (m_targetingMode && !m_burnActive && solution.isExecutable()) {
+        m_burnDuration = static_cast<float>(solution.duration);
+    }
+}
+
+void Ui::renderManeuverPlanner(const SpacecraftState& state, const OrbitalElements& elements) {
     ImGui::SetNextWindowPos(ImVec2(300, 30), ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(ImVec2(250, 230), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(250, 330), ImGuiCond_FirstUseEver);
     
     if (ImGui::Begin("Maneuver Planner", &m_showManeuverPlanner)) {
-        // Thrust mode selector
-        const char* modes[] = { 
-            "Prograde", "Retrograde", "Radial In", "Radial Out", "Normal", "Anti-Normal"
-        };
-        int modeInt = static_cast<int>(m_thrustMode);
-        if (ImGui::Combo("Burn Direction", &modeInt, modes, 6)) {
-            m_thrustMode = static_cast<Spacecraft::ThrustMode>(modeInt);
+        // Manual: pick direction and duration. Targeting: pick a goal and
+        // fly the solver's burn.
+        if (ImGui::RadioButton("Manual", !m_targetingMode)) {
+            m_targetingMode = false;
         }
+        ImGui::SameLine();
+        if (ImGui::RadioButton("Targeting", m_targetingMode) && !m_targetingMode) {
+            m_targetingMode = true;
+            if (m_throttle <= 0.0f) {
+                m_throttle = 1.0f;
+            }
+        }
+        
+        if (!m_targetingMode) {
+            // Thrust mode selector
+            const char* modes[] = {
+                getThrustModeName(Spacecraft::ThrustMode::Prograde),
+                getThrustModeName(Spacecraft::ThrustMode::Retrograde),
+                getThrustModeName(Spacecraft::ThrustMode::RadialIn),
+                getThrustModeName(Spacecraft::ThrustMode::RadialOut),
+                getThrustModeName(Spacecraft::ThrustMode::Normal),
+                getThrustModeName(Spacecraft::ThrustMode::AntiNormal)
+            };
+            int modeInt = static_cast<int>(m_thrustMode);
+            if (ImGui::Combo("Burn Direction", &modeInt, modes, 6)) {
+                m_thrustMode = static_cast<Spacecraft::ThrustMode>(modeInt);
+            }
+        }
+        
+        // Off, the vehicle tumbles freely under the gravity gradient
+        ImGui::Checkbox("RCS attitude hold", &m_attitudeHold);
         
         // Throttle slider
         ImGui::SliderFloat("Throttle", &m_throttle, 0.0f, 1.0f, "%.2f");
         
-        // Burn duration
-        ImGui::InputFloat("Duration (s)", &m_burnDuration, 1.0f, 10.0f, "%.1f");
-        m_burnDuration = std::max(0.1f, m_burnDuration);
+        if (m_targetingMode) {
+            renderTargeting(elements);
+        } else {
+            // Burn duration, and ignition now or later on the timeline
+            ImGui::InputFloat("Duration (s)", &m_burnDuration, 1.0f, 10.0f, "%.1f");
+            m_burnDuration = std::max(0.1f, m_burnDuration);
+            ImGui::InputFloat("Ignition in (s)", &m_burnDelay, 10.0f, 600.0f, "%.1f");
+            m_burnDelay = std::max(0.0f, m_burnDelay);
+        }
         
-        // Execute burn button
+        // Execute burn button; a targeted burn needs a solution to fly, and
+        // is always flown from now
         ImGui::Separator();
-        if (!m_burnActive) {
-            if (ImGui::Button("Execute Burn", ImVec2(-1, 30))) {
-                m_burnActive = true;
-                m_burnTimeRemaining = m_burnDuration;
-            }
-        } else {
-            ImGui::ProgressBar(1.0f - m_burnTimeRemaining / m_burnDuration, 
+        bool scheduled = !m_targetingMode && m_burnDelay > 0.0f;
+        if (m_burnActive) {
+            ImGui::ProgressBar(1.0f - m_burnTimeRemaining / std::max(m_activeBurnDuration, 1e-3f),
                               ImVec2(-1, 20), "Burning...");
             if (ImGui::Button("Cancel Burn", ImVec2(-1, 25))) {
-                m_burnActive = false;
-                m_throttle = 0.0f;
+                if (m_cancelBurnCallback) {
+                    m_cancelBurnCallback();
+                }
             }
             ImGui::Text("Time remaining: %.1f s", m_burnTimeRemaining);
         }
+        if (!m_burnActive || scheduled) {
+            ImGui::BeginDisabled(m_targetingMode && !m_targeting.isExecutable());
+            if (ImGui::Button(scheduled ? "Schedule Burn" : "Execute Burn", ImVec2(-1, 30))) {
+                if (m_burnCallback) {
+                    m_burnCallback(m_thrustMode, m_throttle, m_burnDuration, scheduled ? m_burnDelay : 0.0f);
+                }
+            }
+            ImGui::EndDisabled();
+        }
+        
+        // Timeline: every planned burn, the one in progress first
+        if (!m_maneuvers.empty()) {
+            ImGui::Separator();
+            ImGui::Text("Timeline");
+            for (const BurnNode& burn : m_maneuvers) {
+                ImGui::PushID(static_cast<int>(burn.id));
+                if (ImGui::SmallButton("x") && m_removeBurnCallback) {
+                    m_removeBurnCallback(burn.id);
+                }
+                ImGui::SameLine();
+                double countdown = burn.startTime - m_maneuverClock;
+                const char* name = burn.mode == Spacecraft::ThrustMode::Custom
+                    ? "Targeted" : getThrustModeName(burn.mode);
+                if (countdown > 0.0) {
+                    ImGui::Text("T-%.1f s  %s %.1f s at %.0f%%", countdown, name, burn.duration,
+                                burn.throttle * 100.0);
+                } else {
+                    ImGui::Text("Now  %s %.1f s at %.0f%%", name, burn.duration, burn.throttle * 100.0);
+                }
+                ImGui::PopID();
+            }
+        }
         
         // Fuel info
         ImGui::Separator();
@@ -248,6 +425,45 @@ void Ui::renderManeuverPlanner(const SpacecraftState& state) {
     ImGui::End();
 }
 
+void Ui::renderTargeting(const OrbitalElements& elements) {
+    const char* goals[] = { "Periapsis altitude", "Circularize", "Inclination" };
+    int goalIndex = static_cast<int>(m_targetGoal) - 1;
+    if (ImGui::Combo("Goal", &goalIndex, goals, 3)) {
+        m_targetGoal = static_cast<Targeting::Goal>(goalIndex + 1);
+        if (m_targetGoal == Targeting::Goal::Inclination) {
+            // Start from the current plane
+            m_targetInclination = static_cast<float>(elements.inclination * Constants::RAD_TO_DEG);
+        }
+    }
+    if (m_targetGoal == Targeting::Goal::PeriapsisAltitude) {
+        ImGui::InputFloat("Periapsis (km)", &m_targetPeriapsis, 1.0f, 10.0f, "%.1f");
+    } else if (m_targetGoal == Targeting::Goal::Inclination) {
+        ImGui::InputFloat("Inclination (deg)", &m_targetInclination, 0.1f, 1.0f, "%.2f");
+        m_targetInclination = std::clamp(m_targetInclination, 0.0f, 180.0f);
+    }
+    
+    const Targeting::Solution& solution = m_targeting;
+    if (solution.status == Targeting::Status::Converged && solution.duration <= 0.0) {
+        ImGui::Text("Goal already met");
+        return;
+    }
+    if (solution.status == Targeting::Status::Converged) {
+        ImGui::Text("Solved in %d iterations", solution.iterations);
+    } else {
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.3f, 1.0f), "No burn: %s", Targeting::getStatusName(solution.status));
+        if (solution.status != Targeting::Status::OutOfFuel) {
+            return;
+        }
+    }
+    
+    // Components in the frame at the start of the burn
+    ImGui::Text("Delta-v: %.2f m/s", glm::length(solution.deltaV));
+    ImGui::Text("  Prograde: %.2f  Normal: %.2f  Radial: %.2f",
+               solution.localDeltaV.x, solution.localDeltaV.y, solution.localDeltaV.z);
+    ImGui::Text("Duration: %.1f s", solution.duration);
+    ImGui::Text("Propellant: %.1f kg", solution.propellant);
+}
+
 void Ui::renderCameraControls(Camera& camera, bool& showOrbitPath,
                              bool& showVelocityVector, bool& showThrustVector) {
     ImGui::SetNextWindowPos(ImVec2(560, 30), ImGuiCond_FirstUseEver);
@@ -269,7 +485,8 @@ void Ui::renderCameraControls(Camera& camera, bool& showOrbitPath,
         // Orbit distance (for orbit/topdown modes)
         if (m_selectedCameraMode == 2 || m_selectedCameraMode == 3) {
             float dist = camera.getOrbitDistance();
-            if (ImGui::SliderFloat("Distance", &dist, 100.0f, 20000.0f, "%.0f km")) {
+            if (ImGui::SliderFloat("Distance", &dist, Camera::MIN_ORBIT_DISTANCE, Camera::MAX_ORBIT_DISTANCE,
+                                   "%.0f km", ImGuiSliderFlags_Logarithmic)) {
                 camera.setOrbitDistance(dist);
             }
         }
@@ -330,7 +547,7 @@ void Ui::renderImpactScreen() {
     ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x * 0.5f, 
                                    ImGui::GetIO().DisplaySize.y * 0.5f),
                            ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-    ImGui::SetNextWindowSize(ImVec2(300, 150), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(300, 170), ImGuiCond_Always);
     
     ImGui::Begin("Impact!", nullptr, 
                 ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | 
@@ -345,6 +562,10 @@ void Ui::renderImpactScreen() {
     ImGui::Separator();
     ImGui::Text("The spacecraft has collided with");
     ImGui::Text("the lunar surface.");
+    if (!m_eventLog.empty() && m_eventLog.back().isImpact()) {
+        const Event& impact = m_eventLog.back();
+        ImGui::Text("T %.3f s at %.1f m/s", impact.time, glm::length(impact.velocity));
+    }
     ImGui::Separator();
     
     if (ImGui::Button("Reset Simulation", ImVec2(-1, 30))) {
@@ -358,7 +579,7 @@ void Ui::renderImpactScreen() {
 }
 
 void Ui::renderPerformanceOverlay(const Time& time) {
-    ImGui::SetNextWindowPos(ImVec2(10, ImGui::GetIO().DisplaySize.y - 80), ImGuiCond_Always);
+    ImGui::SetNextWindowPos(ImVec2(10, ImGui::GetIO().DisplaySize.y - 150), ImGuiCond_Always);
     ImGui::SetNextWindowBgAlpha(0.5f);
     
     if (ImGui::Begin("Performance", &m_showPerformance, 
@@ -368,6 +589,291 @@ void Ui::renderPerformanceOverlay(const Time& time) {
                    1000.0 / std::max(time.getFrameTime(), 0.001));
         ImGui::Text("Physics: %.2f ms", time.getPhysicsTime());
         ImGui::Text("Render: %.2f ms", time.getRenderTime());
+        
+        // Achieved vs requested warp; highlighted when physics falls behind
+        int requestedWarp = time.isPaused() ? 0 : time.getTimeWarp();
+        bool behind = requestedWarp > 0 && m_achievedWarp < 0.95 * requestedWarp;
+        ImVec4 warpColor = behind ? ImVec4(1.0f, 0.6f, 0.2f, 1.0f) : ImVec4(0.7f, 1.0f, 0.7f, 1.0f);
+        ImGui::TextColored(warpColor, "Warp: %.0fx of %dx", m_achievedWarp, requestedWarp);
+        ImGui::Text("Step: %s, %d x %.3g s", WarpFrameStats::getMethodName(m_warpStats.method),
+                   m_warpStats.steps, m_warpStats.stepSize);
+        if (m_warpStats.attitudeSteps > 0) {
+            ImGui::Text("Attitude: %d x %.3g s", m_warpStats.attitudeSteps, m_warpStats.attitudeStepSize);
+        } else if (m_warpStats.advancedTime > 0.0) {
+            ImGui::Text("Attitude: settled on hold");
+        }
+        if (m_warpStats.backlog > 0.0 || m_warpStats.droppedTime > 0.0) {
+            ImGui::Text("Backlog: %.2f s, dropped %.2f s", m_warpStats.backlog, m_warpStats.droppedTime);
+        }
+        if (m_fleetSize > 0) {
+            ImGui::Text("Fleet: %zu vehicles, %.3f ms", m_fleetSize, m_fleetTime);
+        }
+    }
+    ImGui::End();
+}
+
+namespace {
+    // Viridis, five stops: purple (expensive) to yellow (cheap)
+    ImU32 heatmapColor(float t) {
+        static const float stops[5][3] = {
+            {68, 1, 84}, {59, 82, 139}, {33, 145, 140}, {94, 201, 98}, {253, 231, 37}
+        };
+        t = std::clamp(t, 0.0f, 1.0f) * 4.0f;
+        int i = std::min(static_cast<int>(t), 3);
+        float f = t - i;
+        auto channel = [&](int c) {
+            return static_cast<int>(stops[i][c] + (stops[i + 1][c] - stops[i][c]) * f);
+        };
+        return IM_COL32(channel(0), channel(1), channel(2), 255);
+    }
+}
+
+void Ui::setTransferGrid(TransferGrid::Result result, double computedAt) {
+    m_transferGrid = std::move(result);
+    m_transferTime = computedAt;
+    m_transferError.clear();
+    m_selectedTransferCell = SIZE_MAX;
+    
+    // Bin the grid once here rather than every frame
+    const TransferGrid::Result& grid = m_transferGrid;
+    m_heatmapColumns = std::min(grid.departureCount, HEATMAP_BINS);
+    m_heatmapRows = std::min(grid.arrivalCount, HEATMAP_BINS);
+    m_heatmapColors.assign(static_cast<size_t>(m_heatmapColumns) * m_heatmapRows, IM_COL32(40, 40, 40, 255));
+    m_heatmapCells.assign(m_heatmapColors.size(), SIZE_MAX);
+    if (grid.solvedCells == 0) {
+        return;
+    }
+    
+    const float logRange = std::log(HEATMAP_RANGE);
+    for (int bx = 0; bx < m_heatmapColumns; ++bx) {
+        int i0 = bx * grid.departureCount / m_heatmapColumns;
+        int i1 = (bx + 1) * grid.departureCount / m_heatmapColumns;
+        for (int by = 0; by < m_heatmapRows; ++by) {
+            // Row 0 is the latest arrival, so arrival time runs upwards
+            int binRow = m_heatmapRows - 1 - by;
+            int j0 = binRow * grid.arrivalCount / m_heatmapRows;
+            int j1 = (binRow + 1) * grid.arrivalCount / m_heatmapRows;
+            
+            size_t best = SIZE_MAX;
+            float bestTotal = std::numeric_limits<float>::infinity();
+            for (int i = i0; i < i1; ++i) {
+                for (int j = j0; j < j1; ++j) {
+                    size_t cell = static_cast<size_t>(i) * grid.arrivalCount + j;
+                    float total = grid.getTotalDeltaV(cell);
+                    if (total < bestTotal) {
+                        bestTotal = total;
+                        best = cell;
+                    }
+                }
+            }
+            if (best == SIZE_MAX) {
+                continue;
+            }
+            size_t bin = static_cast<size_t>(by) * m_heatmapColumns + bx;
+            m_heatmapCells[bin] = best;
+            m_heatmapColors[bin] = heatmapColor(1.0f - std::log(bestTotal / grid.bestDeltaV) / logRange);
+        }
+    }
+}
+
+void Ui::requestTransferGrid() {
+    if (!m_transferCallback) {
+        return;
+    }
+    TransferGrid::Options options;
+    options.mu = Constants::MOON_MU;
+    Orbit::createCircularOrbit(m_transferAltitude * 1000.0, m_transferInclination * Constants::DEG_TO_RAD,
+                               m_transferRaan * Constants::DEG_TO_RAD, m_transferPhase * Constants::DEG_TO_RAD,
+                               Constants::MOON_MU, Constants::MOON_RADIUS,
+                               options.arrivalPosition, options.arrivalVelocity);
+    int resolution = TRANSFER_RESOLUTIONS[m_transferResolution];
+    options.departureStart = 0.0;
+    options.departureEnd = m_transferDepartureHours * 3600.0;
+    options.departureCount = resolution;
+    options.arrivalStart = 600.0;
+    options.arrivalEnd = std::max(m_transferArrivalHours * 3600.0, options.arrivalStart);
+    options.arrivalCount = resolution;
+    m_transferCallback(options);
+}
+
+void Ui::renderTransferWindow() {
+    ImGui::SetNextWindowPos(ImVec2(790, 30), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(400, 600), ImGuiCond_FirstUseEver);
+    
+    if (ImGui::Begin("Transfer Window", &m_showTransferWindow)) {
+        // Target: a circular orbit, placed as of now
+        ImGui::Text("Target orbit (circular)");
+        ImGui::InputFloat("Altitude (km)", &m_transferAltitude, 10.0f, 100.0f, "%.0f");
+        ImGui::InputFloat("Inclination (deg)", &m_transferInclination, 1.0f, 10.0f, "%.1f");
+        ImGui::InputFloat("Node (deg)", &m_transferRaan, 1.0f, 10.0f, "%.1f");
+        ImGui::InputFloat("Phase (deg)", &m_transferPhase, 5.0f, 30.0f, "%.0f");
+        m_transferAltitude = std::max(1.0f, m_transferAltitude);
+        m_transferInclination = std::clamp(m_transferInclination, 0.0f, 180.0f);
+        
+        ImGui::Separator();
+        ImGui::InputFloat("Departures over (h)", &m_transferDepartureHours, 0.5f, 2.0f, "%.1f");
+        ImGui::InputFloat("Arrivals until (h)", &m_transferArrivalHours, 0.5f, 2.0f, "%.1f");
+        m_transferDepartureHours = std::max(0.1f, m_transferDepartureHours);
+        m_transferArrivalHours = std::max(0.2f, m_transferArrivalHours);
+        const char* resolutions[] = { "100 x 100", "300 x 300", "1000 x 1000" };
+        ImGui::Combo("Grid", &m_transferResolution, resolutions, 3);
+        
+        ImGui::BeginDisabled(m_transferBusy);
+        if (ImGui::Button("Compute", ImVec2(100, 0))) {
+            requestTransferGrid();
+        }
+        ImGui::EndDisabled();
+        if (m_transferBusy) {
+            ImGui::SameLine();
+            ImGui::Text("Computing...");
+        }
+        if (!m_transferError.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", m_transferError.c_str());
+        }
+        
+        const TransferGrid::Result& grid = m_transferGrid;
+        if (m_heatmapCells.empty()) {
+            ImGui::End();
+            return;
+        }
+        
+        ImGui::Separator();
+        ImGui::Text("%d x %d cells in %.2f s, %.1f iterations/arc",
+                   grid.departureCount, grid.arrivalCount, grid.wallSeconds, grid.meanIterations);
+        
+        // Heatmap: departure to the right, arrival upwards
+        float size = std::min(ImGui::GetContentRegionAvail().x, 360.0f);
+        ImGui::InvisibleButton("##heatmap", ImVec2(size, size));
+        ImVec2 origin = ImGui::GetItemRectMin();
+        float binWidth = size / m_heatmapColumns;
+        float binHeight = size / m_heatmapRows;
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        for (int by = 0; by < m_heatmapRows; ++by) {
+            for (int bx = 0; bx < m_heatmapColumns; ++bx) {
+                ImVec2 min(origin.x + bx * binWidth, origin.y + by * binHeight);
+                ImVec2 max(min.x + binWidth + 0.5f, min.y + binHeight + 0.5f);
+                drawList->AddRectFilled(min, max, m_heatmapColors[static_cast<size_t>(by) * m_heatmapColumns + bx]);
+            }
+        }
+        
+        auto cellTimes = [&](size_t cell, double& departure, double& arrival) {
+            departure = grid.getDepartureTime(static_cast<int>(cell / grid.arrivalCount));
+            arrival = grid.getArrivalTime(static_cast<int>(cell % grid.arrivalCount));
+        };
+        if (ImGui::IsItemHovered()) {
+            ImVec2 mouse = ImGui::GetMousePos();
+            int bx = std::clamp(static_cast<int>((mouse.x - origin.x) / binWidth), 0, m_heatmapColumns - 1);
+            int by = std::clamp(static_cast<int>((mouse.y - origin.y) / binHeight), 0, m_heatmapRows - 1);
+            size_t cell = m_heatmapCells[static_cast<size_t>(by) * m_heatmapColumns + bx];
+            if (cell != SIZE_MAX) {
+                double departure, arrival;
+                cellTimes(cell, departure, arrival);
+                ImGui::SetTooltip("Depart T+%.2f h, arrive T+%.2f h\nDelta-v %.1f m/s",
+                                  departure / 3600.0, arrival / 3600.0, grid.getTotalDeltaV(cell));
+                if (ImGui::IsItemClicked()) {
+                    m_selectedTransferCell = cell;
+                }
+            }
+        }
+        
+        // Marker on the cheapest cell
+        auto cellCenter = [&](size_t cell) {
+            float fx = (static_cast<float>(cell / grid.arrivalCount) + 0.5f) / grid.departureCount;
+            float fy = (static_cast<float>(cell % grid.arrivalCount) + 0.5f) / grid.arrivalCount;
+            return ImVec2(origin.x + fx * size, origin.y + (1.0f - fy) * size);
+        };
+        drawList->AddCircle(cellCenter(grid.bestIndex), 5.0f, IM_COL32(255, 255, 255, 255), 12, 2.0f);
+        if (m_selectedTransferCell != SIZE_MAX) {
+            drawList->AddCircle(cellCenter(m_selectedTransferCell), 5.0f, IM_COL32(255, 80, 80, 255), 12, 2.0f);
+        }
+        
+        ImGui::Text("Departure T+0 to T+%.1f h (right), arrival up to T+%.1f h (up)",
+                   grid.getDepartureTime(grid.departureCount - 1) / 3600.0,
+                   grid.getArrivalTime(grid.arrivalCount - 1) / 3600.0);
+        ImGui::Text("Yellow %.0f m/s to purple %.0f m/s and above; grey: none",
+                   grid.bestDeltaV, grid.bestDeltaV * HEATMAP_RANGE);
+        ImGui::Text("T+0 = sim time %.0f s", m_transferTime);
+        
+        ImGui::Separator();
+        auto showCell = [&](const char* label, size_t cell) {
+            double departure, arrival;
+            cellTimes(cell, departure, arrival);
+            ImGui::Text("%s: depart T+%.2f h, %.2f h flight, %d rev", label, departure / 3600.0,
+                       (arrival - departure) / 3600.0, grid.revolutions[cell]);
+            ImGui::Text("  %.1f + %.1f = %.1f m/s", grid.departureDeltaV[cell], grid.arrivalDeltaV[cell],
+                       grid.getTotalDeltaV(cell));
+        };
+        showCell("Best", grid.bestIndex);
+        if (m_selectedTransferCell != SIZE_MAX) {
+            showCell("Selected", m_selectedTransferCell);
+        }
+    }
+    ImGui::End();
+}
+
+void Ui::setFleet(const std::vector<FleetInstance>& fleet, double fleetTime) {
+    m_fleetSize = fleet.size();
+    m_fleetBurning = static_cast<size_t>(std::count_if(fleet.begin(), fleet.end(), [](const FleetInstance& vehicle) {
+        return vehicle.throttle > 0.0f;
+    }));
+    m_fleetTime = fleetTime;
+    if (m_selectedVehicle >= static_cast<int>(fleet.size())) {
+        m_selectedVehicle = -1;
+    }
+    if (m_selectedVehicle >= 0) {
+        m_selectedVehicleState = fleet[m_selectedVehicle];
+    }
+}
+
+void Ui::renderFleet() {
+    ImGui::SetNextWindowPos(ImVec2(300, 370), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(280, 300), ImGuiCond_FirstUseEver);
+    
+    if (ImGui::Begin("Fleet", &m_showFleet)) {
+        ImGui::Text("%zu vehicles, %zu burning", m_fleetSize, m_fleetBurning);
+        ImGui::Text("Advance: %.3f ms per tick", m_fleetTime);
+        
+        // Spawning replaces the fleet, on the same orbits for the same count
+        ImGui::SliderInt("Vehicles", &m_fleetSpawnCount, 0, static_cast<int>(Fleet::MAX_VEHICLES));
+        if (ImGui::Button("Spawn", ImVec2(-1, 25)) && m_spawnFleetCallback) {
+            m_spawnFleetCallback(m_fleetSpawnCount);
+        }
+        
+        ImGui::Separator();
+        ImGui::InputInt("Vehicle (-1 = all)", &m_selectedVehicle);
+        m_selectedVehicle = std::clamp(m_selectedVehicle, -1, static_cast<int>(m_fleetSize) - 1);
+        if (m_selectedVehicle >= 0) {
+            const FleetInstance& vehicle = m_selectedVehicleState;
+            OrbitalElements elements = Orbit::computeElements(vehicle.position, vehicle.velocity, Constants::MOON_MU);
+            ImGui::Text("%s%s", Fleet::getVehicleClassName(vehicle.vehicleClass),
+                        vehicle.throttle > 0.0f ? ", burning" : "");
+            ImGui::Text("Altitude: %.1f km", Orbit::computeAltitude(vehicle.position, Constants::MOON_RADIUS) / 1000.0);
+            ImGui::Text("Periapsis: %.1f km", elements.periapsisAltitude / 1000.0);
+            ImGui::Text("Apoapsis: %.1f km", elements.apoapsisAltitude / 1000.0);
+        }
+        
+        // Burn from now; the fleet has no custom directions
+        const char* modes[] = {
+            getThrustModeName(Spacecraft::ThrustMode::Prograde),
+            getThrustModeName(Spacecraft::ThrustMode::Retrograde),
+            getThrustModeName(Spacecraft::ThrustMode::RadialIn),
+            getThrustModeName(Spacecraft::ThrustMode::RadialOut),
+            getThrustModeName(Spacecraft::ThrustMode::Normal),
+            getThrustModeName(Spacecraft::ThrustMode::AntiNormal)
+        };
+        int modeInt = static_cast<int>(m_fleetThrustMode);
+        if (ImGui::Combo("Direction", &modeInt, modes, 6)) {
+            m_fleetThrustMode = static_cast<Spacecraft::ThrustMode>(modeInt);
+        }
+        ImGui::SliderFloat("Throttle", &m_fleetThrottle, 0.0f, 1.0f, "%.2f");
+        ImGui::InputFloat("Duration (s)", &m_fleetBurnDuration, 1.0f, 10.0f, "%.1f");
+        m_fleetBurnDuration = std::max(0.1f, m_fleetBurnDuration);
+        
+        ImGui::BeginDisabled(m_fleetSize == 0 || m_fleetThrottle <= 0.0f);
+        if (ImGui::Button(m_selectedVehicle < 0 ? "Burn All" : "Burn", ImVec2(-1, 25)) && m_fleetBurnCallback) {
+            m_fleetBurnCallback(m_selectedVehicle, m_fleetThrustMode, m_fleetThrottle, m_fleetBurnDuration);
+        }
+        ImGui::EndDisabled();
     }
     ImGui::End();
 }
@@ -390,13 +896,3 @@ void Ui::recordTelemetry(double simTime, double altitude, double speed, double e
         m_eccentricityHistory.pop_front();
     }
 }
-
-void Ui::updateBurn(double dt) {
-    if (m_burnActive) {
-        m_burnTimeRemaining -= static_cast<float>(dt);
-        if (m_burnTimeRemaining <= 0.0f) {
-            m_burnActive = false;
-            m_burnTimeRemaining = 0.0f;
-        }
-    }
-}
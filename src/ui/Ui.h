@@ -2,10 +2,20 @@
 
 #include "physics/Spacecraft.h"
 #include "physics/Orbit.h"
+#include "physics/Fleet.h"
+#include "physics/GravityField.h"
+#include "physics/ImpactPredictor.h"
+#include "physics/ManeuverTimeline.h"
+#include "physics/Targeting.h"
+#include "physics/TransferGrid.h"
+#include "physics/WarpScheduler.h"
 #include "core/Time.h"
 #include "render/Camera.h"
+#include <cstdint>
 #include <deque>
 #include <functional>
+#include <string>
+#include <vector>
 
 struct GLFWwindow;
 
@@ -24,24 +34,109 @@ public:
     
     // Command callbacks
     using ResetCallback = std::function<void(int scenarioIndex)>;
-    using BurnCallback = std::function<void(Spacecraft::ThrustMode mode, float throttle)>;
+    // delay: seconds of simulation time from now to ignition; 0 burns now
+    using BurnCallback = std::function<void(Spacecraft::ThrustMode mode, float throttle, float duration,
+                                            float delay)>;
+    using CancelBurnCallback = std::function<void()>;
+    using RemoveBurnCallback = std::function<void(uint32_t burnId)>;
+    
+    // Fleet: replace it with count new vehicles; burn one vehicle from
+    // now, or every vehicle if vehicleIndex is negative
+    using SpawnFleetCallback = std::function<void(int count)>;
+    using FleetBurnCallback = std::function<void(int vehicleIndex, Spacecraft::ThrustMode mode, float throttle,
+                                                 float duration)>;
+    
+    // Transfer window: the target orbit and time windows, from now; the
+    // receiver fills in the departure state
+    using TransferCallback = std::function<void(const TransferGrid::Options& options)>;
     
     void setResetCallback(ResetCallback callback) { m_resetCallback = callback; }
+    
+    // Entries of the scenario selector, in reset index order
+    void setScenarioNames(std::vector<std::string> names) { m_scenarioNames = std::move(names); }
     void setBurnCallback(BurnCallback callback) { m_burnCallback = callback; }
+    void setCancelBurnCallback(CancelBurnCallback callback) { m_cancelBurnCallback = callback; }
+    void setRemoveBurnCallback(RemoveBurnCallback callback) { m_removeBurnCallback = callback; }
+    void setTransferCallback(TransferCallback callback) { m_transferCallback = callback; }
+    void setSpawnFleetCallback(SpawnFleetCallback callback) { m_spawnFleetCallback = callback; }
+    void setFleetBurnCallback(FleetBurnCallback callback) { m_fleetBurnCallback = callback; }
+    
+    // Transfer window grid, computed from simulation time computedAt, or
+    // why it could not be
+    void setTransferBusy(bool busy) { m_transferBusy = busy; }
+    void setTransferGrid(TransferGrid::Result result, double computedAt);
+    void setTransferError(std::string error) { m_transferError = std::move(error); }
     
     // Telemetry history for graphs
     void recordTelemetry(double simTime, double altitude, double speed, double eccentricity);
     
     // Integrator selection
     int getSelectedIntegrator() const { return m_selectedIntegrator; }
+    double getPhysicsTimestep() const { return TIMESTEP_OPTIONS[m_selectedTimestep]; }
+    bool isAnalyticCoastEnabled() const { return m_analyticCoast; }
+    
+    // Gravity model: requested spherical-harmonic degree, and the degree the
+    // loaded field actually provides (0 = point mass)
+    int getGravityDegree() const { return GRAVITY_DEGREE_OPTIONS[m_selectedGravity]; }
+    bool isThirdBodiesEnabled() const { return m_thirdBodies; }
+    void setGravityDegreeInUse(int degree, bool cached) {
+        m_gravityDegreeInUse = degree;
+        m_gravityCached = cached;
+    }
+    
+    // Earth-Moon CR3BP scenario and its Jacobi constant monitor
+    void setCR3BPStatus(bool active, double jacobiConstant, double jacobiDrift) {
+        m_cr3bp = active;
+        m_jacobiConstant = jacobiConstant;
+        m_jacobiDrift = jacobiDrift;
+    }
     
     // Thrust settings
     float getThrottle() const { return m_throttle; }
     Spacecraft::ThrustMode getThrustMode() const { return m_thrustMode; }
+    bool isAttitudeHoldEnabled() const { return m_attitudeHold; }
     bool isBurnActive() const { return m_burnActive; }
+    double getBurnTimeRemaining() const { return m_burnTimeRemaining; }
+    
+    // Goal for the targeting solver; goal None in manual mode
+    Targeting::Target getTarget() const;
+    
+    // Newest solution from the physics thread; prefills the burn duration
+    void setTargetingSolution(const Targeting::Solution& solution);
+    
+    // Burn progress as reported by the physics thread
+    void setBurnStatus(bool active, double timeRemaining, double duration) {
+        m_burnActive = active;
+        m_burnTimeRemaining = static_cast<float>(timeRemaining);
+        m_activeBurnDuration = static_cast<float>(duration);
+    }
     
-    // Update burn timer (call from main loop)
-    void updateBurn(double dt);
+    // Maneuver timeline from the physics thread, and the simulation time
+    // now for the countdowns
+    void setManeuvers(const std::vector<BurnNode>& maneuvers, double simulationTime) {
+        m_maneuvers = maneuvers;
+        m_maneuverClock = simulationTime;
+    }
+    
+    // Time-warp scheduler report for the performance overlay
+    void setWarpStats(const WarpFrameStats& stats, double achievedWarp) {
+        m_warpStats = stats;
+        m_achievedWarp = achievedWarp;
+    }
+    
+    // Fleet from the physics thread and the ms its last advance took; only
+    // the counts and the selected vehicle are kept
+    void setFleet(const std::vector<FleetInstance>& fleet, double fleetTime);
+    
+    // Recent events from the physics thread, oldest first
+    void setEventLog(const std::vector<Event>& events) { m_eventLog = events; }
+    
+    // Impact or closest approach along the current prediction, and the
+    // simulation time now for the countdown
+    void setImpactPrediction(const ImpactPrediction& prediction, double simulationTime) {
+        m_impactPrediction = prediction;
+        m_predictionClock = simulationTime;
+    }
     
     // Impact screen
     bool isImpactOccurred() const { return m_impactOccurred; }
@@ -50,31 +145,106 @@ public:
 private:
     void renderSimulationControls(Time& time);
     void renderTelemetry(const SpacecraftState& state, const OrbitalElements& elements);
-    void renderManeuverPlanner(const SpacecraftState& state);
+    void renderManeuverPlanner(const SpacecraftState& state, const OrbitalElements& elements);
+    void renderTargeting(const OrbitalElements& elements);
     void renderCameraControls(Camera& camera, bool& showOrbitPath,
                              bool& showVelocityVector, bool& showThrustVector);
     void renderGraphs();
     void renderImpactScreen();
     void renderPerformanceOverlay(const Time& time);
+    void renderTransferWindow();
+    void requestTransferGrid();
+    void renderFleet();
     
     ResetCallback m_resetCallback;
     BurnCallback m_burnCallback;
+    CancelBurnCallback m_cancelBurnCallback;
+    RemoveBurnCallback m_removeBurnCallback;
+    TransferCallback m_transferCallback;
+    SpawnFleetCallback m_spawnFleetCallback;
+    FleetBurnCallback m_fleetBurnCallback;
     
     // UI state
     int m_selectedScenario = 0;
+    std::vector<std::string> m_scenarioNames;
     int m_selectedIntegrator = 2;  // RK4 by default
+    int m_selectedTimestep = 0;    // Constants::FIXED_TIMESTEP by default
+    static constexpr double TIMESTEP_OPTIONS[] = {0.02, 0.1, 1.0, 5.0, 10.0};
+    bool m_analyticCoast = true;   // Kepler jumps while no burn is active
+    int m_selectedGravity = 4;     // full field by default
+    static constexpr int GRAVITY_DEGREE_OPTIONS[] = {0, 2, 10, 50, GravityField::MAX_DEGREE};
+    int m_gravityDegreeInUse = 0;
+    bool m_gravityCached = false;
+    bool m_thirdBodies = true;     // Earth and Sun perturbations
+    bool m_cr3bp = false;
+    double m_jacobiConstant = 0.0;
+    double m_jacobiDrift = 0.0;
     int m_selectedCameraMode = 2;  // OrbitAroundMoon by default
     
     // Maneuver planner state
     float m_throttle = 0.0f;
     Spacecraft::ThrustMode m_thrustMode = Spacecraft::ThrustMode::Prograde;
+    bool m_attitudeHold = true;    // RCS holds the nose along the burn direction
     bool m_burnActive = false;
     float m_burnDuration = 10.0f;
+    float m_burnDelay = 0.0f;      // seconds to ignition; 0 = now
     float m_burnTimeRemaining = 0.0f;
+    float m_activeBurnDuration = 0.0f;
+    std::vector<BurnNode> m_maneuvers;
+    double m_maneuverClock = 0.0;
+    
+    // Targeting mode: the solver picks direction and duration
+    bool m_targetingMode = false;
+    Targeting::Goal m_targetGoal = Targeting::Goal::PeriapsisAltitude;
+    float m_targetPeriapsis = 20.0f;       // km
+    float m_targetInclination = 0.0f;      // degrees
+    Targeting::Solution m_targeting;
+    
+    // Transfer window: circular target orbit, windows from now, and the
+    // grid as a heatmap of at most HEATMAP_BINS squared bins, each showing
+    // its cheapest cell
+    float m_transferAltitude = 200.0f;      // km
+    float m_transferInclination = 30.0f;    // degrees
+    float m_transferRaan = 0.0f;            // degrees
+    float m_transferPhase = 120.0f;         // argument of latitude now (degrees)
+    float m_transferDepartureHours = 4.0f;
+    float m_transferArrivalHours = 8.0f;
+    int m_transferResolution = 1;
+    static constexpr int TRANSFER_RESOLUTIONS[] = {100, 300, 1000};
+    static constexpr int HEATMAP_BINS = 96;
+    static constexpr float HEATMAP_RANGE = 4.0f;    // colour scale: best to HEATMAP_RANGE x best
+    bool m_transferBusy = false;
+    std::string m_transferError;
+    TransferGrid::Result m_transferGrid;
+    double m_transferTime = 0.0;
+    int m_heatmapColumns = 0;       // departure bins
+    int m_heatmapRows = 0;          // arrival bins, latest first
+    std::vector<uint32_t> m_heatmapColors;      // ImU32 per bin
+    std::vector<size_t> m_heatmapCells;         // cheapest cell per bin, or SIZE_MAX
+    size_t m_selectedTransferCell = SIZE_MAX;
+    
+    // Fleet: spawn size, burn settings, and what the physics thread
+    // reported; vehicle -1 selects every vehicle
+    int m_fleetSpawnCount = 100;
+    int m_selectedVehicle = -1;
+    Spacecraft::ThrustMode m_fleetThrustMode = Spacecraft::ThrustMode::Prograde;
+    float m_fleetThrottle = 1.0f;
+    float m_fleetBurnDuration = 10.0f;
+    size_t m_fleetSize = 0;
+    size_t m_fleetBurning = 0;
+    double m_fleetTime = 0.0;
+    FleetInstance m_selectedVehicleState;
     
     // Impact state
     bool m_impactOccurred = false;
     
+    // Time-warp report
+    WarpFrameStats m_warpStats;
+    std::vector<Event> m_eventLog;
+    ImpactPrediction m_impactPrediction;
+    double m_predictionClock = 0.0;
+    double m_achievedWarp = 1.0;
+    
     // Telemetry history for graphs
     static constexpr int MAX_HISTORY_POINTS = 500;
     std::deque<double> m_timeHistory;
@@ -90,4 +260,6 @@ private:
     bool m_showCameraControls = true;
     bool m_showGraphs = true;
     bool m_showPerformance = true;
+    bool m_showTransferWindow = false;
+    bool m_showFleet = false;
 };